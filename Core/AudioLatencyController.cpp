@@ -0,0 +1,51 @@
+#include "stdafx.h"
+#include "AudioLatencyController.h"
+
+void AudioLatencyController::Reset(uint32_t requestedLatency)
+{
+	_requestedLatency = requestedLatency;
+	_targetLatency = requestedLatency;
+	_lowestLevel = -1;
+	_stableFrames = 0;
+	_increaseCount = 0;
+	_decreaseCount = 0;
+}
+
+bool AudioLatencyController::ProcessFrame(uint32_t underrunCount, double lowestLevel)
+{
+	if(underrunCount > 0) {
+		//Start over: the margin must be measured again at the new target
+		_lowestLevel = -1;
+		_stableFrames = 0;
+
+		double target = std::min(_targetLatency + IncreaseStep, _requestedLatency + MaxExtraLatency);
+		if(target != _targetLatency) {
+			_targetLatency = target;
+			_increaseCount++;
+			return true;
+		}
+		return false;
+	}
+
+	if(lowestLevel < 0) {
+		//The device isn't playing (paused, or waiting for the buffer to fill up)
+		return false;
+	}
+
+	_lowestLevel = _lowestLevel < 0 ? lowestLevel : std::min(_lowestLevel, lowestLevel);
+	_stableFrames++;
+	if(_stableFrames < StableFrameCount) {
+		return false;
+	}
+
+	bool changed = false;
+	if(_targetLatency > _requestedLatency && _lowestLevel >= RequiredMargin + DecreaseStep) {
+		_targetLatency = std::max(_requestedLatency, _targetLatency - DecreaseStep);
+		_decreaseCount++;
+		changed = true;
+	}
+
+	_lowestLevel = -1;
+	_stableFrames = 0;
+	return changed;
+}
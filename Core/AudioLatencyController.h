@@ -0,0 +1,38 @@
+#pragma once
+#include "stdafx.h"
+
+//Picks the amount of audio an output device keeps buffered, to make low latencies (e.g 20-30ms) usable on systems where the
+//audio callback's timing is too irregular to play at the requested latency without underruns. Called once per frame:
+//-Each frame with underruns raises the target latency by a step (up to MaxExtraLatency above the requested latency)
+//-After a while without underruns, if the buffer's lowest fill level over that period left enough margin, the target
+// is lowered back by a smaller step, towards the requested latency
+class AudioLatencyController
+{
+private:
+	static constexpr double IncreaseStep = 5; //ms
+	static constexpr double DecreaseStep = 1; //ms
+	static constexpr double RequiredMargin = 4; //ms - lowest fill level needed to lower the target
+	static constexpr uint32_t StableFrameCount = 600; //~10 seconds
+
+	double _requestedLatency = 0;
+	double _targetLatency = 0;
+	double _lowestLevel = -1;
+	uint32_t _stableFrames = 0;
+	uint32_t _increaseCount = 0;
+	uint32_t _decreaseCount = 0;
+
+public:
+	//Highest target latency, above the requested latency
+	static constexpr double MaxExtraLatency = 60; //ms
+
+	void Reset(uint32_t requestedLatency);
+
+	//underrunCount: number of underruns since the last call
+	//lowestLevel: lowest amount of audio (in ms) left in the buffer after the device read from it since the last call (-1 if it didn't read)
+	//Returns true when the target latency changed
+	bool ProcessFrame(uint32_t underrunCount, double lowestLevel);
+
+	double GetTargetLatency() { return _targetLatency; }
+	uint32_t GetIncreaseCount() { return _increaseCount; }
+	uint32_t GetDecreaseCount() { return _decreaseCount; }
+};
@@ -57,6 +57,7 @@ shared_ptr<BaseCartridge> BaseCartridge::CreateCartridge(Console* console, Virtu
 		}
 
 		cart->_console = console;
+		cart->_profiler = console->GetSubsystemProfiler().get();
 		cart->_romPath = romFile;
 
 		string fileExt = FolderUtilities::GetExtension(romFile.GetFileName());
@@ -506,10 +507,12 @@ void BaseCartridge::InitCoprocessor()
 	if(_coprocessorType == CoprocessorType::SA1) {
 		_coprocessor.reset(new Sa1(_console));
 		_sa1 = dynamic_cast<Sa1*>(_coprocessor.get());
+		_coprocessorSubsystem = HostSubsystem::Sa1;
 		_needCoprocSync = true;
 	} else if(_coprocessorType == CoprocessorType::GSU) {
 		_coprocessor.reset(new Gsu(_console, _coprocessorRamSize));
 		_gsu = dynamic_cast<Gsu*>(_coprocessor.get());
+		_coprocessorSubsystem = HostSubsystem::Gsu;
 		_needCoprocSync = true;
 	} else if(_coprocessorType == CoprocessorType::SDD1) {
 		_coprocessor.reset(new Sdd1(_console));
@@ -530,6 +533,7 @@ void BaseCartridge::InitCoprocessor()
 	} else if(_coprocessorType == CoprocessorType::CX4) {
 		_coprocessor.reset(new Cx4(_console));
 		_cx4 = dynamic_cast<Cx4*>(_coprocessor.get());
+		_coprocessorSubsystem = HostSubsystem::Cx4;
 		_needCoprocSync = true;
 	} else if(_coprocessorType == CoprocessorType::OBC1 && _saveRamSize > 0) {
 		_coprocessor.reset(new Obc1(_console, _saveRam, _saveRamSize));
@@ -844,6 +848,7 @@ void BaseCartridge::RunCoprocessors()
 {
 	//These coprocessors are run at the end of the frame, or as needed
 	if(_necDsp) {
+		SubsystemScope scope(_profiler, HostSubsystem::Coprocessor);
 		_necDsp->Run();
 	}
 }
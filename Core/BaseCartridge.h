@@ -3,6 +3,7 @@
 #include "IMemoryHandler.h"
 #include "CartTypes.h"
 #include "BaseCoprocessor.h"
+#include "SubsystemProfiler.h"
 #include "../Utilities/ISerializable.h"
 
 class MemoryMappings;
@@ -24,6 +25,8 @@ class BaseCartridge : public ISerializable
 {
 private:
 	Console *_console;
+	SubsystemProfiler* _profiler;
+	HostSubsystem _coprocessorSubsystem = HostSubsystem::Coprocessor;
 
 	vector<unique_ptr<IMemoryHandler>> _prgRomHandlers;
 	vector<unique_ptr<IMemoryHandler>> _saveRamHandlers;
@@ -117,10 +120,12 @@ public:
 	Gameboy* GetGameboy();
 
 	void RunCoprocessors();
+	bool NeedsCoprocessorSync() { return _needCoprocSync; }
 	
 	__forceinline void SyncCoprocessors()
 	{
 		if(_needCoprocSync) {
+			SubsystemScope scope(_profiler, _coprocessorSubsystem);
 			_coprocessor->Run();
 		}
 	}
@@ -1,6 +1,7 @@
 #include "stdafx.h"
 #include "BaseControlDevice.h"
 #include "Console.h"
+#include "EmuSettings.h"
 #include "KeyManager.h"
 #include "../Utilities/StringUtilities.h"
 #include "../Utilities/Serializer.h"
@@ -211,9 +212,19 @@ void BaseControlDevice::InvertBit(uint8_t bit)
 	}
 }
 
+bool BaseControlDevice::IsKeyPressed(uint32_t keyCode)
+{
+	return _console->GetSettings()->IsInputEnabled() && KeyManager::IsKeyPressed(keyCode);
+}
+
+bool BaseControlDevice::IsMouseButtonPressed(MouseButton button)
+{
+	return _console->GetSettings()->IsInputEnabled() && KeyManager::IsMouseButtonPressed(button);
+}
+
 void BaseControlDevice::SetPressedState(uint8_t bit, uint32_t keyCode)
 {
-	if(KeyManager::IsKeyPressed(keyCode)) {
+	if(IsKeyPressed(keyCode)) {
 		SetBit(bit);
 	}
 }
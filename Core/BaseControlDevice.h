@@ -34,6 +34,9 @@ protected:
 
 	virtual string GetKeyNames() { return ""; }
 
+	bool IsKeyPressed(uint32_t keyCode);
+	bool IsMouseButtonPressed(MouseButton button);
+
 	void SetPressedState(uint8_t bit, uint32_t keyCode);
 	void SetPressedState(uint8_t bit, bool enabled);
 
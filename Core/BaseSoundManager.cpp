@@ -11,7 +11,13 @@ void BaseSoundManager::ProcessLatency(uint32_t readPosition, uint32_t writePosit
 		cursorGap = writePosition - readPosition;
 	}
 
-	_cursorGaps[_cursorGapIndex] = cursorGap;
+	ProcessLatency((uint32_t)cursorGap);
+}
+
+void BaseSoundManager::ProcessLatency(uint32_t bufferedBytes)
+{
+	//Record the amount of audio that is buffered (written but not played yet) once per frame
+	_cursorGaps[_cursorGapIndex] = (int32_t)bufferedBytes;
 	_cursorGapIndex = (_cursorGapIndex + 1) % 60;
 	if(_cursorGapIndex == 0) {
 		_cursorGapFilled = true;
@@ -0,0 +1,71 @@
+#include "stdafx.h"
+#include "BatchRunner.h"
+#include "Console.h"
+#include "EmuSettings.h"
+#include "BatteryManager.h"
+#include "MovieManager.h"
+#include "VideoDecoder.h"
+#include "../Utilities/VirtualFile.h"
+#include "../Utilities/WorkerPool.h"
+
+vector<BatchJobResult> BatchRunner::Run(vector<BatchJob> &jobs, uint32_t threadCount)
+{
+	if(threadCount == 0) {
+		threadCount = std::max<uint32_t>(1, std::thread::hardware_concurrency());
+	}
+
+	vector<BatchJobResult> results(jobs.size());
+	WorkerPool workerPool(std::min<uint32_t>(threadCount, (uint32_t)jobs.size()));
+	workerPool.Run((uint32_t)jobs.size(), [&](uint32_t i) {
+		results[i] = RunJob(jobs[i]);
+	});
+	return results;
+}
+
+shared_ptr<Console> BatchRunner::LoadJob(BatchJob &job)
+{
+	shared_ptr<Console> console(new Console());
+	console->Initialize(true);
+
+	//Results must only depend on the rom, the movie & the frame count
+	EmulationConfig cfg = console->GetSettings()->GetEmulationConfig();
+	cfg.RamPowerOnState = RamState::AllZeros;
+	cfg.EnableIdleLoopSkip = job.EnableIdleLoopSkip;
+	console->GetSettings()->SetEmulationConfig(cfg);
+	console->GetBatteryManager()->SetFileAccessEnabled(false);
+
+	if(console->LoadRom((VirtualFile)job.RomPath, VirtualFile())) {
+		if(job.MoviePath.empty()) {
+			return console;
+		}
+
+		console->GetMovieManager()->Play((VirtualFile)job.MoviePath, true);
+		if(console->GetMovieManager()->Playing()) {
+			return console;
+		}
+	}
+
+	console->Release();
+	return nullptr;
+}
+
+BatchJobResult BatchRunner::RunJob(BatchJob &job)
+{
+	BatchJobResult result;
+
+	shared_ptr<Console> console = LoadJob(job);
+	if(!console) {
+		return result;
+	}
+
+	shared_ptr<VideoDecoder> videoDecoder = console->GetVideoDecoder();
+	result.FrameHashes.reserve(job.FrameCount);
+	for(uint32_t i = 0; i < job.FrameCount; i++) {
+		console->RunSingleFrame();
+		result.FrameHashes.push_back(videoDecoder->GetFrameHash());
+	}
+	result.Success = true;
+
+	console->Release();
+	return result;
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+#include "stdafx.h"
+
+class Console;
+
+struct BatchJob
+{
+	string RomPath;
+	string MoviePath; //Optional, input is played back from the movie (from power on)
+	uint32_t FrameCount = 0;
+	bool EnableIdleLoopSkip = false;
+};
+
+struct BatchJobResult
+{
+	bool Success = false;
+	vector<uint32_t> FrameHashes; //CRC32 of each frame's PPU output
+};
+
+//Runs jobs on headless consoles (one console per job, created & destroyed on the worker thread that runs it)
+//Consoles share no state, so the jobs are spread across all threads without any synchronization between them.
+class BatchRunner
+{
+private:
+	static BatchJobResult RunJob(BatchJob &job);
+
+public:
+	//Creates a headless console and loads the job's rom (and movie) - returns nullptr if either one can't be loaded
+	static shared_ptr<Console> LoadJob(BatchJob &job);
+
+	//threadCount: number of jobs that run at the same time (0 = one per core)
+	static vector<BatchJobResult> Run(vector<BatchJob> &jobs, uint32_t threadCount = 0);
+};
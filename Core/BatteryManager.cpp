@@ -23,8 +23,17 @@ void BatteryManager::SetBatteryRecorder(shared_ptr<IBatteryRecorder> recorder)
 	_recorder = recorder;
 }
 
+void BatteryManager::SetFileAccessEnabled(bool enabled)
+{
+	_fileAccessEnabled = enabled;
+}
+
 void BatteryManager::SaveBattery(string extension, uint8_t* data, uint32_t length)
 {
+	if(!_fileAccessEnabled) {
+		return;
+	}
+
 #ifdef LIBRETRO
 	if(extension == ".srm") {
 		//Disable .srm files for libretro, let the frontend handle save ram
@@ -46,7 +55,7 @@ vector<uint8_t> BatteryManager::LoadBattery(string extension)
 	if(provider) {
 		//Used by movie player to provider initial state of ram at startup
 		batteryData = provider->LoadBattery(extension);
-	} else {
+	} else if(_fileAccessEnabled) {
 		VirtualFile file = GetBasePath() + extension;
 		if(file.IsValid()) {
 			file.ReadFile(batteryData);
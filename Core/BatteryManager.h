@@ -19,6 +19,7 @@ private:
 	string _romName;
 	std::weak_ptr<IBatteryProvider> _provider;
 	std::weak_ptr<IBatteryRecorder> _recorder;
+	bool _fileAccessEnabled = true;
 
 	string GetBasePath();
 
@@ -27,6 +28,9 @@ public:
 
 	void SetBatteryProvider(shared_ptr<IBatteryProvider> provider);
 	void SetBatteryRecorder(shared_ptr<IBatteryRecorder> recorder);
+
+	//When disabled, battery files are never read from or written to the save folder (e.g for headless consoles)
+	void SetFileAccessEnabled(bool enabled);
 	
 	void SaveBattery(string extension, uint8_t* data, uint32_t length);
 	
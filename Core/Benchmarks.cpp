@@ -0,0 +1,458 @@
+#include "stdafx.h"
+#include "Benchmarks.h"
+#include "BatchRunner.h"
+#include "Console.h"
+#include "VideoDecoder.h"
+#include "MemoryManager.h"
+#include "SubsystemProfiler.h"
+#include "SaveStateManager.h"
+#include "Cpu.h"
+#include "Ppu.h"
+#include "RewindData.h"
+#include "MemoryMappings.h"
+#include "BaseCartridge.h"
+#include "Sa1.h"
+#include "DmaController.h"
+#include "../Utilities/FolderUtilities.h"
+#include "../Utilities/HexUtilities.h"
+#include "../Utilities/CRC32.h"
+#include "../Utilities/Timer.h"
+
+bool Benchmarks::RunJobs(vector<BatchJob> &jobs, string &report, std::function<BenchmarkJobResult(BatchJob &job, std::stringstream &out)> runJob, string headerFields)
+{
+	std::stringstream ss;
+	ss << "{" << std::endl << headerFields << "\t\"roms\": [";
+
+	bool passed = true;
+	for(size_t i = 0; i < jobs.size(); i++) {
+		std::stringstream out;
+		out << std::fixed << std::setprecision(3);
+		BenchmarkJobResult result = runJob(jobs[i], out);
+		passed &= result != BenchmarkJobResult::Failed;
+
+		ss << (i > 0 ? "," : "") << std::endl << "\t\t{ \"rom\": " << ToJsonString(FolderUtilities::GetFilename(jobs[i].RomPath, true));
+		if(result == BenchmarkJobResult::NotLoaded) {
+			ss << ", \"loaded\": false }";
+		} else {
+			ss << ", \"loaded\": true, \"frames\": " << jobs[i].FrameCount << out.str();
+			ss << ", \"passed\": " << (result == BenchmarkJobResult::Passed ? "true" : "false") << " }";
+		}
+	}
+
+	ss << std::endl << "\t]," << std::endl << "\t\"passed\": " << (passed ? "true" : "false") << std::endl << "}" << std::endl;
+	report = ss.str();
+	return passed;
+}
+
+double Benchmarks::RunFrames(Console* console, uint32_t frameCount, vector<uint32_t>* frameHashes)
+{
+	shared_ptr<VideoDecoder> videoDecoder = console->GetVideoDecoder();
+	if(frameHashes) {
+		frameHashes->reserve(frameHashes->size() + frameCount);
+	}
+
+	Timer timer;
+	for(uint32_t i = 0; i < frameCount; i++) {
+		console->RunSingleFrame();
+		if(frameHashes) {
+			frameHashes->push_back(videoDecoder->GetFrameHash());
+		}
+	}
+	return timer.GetElapsedMS();
+}
+
+string Benchmarks::ToJsonString(string str)
+{
+	string result = "\"";
+	for(char c : str) {
+		if(c == '"' || c == '\\') {
+			result += '\\';
+		}
+		result += c;
+	}
+	return result + "\"";
+}
+
+string Benchmarks::GetSaveStateTimings(Console* console)
+{
+	//Average time taken to save/load a state, with the compressed stream format (save state files)
+	//and with the uncompressed format saved to a fixed-size buffer (libretro's retro_serialize/retro_unserialize)
+	constexpr int iterations = 100;
+	shared_ptr<SaveStateManager> saveStateManager = console->GetSaveStateManager();
+
+	Timer timer;
+	string streamState;
+	for(int i = 0; i < iterations; i++) {
+		std::stringstream out;
+		saveStateManager->SaveState(out);
+		streamState = out.str();
+	}
+	double streamSaveUs = timer.GetElapsedMS() * 1000 / iterations;
+
+	timer.Reset();
+	for(int i = 0; i < iterations; i++) {
+		std::stringstream in(streamState);
+		saveStateManager->LoadState(in);
+	}
+	double streamLoadUs = timer.GetElapsedMS() * 1000 / iterations;
+
+	vector<uint8_t> memoryState(saveStateManager->GetMemoryStateSize());
+	timer.Reset();
+	for(int i = 0; i < iterations; i++) {
+		saveStateManager->SaveStateToMemory(memoryState.data(), (uint32_t)memoryState.size());
+	}
+	double memorySaveUs = timer.GetElapsedMS() * 1000 / iterations;
+
+	timer.Reset();
+	for(int i = 0; i < iterations; i++) {
+		saveStateManager->LoadStateFromMemory(memoryState.data(), (uint32_t)memoryState.size());
+	}
+	double memoryLoadUs = timer.GetElapsedMS() * 1000 / iterations;
+
+	std::stringstream ss;
+	ss << std::fixed << std::setprecision(3);
+	ss << "\"saveState\": { \"streamSize\": " << streamState.size() << ", \"streamSaveUs\": " << streamSaveUs << ", \"streamLoadUs\": " << streamLoadUs;
+	ss << ", \"memorySize\": " << memoryState.size() << ", \"memorySaveUs\": " << memorySaveUs << ", \"memoryLoadUs\": " << memoryLoadUs << " }";
+	return ss.str();
+}
+
+string Benchmarks::GetIdleLoopSkipResults(BatchJob job, vector<uint32_t> &frameHashes, double elapsedMs, bool &framesMatch)
+{
+	//Runs the same frames with idle loop skipping enabled, every frame must be identical
+	job.EnableIdleLoopSkip = true;
+	shared_ptr<Console> console = BatchRunner::LoadJob(job);
+	if(!console) {
+		framesMatch = false;
+		return "\"idleLoopSkip\": null";
+	}
+
+	vector<uint32_t> skipFrameHashes;
+	double skipElapsedMs = RunFrames(console.get(), job.FrameCount, &skipFrameHashes);
+	uint64_t masterClock = console->GetMemoryManager()->GetMasterClock();
+	IdleLoopStats stats = console->GetCpu()->GetIdleLoopDetector()->GetStats();
+	console->Release();
+
+	int64_t firstMismatch = -1;
+	for(uint32_t i = 0; i < job.FrameCount; i++) {
+		if(skipFrameHashes[i] != frameHashes[i]) {
+			firstMismatch = i;
+			break;
+		}
+	}
+	framesMatch = firstMismatch < 0;
+
+	std::stringstream ss;
+	ss << std::fixed << std::setprecision(3);
+	ss << "\"idleLoopSkip\": { \"timeMs\": " << skipElapsedMs;
+	ss << ", \"speedup\": " << (skipElapsedMs > 0 ? elapsedMs / skipElapsedMs : 0);
+	ss << ", \"skippedClocks\": " << stats.SkippedClocks;
+	ss << ", \"skippedPercent\": " << (masterClock > 0 ? stats.SkippedClocks * 100.0 / masterClock : 0);
+	ss << ", \"skipCount\": " << stats.SkipCount;
+	ss << ", \"framesMatch\": " << (framesMatch ? "true" : "false");
+	ss << ", \"firstMismatch\": " << firstMismatch << " }";
+	return ss.str();
+}
+
+bool Benchmarks::RunEmulationBenchmark(vector<BatchJob> &jobs, bool enableDebugger, string &report)
+{
+	string headerFields = string("\t\"debugger\": ") + (enableDebugger ? "true" : "false") + ",\n";
+	if(!SubsystemProfiler::IsAvailable()) {
+		//The per-rom "subsystemMs" fields are null, rather than left out, so a missing profile isn't mistaken for a format change
+		headerFields += "\t\"subsystemMsNote\": \"The subsystem profiler is compiled out (build with PROFILER=true, or define SUBSYSTEMPROFILER, to measure the time spent in each subsystem)\",\n";
+	}
+	return RunJobs(jobs, report, [enableDebugger](BatchJob &job, std::stringstream &out) {
+		//1st pass: measures the emulation speed on its own (no profiling, no video filter)
+		shared_ptr<Console> console = BatchRunner::LoadJob(job);
+		if(!console) {
+			return BenchmarkJobResult::NotLoaded;
+		}
+
+		if(enableDebugger) {
+			//Turn on the debugger to measure (and profile) the instrumented emulation loop
+			console->GetDebugger();
+		}
+
+		uint64_t startClock = console->GetMemoryManager()->GetMasterClock();
+		vector<uint32_t> frameHashes;
+		double elapsedMs = RunFrames(console.get(), job.FrameCount, &frameHashes);
+		uint64_t masterClocks = console->GetMemoryManager()->GetMasterClock() - startClock;
+		string saveStateTimings = GetSaveStateTimings(console.get());
+		console->Release();
+
+		out << ", \"timeMs\": " << elapsedMs;
+		out << ", \"fps\": " << (elapsedMs > 0 ? job.FrameCount * 1000 / elapsedMs : 0);
+		out << ", \"masterClocks\": " << masterClocks;
+		out << ", \"nsPerMasterClock\": " << (masterClocks > 0 ? elapsedMs * 1000000 / masterClocks : 0);
+		out << ", \"lastFrameHash\": \"" << HexUtilities::ToHex(frameHashes.empty() ? 0 : frameHashes.back()) << "\"";
+		out << ", " << saveStateTimings;
+
+		bool framesMatch = true;
+		if(!enableDebugger) {
+			out << ", " << GetIdleLoopSkipResults(job, frameHashes, elapsedMs, framesMatch);
+		}
+
+		if(SubsystemProfiler::IsAvailable()) {
+			//2nd pass: same frames with the subsystem profiler enabled and the frames sent to the video filter
+			//The profiler's own overhead is included in these times, so they are only meant to be compared with each other
+			console = BatchRunner::LoadJob(job);
+			if(enableDebugger) {
+				console->GetDebugger();
+			}
+			shared_ptr<SubsystemProfiler> profiler = console->GetSubsystemProfiler();
+			console->GetVideoDecoder()->SetFilterHeadlessFrames(true);
+			profiler->SetEnabled(true);
+			RunFrames(console.get(), job.FrameCount);
+
+			out << ", \"subsystemMs\": { ";
+			for(int i = 0; i < HostSubsystemCount; i++) {
+				out << (i > 0 ? ", " : "") << "\"" << SubsystemProfiler::GetSubsystemName((HostSubsystem)i) << "\": " << profiler->GetTotalTime((HostSubsystem)i) / 1000000.0;
+			}
+			out << " }";
+
+			profiler->SetEnabled(false);
+			console->Release();
+		} else {
+			out << ", \"subsystemMs\": null";
+		}
+
+		return framesMatch ? BenchmarkJobResult::Passed : BenchmarkJobResult::Failed;
+	}, headerFields);
+}
+
+bool Benchmarks::RunRewindBenchmark(vector<BatchJob> &jobs, string &report)
+{
+	return RunJobs(jobs, report, [](BatchJob &job, std::stringstream &out) {
+		constexpr uint32_t blockFrameCount = 60; //RewindManager::BufferSize
+		constexpr uint32_t checkedBlockInterval = 300; //Keep a copy of the state of every 300th block, to compare with the state loaded at the end
+
+		shared_ptr<Console> console = BatchRunner::LoadJob(job);
+		if(!console) {
+			return BenchmarkJobResult::NotLoaded;
+		}
+
+		std::deque<RewindData> history;
+		RewindStateBuffers buffers;
+		vector<std::pair<size_t, vector<uint8_t>>> checkedStates;
+		uint64_t legacySize = 0;
+		double saveMs = 0;
+		for(uint32_t frame = 1; frame <= job.FrameCount; frame++) {
+			console->RunSingleFrame();
+			if(frame % blockFrameCount == 0) {
+				Timer timer;
+				history.push_back(RewindData());
+				history.back().SaveState(console, buffers);
+				saveMs += timer.GetElapsedMS();
+
+				if(history.size() % checkedBlockInterval == 1 || history.size() % checkedBlockInterval == checkedBlockInterval - 1) {
+					//Check both a block near the start of a chain of deltas and one near the end
+					vector<uint8_t> state;
+					state.resize(console->SaveSnapshot(state));
+					checkedStates.push_back({ history.size() - 1, state });
+				}
+
+				//Previous format: the (compressed) save state, for every block
+				std::stringstream legacyState;
+				console->Serialize(legacyState);
+				legacySize += legacyState.str().size();
+			}
+		}
+
+		uint64_t historySize = 0;
+		uint32_t keyframeCount = 0;
+		for(size_t i = 0; i < history.size(); i++) {
+			historySize += history[i].GetMemoryUsage(i == 0);
+			keyframeCount += history[i].IsKeyframe() ? 1 : 0;
+		}
+
+		bool restoreMatches = true;
+		vector<uint8_t> restoredState;
+		Timer timer;
+		for(auto &checkedState : checkedStates) {
+			history[checkedState.first].LoadState(console, buffers);
+			restoredState.resize(console->SaveSnapshot(restoredState));
+			restoreMatches &= restoredState == checkedState.second;
+		}
+		double loadMs = timer.GetElapsedMS();
+		console->Release();
+
+		double minutes = job.FrameCount / 3600.0;
+		out << ", \"blocks\": " << history.size() << ", \"keyframes\": " << keyframeCount;
+		out << ", \"historyBytes\": " << historySize << ", \"historyBytesPerMinute\": " << (uint64_t)(historySize / minutes);
+		out << ", \"legacyBytes\": " << legacySize << ", \"legacyBytesPerMinute\": " << (uint64_t)(legacySize / minutes);
+		out << ", \"reduction\": " << (historySize > 0 ? (double)legacySize / historySize : 0);
+		out << ", \"saveUs\": " << (history.size() > 0 ? saveMs * 1000 / history.size() : 0);
+		out << ", \"loadUs\": " << (checkedStates.size() > 0 ? loadMs * 1000 / checkedStates.size() : 0);
+		out << ", \"restoredBlocks\": " << checkedStates.size() << ", \"restoreMatches\": " << (restoreMatches ? "true" : "false");
+		return restoreMatches ? BenchmarkJobResult::Passed : BenchmarkJobResult::Failed;
+	});
+}
+
+bool Benchmarks::RunTileCacheBenchmark(vector<BatchJob> &jobs, string &report)
+{
+	return RunJobs(jobs, report, [](BatchJob &job, std::stringstream &out) {
+		vector<uint32_t> frameHashes[2];
+		double elapsedMs[2] = {};
+		double ppuMs[2] = {};
+		TileCacheStats stats = {};
+		for(int pass = 0; pass < 2; pass++) {
+			//1st pass: with the tile cache, 2nd pass: every tile row is decoded from the bitplanes
+			bool cacheEnabled = pass == 0;
+			shared_ptr<Console> console = BatchRunner::LoadJob(job);
+			if(!console) {
+				return BenchmarkJobResult::NotLoaded;
+			}
+
+			shared_ptr<Ppu> ppu = console->GetPpu();
+			ppu->SetTileCacheEnabled(cacheEnabled);
+			shared_ptr<SubsystemProfiler> profiler = console->GetSubsystemProfiler();
+			profiler->SetEnabled(SubsystemProfiler::IsAvailable());
+
+			elapsedMs[pass] = RunFrames(console.get(), job.FrameCount, &frameHashes[pass]);
+			ppuMs[pass] = profiler->GetTotalTime(HostSubsystem::Ppu) / 1000000.0;
+			if(cacheEnabled) {
+				stats = ppu->GetTileCacheStats();
+			}
+
+			profiler->SetEnabled(false);
+			console->Release();
+		}
+
+		bool framesMatch = frameHashes[0] == frameHashes[1];
+		uint64_t lookups = stats.Hits + stats.Misses;
+		out << ", \"cached\": { \"timeMs\": " << elapsedMs[0] << ", \"ppuMs\": " << ppuMs[0] << " }";
+		out << ", \"uncached\": { \"timeMs\": " << elapsedMs[1] << ", \"ppuMs\": " << ppuMs[1] << " }";
+		out << ", \"ppuSpeedup\": " << (ppuMs[0] > 0 ? ppuMs[1] / ppuMs[0] : 0);
+		out << ", \"hits\": " << stats.Hits << ", \"misses\": " << stats.Misses << ", \"invalidations\": " << stats.Invalidations;
+		out << ", \"hitRate\": " << (lookups > 0 ? stats.Hits * 100.0 / lookups : 0);
+		out << ", \"framesMatch\": " << (framesMatch ? "true" : "false");
+		return framesMatch ? BenchmarkJobResult::Passed : BenchmarkJobResult::Failed;
+	});
+}
+
+bool Benchmarks::RunDirectPageBenchmark(vector<BatchJob> &jobs, uint32_t runCount, string &report)
+{
+	return RunJobs(jobs, report, [runCount](BatchJob &job, std::stringstream &out) {
+		vector<uint32_t> referenceHashes;
+		double bestMs[2] = { 0, 0 };
+		bool framesMatch = true;
+		for(uint32_t run = 0; run < runCount * 2; run++) {
+			//Even runs: direct page tables, odd runs: every access goes through the handlers
+			bool directPages = (run & 0x01) == 0;
+			shared_ptr<Console> console = BatchRunner::LoadJob(job);
+			if(!console) {
+				return BenchmarkJobResult::NotLoaded;
+			}
+
+			console->GetMemoryManager()->GetMemoryMappings()->SetDirectPagesEnabled(directPages);
+			if(console->GetCartridge()->GetSa1()) {
+				console->GetCartridge()->GetSa1()->GetMemoryMappings()->SetDirectPagesEnabled(directPages);
+			}
+
+			vector<uint32_t> frameHashes;
+			double elapsedMs = RunFrames(console.get(), job.FrameCount, &frameHashes);
+			console->Release();
+
+			double &best = bestMs[directPages ? 0 : 1];
+			best = best == 0 ? elapsedMs : std::min(best, elapsedMs);
+			if(run == 0) {
+				referenceHashes = std::move(frameHashes);
+			} else {
+				framesMatch &= frameHashes == referenceHashes;
+			}
+		}
+
+		auto getFps = [&job](double ms) { return ms > 0 ? job.FrameCount * 1000 / ms : 0; };
+		out << ", \"runs\": " << runCount;
+		out << ", \"directFps\": " << getFps(bestMs[0]) << ", \"handlerFps\": " << getFps(bestMs[1]);
+		out << ", \"speedup\": " << (bestMs[0] > 0 ? bestMs[1] / bestMs[0] : 0);
+		out << ", \"framesMatch\": " << (framesMatch ? "true" : "false");
+		return framesMatch ? BenchmarkJobResult::Passed : BenchmarkJobResult::Failed;
+	});
+}
+
+bool Benchmarks::RunDmaTest(vector<BatchJob> &jobs, string &report)
+{
+	return RunJobs(jobs, report, [](BatchJob &job, std::stringstream &out) {
+		//Each DMA copies a pattern from WRAM to VRAM, starting in vblank (block copies) or during active display (byte by byte)
+		//The same DMA is also run with the debugger enabled, which always copies the bytes one at a time
+		constexpr uint16_t transferSizes[2] = { 0, 0x1235 }; //0 = 64KB
+
+		bool passed = true;
+		bool firstTest = true;
+		out << ", \"tests\": [";
+		for(uint16_t transferSize : transferSizes) {
+			for(bool inVblank : { true, false }) {
+				uint64_t strippedClocks = 0;
+				for(bool enableDebugger : { false, true }) {
+					shared_ptr<Console> console = BatchRunner::LoadJob(job);
+					if(!console) {
+						return BenchmarkJobResult::NotLoaded;
+					}
+					if(enableDebugger) {
+						console->GetDebugger();
+					}
+
+					RunFrames(console.get(), job.FrameCount);
+
+					shared_ptr<Ppu> ppu = console->GetPpu();
+					shared_ptr<MemoryManager> memoryManager = console->GetMemoryManager();
+					shared_ptr<DmaController> dmaController = console->GetDmaController();
+					uint16_t scanline = inVblank ? ppu->GetVblankStart() + 1 : 100;
+					while(ppu->GetScanline() != scanline) {
+						console->GetCpu()->Exec();
+					}
+
+					uint32_t byteCount = transferSize ? transferSize : 0x10000;
+					uint8_t* workRam = memoryManager->DebugGetWorkRam();
+					uint8_t* videoRam = ppu->GetVideoRam();
+					for(uint32_t i = 0; i < 0x10000; i++) {
+						workRam[i] = (uint8_t)(i * 7 + (i >> 8) + 1);
+					}
+					memset(videoRam, 0, 0x10000);
+
+					auto write = [&memoryManager](uint16_t addr, uint8_t value) { memoryManager->Write(addr, value, MemoryOperationType::Write); };
+					write(0x2100, 0x80); //Forced blank, VRAM can be written outside of vblank
+					write(0x2115, 0x80); //Increment the VRAM address after writes to $2119
+					write(0x2116, 0x00);
+					write(0x2117, 0x00);
+					write(0x4300, 0x01); //A->B, increment, $2118/$2119
+					write(0x4301, 0x18);
+					write(0x4302, 0x00);
+					write(0x4303, 0x00);
+					write(0x4304, 0x7E);
+					write(0x4305, (uint8_t)transferSize);
+					write(0x4306, (uint8_t)(transferSize >> 8));
+
+					uint64_t startClock = memoryManager->GetMasterClock();
+					write(0x420B, 0x01);
+					while(dmaController->GetChannelConfig(0).DmaActive) {
+						dmaController->ProcessPendingTransfers();
+					}
+					uint64_t clocks = memoryManager->GetMasterClock() - startClock;
+
+					DmaChannelConfig channel = dmaController->GetChannelConfig(0);
+					bool vramMatches = memcmp(videoRam, workRam, byteCount) == 0;
+					for(uint32_t i = byteCount; i < 0x10000; i++) {
+						vramMatches &= videoRam[i] == 0;
+					}
+					uint32_t vramCrc = CRC32::GetCRC(videoRam, 0x10000);
+					console->Release();
+
+					//Same timing with and without the debugger, 8 master clocks per byte (+ overhead, HDMA, refresh, etc.)
+					if(!enableDebugger) {
+						strippedClocks = clocks;
+					}
+					bool testPassed = vramMatches && channel.TransferSize == 0 && clocks >= byteCount * 8 && clocks == strippedClocks;
+					passed &= testPassed;
+
+					out << (firstTest ? "" : ",") << std::endl << "\t\t\t{ \"transferSize\": " << byteCount << ", \"start\": \"" << (inVblank ? "vblank" : "activeDisplay") << "\"";
+					out << ", \"debugger\": " << (enableDebugger ? "true" : "false") << ", \"vramMatches\": " << (vramMatches ? "true" : "false");
+					out << ", \"vramCrc\": \"" << HexUtilities::ToHex(vramCrc) << "\", \"masterClocks\": " << clocks << ", \"passed\": " << (testPassed ? "true" : "false") << " }";
+					firstTest = false;
+				}
+			}
+		}
+		out << std::endl << "\t\t]";
+		return passed ? BenchmarkJobResult::Passed : BenchmarkJobResult::Failed;
+	});
+}
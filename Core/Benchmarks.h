@@ -0,0 +1,51 @@
+#pragma once
+#include "stdafx.h"
+#include <functional>
+#include "BatchRunner.h"
+
+class Console;
+
+enum class BenchmarkJobResult
+{
+	NotLoaded,
+	Passed,
+	Failed
+};
+
+//Benchmarks & tests that run jobs on headless consoles (see BatchRunner), used by the PGO helper
+//Each one returns true when all of its checks passed, and fills report with a JSON report that contains an entry for each job
+class Benchmarks
+{
+private:
+	//Writes the report's header and an entry for each job, containing the fields written by runJob
+	//Roms that can't be loaded are listed in the report, but don't fail the benchmark
+	static bool RunJobs(vector<BatchJob> &jobs, string &report, std::function<BenchmarkJobResult(BatchJob &job, std::stringstream &out)> runJob, string headerFields = "");
+
+	//Returns the time taken to run the frames (in ms), and the hash of each frame
+	static double RunFrames(Console* console, uint32_t frameCount, vector<uint32_t>* frameHashes = nullptr);
+
+	static string ToJsonString(string str);
+	static string GetSaveStateTimings(Console* console);
+	static string GetIdleLoopSkipResults(BatchJob job, vector<uint32_t> &frameHashes, double elapsedMs, bool &framesMatch);
+
+public:
+	//Runs each job and reports the time taken (fps, ns per master clock, save states, time per subsystem)
+	//Each job is also run with idle loop skipping enabled, which must produce the same frames (the report contains the speedup & the first frame that differs, if any)
+	static bool RunEmulationBenchmark(vector<BatchJob> &jobs, bool enableDebugger, string &report);
+
+	//Builds the rewind history of each job (a block every 60 frames, like RewindManager) and reports the memory it uses, compared to
+	//the previous format (a full compressed save state per block) - some of the blocks are loaded back at the end, they must restore the exact state
+	static bool RunRewindBenchmark(vector<BatchJob> &jobs, string &report);
+
+	//Runs each job with and without the PPU's tile cache and reports the time taken (and time spent in the PPU, when the profiler is available)
+	//along with the cache's hit rate - both passes must produce the same frames
+	static bool RunTileCacheBenchmark(vector<BatchJob> &jobs, string &report);
+
+	//Runs each job with and without the direct page tables (plain RAM/ROM accessed without going through the memory handlers) and reports the fps
+	//The passes alternate and the fastest run of each is kept, to reduce the noise - all passes must produce the same frames
+	static bool RunDirectPageBenchmark(vector<BatchJob> &jobs, uint32_t runCount, string &report);
+
+	//Runs DMA transfers to VRAM (64KB and partial, starting in vblank and during active display), with and without the debugger, after running each job's frames
+	//Each transfer must copy every byte and take the same number of master clocks whether its bytes are copied in blocks or one at a time
+	static bool RunDmaTest(vector<BatchJob> &jobs, string &report);
+};
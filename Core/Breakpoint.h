@@ -18,6 +18,9 @@ public:
 
 	uint32_t GetId();
 	CpuType GetCpuType();
+	SnesMemoryType GetMemoryType();
+	int32_t GetStartAddress();
+	int32_t GetEndAddress();
 	bool IsEnabled();
 	bool IsMarked();
 	
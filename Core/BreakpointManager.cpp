@@ -21,7 +21,12 @@ void BreakpointManager::SetBreakpoints(Breakpoint breakpoints[], uint32_t count)
 	for(int i = 0; i < BreakpointManager::BreakpointTypeCount; i++) {
 		_breakpoints[i].clear();
 		_rpnList[i].clear();
+		_conditions[i].clear();
 		_hasBreakpointType[i] = false;
+		_cpuAddressIndex[i].Clear();
+		for(BreakpointAddressIndex &index : _absAddressIndex[i]) {
+			index.Clear();
+		}
 	}
 
 	_bpExpEval.reset(new ExpressionEvaluator(_debugger, _cpuType));
@@ -38,12 +43,21 @@ void BreakpointManager::SetBreakpoints(Breakpoint breakpoints[], uint32_t count)
 
 				_breakpoints[i].push_back(bp);
 
+				uint32_t bpIndex = (uint32_t)_breakpoints[i].size() - 1;
+				if(bp.GetMemoryType() <= DebugUtilities::GetLastCpuMemoryType()) {
+					_cpuAddressIndex[i].Add(bpIndex, bp.GetStartAddress(), bp.GetEndAddress());
+				} else {
+					_absAddressIndex[i][(int)bp.GetMemoryType()].Add(bpIndex, bp.GetStartAddress(), bp.GetEndAddress());
+				}
+
 				if(bp.HasCondition()) {
 					bool success = true;
 					ExpressionData data = _bpExpEval->GetRpnList(bp.GetCondition(), success);
 					_rpnList[i].push_back(success ? data : ExpressionData());
+					_conditions[i].push_back(_bpExpEval->Compile(_rpnList[i].back()));
 				} else {
 					_rpnList[i].push_back(ExpressionData());
+					_conditions[i].push_back(CompiledExpression());
 				}
 				
 				_hasBreakpoint = true;
@@ -71,6 +85,35 @@ BreakpointType BreakpointManager::GetBreakpointType(MemoryOperationType type)
 	}
 }
 
+bool BreakpointManager::CheckCondition(int typeIndex, size_t index, bool &cpuStateLoaded, bool &ppuStateLoaded, MemoryOperationInfo &operationInfo)
+{
+	CompiledExpression &condition = _conditions[typeIndex][index];
+	if(condition.IsValid()) {
+		if(condition.UsesCpuState && !cpuStateLoaded) {
+			_debugger->GetCpuState(_state, _cpuType);
+			cpuStateLoaded = true;
+		}
+		if(condition.UsesPpuState && !ppuStateLoaded) {
+			_debugger->GetPpuState(_state, _cpuType);
+			ppuStateLoaded = true;
+		}
+		return _bpExpEval->Evaluate(condition, _state, operationInfo) != 0;
+	}
+
+	ExpressionData &rpnList = _rpnList[typeIndex][index];
+	if(rpnList.RpnQueue.empty()) {
+		//Invalid condition
+		return false;
+	}
+
+	//Conditions that can't be compiled are interpreted, using the full state
+	_debugger->GetState(_state, false);
+	cpuStateLoaded = true;
+	ppuStateLoaded = true;
+	EvalResultType resultType;
+	return _bpExpEval->Evaluate(rpnList, _state, resultType, operationInfo) != 0;
+}
+
 int BreakpointManager::InternalCheckBreakpoint(MemoryOperationInfo operationInfo, AddressInfo &address)
 {
 	BreakpointType type = GetBreakpointType(operationInfo.Type);
@@ -79,13 +122,53 @@ int BreakpointManager::InternalCheckBreakpoint(MemoryOperationInfo operationInfo
 		return -1;
 	}
 
-	DebugState state;
-	_debugger->GetState(state, false);
-	EvalResultType resultType;
+	//Get the lists of breakpoints that can match this address
+	vector<uint32_t>* candidates[4];
+	int listCount = 0;
+	auto addCandidates = [&](vector<uint32_t>* list) {
+		if(list) {
+			candidates[listCount++] = list;
+		}
+	};
+
+	if(!DebugUtilities::IsPpuMemory(address.Type)) {
+		addCandidates(_cpuAddressIndex[(int)type].GetPage(operationInfo.Address));
+		addCandidates(_cpuAddressIndex[(int)type].GetAllAddresses());
+	}
+	if((uint32_t)address.Type <= (uint32_t)SnesMemoryType::Register) {
+		BreakpointAddressIndex &absIndex = _absAddressIndex[(int)type][(int)address.Type];
+		if(address.Address >= 0) {
+			addCandidates(absIndex.GetPage(address.Address));
+		}
+		addCandidates(absIndex.GetAllAddresses());
+	}
+
+	if(listCount == 0) {
+		return -1;
+	}
+
+	//The state is only read when a matching breakpoint's condition needs it
+	bool cpuStateLoaded = false;
+	bool ppuStateLoaded = false;
 	vector<Breakpoint> &breakpoints = _breakpoints[(int)type];
-	for(size_t i = 0; i < breakpoints.size(); i++) {
+	size_t listPos[4] = {};
+	while(true) {
+		//Check the candidates in the order the breakpoints were set (the first enabled match is the one that's reported)
+		uint32_t i = UINT32_MAX;
+		int listIndex = -1;
+		for(int j = 0; j < listCount; j++) {
+			if(listPos[j] < candidates[j]->size() && (*candidates[j])[listPos[j]] < i) {
+				i = (*candidates[j])[listPos[j]];
+				listIndex = j;
+			}
+		}
+		if(listIndex < 0) {
+			break;
+		}
+		listPos[listIndex]++;
+
 		if(breakpoints[i].Matches(operationInfo.Address, address)) {
-			if(!breakpoints[i].HasCondition() || _bpExpEval->Evaluate(_rpnList[(int)type][i], state, resultType, operationInfo)) {
+			if(!breakpoints[i].HasCondition() || CheckCondition((int)type, i, cpuStateLoaded, ppuStateLoaded, operationInfo)) {
 				if(breakpoints[i].IsMarked()) {
 					_eventManager->AddEvent(DebugEventType::Breakpoint, operationInfo, breakpoints[i].GetId());
 				}
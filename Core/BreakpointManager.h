@@ -8,8 +8,64 @@ class ExpressionEvaluator;
 class Debugger;
 class IEventManager;
 struct ExpressionData;
+struct CompiledExpression;
 enum class MemoryOperationType;
 
+//Lists the breakpoints that can match each page of an address space, so memory operations only need to
+//check the few breakpoints that are close to the address (indexes are sorted in the order the breakpoints were set)
+class BreakpointAddressIndex
+{
+private:
+	static constexpr int PageShift = 12;
+
+	vector<vector<uint32_t>> _pages;
+	vector<uint32_t> _allAddresses;
+
+public:
+	void Clear()
+	{
+		_pages.clear();
+		_allAddresses.clear();
+	}
+
+	void Add(uint32_t bpIndex, int32_t startAddr, int32_t endAddr)
+	{
+		if(startAddr == -1) {
+			_allAddresses.push_back(bpIndex);
+			return;
+		}
+
+		if(endAddr == -1) {
+			endAddr = startAddr;
+		}
+		if(startAddr < 0 || endAddr < startAddr) {
+			return;
+		}
+
+		uint32_t lastPage = (uint32_t)endAddr >> PageShift;
+		if(_pages.size() <= lastPage) {
+			_pages.resize(lastPage + 1);
+		}
+		for(uint32_t page = (uint32_t)startAddr >> PageShift; page <= lastPage; page++) {
+			_pages[page].push_back(bpIndex);
+		}
+	}
+
+	vector<uint32_t>* GetPage(uint32_t addr)
+	{
+		uint32_t page = addr >> PageShift;
+		if(page < _pages.size() && !_pages[page].empty()) {
+			return &_pages[page];
+		}
+		return nullptr;
+	}
+
+	vector<uint32_t>* GetAllAddresses()
+	{
+		return _allAddresses.empty() ? nullptr : &_allAddresses;
+	}
+};
+
 class BreakpointManager
 {
 private:
@@ -21,12 +77,21 @@ private:
 	
 	vector<Breakpoint> _breakpoints[BreakpointTypeCount];
 	vector<ExpressionData> _rpnList[BreakpointTypeCount];
+	vector<CompiledExpression> _conditions[BreakpointTypeCount];
 	bool _hasBreakpoint;
 	bool _hasBreakpointType[BreakpointTypeCount] = {};
 
+	//Breakpoints on CPU addresses, and breakpoints on absolute addresses for each memory type
+	BreakpointAddressIndex _cpuAddressIndex[BreakpointTypeCount];
+	BreakpointAddressIndex _absAddressIndex[BreakpointTypeCount][(int)SnesMemoryType::Register + 1];
+
 	unique_ptr<ExpressionEvaluator> _bpExpEval;
 
+	//Only the parts of the state used by the conditions are updated before they are evaluated
+	DebugState _state;
+
 	BreakpointType GetBreakpointType(MemoryOperationType type);
+	bool CheckCondition(int typeIndex, size_t index, bool &cpuStateLoaded, bool &ppuStateLoaded, MemoryOperationInfo &operationInfo);
 	int InternalCheckBreakpoint(MemoryOperationInfo operationInfo, AddressInfo &address);
 
 public:
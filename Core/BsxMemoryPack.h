@@ -50,5 +50,8 @@ public:
 
 		uint8_t Read(uint32_t addr) override;
 		void Write(uint32_t addr, uint8_t value) override;
+
+		uint8_t* GetDirectReadPage() override { return nullptr; }
+		uint8_t* GetDirectWritePage() override { return nullptr; }
 	};
 };
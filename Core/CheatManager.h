@@ -30,6 +30,7 @@ public:
 	void ClearCheats(bool showMessage = true);
 
 	vector<CheatCode> GetCheats();
+	bool HasCheats() { return _hasCheats; }
 
 	__forceinline void ApplyCheat(uint32_t addr, uint8_t &value);
 };
@@ -36,6 +36,10 @@
 #include "SystemActionManager.h"
 #include "SpcHud.h"
 #include "Msu1.h"
+#include "GameServer.h"
+#include "GameClient.h"
+#include "SubsystemProfiler.h"
+#include "RollbackManager.h"
 #include "../Utilities/Serializer.h"
 #include "../Utilities/Timer.h"
 #include "../Utilities/VirtualFile.h"
@@ -58,9 +62,10 @@ Console::~Console()
 {
 }
 
-void Console::Initialize()
+void Console::Initialize(bool headless)
 {
 	_lockCounter = 0;
+	_headless = headless;
 
 	_notificationManager.reset(new NotificationManager());
 	_batteryManager.reset(new BatteryManager());
@@ -71,13 +76,26 @@ void Console::Initialize()
 	_debugHud.reset(new DebugHud());
 	_cheatManager.reset(new CheatManager(this));
 	_movieManager.reset(new MovieManager(shared_from_this()));
-
-	_videoDecoder->StartThread();
-	_videoRenderer->StartThread();
+	_gameServer.reset(new GameServer(this));
+	_gameClient.reset(new GameClient(this));
+	_subsystemProfiler.reset(new SubsystemProfiler());
+	_rollbackManager.reset(new RollbackManager(this));
+
+	_notificationManager->RegisterNotificationListener(_gameServer);
+	_notificationManager->RegisterNotificationListener(_gameClient);
+	_notificationManager->RegisterNotificationListener(_rollbackManager);
+
+	if(!_headless) {
+		_videoDecoder->StartThread();
+		_videoRenderer->StartThread();
+	}
 }
 
 void Console::Release()
 {
+	_gameClient->Disconnect();
+	_gameServer->StopServer();
+
 	Stop(true);
 
 	_videoDecoder->StopThread();
@@ -92,11 +110,15 @@ void Console::Release()
 	_settings.reset();
 	_cheatManager.reset();
 	_movieManager.reset();
+	_gameServer.reset();
+	_gameClient.reset();
+	_rollbackManager.reset();
 }
 
 void Console::RunFrame()
 {
 	_frameRunning = true;
+	UpdateInstrumentation();
 	if(_settings->CheckFlag(EmulationFlags::GameboyMode)) {
 		Gameboy* gameboy = _cart->GetGameboy();
 		while(_frameRunning) {
@@ -135,8 +157,11 @@ void Console::Run()
 	_lastFrameTimer.Reset();
 
 	while(!_stopFlag) {
-		bool useRunAhead = _settings->GetEmulationConfig().RunAheadFrames > 0 && !_debugger && !_rewindManager->IsRewinding() && _settings->GetEmulationSpeed() > 0 && _settings->GetEmulationSpeed() <= 100;
-		if(useRunAhead) {
+		bool useRollback = _rollbackManager->IsEnabled();
+		bool useRunAhead = !useRollback && _settings->GetEmulationConfig().RunAheadFrames > 0 && !_debugger && !_rewindManager->IsRewinding() && _settings->GetEmulationSpeed() > 0 && _settings->GetEmulationSpeed() <= 100;
+		if(useRollback) {
+			RunFrameWithRollback();
+		} else if(useRunAhead) {
 			RunFrameWithRunAhead();
 		} else {
 			RunFrame();
@@ -180,15 +205,33 @@ bool Console::ProcessSystemActions()
 	return false;
 }
 
+void Console::UpdateInstrumentation()
+{
+	//Switch between the instrumented and stripped variants of the memory manager's bus access code
+	//This is done at the start of each frame (on the emulation thread) - the debugger (and scripts) or cheats
+	//can be attached at any time, in which case they will start receiving callbacks on the following frame
+	bool instrumented = _debugger || _cheatManager->HasCheats();
+	if(_memoryManager->IsInstrumented() != instrumented) {
+		_memoryManager->SetInstrumented(instrumented);
+	}
+
+	//Idle loops can't be skipped when each cycle must be seen (debugger, cheats) or when a coprocessor runs in parallel with the CPU
+	bool skipIdleLoops = _settings->GetEmulationConfig().EnableIdleLoopSkip && !instrumented && !_cart->NeedsCoprocessorSync();
+	_cpu->GetIdleLoopDetector()->SetEnabled(skipIdleLoops);
+}
+
 void Console::RunFrameWithRunAhead()
 {
-	stringstream runAheadState;
 	uint32_t frameCount = _settings->GetEmulationConfig().RunAheadFrames;
 
 	//Run a single frame and save the state (no audio/video)
 	_isRunAheadFrame = true;
 	RunFrame();
-	Serialize(runAheadState, 0);
+
+	Timer timer;
+	uint32_t stateSize = SaveSnapshot(_runAheadState);
+	_runAheadStats.SaveTime = timer.GetElapsedMS() * 1000;
+	_runAheadStats.StateSize = stateSize;
 
 	while(frameCount > 1) {
 		//Run extra frames if the requested run ahead frame count is higher than 1
@@ -205,20 +248,83 @@ void Console::RunFrameWithRunAhead()
 	if(!wasReset) {
 		//Load the state we saved earlier
 		_isRunAheadFrame = true;
-		Deserialize(runAheadState, SaveStateManager::FileFormatVersion, false);
+		timer.Reset();
+		LoadSnapshot(_runAheadState.data(), stateSize);
+		_runAheadStats.LoadTime = timer.GetElapsedMS() * 1000;
+		_isRunAheadFrame = false;
+	}
+}
+
+void Console::RunFrameWithRollback()
+{
+	//Netplay rollback mode (see RollbackManager): the input for the next frame is polled at the end of each frame, and the frame's snapshot is saved right after
+	uint32_t rollbackFrame;
+	if(_rollbackManager->GetRollbackFrame(rollbackFrame)) {
+		//The input predicted for a previous frame was wrong, load that frame's snapshot and run the following frames again (no audio/video)
+		uint32_t currentFrame = _rollbackManager->GetFrame();
+		_isRunAheadFrame = true;
+		if(_rollbackManager->LoadFrame(rollbackFrame)) {
+			_controlManager->UpdateInputState();
+			_internalRegisters->ProcessAutoJoypadRead();
+			_rollbackManager->SaveFrame();
+
+			while((int32_t)(_rollbackManager->GetFrame() - currentFrame) < 0) {
+				RunRollbackFrame();
+				_rollbackManager->SaveFrame();
+			}
+		}
 		_isRunAheadFrame = false;
 	}
+
+	_rollbackManager->UpdateStateHashes();
+
+	if(_rollbackManager->IsStalled()) {
+		//Too far ahead of the remote players' input, wait for it
+		_rollbackManager->WaitForInput();
+		return;
+	}
+
+	RunRollbackFrame();
+	_rollbackManager->SaveFrame();
+	_rewindManager->ProcessEndOfFrame();
+	ProcessSystemActions();
+}
+
+void Console::RunRollbackFrame()
+{
+	RunFrame();
+
+	if(_headless) {
+		//Headless consoles don't poll the input in ProcessEndOfFrame, do it here to match regular consoles
+		_cart->RunCoprocessors();
+		if(_cart->GetCoprocessor()) {
+			_cart->GetCoprocessor()->ProcessEndOfFrame();
+		}
+
+		_controlManager->UpdateInputState();
+		_controlManager->UpdateControlDevices();
+		_internalRegisters->ProcessAutoJoypadRead();
+	}
 }
 
 void Console::ProcessEndOfFrame()
 {
+	_subsystemProfiler->EndFrame();
+
 #ifndef LIBRETRO
+	if(_headless) {
+		//RunSingleFrame processes the coprocessors and the input, and there is no frame limiting
+		_frameRunning = false;
+		return;
+	}
+
 	_cart->RunCoprocessors();
 	if(_cart->GetCoprocessor()) {
 		_cart->GetCoprocessor()->ProcessEndOfFrame();
 	}
 
 	if(!_isRunAheadFrame) {
+		SubsystemScope scope(_subsystemProfiler.get(), HostSubsystem::Idle);
 		_frameLimiter->ProcessFrame();
 		while(_frameLimiter->WaitForNextFrame()) {
 			if(_stopFlag || _frameDelay != GetFrameDelay() || _paused || _pauseOnNextFrame || _lockCounter > 0) {
@@ -250,10 +356,15 @@ void Console::ProcessEndOfFrame()
 
 void Console::RunSingleFrame()
 {
-	//Used by Libretro
+	//Used by Libretro and headless consoles
 	_emulationThreadId = std::this_thread::get_id();
 	_isRunAheadFrame = false;
 
+	if(_rollbackManager->IsEnabled()) {
+		RunFrameWithRollback();
+		return;
+	}
+
 	_controlManager->UpdateInputState();
 	_internalRegisters->ProcessAutoJoypadRead();
 
@@ -286,7 +397,7 @@ void Console::Stop(bool sendNotification)
 		_emuThread.release();
 	}
 
-	if(_cart && !_settings->GetPreferences().DisableGameSelectionScreen) {
+	if(_cart && !_headless && !_settings->GetPreferences().DisableGameSelectionScreen) {
 		RomInfo romInfo = _cart->GetRomInfo();
 		_saveStateManager->SaveRecentGame(romInfo.RomFile.GetFileName(), romInfo.RomFile, romInfo.PatchFile);
 	}
@@ -393,7 +504,9 @@ bool Console::LoadRom(VirtualFile romFile, VirtualFile patchFile, bool stopRom,
 	if(cart) {
 		bool debuggerActive = _debugger != nullptr;
 		if(stopRom) {
-			KeyManager::UpdateDevices();
+			if(!_headless) {
+				KeyManager::UpdateDevices();
+			}
 			Stop(false);
 		}
 
@@ -416,7 +529,7 @@ bool Console::LoadRom(VirtualFile romFile, VirtualFile patchFile, bool stopRom,
 		_memoryManager.reset(new MemoryManager());
 		_ppu.reset(new Ppu(this));
 		_controlManager.reset(new ControlManager(this));
-		_dmaController.reset(new DmaController(_memoryManager.get()));
+		_dmaController.reset(new DmaController(_memoryManager.get(), _subsystemProfiler.get()));
 		_spc.reset(new Spc(this));
 
 		_msu1.reset(Msu1::Init(romFile, _spc.get()));
@@ -465,7 +578,7 @@ bool Console::LoadRom(VirtualFile romFile, VirtualFile patchFile, bool stopRom,
 			MessageManager::DisplayMessage(messageTitle, FolderUtilities::GetFilename(GetRomInfo().RomFile.GetFileName(), false));
 		}
 
-		if(stopRom) {
+		if(stopRom && !_headless) {
 			#ifndef LIBRETRO
 			_emuThread.reset(new thread(&Console::Run, this));
 			#endif
@@ -686,9 +799,8 @@ void Console::WaitForLock()
 	}
 }
 
-void Console::Serialize(ostream &out, int compressionLevel)
+void Console::SerializeState(Serializer &serializer)
 {
-	Serializer serializer(SaveStateManager::FileFormatVersion);
 	bool isGameboyMode = _settings->CheckFlag(EmulationFlags::GameboyMode);
 
 	if(!isGameboyMode) {
@@ -707,33 +819,51 @@ void Console::Serialize(ostream &out, int compressionLevel)
 		serializer.Stream(_cart.get());
 		serializer.Stream(_controlManager.get());
 	}
+}
+
+void Console::Serialize(ostream &out, int compressionLevel)
+{
+	Serializer serializer(SaveStateManager::FileFormatVersion);
+	SerializeState(serializer);
 	serializer.Save(out, compressionLevel);
 }
 
 void Console::Deserialize(istream &in, uint32_t fileFormatVersion, bool compressed)
 {
 	Serializer serializer(in, fileFormatVersion, compressed);
-	bool isGameboyMode = _settings->CheckFlag(EmulationFlags::GameboyMode);
-
-	if(!isGameboyMode) {
-		serializer.Stream(_cpu.get());
-		serializer.Stream(_memoryManager.get());
-		serializer.Stream(_ppu.get());
-		serializer.Stream(_dmaController.get());
-		serializer.Stream(_internalRegisters.get());
-		serializer.Stream(_cart.get());
-		serializer.Stream(_controlManager.get());
-		serializer.Stream(_spc.get());
-		if(_msu1) {
-			serializer.Stream(_msu1.get());
-		}
-	} else {
-		serializer.Stream(_cart.get());
-		serializer.Stream(_controlManager.get());
-	}
+	SerializeState(serializer);
 	_notificationManager->SendNotification(ConsoleNotificationType::StateLoaded);
 }
 
+uint32_t Console::SaveSnapshot(vector<uint8_t> &buffer)
+{
+	//Saves an uncompressed state directly into the buffer (which is reused across calls to avoid allocations)
+	//Returns the number of bytes used in the buffer (the buffer itself is never shrunk)
+	Serializer serializer(SaveStateManager::FileFormatVersion, buffer);
+	SerializeState(serializer);
+	return serializer.GetSize();
+}
+
+uint32_t Console::SaveSnapshot(uint8_t* buffer, uint32_t bufferSize)
+{
+	//Same as above, but the buffer cannot grow - throws if the state does not fit in it
+	Serializer serializer(SaveStateManager::FileFormatVersion, buffer, bufferSize);
+	SerializeState(serializer);
+	return serializer.GetSize();
+}
+
+void Console::LoadSnapshot(uint8_t* data, uint32_t size)
+{
+	//Used for run-ahead, etc. - does not send a StateLoaded notification, since this isn't a user-initiated state load
+	Serializer serializer(data, size, SaveStateManager::FileFormatVersion);
+	SerializeState(serializer);
+}
+
+SnapshotStatistics Console::GetRunAheadStatistics()
+{
+	return _runAheadStats;
+}
+
 shared_ptr<SoundMixer> Console::GetSoundMixer()
 {
 	return _soundMixer;
@@ -789,6 +919,26 @@ shared_ptr<MovieManager> Console::GetMovieManager()
 	return _movieManager;
 }
 
+shared_ptr<GameServer> Console::GetGameServer()
+{
+	return _gameServer;
+}
+
+shared_ptr<GameClient> Console::GetGameClient()
+{
+	return _gameClient;
+}
+
+shared_ptr<SubsystemProfiler> Console::GetSubsystemProfiler()
+{
+	return _subsystemProfiler;
+}
+
+shared_ptr<RollbackManager> Console::GetRollbackManager()
+{
+	return _rollbackManager;
+}
+
 shared_ptr<Cpu> Console::GetCpu()
 {
 	return _cpu;
@@ -877,6 +1027,11 @@ bool Console::IsRunning()
 	return _cpu != nullptr;
 }
 
+bool Console::IsHeadless()
+{
+	return _headless;
+}
+
 bool Console::IsRunAheadFrame()
 {
 	return _isRunAheadFrame;
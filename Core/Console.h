@@ -32,6 +32,11 @@ class SpcHud;
 class FrameLimiter;
 class DebugStats;
 class Msu1;
+class GameServer;
+class GameClient;
+class SubsystemProfiler;
+class RollbackManager;
+class Serializer;
 
 enum class MemoryOperationType;
 enum class SnesMemoryType;
@@ -39,6 +44,13 @@ enum class EventType;
 enum class ConsoleRegion;
 enum class ConsoleType;
 
+struct SnapshotStatistics
+{
+	double SaveTime;
+	double LoadTime;
+	uint32_t StateSize;
+};
+
 class Console : public std::enable_shared_from_this<Console>
 {
 private:
@@ -69,6 +81,10 @@ private:
 	shared_ptr<CheatManager> _cheatManager;
 	shared_ptr<MovieManager> _movieManager;
 	shared_ptr<SpcHud> _spcHud;
+	shared_ptr<GameServer> _gameServer;
+	shared_ptr<GameClient> _gameClient;
+	shared_ptr<SubsystemProfiler> _subsystemProfiler;
+	shared_ptr<RollbackManager> _rollbackManager;
 
 	thread::id _emulationThreadId;
 	
@@ -82,6 +98,8 @@ private:
 	atomic<bool> _pauseOnNextFrame;
 	atomic<bool> _threadPaused;
 
+	bool _headless = false;
+
 	ConsoleRegion _region;
 	ConsoleType _consoleType;
 	uint32_t _masterClockRate;
@@ -89,6 +107,9 @@ private:
 	atomic<bool> _isRunAheadFrame;
 	bool _frameRunning = false;
 
+	vector<uint8_t> _runAheadState;
+	SnapshotStatistics _runAheadStats = {};
+
 	unique_ptr<DebugStats> _stats;
 	unique_ptr<FrameLimiter> _frameLimiter;
 	Timer _lastFrameTimer;
@@ -100,14 +121,21 @@ private:
 	void WaitForPauseEnd();
 
 	void RunFrame();
+	void UpdateInstrumentation();
 	bool ProcessSystemActions();
 	void RunFrameWithRunAhead();
+	void RunFrameWithRollback();
+	void RunRollbackFrame();
+
+	void SerializeState(Serializer &serializer);
 
 public:
 	Console();
 	~Console();
 
-	void Initialize();
+	//Headless consoles have no emulation/video threads and don't read the host's input devices - the caller runs
+	//them one frame at a time with RunSingleFrame(), and their frames aren't decoded (see VideoDecoder::GetFrameHash)
+	void Initialize(bool headless = false);
 	void Release();
 
 
@@ -142,6 +170,11 @@ public:
 	void Serialize(ostream &out, int compressionLevel = 1);
 	void Deserialize(istream &in, uint32_t fileFormatVersion, bool compressed = true);
 
+	uint32_t SaveSnapshot(vector<uint8_t> &buffer);
+	uint32_t SaveSnapshot(uint8_t* buffer, uint32_t bufferSize);
+	void LoadSnapshot(uint8_t* data, uint32_t size);
+	SnapshotStatistics GetRunAheadStatistics();
+
 	shared_ptr<SoundMixer> GetSoundMixer();
 	shared_ptr<VideoRenderer> GetVideoRenderer();
 	shared_ptr<VideoDecoder> GetVideoDecoder();
@@ -153,6 +186,10 @@ public:
 	shared_ptr<BatteryManager> GetBatteryManager();
 	shared_ptr<CheatManager> GetCheatManager();
 	shared_ptr<MovieManager> GetMovieManager();
+	shared_ptr<GameServer> GetGameServer();
+	shared_ptr<GameClient> GetGameClient();
+	shared_ptr<SubsystemProfiler> GetSubsystemProfiler();
+	shared_ptr<RollbackManager> GetRollbackManager();
 
 	shared_ptr<Cpu> GetCpu();
 	shared_ptr<Ppu> GetPpu();
@@ -172,6 +209,7 @@ public:
 	
 	bool IsRunning();
 	bool IsRunAheadFrame();
+	bool IsHeadless();
 
 	uint32_t GetFrameCount();	
 	double GetFps();
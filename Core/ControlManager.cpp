@@ -138,14 +138,20 @@ void ControlManager::UpdateControlDevices()
 
 void ControlManager::UpdateInputState()
 {
-	KeyManager::RefreshKeyState();
+	//Headless consoles only receive input from the input providers (movies, netplay, etc.)
+	bool headless = _console->IsHeadless();
+	if(!headless) {
+		KeyManager::RefreshKeyState();
+	}
 
 	auto lock = _deviceLock.AcquireSafe();
 
 	//string log = "F: " + std::to_string(_console->GetPpu()->GetFrameCount()) + " C:" + std::to_string(_pollCounter) + " ";
 	for(shared_ptr<BaseControlDevice> &device : _controlDevices) {
 		device->ClearState();
-		device->SetStateFromInput();
+		if(!headless) {
+			device->SetStateFromInput();
+		}
 
 		for(size_t i = 0; i < _inputProviders.size(); i++) {
 			IInputProvider* provider = _inputProviders[i];
@@ -15,6 +15,7 @@ Cpu::Cpu(Console *console)
 	_console = console;
 	_memoryManager = console->GetMemoryManager().get();
 	_dmaController = console->GetDmaController().get();
+	_idleLoopDetector.Initialize(console);
 }
 #endif
 
@@ -27,7 +28,16 @@ void Cpu::Exec()
 	_immediateMode = false;
 
 	switch(_state.StopState) {
-		case CpuStopState::Running: RunOp(); break;
+		case CpuStopState::Running:
+		#ifndef DUMMYCPU
+			if(_idleLoopDetector.IsEnabled()) {
+				RunOpWithIdleLoopDetection();
+				break;
+			}
+		#endif
+			RunOp();
+			break;
+
 		case CpuStopState::Stopped:
 			//STP was executed, CPU no longer executes any code
 		#ifndef DUMMYCPU
@@ -37,6 +47,11 @@ void Cpu::Exec()
 
 		case CpuStopState::WaitingForIrq:
 			//WAI
+		#ifndef DUMMYCPU
+			if(_idleLoopDetector.IsEnabled()) {
+				_idleLoopDetector.ProcessWait(_state);
+			}
+		#endif
 			Idle();
 			if(_state.IrqSource || _state.NeedNmi) {
 				Idle();
@@ -61,6 +76,19 @@ void Cpu::Exec()
 #endif
 }
 
+#ifndef DUMMYCPU
+void Cpu::RunOpWithIdleLoopDetection()
+{
+	uint32_t opAddr = GetProgramAddress(_state.PC);
+	_branchTaken = false;
+	RunOp();
+	if(_branchTaken && GetProgramAddress(_state.PC) <= opAddr) {
+		//Backward branch/jump, may be the end of a polling loop's iteration
+		_idleLoopDetector.ProcessLoop(_state);
+	}
+}
+#endif
+
 void Cpu::Idle()
 {
 #ifndef DUMMYCPU
@@ -73,12 +101,18 @@ void Cpu::Idle()
 
 void Cpu::IdleEndJump()
 {
-	//Used by SA1
+	//Used by SA1 and the idle loop detector
+#ifndef DUMMYCPU
+	_branchTaken = true;
+#endif
 }
 
 void Cpu::IdleTakeBranch()
 {
-	//Used by SA1
+	//Used by SA1 and the idle loop detector
+#ifndef DUMMYCPU
+	_branchTaken = true;
+#endif
 }
 
 void Cpu::ProcessCpuCycle()
@@ -104,6 +138,7 @@ uint8_t Cpu::Read(uint32_t addr, MemoryOperationType type)
 {
 	_memoryManager->SetCpuSpeed(_memoryManager->GetCpuSpeed(addr));
 	ProcessCpuCycle();
+	_idleLoopDetector.LogRead(addr);
 	uint8_t value = _memoryManager->Read(addr, type);
 	UpdateIrqNmiFlags();
 	return value;
@@ -113,6 +148,7 @@ void Cpu::Write(uint32_t addr, uint8_t value, MemoryOperationType type)
 {
 	_memoryManager->SetCpuSpeed(_memoryManager->GetCpuSpeed(addr));
 	ProcessCpuCycle();
+	_idleLoopDetector.LogWrite();
 	_memoryManager->Write(addr, value, type);
 	UpdateIrqNmiFlags();
 }
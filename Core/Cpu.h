@@ -7,6 +7,7 @@
 
 #include "stdafx.h"
 #include "CpuTypes.h"
+#include "IdleLoopDetector.h"
 #include "../Utilities/ISerializable.h"
 
 class MemoryMappings;
@@ -39,6 +40,13 @@ private:
 	CpuState _state = {};
 	uint32_t _operand = -1;
 
+#ifndef DUMMYCPU
+	IdleLoopDetector _idleLoopDetector;
+	bool _branchTaken = false;
+
+	void RunOpWithIdleLoopDetection();
+#endif
+
 	uint32_t GetProgramAddress(uint16_t addr);
 	uint32_t GetDataAddress(uint16_t addr);
 
@@ -342,6 +350,10 @@ public:
 	bool CheckIrqSource(IrqSource source);
 	void ClearIrqSource(IrqSource source);
 
+#ifndef DUMMYCPU
+	IdleLoopDetector* GetIdleLoopDetector() { return &_idleLoopDetector; }
+#endif
+
 	// Inherited via ISerializable
 	void Serialize(Serializer &s) override;
 
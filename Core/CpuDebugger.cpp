@@ -79,10 +79,8 @@ void CpuDebugger::ProcessRead(uint32_t addr, uint8_t value, MemoryOperationType
 		}
 
 		if(_traceLogger->IsCpuLogged(_cpuType)) {
-			_debugger->GetState(_debugState, true);
-
 			DisassemblyInfo disInfo = _disassembler->GetDisassemblyInfo(addressInfo, addr, state.PS, _cpuType);
-			_traceLogger->Log(_cpuType, _debugState, disInfo);
+			_traceLogger->Log(_cpuType, state, disInfo);
 		}
 
 		uint32_t pc = (state.K << 16) | state.PC;
@@ -41,7 +41,6 @@ class CpuDebugger final : public IDebugger
 	bool _enableBreakOnUninitRead = false;
 	uint8_t _prevOpCode = 0xFF;
 	uint32_t _prevProgramCounter = 0;
-	DebugState _debugState;
 
 	MemoryMappings& GetMemoryMappings();
 	CpuState GetState();
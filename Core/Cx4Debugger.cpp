@@ -55,11 +55,8 @@ void Cx4Debugger::ProcessRead(uint32_t addr, uint8_t value, MemoryOperationType
 			_disassembler->BuildCache(addressInfo, 0, CpuType::Cx4);
 
 			if(_traceLogger->IsCpuLogged(CpuType::Cx4)) {
-				DebugState debugState;
-				_debugger->GetState(debugState, true);
-
 				DisassemblyInfo disInfo = _disassembler->GetDisassemblyInfo(addressInfo, addr, 0, CpuType::Cx4);
-				_traceLogger->Log(CpuType::Cx4, debugState, disInfo);
+				_traceLogger->Log(state, disInfo);
 			}
 		}
 
@@ -5,6 +5,9 @@
 #include "EmuSettings.h"
 #include "DebugHud.h"
 #include "IAudioDevice.h"
+#include "RollbackManager.h"
+#include "GameServer.h"
+#include "GameClient.h"
 
 void DebugStats::DisplayStats(Console *console, double lastFrameTime)
 {
@@ -17,8 +20,8 @@ void DebugStats::DisplayStats(Console *console, double lastFrameTime)
 
 	int startFrame = console->GetFrameCount();
 
-	hud->DrawRectangle(8, 8, 115, 49, 0x40000000, true, 1, startFrame);
-	hud->DrawRectangle(8, 8, 115, 49, 0xFFFFFF, false, 1, startFrame);
+	hud->DrawRectangle(8, 8, 115, 58, 0x40000000, true, 1, startFrame);
+	hud->DrawRectangle(8, 8, 115, 58, 0xFFFFFF, false, 1, startFrame);
 
 	hud->DrawString(10, 10, "Audio Stats", 0xFFFFFF, 0xFF000000, 1, startFrame);
 	hud->DrawString(10, 21, "Latency: ", 0xFFFFFF, 0xFF000000, 1, startFrame);
@@ -30,10 +33,11 @@ void DebugStats::DisplayStats(Console *console, double lastFrameTime)
 
 	hud->DrawString(10, 30, "Underruns: " + std::to_string(stats.BufferUnderrunEventCount), 0xFFFFFF, 0xFF000000, 1, startFrame);
 	hud->DrawString(10, 39, "Buffer Size: " + std::to_string(stats.BufferSize / 1024) + "kb", 0xFFFFFF, 0xFF000000, 1, startFrame);
-	hud->DrawString(10, 48, "Rate: " + std::to_string((uint32_t)(audioCfg.SampleRate *  console->GetSoundMixer()->GetRateAdjustment())) + "Hz", 0xFFFFFF, 0xFF000000, 1, startFrame);
+	hud->DrawString(10, 48, "Overruns: " + std::to_string(stats.BufferOverrunEventCount), 0xFFFFFF, 0xFF000000, 1, startFrame);
+	hud->DrawString(10, 57, "Rate: " + std::to_string((uint32_t)(audioCfg.SampleRate *  console->GetSoundMixer()->GetRateAdjustment())) + "Hz", 0xFFFFFF, 0xFF000000, 1, startFrame);
 
-	hud->DrawRectangle(132, 8, 115, 49, 0x40000000, true, 1, startFrame);
-	hud->DrawRectangle(132, 8, 115, 49, 0xFFFFFF, false, 1, startFrame);
+	hud->DrawRectangle(132, 8, 115, 58, 0x40000000, true, 1, startFrame);
+	hud->DrawRectangle(132, 8, 115, 58, 0xFFFFFF, false, 1, startFrame);
 	hud->DrawString(134, 10, "Video Stats", 0xFFFFFF, 0xFF000000, 1, startFrame);
 
 	double totalDuration = 0;
@@ -64,4 +68,41 @@ void DebugStats::DisplayStats(Console *console, double lastFrameTime)
 	ss = std::stringstream();
 	ss << "Max Delay: " << std::fixed << std::setprecision(2) << _lastFrameMax << " ms";
 	hud->DrawString(134, 48, ss.str(), 0xFFFFFF, 0xFF000000, 1, startFrame);
+
+	if(console->GetSettings()->GetEmulationConfig().RunAheadFrames > 0) {
+		SnapshotStatistics runAheadStats = console->GetRunAheadStatistics();
+
+		hud->DrawRectangle(8, 69, 115, 40, 0x40000000, true, 1, startFrame);
+		hud->DrawRectangle(8, 69, 115, 40, 0xFFFFFF, false, 1, startFrame);
+		hud->DrawString(10, 71, "Run-Ahead Stats", 0xFFFFFF, 0xFF000000, 1, startFrame);
+
+		ss = std::stringstream();
+		ss << "Save: " << std::fixed << std::setprecision(1) << runAheadStats.SaveTime << " us";
+		hud->DrawString(10, 82, ss.str(), 0xFFFFFF, 0xFF000000, 1, startFrame);
+
+		ss = std::stringstream();
+		ss << "Load: " << std::fixed << std::setprecision(1) << runAheadStats.LoadTime << " us";
+		hud->DrawString(10, 91, ss.str(), 0xFFFFFF, 0xFF000000, 1, startFrame);
+
+		hud->DrawString(10, 100, "State Size: " + std::to_string(runAheadStats.StateSize / 1024) + "kb", 0xFFFFFF, 0xFF000000, 1, startFrame);
+	}
+
+	shared_ptr<RollbackManager> rollbackManager = console->GetRollbackManager();
+	if(rollbackManager->IsEnabled()) {
+		RollbackStatistics netplayStats = rollbackManager->GetStatistics();
+		NetplayStatistics networkStats = console->GetGameServer()->Started() ? console->GetGameServer()->GetStatistics() : console->GetGameClient()->GetStatistics();
+
+		hud->DrawRectangle(132, 69, 115, 76, 0x40000000, true, 1, startFrame);
+		hud->DrawRectangle(132, 69, 115, 76, 0xFFFFFF, false, 1, startFrame);
+		hud->DrawString(134, 71, "Netplay Stats", 0xFFFFFF, 0xFF000000, 1, startFrame);
+		hud->DrawString(134, 82, "Rollbacks: " + std::to_string(netplayStats.RollbackCount), 0xFFFFFF, 0xFF000000, 1, startFrame);
+		hud->DrawString(134, 91, "Frames Rerun: " + std::to_string(netplayStats.RolledBackFrames), 0xFFFFFF, 0xFF000000, 1, startFrame);
+		hud->DrawString(134, 100, "Max Depth: " + std::to_string(netplayStats.MaxRollbackDepth), 0xFFFFFF, 0xFF000000, 1, startFrame);
+		hud->DrawString(134, 109, "Stalls: " + std::to_string(netplayStats.StallCount), 0xFFFFFF, 0xFF000000, 1, startFrame);
+
+		int color = netplayStats.DesyncCount > 0 ? 0xFF0000 : 0xFFFFFF;
+		hud->DrawString(134, 118, "Desyncs: " + std::to_string(netplayStats.DesyncCount), color, 0xFF000000, 1, startFrame);
+		hud->DrawString(134, 127, "Sent: " + std::to_string(networkStats.BytesSent / 1024) + "kb", 0xFFFFFF, 0xFF000000, 1, startFrame);
+		hud->DrawString(134, 136, "Received: " + std::to_string(networkStats.BytesReceived / 1024) + "kb", 0xFFFFFF, 0xFF000000, 1, startFrame);
+	}
 }
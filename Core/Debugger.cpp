@@ -44,6 +44,7 @@
 #include "Assembler.h"
 #include "Gameboy.h"
 #include "GbPpu.h"
+#include "GbCpu.h"
 #include "GbAssembler.h"
 #include "GameboyHeader.h"
 #include "../Utilities/HexUtilities.h"
@@ -150,7 +151,7 @@ void Debugger::ProcessMemoryRead(uint32_t addr, uint8_t value, MemoryOperationTy
 		case CpuType::Gameboy: _gbDebugger->ProcessRead(addr, value, opType); break;
 	}
 	
-	if(_scriptManager->HasScript()) {
+	if(_scriptManager->HasMemoryCallback(addr, opType, type)) {
 		_scriptManager->ProcessMemoryOperation(addr, value, opType, type);
 	}
 }
@@ -168,7 +169,7 @@ void Debugger::ProcessMemoryWrite(uint32_t addr, uint8_t value, MemoryOperationT
 		case CpuType::Gameboy: _gbDebugger->ProcessWrite(addr, value, opType); break;
 	}
 	
-	if(_scriptManager->HasScript()) {
+	if(_scriptManager->HasMemoryCallback(addr, opType, type)) {
 		_scriptManager->ProcessMemoryOperation(addr, value, opType, type);
 	}
 }
@@ -511,6 +512,28 @@ void Debugger::GetState(DebugState &state, bool partialPpuState)
 	}
 }
 
+void Debugger::GetCpuState(DebugState &state, CpuType cpuType)
+{
+	switch(cpuType) {
+		case CpuType::Cpu: state.Cpu = _cpu->GetState(); break;
+		case CpuType::Spc: state.Spc = _spc->GetState(); break;
+		case CpuType::NecDsp: state.NecDsp = _cart->GetDsp()->GetState(); break;
+		case CpuType::Sa1: state.Sa1.Cpu = _cart->GetSa1()->GetCpuState(); break;
+		case CpuType::Gsu: state.Gsu = _cart->GetGsu()->GetState(); break;
+		case CpuType::Cx4: state.Cx4 = _cart->GetCx4()->GetState(); break;
+		case CpuType::Gameboy: state.Gameboy.Cpu = _cart->GetGameboy()->GetCpu()->GetState(); break;
+	}
+}
+
+void Debugger::GetPpuState(DebugState &state, CpuType cpuType)
+{
+	if(cpuType == CpuType::Gameboy) {
+		state.Gameboy.Ppu = _cart->GetGameboy()->GetPpu()->GetState();
+	} else {
+		_ppu->GetState(state.Ppu, true);
+	}
+}
+
 AddressInfo Debugger::GetAbsoluteAddress(AddressInfo relAddress)
 {
 	if(relAddress.Type == SnesMemoryType::CpuMemory) {
@@ -129,6 +129,10 @@ public:
 
 	void GetState(DebugState &state, bool partialPpuState);
 
+	//Only fill the parts of the state that expressions evaluated for the given CPU can read
+	void GetCpuState(DebugState &state, CpuType cpuType);
+	void GetPpuState(DebugState &state, CpuType cpuType);
+
 	AddressInfo GetAbsoluteAddress(AddressInfo relAddress);
 	AddressInfo GetRelativeAddress(AddressInfo absAddress, CpuType cpuType);
 
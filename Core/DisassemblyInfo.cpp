@@ -29,6 +29,7 @@ void DisassemblyInfo::Initialize(uint8_t *opPointer, uint8_t cpuFlags, CpuType t
 	_flags = cpuFlags;
 	_opSize = GetOpSize(opPointer[0], _flags, _cpuType);
 	memcpy(_byteCode, opPointer, _opSize);
+	memset(_byteCode + _opSize, 0, sizeof(_byteCode) - _opSize); //Binary trace logs contain the whole array
 
 	_initialized = true;
 }
@@ -46,6 +47,7 @@ void DisassemblyInfo::Initialize(uint32_t cpuAddress, uint8_t cpuFlags, CpuType
 	for(int i = 1; i < _opSize; i++) {
 		_byteCode[i] = memoryDumper->GetMemoryValue(cpuMemType, cpuAddress+i);
 	}
+	memset(_byteCode + _opSize, 0, sizeof(_byteCode) - _opSize);
 
 	_initialized = true;
 }
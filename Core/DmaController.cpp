@@ -2,7 +2,10 @@
 #include "DmaController.h"
 #include "DmaControllerTypes.h"
 #include "MemoryManager.h"
+#include "MemoryMappings.h"
+#include "IMemoryHandler.h"
 #include "MessageManager.h"
+#include "SubsystemProfiler.h"
 #include "../Utilities/Serializer.h"
 
 static constexpr uint8_t _transferByteCount[8] = { 1, 2, 2, 4, 4, 4, 2, 4 };
@@ -11,9 +14,10 @@ static constexpr uint8_t _transferOffset[8][4] = {
 	{ 0, 1, 2, 3 }, { 0, 1, 0, 1 }, { 0, 0, 0, 0 }, { 0, 0, 1, 1 }
 };
 
-DmaController::DmaController(MemoryManager *memoryManager)
+DmaController::DmaController(MemoryManager *memoryManager, SubsystemProfiler *profiler)
 {
 	_memoryManager = memoryManager;
+	_profiler = profiler;
 	Reset();
 
 	for(int j = 0; j < 8; j++) {
@@ -74,6 +78,12 @@ void DmaController::RunDma(DmaChannelConfig &channel)
 
 	uint8_t i = 0;
 	do {
+		//Copy the bytes that can be copied in a single block first, the next byte (if any) is copied normally
+		//A TransferSize of 0 means 64KB, so the transfer is only over if the block copied the last bytes
+		if(RunBlockTransfer(channel, i) > 0 && channel.TransferSize == 0) {
+			break;
+		}
+
 		//Manual DMA transfers run to the end of the transfer when started
 		CopyDmaByte(
 			(channel.SrcBank << 16) | channel.SrcAddress,
@@ -93,6 +103,61 @@ void DmaController::RunDma(DmaChannelConfig &channel)
 	channel.DmaActive = false;
 }
 
+uint32_t DmaController::RunBlockTransfer(DmaChannelConfig &channel, uint8_t &offsetIndex)
+{
+	//Fast path for the common bus A -> bus B uploads (ROM/RAM to VRAM, CGRAM & OAM during vblank, or to the WRAM port)
+	//The bytes that can be copied before anything else can happen (event, IRQ, etc.) are copied without running each
+	//master clock - the clock is moved forward once at the end, so the result is the same as with CopyDmaByte
+	if(channel.InvertDirection) {
+		return 0;
+	}
+
+	const uint8_t *transferOffsets = _transferOffset[channel.TransferMode];
+	bool toWorkRamPort = false;
+	for(int i = 0; i < 4; i++) {
+		uint16_t addressBusB = 0x2100 | (uint8_t)(channel.DestAddress + transferOffsets[i]);
+		if(!_memoryManager->IsBlockTransferTarget(addressBusB)) {
+			return 0;
+		}
+		toWorkRamPort |= addressBusB == 0x2180;
+	}
+
+	//8 master clocks per byte
+	uint32_t count = std::min<uint32_t>(_memoryManager->GetIdleClockWindow() / 8, channel.TransferSize ? channel.TransferSize : 0x10000);
+	if(count == 0) {
+		return 0;
+	}
+
+	MemoryMappings* mappings = _memoryManager->GetMemoryMappings();
+	uint32_t addressBusA = 0;
+	uint8_t value = 0;
+	uint32_t copied = 0;
+	for(; copied < count; copied++) {
+		uint32_t addr = (channel.SrcBank << 16) | channel.SrcAddress;
+		uint8_t* page = mappings->GetDirectReadPage(addr);
+		if(!page || (toWorkRamPort && _memoryManager->IsWorkRam(addr))) {
+			//Registers, etc. (or WRAM->$2180, which doesn't write anything) - the rest is copied normally
+			break;
+		}
+
+		addressBusA = addr;
+		value = page[addr & 0xFFF];
+		uint16_t addressBusB = 0x2100 | (uint8_t)(channel.DestAddress + transferOffsets[offsetIndex & 0x03]);
+		mappings->GetHandler(addressBusB)->Write(addressBusB, value);
+
+		if(!channel.FixedTransfer) {
+			channel.SrcAddress += channel.Decrement ? -1 : 1;
+		}
+		channel.TransferSize--;
+		offsetIndex++;
+	}
+
+	if(copied > 0) {
+		_memoryManager->EndBlockTransfer(addressBusA, value, copied * 8);
+	}
+	return copied;
+}
+
 bool DmaController::InitHdmaChannels()
 {
 	_hdmaInitPending = false;
@@ -351,6 +416,8 @@ bool DmaController::ProcessPendingTransfers()
 		return false;
 	}
 
+	SubsystemScope scope(_profiler, HostSubsystem::Dma);
+
 	if(_hdmaPending) {
 		return ProcessHdmaChannels();
 	} else if(_hdmaInitPending) {
@@ -5,6 +5,7 @@
 #include "../Utilities/ISerializable.h"
 
 class MemoryManager;
+class SubsystemProfiler;
 
 class DmaController final : public ISerializable
 {
@@ -23,10 +24,12 @@ private:
 
 	DmaChannelConfig _channel[8] = {};
 	MemoryManager *_memoryManager;
+	SubsystemProfiler *_profiler;
 	
 	void CopyDmaByte(uint32_t addressBusA, uint16_t addressBusB, bool fromBtoA);
 
 	void RunDma(DmaChannelConfig &channel);
+	uint32_t RunBlockTransfer(DmaChannelConfig &channel, uint8_t &offsetIndex); //Returns the number of bytes copied
 	
 	void RunHdmaTransfer(DmaChannelConfig &channel);
 	bool ProcessHdmaChannels();
@@ -40,7 +43,7 @@ private:
 	bool HasActiveDmaChannel();
 
 public:
-	DmaController(MemoryManager *memoryManager);
+	DmaController(MemoryManager *memoryManager, SubsystemProfiler *profiler);
 
 	void Reset();
 
@@ -48,6 +51,7 @@ public:
 	void BeginHdmaInit();
 
 	bool ProcessPendingTransfers();
+	bool HasPendingTransfers() { return _needToProcess; }
 
 	void Write(uint16_t addr, uint8_t value);
 	uint8_t Read(uint16_t addr);
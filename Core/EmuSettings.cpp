@@ -235,7 +235,14 @@ OverscanDimensions EmuSettings::GetOverscan()
 
 uint32_t EmuSettings::GetRewindBufferSize()
 {
-	return _preferences.RewindBufferSize;
+	//Headless consoles are never rewound, don't keep any history for them
+	return _console->IsHeadless() ? 0 : _preferences.RewindBufferSize;
+}
+
+uint32_t EmuSettings::GetRewindVideoBufferSize()
+{
+	//Setting is in MB
+	return _preferences.RewindVideoBufferSize * 1024 * 1024;
 }
 
 uint32_t EmuSettings::GetEmulationSpeed()
@@ -67,6 +67,7 @@ public:
 
 	OverscanDimensions GetOverscan();
 	uint32_t GetRewindBufferSize();
+	uint32_t GetRewindVideoBufferSize();
 	uint32_t GetEmulationSpeed();
 	double GetAspectRatio(ConsoleRegion region);
 
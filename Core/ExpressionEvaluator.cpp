@@ -446,6 +446,133 @@ bool ExpressionEvaluator::ToRpn(string expression, ExpressionData &data)
 	return true;
 }
 
+int64_t ExpressionEvaluator::GetLabelValue(string &label)
+{
+	int64_t value = _labelManager->GetLabelRelativeAddress(label, _cpuType);
+	if(value < -1) {
+		//Label doesn't exist, try to find a matching multi-byte label
+		string multiByteLabel = label + "+0";
+		value = _labelManager->GetLabelRelativeAddress(multiByteLabel, _cpuType);
+	}
+	return value;
+}
+
+#define STATE_VALUE(value) [](DebugState &state) -> int64_t { return value; }
+
+EvalValueReader ExpressionEvaluator::GetValueReader(int64_t token, bool &isPpuValue)
+{
+	isPpuValue = true;
+	if(_cpuType == CpuType::Gameboy) {
+		switch(token) {
+			case EvalValues::PpuFrameCount: return STATE_VALUE(state.Gameboy.Ppu.FrameCount);
+			case EvalValues::PpuCycle: return STATE_VALUE(state.Gameboy.Ppu.Cycle);
+			case EvalValues::PpuScanline: return STATE_VALUE(state.Gameboy.Ppu.Scanline);
+		}
+	} else {
+		switch(token) {
+			case EvalValues::PpuFrameCount: return STATE_VALUE(state.Ppu.FrameCount);
+			case EvalValues::PpuCycle: return STATE_VALUE(state.Ppu.Cycle);
+			case EvalValues::PpuScanline: return STATE_VALUE(state.Ppu.Scanline);
+		}
+	}
+
+	isPpuValue = false;
+	switch(_cpuType) {
+		case CpuType::Cpu:
+			switch(token) {
+				case EvalValues::RegA: return STATE_VALUE(state.Cpu.A);
+				case EvalValues::RegX: return STATE_VALUE(state.Cpu.X);
+				case EvalValues::RegY: return STATE_VALUE(state.Cpu.Y);
+				case EvalValues::RegSP: return STATE_VALUE(state.Cpu.SP);
+				case EvalValues::RegPS: return STATE_VALUE(state.Cpu.PS);
+				case EvalValues::RegPC: return STATE_VALUE(state.Cpu.PC);
+				case EvalValues::Nmi: return STATE_VALUE(state.Cpu.NmiFlag);
+				case EvalValues::Irq: return STATE_VALUE(state.Cpu.IrqSource != 0);
+			}
+			break;
+
+		case CpuType::Sa1:
+			switch(token) {
+				case EvalValues::RegA: return STATE_VALUE(state.Sa1.Cpu.A);
+				case EvalValues::RegX: return STATE_VALUE(state.Sa1.Cpu.X);
+				case EvalValues::RegY: return STATE_VALUE(state.Sa1.Cpu.Y);
+				case EvalValues::RegSP: return STATE_VALUE(state.Sa1.Cpu.SP);
+				case EvalValues::RegPS: return STATE_VALUE(state.Sa1.Cpu.PS);
+				case EvalValues::RegPC: return STATE_VALUE(state.Sa1.Cpu.PC);
+				case EvalValues::Nmi: return STATE_VALUE(state.Sa1.Cpu.NmiFlag);
+				case EvalValues::Irq: return STATE_VALUE(state.Sa1.Cpu.IrqSource != 0);
+			}
+			break;
+
+		case CpuType::Spc:
+			switch(token) {
+				case EvalValues::RegA: return STATE_VALUE(state.Spc.A);
+				case EvalValues::RegX: return STATE_VALUE(state.Spc.X);
+				case EvalValues::RegY: return STATE_VALUE(state.Spc.Y);
+				case EvalValues::RegSP: return STATE_VALUE(state.Spc.SP);
+				case EvalValues::RegPS: return STATE_VALUE(state.Spc.PS);
+				case EvalValues::RegPC: return STATE_VALUE(state.Spc.PC);
+			}
+			break;
+
+		case CpuType::Gameboy:
+			switch(token) {
+				case EvalValues::RegA: return STATE_VALUE(state.Gameboy.Cpu.A);
+				case EvalValues::RegB: return STATE_VALUE(state.Gameboy.Cpu.B);
+				case EvalValues::RegC: return STATE_VALUE(state.Gameboy.Cpu.C);
+				case EvalValues::RegD: return STATE_VALUE(state.Gameboy.Cpu.D);
+				case EvalValues::RegE: return STATE_VALUE(state.Gameboy.Cpu.E);
+				case EvalValues::RegF: return STATE_VALUE(state.Gameboy.Cpu.Flags);
+				case EvalValues::RegH: return STATE_VALUE(state.Gameboy.Cpu.H);
+				case EvalValues::RegL: return STATE_VALUE(state.Gameboy.Cpu.L);
+				case EvalValues::RegAF: return STATE_VALUE((state.Gameboy.Cpu.A << 8) | state.Gameboy.Cpu.Flags);
+				case EvalValues::RegBC: return STATE_VALUE((state.Gameboy.Cpu.B << 8) | state.Gameboy.Cpu.C);
+				case EvalValues::RegDE: return STATE_VALUE((state.Gameboy.Cpu.D << 8) | state.Gameboy.Cpu.E);
+				case EvalValues::RegHL: return STATE_VALUE((state.Gameboy.Cpu.H << 8) | state.Gameboy.Cpu.L);
+				case EvalValues::RegSP: return STATE_VALUE(state.Gameboy.Cpu.SP);
+				case EvalValues::RegPC: return STATE_VALUE(state.Gameboy.Cpu.PC);
+			}
+			break;
+
+		case CpuType::Gsu:
+			switch(token) {
+				case EvalValues::R0: return STATE_VALUE(state.Gsu.R[0]);
+				case EvalValues::R1: return STATE_VALUE(state.Gsu.R[1]);
+				case EvalValues::R2: return STATE_VALUE(state.Gsu.R[2]);
+				case EvalValues::R3: return STATE_VALUE(state.Gsu.R[3]);
+				case EvalValues::R4: return STATE_VALUE(state.Gsu.R[4]);
+				case EvalValues::R5: return STATE_VALUE(state.Gsu.R[5]);
+				case EvalValues::R6: return STATE_VALUE(state.Gsu.R[6]);
+				case EvalValues::R7: return STATE_VALUE(state.Gsu.R[7]);
+				case EvalValues::R8: return STATE_VALUE(state.Gsu.R[8]);
+				case EvalValues::R9: return STATE_VALUE(state.Gsu.R[9]);
+				case EvalValues::R10: return STATE_VALUE(state.Gsu.R[10]);
+				case EvalValues::R11: return STATE_VALUE(state.Gsu.R[11]);
+				case EvalValues::R12: return STATE_VALUE(state.Gsu.R[12]);
+				case EvalValues::R13: return STATE_VALUE(state.Gsu.R[13]);
+				case EvalValues::R14: return STATE_VALUE(state.Gsu.R[14]);
+				case EvalValues::R15: return STATE_VALUE(state.Gsu.R[15]);
+
+				case EvalValues::SrcReg: return STATE_VALUE(state.Gsu.SrcReg);
+				case EvalValues::DstReg: return STATE_VALUE(state.Gsu.DestReg);
+
+				case EvalValues::SFR: return STATE_VALUE((state.Gsu.SFR.GetFlagsHigh() << 8) | state.Gsu.SFR.GetFlagsLow());
+				case EvalValues::PBR: return STATE_VALUE(state.Gsu.ProgramBank);
+				case EvalValues::RomBR: return STATE_VALUE(state.Gsu.RomBank);
+				case EvalValues::RamBR: return STATE_VALUE(state.Gsu.RamBank);
+			}
+			break;
+
+		case CpuType::NecDsp:
+		case CpuType::Cx4:
+			break;
+	}
+
+	return nullptr;
+}
+
+#undef STATE_VALUE
+
 int32_t ExpressionEvaluator::Evaluate(ExpressionData &data, DebugState &state, EvalResultType &resultType, MemoryOperationInfo &operationInfo)
 {
 	if(data.RpnQueue.empty()) {
@@ -466,12 +593,7 @@ int32_t ExpressionEvaluator::Evaluate(ExpressionData &data, DebugState &state, E
 			if(token >= EvalValues::FirstLabelIndex) {
 				int64_t labelIndex = token - EvalValues::FirstLabelIndex;
 				if((size_t)labelIndex < data.Labels.size()) {
-					token = _labelManager->GetLabelRelativeAddress(data.Labels[(uint32_t)labelIndex], _cpuType);
-					if(token < -1) {
-						//Label doesn't exist, try to find a matching multi-byte label
-						string label = data.Labels[(uint32_t)labelIndex] + "+0";
-						token = _labelManager->GetLabelRelativeAddress(label, _cpuType);
-					}
+					token = GetLabelValue(data.Labels[(uint32_t)labelIndex]);
 				} else {
 					token = -2;
 				}
@@ -483,9 +605,6 @@ int32_t ExpressionEvaluator::Evaluate(ExpressionData &data, DebugState &state, E
 			} else {
 				switch(token) {
 					/*case EvalValues::RegOpPC: token = state.Cpu.DebugPC; break;*/
-					case EvalValues::PpuFrameCount: token = _cpuType == CpuType::Gameboy ? state.Gameboy.Ppu.FrameCount : state.Ppu.FrameCount; break;
-					case EvalValues::PpuCycle: token = _cpuType == CpuType::Gameboy ? state.Gameboy.Ppu.Cycle : state.Ppu.Cycle; break;
-					case EvalValues::PpuScanline: token = _cpuType == CpuType::Gameboy ? state.Gameboy.Ppu.Scanline : state.Ppu.Scanline; break;
 					case EvalValues::Value: token = operationInfo.Value; break;
 					case EvalValues::Address: token = operationInfo.Address; break;
 					//case EvalValues::AbsoluteAddress: token = _debugger->GetAbsoluteAddress(operationInfo.Address); break;
@@ -493,86 +612,19 @@ int32_t ExpressionEvaluator::Evaluate(ExpressionData &data, DebugState &state, E
 					case EvalValues::IsRead: token = operationInfo.Type != MemoryOperationType::Write && operationInfo.Type != MemoryOperationType::DmaWrite; break;
 					//case EvalValues::PreviousOpPC: token = state.CPU.PreviousDebugPC; break;
 
-					default:
-						switch(_cpuType) {
-							case CpuType::Cpu:
-							case CpuType::Sa1:
-								switch(token) {
-									case EvalValues::RegA: token = state.Cpu.A; break;
-									case EvalValues::RegX: token = state.Cpu.X; break;
-									case EvalValues::RegY: token = state.Cpu.Y; break;
-									case EvalValues::RegSP: token = state.Cpu.SP; break;
-									case EvalValues::RegPS: token = state.Cpu.PS; break;
-									case EvalValues::RegPC: token = state.Cpu.PC; break;
-									case EvalValues::Nmi: token = state.Cpu.NmiFlag; resultType = EvalResultType::Boolean; break;
-									case EvalValues::Irq: token = state.Cpu.IrqSource != 0; resultType = EvalResultType::Boolean; break;
-								}
-								break;
-
-							case CpuType::Spc:
-								switch(token) {
-									case EvalValues::RegA: token = state.Spc.A; break;
-									case EvalValues::RegX: token = state.Spc.X; break;
-									case EvalValues::RegY: token = state.Spc.Y; break;
-									case EvalValues::RegSP: token = state.Spc.SP; break;
-									case EvalValues::RegPS: token = state.Spc.PS; break;
-									case EvalValues::RegPC: token = state.Spc.PC; break;
-								}
-								break;
-
-							case CpuType::Gameboy:
-								switch(token) {
-									case EvalValues::RegA: token = state.Gameboy.Cpu.A; break;
-									case EvalValues::RegB: token = state.Gameboy.Cpu.B; break;
-									case EvalValues::RegC: token = state.Gameboy.Cpu.C; break;
-									case EvalValues::RegD: token = state.Gameboy.Cpu.D; break;
-									case EvalValues::RegE: token = state.Gameboy.Cpu.E; break;
-									case EvalValues::RegF: token = state.Gameboy.Cpu.Flags; break;
-									case EvalValues::RegH: token = state.Gameboy.Cpu.H; break;
-									case EvalValues::RegL: token = state.Gameboy.Cpu.L; break;
-									case EvalValues::RegAF: token = (state.Gameboy.Cpu.A << 8) | state.Gameboy.Cpu.Flags; break;
-									case EvalValues::RegBC: token = (state.Gameboy.Cpu.B << 8) | state.Gameboy.Cpu.C; break;
-									case EvalValues::RegDE: token = (state.Gameboy.Cpu.D << 8) | state.Gameboy.Cpu.E; break;
-									case EvalValues::RegHL: token = (state.Gameboy.Cpu.H << 8) | state.Gameboy.Cpu.L; break;
-									case EvalValues::RegSP: token = state.Gameboy.Cpu.SP; break;
-									case EvalValues::RegPC: token = state.Gameboy.Cpu.PC; break;
-								}
-								break;
-
-							case CpuType::Gsu:
-								switch(token) {
-									case EvalValues::R0: token = state.Gsu.R[0]; break;
-									case EvalValues::R1: token = state.Gsu.R[1]; break;
-									case EvalValues::R2: token = state.Gsu.R[2]; break;
-									case EvalValues::R3: token = state.Gsu.R[3]; break;
-									case EvalValues::R4: token = state.Gsu.R[4]; break;
-									case EvalValues::R5: token = state.Gsu.R[5]; break;
-									case EvalValues::R6: token = state.Gsu.R[6]; break;
-									case EvalValues::R7: token = state.Gsu.R[7]; break;
-									case EvalValues::R8: token = state.Gsu.R[8]; break;
-									case EvalValues::R9: token = state.Gsu.R[9]; break;
-									case EvalValues::R10: token = state.Gsu.R[10]; break;
-									case EvalValues::R11: token = state.Gsu.R[11]; break;
-									case EvalValues::R12: token = state.Gsu.R[12]; break;
-									case EvalValues::R13: token = state.Gsu.R[13]; break;
-									case EvalValues::R14: token = state.Gsu.R[14]; break;
-									case EvalValues::R15: token = state.Gsu.R[15]; break;
-
-									case EvalValues::SrcReg: token = state.Gsu.SrcReg; break;
-									case EvalValues::DstReg: token = state.Gsu.DestReg; break;
-									
-									case EvalValues::SFR: token = (state.Gsu.SFR.GetFlagsHigh() << 8) | state.Gsu.SFR.GetFlagsLow(); break;
-									case EvalValues::PBR: token = state.Gsu.ProgramBank; break;
-									case EvalValues::RomBR: token = state.Gsu.RomBank; break;
-									case EvalValues::RamBR: token = state.Gsu.RamBank; break;
-								}
-								break;
-
-							case CpuType::NecDsp:
-							case CpuType::Cx4:
-								throw std::runtime_error("Invalid CPU type");
+					default: {
+						bool isPpuValue;
+						EvalValueReader reader = GetValueReader(token, isPpuValue);
+						if(reader) {
+							if(token == EvalValues::Nmi || token == EvalValues::Irq) {
+								resultType = EvalResultType::Boolean;
+							}
+							token = reader(state);
+						} else if(_cpuType == CpuType::NecDsp || _cpuType == CpuType::Cx4) {
+							throw std::runtime_error("Invalid CPU type");
 						}
 						break;
+					}
 				}
 			}
 		} else if(token >= EvalOperators::Multiplication) {
@@ -629,6 +681,187 @@ int32_t ExpressionEvaluator::Evaluate(ExpressionData &data, DebugState &state, E
 	return (int32_t)operandStack[0];
 }
 
+CompiledExpression ExpressionEvaluator::Compile(ExpressionData &data)
+{
+	CompiledExpression expression;
+	expression.Labels = data.Labels;
+
+	//Only used to fold constants, the state is never read
+	DebugState state;
+	MemoryOperationInfo operationInfo = {};
+
+	int stackSize = 0;
+	for(int64_t token : data.RpnQueue) {
+		EvalInstruction inst = {};
+		if(token >= EvalValues::RegA) {
+			if(token >= EvalValues::FirstLabelIndex) {
+				inst.OpCode = EvalOpCode::Label;
+				inst.Value = token - EvalValues::FirstLabelIndex;
+				if((size_t)inst.Value >= data.Labels.size()) {
+					return CompiledExpression();
+				}
+			} else {
+				switch(token) {
+					case EvalValues::Value: inst.OpCode = EvalOpCode::OperationValue; break;
+					case EvalValues::Address: inst.OpCode = EvalOpCode::OperationAddress; break;
+					case EvalValues::IsWrite: inst.OpCode = EvalOpCode::IsWrite; break;
+					case EvalValues::IsRead: inst.OpCode = EvalOpCode::IsRead; break;
+
+					default: {
+						bool isPpuValue;
+						inst.OpCode = EvalOpCode::StateValue;
+						inst.Reader = GetValueReader(token, isPpuValue);
+						if(!inst.Reader) {
+							//Not a value for this CPU, let the RPN evaluator handle it
+							return CompiledExpression();
+						}
+						if(isPpuValue) {
+							expression.UsesPpuState = true;
+						} else {
+							expression.UsesCpuState = true;
+						}
+						break;
+					}
+				}
+			}
+			stackSize++;
+		} else if(token >= EvalOperators::Multiplication) {
+			bool isBinary = token <= EvalOperators::LogicalOr;
+			if(stackSize < (isBinary ? 2 : 1)) {
+				return CompiledExpression();
+			}
+
+			if(isBinary) {
+				inst.OpCode = (EvalOpCode)((int)EvalOpCode::Multiplication + (token - EvalOperators::Multiplication));
+				stackSize--;
+			} else if(token == EvalOperators::Plus) {
+				continue;
+			} else if(token >= EvalOperators::Minus && token <= EvalOperators::Braces) {
+				inst.OpCode = (EvalOpCode)((int)EvalOpCode::Minus + (token - EvalOperators::Minus));
+			} else {
+				return CompiledExpression();
+			}
+
+			//Replace operations on constants by their result
+			size_t operandCount = isBinary ? 2 : 1;
+			size_t codeSize = expression.Code.size();
+			bool canFold = inst.OpCode != EvalOpCode::ReadByte && inst.OpCode != EvalOpCode::ReadWord && codeSize >= operandCount;
+			for(size_t i = codeSize - operandCount; canFold && i < codeSize; i++) {
+				canFold = expression.Code[i].OpCode == EvalOpCode::Constant;
+			}
+			if(canFold) {
+				CompiledExpression constExpression;
+				constExpression.Code.insert(constExpression.Code.end(), expression.Code.end() - operandCount, expression.Code.end());
+				constExpression.Code.push_back(inst);
+
+				int64_t result;
+				if(Execute(constExpression, state, operationInfo, result)) {
+					expression.Code.resize(codeSize - operandCount);
+					inst.OpCode = EvalOpCode::Constant;
+					inst.Value = result;
+				}
+			}
+		} else {
+			inst.OpCode = EvalOpCode::Constant;
+			inst.Value = token;
+			stackSize++;
+		}
+
+		if(stackSize > 1000) {
+			return CompiledExpression();
+		}
+		expression.Code.push_back(inst);
+	}
+
+	if(stackSize != 1) {
+		return CompiledExpression();
+	}
+	return expression;
+}
+
+bool ExpressionEvaluator::Execute(CompiledExpression &expression, DebugState &state, MemoryOperationInfo &operationInfo, int64_t &result)
+{
+	int64_t* stack = operandStack;
+	int pos = 0;
+	for(EvalInstruction &inst : expression.Code) {
+		int64_t value;
+		switch(inst.OpCode) {
+			case EvalOpCode::Constant: stack[pos++] = inst.Value; continue;
+			case EvalOpCode::StateValue: stack[pos++] = inst.Reader(state); continue;
+			case EvalOpCode::OperationValue: stack[pos++] = operationInfo.Value; continue;
+			case EvalOpCode::OperationAddress: stack[pos++] = operationInfo.Address; continue;
+			case EvalOpCode::IsWrite: stack[pos++] = operationInfo.Type == MemoryOperationType::Write || operationInfo.Type == MemoryOperationType::DmaWrite; continue;
+			case EvalOpCode::IsRead: stack[pos++] = operationInfo.Type != MemoryOperationType::Write && operationInfo.Type != MemoryOperationType::DmaWrite; continue;
+			case EvalOpCode::Label:
+				value = GetLabelValue(expression.Labels[(size_t)inst.Value]);
+				if(value < 0) {
+					//Label is no longer valid
+					return false;
+				}
+				stack[pos++] = value;
+				continue;
+
+			//Unary operators
+			case EvalOpCode::Minus: stack[pos - 1] = -stack[pos - 1]; continue;
+			case EvalOpCode::BinaryNot: stack[pos - 1] = ~stack[pos - 1]; continue;
+			case EvalOpCode::LogicalNot: stack[pos - 1] = !stack[pos - 1]; continue;
+			case EvalOpCode::ReadByte: stack[pos - 1] = _debugger->GetMemoryDumper()->GetMemoryValue(_cpuMemory, (uint32_t)stack[pos - 1]); continue;
+			case EvalOpCode::ReadWord: stack[pos - 1] = _debugger->GetMemoryDumper()->GetMemoryValueWord(_cpuMemory, (uint32_t)stack[pos - 1]); continue;
+
+			default:
+				break;
+		}
+
+		//Binary operators
+		int64_t right = stack[--pos];
+		int64_t left = stack[pos - 1];
+		switch(inst.OpCode) {
+			case EvalOpCode::Multiplication: value = left * right; break;
+			case EvalOpCode::Division:
+				if(right == 0) {
+					return false;
+				}
+				value = left / right;
+				break;
+			case EvalOpCode::Modulo:
+				if(right == 0) {
+					return false;
+				}
+				value = left % right;
+				break;
+			case EvalOpCode::Addition: value = left + right; break;
+			case EvalOpCode::Substration: value = left - right; break;
+			case EvalOpCode::ShiftLeft: value = left << right; break;
+			case EvalOpCode::ShiftRight: value = left >> right; break;
+			case EvalOpCode::SmallerThan: value = left < right; break;
+			case EvalOpCode::SmallerOrEqual: value = left <= right; break;
+			case EvalOpCode::GreaterThan: value = left > right; break;
+			case EvalOpCode::GreaterOrEqual: value = left >= right; break;
+			case EvalOpCode::Equal: value = left == right; break;
+			case EvalOpCode::NotEqual: value = left != right; break;
+			case EvalOpCode::BinaryAnd: value = left & right; break;
+			case EvalOpCode::BinaryXor: value = left ^ right; break;
+			case EvalOpCode::BinaryOr: value = left | right; break;
+			case EvalOpCode::LogicalAnd: value = left && right; break;
+			case EvalOpCode::LogicalOr: value = left || right; break;
+			default: return false;
+		}
+		stack[pos - 1] = value;
+	}
+
+	result = stack[0];
+	return true;
+}
+
+int32_t ExpressionEvaluator::Evaluate(CompiledExpression &expression, DebugState &state, MemoryOperationInfo &operationInfo)
+{
+	int64_t result;
+	if(expression.IsValid() && Execute(expression, state, operationInfo, result)) {
+		return (int32_t)result;
+	}
+	return 0;
+}
+
 ExpressionEvaluator::ExpressionEvaluator(Debugger* debugger, CpuType cpuType)
 {
 	_debugger = debugger;
@@ -730,6 +963,16 @@ void ExpressionEvaluator::RunTests()
 
 		assert(type == expectedType);
 		assert(result == expectedResult);
+
+		//Compiled expressions must give the same result (invalid expressions evaluate to 0)
+		bool success;
+		ExpressionData data = GetRpnList(expr, success);
+		CompiledExpression compiled = Compile(data);
+		if(compiled.IsValid()) {
+			assert(Evaluate(compiled, state, opInfo) == result);
+		} else {
+			assert(type == EvalResultType::Invalid || type == EvalResultType::DivideBy0);
+		}
 	};
 	
 	test("1 - -1", EvalResultType::Numeric, 2);
@@ -130,6 +130,63 @@ struct ExpressionData
 	std::vector<string> Labels;
 };
 
+typedef int64_t(*EvalValueReader)(DebugState &state);
+
+enum class EvalOpCode : uint8_t
+{
+	Constant,
+	Label,
+	StateValue,
+	OperationValue,
+	OperationAddress,
+	IsWrite,
+	IsRead,
+
+	Multiplication,
+	Division,
+	Modulo,
+	Addition,
+	Substration,
+	ShiftLeft,
+	ShiftRight,
+	SmallerThan,
+	SmallerOrEqual,
+	GreaterThan,
+	GreaterOrEqual,
+	Equal,
+	NotEqual,
+	BinaryAnd,
+	BinaryXor,
+	BinaryOr,
+	LogicalAnd,
+	LogicalOr,
+
+	Minus,
+	BinaryNot,
+	LogicalNot,
+	ReadByte,
+	ReadWord
+};
+
+struct EvalInstruction
+{
+	EvalOpCode OpCode;
+	int64_t Value; //Constant, or index in Labels
+	EvalValueReader Reader; //For StateValue
+};
+
+//Expression converted to a list of instructions for a specific CPU: tokens are resolved ahead of time,
+//constant sub-expressions are folded and the CPU/PPU state is only needed if the expression reads from it.
+struct CompiledExpression
+{
+	vector<EvalInstruction> Code;
+	vector<string> Labels;
+	bool UsesCpuState = false;
+	bool UsesPpuState = false;
+
+	bool IsValid() { return !Code.empty(); }
+};
+
 class ExpressionEvaluator
 {
 private:
@@ -160,6 +217,9 @@ private:
 	bool ToRpn(string expression, ExpressionData &data);
 	int32_t PrivateEvaluate(string expression, DebugState &state, EvalResultType &resultType, MemoryOperationInfo &operationInfo, bool &success);
 	ExpressionData* PrivateGetRpnList(string expression, bool& success);
+	int64_t GetLabelValue(string &label);
+	EvalValueReader GetValueReader(int64_t token, bool &isPpuValue);
+	bool Execute(CompiledExpression &expression, DebugState &state, MemoryOperationInfo &operationInfo, int64_t &result);
 
 public:
 	ExpressionEvaluator(Debugger* debugger, CpuType cpuType);
@@ -168,6 +228,10 @@ public:
 	int32_t Evaluate(string expression, DebugState &state, EvalResultType &resultType, MemoryOperationInfo &operationInfo);
 	ExpressionData GetRpnList(string expression, bool &success);
 
+	//Returns an invalid (empty) expression if the expression can't be compiled - the RPN list must be evaluated instead
+	CompiledExpression Compile(ExpressionData &data);
+	int32_t Evaluate(CompiledExpression &expression, DebugState &state, MemoryOperationInfo &operationInfo);
+
 	bool Validate(string expression);
 
 #if _DEBUG
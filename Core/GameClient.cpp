@@ -9,50 +9,47 @@ using std::thread;
 #include "../Utilities/Socket.h"
 #include "ClientConnectionData.h"
 #include "GameClientConnection.h"
+#include "RollbackManager.h"
 
-shared_ptr<GameClient> GameClient::_instance;
-
-GameClient::GameClient(shared_ptr<Console> console)
+GameClient::GameClient(Console* console)
 {
 	_console = console;
 	_stop = false;
+	_connected = false;
 }
 
 GameClient::~GameClient()
 {
-	_stop = true;
-	if(_clientThread) {
-		_clientThread->join();
-	}
+	Disconnect();
 }
 
 bool GameClient::Connected()
 {
-	shared_ptr<GameClient> instance = _instance;
-	return instance ? instance->_connected : false;
+	return _connected;
 }
 
-void GameClient::Connect(shared_ptr<Console> console, ClientConnectionData &connectionData)
+void GameClient::Connect(ClientConnectionData &connectionData)
 {
-	_instance.reset(new GameClient(console));
-	console->GetNotificationManager()->RegisterNotificationListener(_instance);
-	
-	shared_ptr<GameClient> instance = _instance;
-	if(instance) {
-		instance->PrivateConnect(connectionData);
-		instance->_clientThread.reset(new thread(&GameClient::Exec, instance.get()));
-	}
+	Disconnect();
+
+	PrivateConnect(connectionData);
+	_clientThread.reset(new thread(&GameClient::Exec, this));
 }
 
 void GameClient::Disconnect()
 {
-	_instance.reset();
+	_stop = true;
+	if(_clientThread) {
+		_clientThread->join();
+		_clientThread.reset();
+	}
+	_connection.reset();
+	_connected = false;
 }
 
 shared_ptr<GameClientConnection> GameClient::GetConnection()
 {
-	shared_ptr<GameClient> instance = _instance;
-	return instance ? instance->_connection : nullptr;
+	return _connection;
 }
 
 void GameClient::PrivateConnect(ClientConnectionData &connectionData)
@@ -60,7 +57,7 @@ void GameClient::PrivateConnect(ClientConnectionData &connectionData)
 	_stop = false;
 	shared_ptr<Socket> socket(new Socket());
 	if(socket->Connect(connectionData.Host.c_str(), connectionData.Port)) {
-		_connection.reset(new GameClientConnection(_console, socket, connectionData));
+		_connection.reset(new GameClientConnection(_console->shared_from_this(), socket, connectionData));
 		_console->GetNotificationManager()->RegisterNotificationListener(_connection);
 		_connected = true;
 	} else {
@@ -90,12 +87,13 @@ void GameClient::Exec()
 void GameClient::ProcessNotification(ConsoleNotificationType type, void* parameter)
 {
 	if(type == ConsoleNotificationType::GameLoaded &&
+		_clientThread &&
 		std::this_thread::get_id() != _clientThread->get_id() && 
 		std::this_thread::get_id() != _console->GetEmulationThreadId()
 	) {
 		//Disconnect if the client tried to manually load a game
 		//A deadlock occurs if this is called from the emulation thread while a network message is being processed
-		GameClient::Disconnect();
+		Disconnect();
 	}
 }
 
@@ -117,4 +115,24 @@ uint8_t GameClient::GetControllerPort()
 {
 	shared_ptr<GameClientConnection> connection = GetConnection();
 	return connection ? connection->GetControllerPort() : GameConnection::SpectatorPort;
+}
+
+NetplayStatistics GameClient::GetStatistics()
+{
+	shared_ptr<GameClientConnection> connection = GetConnection();
+	NetplayStatistics stats = connection ? connection->GetStatistics() : NetplayStatistics {};
+
+	shared_ptr<RollbackManager> rollbackManager = _console->GetRollbackManager();
+	if(rollbackManager->IsEnabled()) {
+		stats.StallCount = rollbackManager->GetStatistics().StallCount;
+	}
+	return stats;
+}
+
+void GameClient::SetSimulatedPacketLoss(uint32_t lossRate)
+{
+	shared_ptr<GameClientConnection> connection = GetConnection();
+	if(connection) {
+		connection->SetSimulatedPacketLoss(lossRate);
+	}
 }
\ No newline at end of file
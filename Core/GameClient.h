@@ -2,6 +2,7 @@
 #include "stdafx.h"
 #include <thread>
 #include "INotificationListener.h"
+#include "GameConnection.h"
 
 using std::thread;
 class Socket;
@@ -12,31 +13,32 @@ class Console;
 class GameClient : public INotificationListener
 {
 private:
-	static shared_ptr<GameClient> _instance;
-
-	shared_ptr<Console> _console;
+	Console* _console;
 	unique_ptr<thread> _clientThread;
 	atomic<bool> _stop;
 
 	shared_ptr<GameClientConnection> _connection;
-	bool _connected = false;
+	atomic<bool> _connected;
 
-	static shared_ptr<GameClientConnection> GetConnection();
+	shared_ptr<GameClientConnection> GetConnection();
 
 	void PrivateConnect(ClientConnectionData &connectionData);
 	void Exec();
 
 public:
-	GameClient(shared_ptr<Console> console);
+	GameClient(Console* console);
 	virtual ~GameClient();
 
-	static bool Connected();
-	static void Connect(shared_ptr<Console> console, ClientConnectionData &connectionData);
-	static void Disconnect();
+	bool Connected();
+	void Connect(ClientConnectionData &connectionData);
+	void Disconnect();
+
+	void SelectController(uint8_t port);
+	uint8_t GetControllerPort();
+	uint8_t GetAvailableControllers();
 
-	static void SelectController(uint8_t port);
-	static uint8_t GetControllerPort();
-	static uint8_t GetAvailableControllers();
+	NetplayStatistics GetStatistics();
+	void SetSimulatedPacketLoss(uint32_t lossRate);
 
 	void ProcessNotification(ConsoleNotificationType type, void* parameter) override;
 };
\ No newline at end of file
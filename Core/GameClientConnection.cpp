@@ -16,6 +16,9 @@
 #include "ServerInformationMessage.h"
 #include "NotificationManager.h"
 #include "RomFinder.h"
+#include "RollbackManager.h"
+#include "RollbackInputMessage.h"
+#include "StateHashMessage.h"
 
 GameClientConnection::GameClientConnection(shared_ptr<Console> console, shared_ptr<Socket> socket, ClientConnectionData &connectionData) : GameConnection(console, socket)
 {
@@ -23,6 +26,7 @@ GameClientConnection::GameClientConnection(shared_ptr<Console> console, shared_p
 	_shutdown = false;
 	_enableControllers = false;
 	_minimumQueueSize = 3;
+	_rollback = false;
 
 	MessageManager::DisplayMessage("NetPlay", "ConnectedToServer");
 }
@@ -37,6 +41,7 @@ void GameClientConnection::Shutdown()
 	if(!_shutdown) {
 		_shutdown = true;
 		DisableControllers();
+		_console->GetRollbackManager()->Stop();
 
 		shared_ptr<ControlManager> controlManager = _console->GetControlManager();
 		if(controlManager) {
@@ -85,6 +90,9 @@ void GameClientConnection::ProcessMessage(NetMessage* message)
 				_console->Lock();
 				ClearInputData();
 				((SaveStateMessage*)message)->LoadState(_console);
+				if(_rollback) {
+					StartRollback(((SaveStateMessage*)message)->GetSyncId(), ((SaveStateMessage*)message)->GetSyncState());
+				}
 				_enableControllers = true;
 				InitControlDevice();
 				_console->Unlock();
@@ -93,7 +101,19 @@ void GameClientConnection::ProcessMessage(NetMessage* message)
 
 		case MessageType::MovieData:
 			if(_gameLoaded) {
-				PushControllerState(((MovieDataMessage*)message)->GetPortNumber(), ((MovieDataMessage*)message)->GetInputState());
+				MovieDataMessage* movieData = (MovieDataMessage*)message;
+				for(uint32_t i = 0; i < movieData->GetInputCount(); i++) {
+					if(movieData->GetPortNumber(i) < BaseControlDevice::PortCount) {
+						PushControllerState(movieData->GetPortNumber(i), movieData->GetInputState(i));
+					}
+				}
+			}
+			break;
+
+		case MessageType::RollbackInput:
+			if(_gameLoaded && _rollback) {
+				//Input from the server and the other clients (the rollback manager ignores the input for the client's own port)
+				ProcessRollbackInput((RollbackInputMessage*)message, (1 << BaseControlDevice::PortCount) - 1);
 			}
 			break;
 
@@ -120,6 +140,10 @@ void GameClientConnection::ProcessMessage(NetMessage* message)
 			}
 
 			ClearInputData();
+			_rollback = gameInfo->IsRollbackEnabled();
+			if(!_rollback) {
+				_console->GetRollbackManager()->Stop();
+			}
 			_console->Unlock();
 
 			_gameLoaded = AttemptLoadGame(gameInfo->GetRomFilename(), gameInfo->GetSha1Hash());
@@ -127,7 +151,9 @@ void GameClientConnection::ProcessMessage(NetMessage* message)
 				_console->Stop(true);
 			} else {
 				_console->GetControlManager()->UnregisterInputProvider(this);
-				_console->GetControlManager()->RegisterInputProvider(this);
+				if(!_rollback) {
+					_console->GetControlManager()->RegisterInputProvider(this);
+				}
 				if(gameInfo->IsPaused()) {
 					_console->Pause();
 				} else {
@@ -140,6 +166,21 @@ void GameClientConnection::ProcessMessage(NetMessage* message)
 	}
 }
 
+void GameClientConnection::StartRollback(uint32_t syncId, RollbackSyncState &syncState)
+{
+	//Called with the console locked, after loading the state sent by the server
+	shared_ptr<RollbackManager> rollbackManager = _console->GetRollbackManager();
+	uint8_t localPorts = _controllerPort < BaseControlDevice::PortCount ? (1 << _controllerPort) : 0;
+	if(rollbackManager->IsEnabled()) {
+		rollbackManager->SetLocalPorts(localPorts);
+	} else {
+		rollbackManager->Start(this, localPorts);
+	}
+
+	rollbackManager->LoadSyncState(syncState);
+	ResetRollbackStream(syncId, syncState);
+}
+
 bool GameClientConnection::AttemptLoadGame(string filename, string sha1Hash)
 {
 	if(filename.size() > 0) {
@@ -178,6 +219,11 @@ bool GameClientConnection::SetInput(BaseControlDevice *device)
 {
 	if(_enableControllers) {
 		uint8_t port = device->GetPort();
+		if(_inputSize[port] == 0) {
+			auto lock = _statsLock.AcquireSafe();
+			_stats.StallCount++;
+		}
+
 		while(_inputSize[port] == 0) {
 			_waitForInput[port].Wait();
 
@@ -222,7 +268,7 @@ void GameClientConnection::ProcessNotification(ConsoleNotificationType type, voi
 {
 	if(type == ConsoleNotificationType::ConfigChanged) {
 		InitControlDevice();
-	} else if(type == ConsoleNotificationType::GameLoaded) {
+	} else if(type == ConsoleNotificationType::GameLoaded && !_rollback) {
 		_console->GetControlManager()->RegisterInputProvider(this);
 	}
 }
@@ -241,7 +287,19 @@ void GameClientConnection::SendInput()
 			inputState = _controlDevice->GetRawState();
 		}
 		
-		if(_lastInputSent != inputState) {
+		if(_rollback) {
+			//Headless consoles set their input directly
+			shared_ptr<RollbackManager> rollbackManager = _console->GetRollbackManager();
+			uint8_t localPort = _controllerPort < BaseControlDevice::PortCount ? (1 << _controllerPort) : 0;
+			if(!_console->IsHeadless() && localPort) {
+				rollbackManager->SetLocalInput(_controllerPort, inputState);
+			}
+
+			//Send the input polled since the last call (and the input that the server hasn't acknowledged yet)
+			if(rollbackManager->IsEnabled()) {
+				SendRollbackInput(localPort, (1 << BaseControlDevice::PortCount) - 1 - localPort);
+			}
+		} else if(_lastInputSent != inputState) {
 			InputDataMessage message(inputState);
 			SendNetMessage(message);
 			_lastInputSent = inputState;
@@ -249,6 +307,12 @@ void GameClientConnection::SendInput()
 	}
 }
 
+void GameClientConnection::SendStateHash(uint32_t frame, uint32_t hash)
+{
+	StateHashMessage message(_syncId, frame, hash);
+	SendNetMessage(message);
+}
+
 void GameClientConnection::SelectController(uint8_t port)
 {
 	SendControllerSelection(port);
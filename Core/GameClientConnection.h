@@ -9,10 +9,12 @@
 #include "IInputProvider.h"
 #include "ControlDeviceState.h"
 #include "ClientConnectionData.h"
+#include "IRollbackSender.h"
 
 class Console;
+struct RollbackSyncState;
 
-class GameClientConnection : public GameConnection, public INotificationListener, public IInputProvider
+class GameClientConnection : public GameConnection, public INotificationListener, public IInputProvider, public IRollbackSender
 {
 private:
 	std::deque<ControlDeviceState> _inputData[BaseControlDevice::PortCount];
@@ -33,6 +35,9 @@ private:
 	ClientConnectionData _connectionData;
 	string _serverSalt;
 
+	//Rollback mode (see RollbackManager)
+	atomic<bool> _rollback;
+
 private:
 	void SendHandshake();
 	void SendControllerSelection(uint8_t port);
@@ -40,6 +45,7 @@ private:
 	void PushControllerState(uint8_t port, ControlDeviceState state);
 	void DisableControllers();
 	bool AttemptLoadGame(string filename, string sha1Hash);
+	void StartRollback(uint32_t syncId, RollbackSyncState &syncState);
 
 protected:
 	void ProcessMessage(NetMessage* message) override;
@@ -56,6 +62,8 @@ public:
 	void InitControlDevice();
 	void SendInput();
 
+	void SendStateHash(uint32_t frame, uint32_t hash) override;
+
 	void SelectController(uint8_t port);
 	uint8_t GetAvailableControllers();
 	uint8_t GetControllerPort();
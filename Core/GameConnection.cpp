@@ -10,11 +10,17 @@
 #include "ClientConnectionData.h"
 #include "ForceDisconnectMessage.h"
 #include "ServerInformationMessage.h"
+#include "RollbackInputMessage.h"
+#include "StateHashMessage.h"
+#include "RollbackManager.h"
+#include "Console.h"
 
 GameConnection::GameConnection(shared_ptr<Console> console, shared_ptr<Socket> socket)
 {
 	_console = console;
 	_socket = socket;
+	_syncId = 0;
+	_packetLossRate = 0;
 }
 
 void GameConnection::ReadSocket()
@@ -23,6 +29,9 @@ void GameConnection::ReadSocket()
 	int bytesReceived = _socket->Recv((char*)_readBuffer + _readPosition, GameConnection::MaxMsgLength - _readPosition, 0);
 	if(bytesReceived > 0) {
 		_readPosition += bytesReceived;
+
+		auto statsLock = _statsLock.AcquireSafe();
+		_stats.BytesReceived += bytesReceived;
 	}
 }
 
@@ -64,6 +73,8 @@ NetMessage* GameConnection::ReadMessage()
 				case MessageType::SelectController: return new SelectControllerMessage(_messageBuffer, messageLength);
 				case MessageType::ForceDisconnect: return new ForceDisconnectMessage(_messageBuffer, messageLength);
 				case MessageType::ServerInformation: return new ServerInformationMessage(_messageBuffer, messageLength);
+				case MessageType::RollbackInput: return new RollbackInputMessage(_messageBuffer, messageLength);
+				case MessageType::StateHash: return new StateHashMessage(_messageBuffer, messageLength);
 			}
 		}
 	}
@@ -73,7 +84,135 @@ NetMessage* GameConnection::ReadMessage()
 void GameConnection::SendNetMessage(NetMessage &message)
 {
 	auto lock = _socketLock.AcquireSafe();
-	message.Send(*_socket.get());
+	uint32_t size = message.Send(*_socket.get());
+
+	auto statsLock = _statsLock.AcquireSafe();
+	_stats.BytesSent += size;
+	_stats.MessagesSent++;
+}
+
+void GameConnection::ResetRollbackStream(uint32_t syncId, RollbackSyncState &syncState)
+{
+	//Called when the server sends its state: both sides restart the input stream from the state's frame
+	auto lock = _rollbackLock.AcquireSafe();
+	_syncId = syncId;
+	for(int i = 0; i < BaseControlDevice::PortCount; i++) {
+		_ackedFrame[i] = syncState.Confirmed[i] ? syncState.Frame : syncState.Frame - 1;
+		_sentFrame[i] = _ackedFrame[i];
+		_sentAck[i] = _ackedFrame[i] - 1;
+	}
+}
+
+void GameConnection::SendRollbackInput(uint8_t inputPorts, uint8_t ackPorts)
+{
+	//Called by the netplay threads, every millisecond - each message contains all the input the other side hasn't acknowledged yet
+	//(up to MaxResendFrames frames per port), so the next message replaces any message that was lost, without having to wait for it to be resent
+	shared_ptr<RollbackManager> rollbackManager = _console->GetRollbackManager();
+	auto lock = _rollbackLock.AcquireSafe();
+
+	RollbackInputMessage message(_syncId);
+	bool newData = false;
+	bool unacknowledged = false;
+	uint32_t frameCount = 0;
+	uint32_t resentFrameCount = 0;
+	uint32_t sentFrame[BaseControlDevice::PortCount];
+	uint32_t sentAck[BaseControlDevice::PortCount];
+
+	//Only the ports that are used by the emulation need to be acknowledged
+	ackPorts &= rollbackManager->GetDevicePorts();
+
+	for(int i = 0; i < BaseControlDevice::PortCount; i++) {
+		sentFrame[i] = _sentFrame[i];
+		sentAck[i] = _sentAck[i];
+
+		if(ackPorts & (1 << i)) {
+			uint32_t confirmedFrame = rollbackManager->GetConfirmedFrame(i);
+			message.SetAck(i, confirmedFrame);
+			if(confirmedFrame != _sentAck[i]) {
+				sentAck[i] = confirmedFrame;
+				newData = true;
+			}
+		}
+
+		if(inputPorts & (1 << i)) {
+			vector<ControlDeviceState> states;
+			uint32_t startFrame = _ackedFrame[i] + 1;
+			rollbackManager->GetConfirmedInput(i, startFrame, states, MaxResendFrames);
+			if(!states.empty()) {
+				uint32_t endFrame = startFrame + (uint32_t)states.size() - 1;
+				unacknowledged = true;
+				frameCount += (uint32_t)states.size();
+				if((int32_t)(endFrame - _sentFrame[i]) > 0) {
+					newData = true;
+					sentFrame[i] = endFrame;
+				}
+				if((int32_t)(_sentFrame[i] - startFrame) >= 0) {
+					resentFrameCount += std::min(_sentFrame[i], endFrame) - startFrame + 1;
+				}
+				message.AddInput(i, startFrame, states);
+			}
+		}
+	}
+
+	if(!newData && (!unacknowledged || _inputSendTimer.GetElapsedMS() < GameConnection::InputResendDelay)) {
+		//Nothing new to send, and the last message was sent recently
+		return;
+	}
+
+	memcpy(_sentFrame, sentFrame, sizeof(_sentFrame));
+	memcpy(_sentAck, sentAck, sizeof(_sentAck));
+	_inputSendTimer.Reset();
+
+	bool dropped = _packetLossRate > 0 && _packetLossRandom() % 100 < _packetLossRate;
+	if(!dropped) {
+		SendNetMessage(message);
+	}
+
+	auto statsLock = _statsLock.AcquireSafe();
+	_stats.InputMessagesSent++;
+	_stats.InputFramesSent += frameCount;
+	_stats.InputFramesResent += resentFrameCount;
+	if(dropped) {
+		_stats.DroppedMessages++;
+	}
+}
+
+void GameConnection::ProcessRollbackInput(RollbackInputMessage* message, uint8_t inputPorts)
+{
+	shared_ptr<RollbackManager> rollbackManager = _console->GetRollbackManager();
+	auto lock = _rollbackLock.AcquireSafe();
+	if(message->GetSyncId() != _syncId) {
+		//Sent before the last state was sent/loaded, ignore it
+		return;
+	}
+
+	for(int i = 0; i < BaseControlDevice::PortCount; i++) {
+		uint32_t ackFrame;
+		if(message->GetAck(i, ackFrame) && (int32_t)(ackFrame - _ackedFrame[i]) > 0 && (int32_t)(ackFrame - _sentFrame[i]) <= 0) {
+			_ackedFrame[i] = ackFrame;
+		}
+	}
+
+	for(RollbackInputRun &run : message->GetInputs()) {
+		if(inputPorts & (1 << run.Port)) {
+			//Frames that were already received are ignored by the rollback manager
+			for(size_t i = 0; i < run.States.size(); i++) {
+				rollbackManager->AddRemoteInput(run.StartFrame + (uint32_t)i, run.Port, run.States[i]);
+			}
+		}
+	}
+}
+
+NetplayStatistics GameConnection::GetStatistics()
+{
+	auto lock = _statsLock.AcquireSafe();
+	return _stats;
+}
+
+void GameConnection::SetSimulatedPacketLoss(uint32_t lossRate)
+{
+	auto lock = _rollbackLock.AcquireSafe();
+	_packetLossRate = std::min<uint32_t>(lossRate, 100);
 }
 
 void GameConnection::Disconnect()
@@ -93,6 +232,10 @@ void GameConnection::ProcessMessages()
 	while((message = ReadMessage()) != nullptr) {
 		//Loop until all messages have been processed
 		message->Initialize();
+		{
+			auto lock = _statsLock.AcquireSafe();
+			_stats.MessagesReceived++;
+		}
 		ProcessMessage(message);
 		delete message;
 	}		
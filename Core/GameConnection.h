@@ -1,10 +1,15 @@
 #pragma once
 #include "stdafx.h"
+#include <random>
+#include "BaseControlDevice.h"
 #include "../Utilities/SimpleLock.h"
+#include "../Utilities/Timer.h"
 
 class Socket;
 class NetMessage;
 class Console;
+class RollbackInputMessage;
+struct RollbackSyncState;
 
 struct PlayerInfo
 {
@@ -13,6 +18,19 @@ struct PlayerInfo
 	bool IsHost;
 };
 
+struct NetplayStatistics
+{
+	uint64_t BytesSent;
+	uint64_t BytesReceived;
+	uint32_t MessagesSent;
+	uint32_t MessagesReceived;
+	uint32_t InputMessagesSent;
+	uint32_t InputFramesSent;
+	uint32_t InputFramesResent; //Rollback mode: frames sent again because the other side hadn't acknowledged them yet
+	uint32_t DroppedMessages; //Input messages discarded by the simulated packet loss
+	uint32_t StallCount; //Number of frames that had to wait for the other players' input
+};
+
 class GameConnection
 {
 protected:
@@ -26,6 +44,22 @@ protected:
 	int _readPosition = 0;
 	SimpleLock _socketLock;
 
+	SimpleLock _statsLock;
+	NetplayStatistics _stats = {};
+
+	//Rollback mode: incremented each time the server sends its state, messages sent for a previous state are ignored
+	atomic<uint32_t> _syncId;
+
+	//Rollback mode input stream (protected by _rollbackLock)
+	SimpleLock _rollbackLock;
+	uint32_t _ackedFrame[BaseControlDevice::PortCount] = {}; //Last frame of each port's input received by the other side
+	uint32_t _sentFrame[BaseControlDevice::PortCount] = {};
+	uint32_t _sentAck[BaseControlDevice::PortCount] = {};
+	Timer _inputSendTimer;
+
+	atomic<uint32_t> _packetLossRate;
+	std::mt19937 _packetLossRandom;
+
 private:
 
 	void ReadSocket();
@@ -36,8 +70,16 @@ private:
 	virtual void ProcessMessage(NetMessage* message) = 0;
 
 protected:
+	//Delay before the input that wasn't acknowledged is sent again, when no new input is available
+	static constexpr double InputResendDelay = 20;
+	static constexpr uint32_t MaxResendFrames = 32;
+
 	void Disconnect();
 
+	void ResetRollbackStream(uint32_t syncId, RollbackSyncState &syncState);
+	void SendRollbackInput(uint8_t inputPorts, uint8_t ackPorts);
+	void ProcessRollbackInput(RollbackInputMessage* message, uint8_t inputPorts);
+
 public:
 	static constexpr uint8_t SpectatorPort = 0xFF;
 	GameConnection(shared_ptr<Console> console, shared_ptr<Socket> socket);
@@ -45,4 +87,9 @@ public:
 	bool ConnectionError();
 	void ProcessMessages();
 	void SendNetMessage(NetMessage &message);
+
+	NetplayStatistics GetStatistics();
+
+	//Randomly discards the given percentage of the rollback input messages (used to test the input stream's resilience to packet loss)
+	void SetSimulatedPacketLoss(uint32_t lossRate);
 };
\ No newline at end of file
@@ -11,22 +11,24 @@ private:
 	string _sha1Hash;
 	uint8_t _controllerPort = 0;
 	bool _paused = false;
+	bool _rollback = false;
 
 protected:
 	void Serialize(Serializer &s) override
 	{
-		s.Stream(_romFilename, _sha1Hash, _controllerPort, _paused);
+		s.Stream(_romFilename, _sha1Hash, _controllerPort, _paused, _rollback);
 	}
 
 public:
 	GameInformationMessage(void* buffer, uint32_t length) : NetMessage(buffer, length) { }
 
-	GameInformationMessage(string filepath, string sha1Hash, uint8_t port, bool paused) : NetMessage(MessageType::GameInformation)
+	GameInformationMessage(string filepath, string sha1Hash, uint8_t port, bool paused, bool rollback = false) : NetMessage(MessageType::GameInformation)
 	{
 		_romFilename = FolderUtilities::GetFilename(filepath, true);
 		_sha1Hash = sha1Hash;
 		_controllerPort = port;
 		_paused = paused;
+		_rollback = rollback;
 	}
 	
 	uint8_t GetPort()
@@ -48,4 +50,9 @@ public:
 	{
 		return _paused;
 	}
+
+	bool IsRollbackEnabled()
+	{
+		return _rollback;
+	}
 };
\ No newline at end of file
@@ -8,44 +8,42 @@ using std::thread;
 #include "ControlManager.h"
 #include "Multitap.h"
 #include "PlayerListMessage.h"
+#include "MovieDataMessage.h"
 #include "NotificationManager.h"
+#include "RollbackManager.h"
 #include "../Utilities/Socket.h"
 
-shared_ptr<GameServer> GameServer::Instance;
-
-GameServer::GameServer(shared_ptr<Console> console, uint16_t listenPort, string password, string hostPlayerName)
+GameServer::GameServer(Console* console)
 {
 	_console = console;
 	_stop = false;
-	_port = listenPort;
-	_password = password;
-	_hostPlayerName = hostPlayerName;
-	_hostControllerPort = 0;
-
-	//If a game is already running, register ourselves as an input recorder/provider right away
-	RegisterServerInput();
 }
 
 GameServer::~GameServer()
 {
-	_stop = true;
-	_serverThread->join();
+	StopServer();
+}
+
+void GameServer::RegisterServerInput()
+{
+	if(_rollback) {
+		//The rollback manager provides the input for all ports
+		return;
+	}
 
-	Stop();
-	
 	shared_ptr<ControlManager> controlManager = _console->GetControlManager();
 	if(controlManager) {
-		controlManager->UnregisterInputRecorder(this);
-		controlManager->UnregisterInputProvider(this);
+		controlManager->RegisterInputRecorder(this);
+		controlManager->RegisterInputProvider(this);
 	}
 }
 
-void GameServer::RegisterServerInput()
+void GameServer::UnregisterServerInput()
 {
 	shared_ptr<ControlManager> controlManager = _console->GetControlManager();
 	if(controlManager) {
-		controlManager->RegisterInputRecorder(this);
-		controlManager->RegisterInputProvider(this);
+		controlManager->UnregisterInputRecorder(this);
+		controlManager->UnregisterInputProvider(this);
 	}
 }
 
@@ -54,8 +52,10 @@ void GameServer::AcceptConnections()
 	while(true) {
 		shared_ptr<Socket> socket = _listener->Accept();
 		if(!socket->ConnectionError()) {
-			auto connection = shared_ptr<GameServerConnection>(new GameServerConnection(_console, socket, _password));
+			auto connection = shared_ptr<GameServerConnection>(new GameServerConnection(this, _console->shared_from_this(), socket, _password));
 			_console->GetNotificationManager()->RegisterNotificationListener(connection);
+			connection->SetSimulatedPacketLoss(_packetLossRate);
+			auto lock = _connectionLock.AcquireSafe();
 			_openConnections.push_back(connection);
 		} else {
 			break;
@@ -72,9 +72,22 @@ void GameServer::UpdateConnections()
 			connectionsToRemove.push_back(connection);
 		} else {
 			connection->ProcessMessages();
+			if(_rollback) {
+				connection->ProcessStateHashes();
+			}
 		}
 	}
 
+	if(_rollback) {
+		//Send the input received from the clients (and the server's own input) to the other clients
+		for(shared_ptr<GameServerConnection> connection : _openConnections) {
+			if(!connection->ConnectionError()) {
+				connection->SendRollbackInput();
+			}
+		}
+	}
+
+	auto lock = _connectionLock.AcquireSafe();
 	for(shared_ptr<GameServerConnection> gameConnection : connectionsToRemove) {
 		_openConnections.remove(gameConnection);
 	}
@@ -82,8 +95,8 @@ void GameServer::UpdateConnections()
 
 list<shared_ptr<GameServerConnection>> GameServer::GetConnectionList()
 {
-	if(GameServer::Started()) {
-		return Instance->_openConnections;
+	if(Started()) {
+		return _openConnections;
 	} else {
 		return list<shared_ptr<GameServerConnection>>();
 	}
@@ -95,19 +108,19 @@ bool GameServer::SetInput(BaseControlDevice *device)
 
 	if(device->GetControllerType() == ControllerType::Multitap) {
 		//Need special handling for the multitap, merge data from P3/4/5 with P1 (or P2, depending which port the multitap is plugged into)
-		GameServerConnection* connection = GameServerConnection::GetNetPlayDevice(port);
+		GameServerConnection* connection = GetNetPlayDevice(port);
 		if(connection) {
 			((Multitap*)device)->SetControllerState(0, connection->GetState());
 		}
 
 		for(int i = 2; i < 5; i++) {
-			GameServerConnection* connection = GameServerConnection::GetNetPlayDevice(i);
+			GameServerConnection* connection = GetNetPlayDevice(i);
 			if(connection) {
 				((Multitap*)device)->SetControllerState(i - 1, connection->GetState());
 			}
 		}
 	} else {
-		GameServerConnection* connection = GameServerConnection::GetNetPlayDevice(port);
+		GameServerConnection* connection = GetNetPlayDevice(port);
 		if(connection) {
 			//Device is controlled by a client
 			device->SetRawState(connection->GetState());
@@ -121,19 +134,58 @@ bool GameServer::SetInput(BaseControlDevice *device)
 
 void GameServer::RecordInput(vector<shared_ptr<BaseControlDevice>> devices)
 {
+	//Send movie stream (a single message per frame, for all devices)
+	MovieDataMessage message;
 	for(shared_ptr<BaseControlDevice> &device : devices) {
-		for(shared_ptr<GameServerConnection> connection : _openConnections) {
-			if(!connection->ConnectionError()) {
-				//Send movie stream
-				connection->SendMovieData(device->GetPort(), device->GetRawState());
-			}
+		message.AddInputState(device->GetPort(), device->GetRawState());
+	}
+
+	for(shared_ptr<GameServerConnection> connection : _openConnections) {
+		if(!connection->ConnectionError()) {
+			connection->SendMovieData(message);
 		}
 	}
 }
 
+void GameServer::SendStateHash(uint32_t frame, uint32_t hash)
+{
+	//The clients send their hashes to the server, which compares them with its own (see GameServerConnection::ProcessStateHashes)
+}
+
+NetplayStatistics GameServer::GetStatistics()
+{
+	NetplayStatistics stats = {};
+	auto lock = _connectionLock.AcquireSafe();
+	for(shared_ptr<GameServerConnection> &connection : _openConnections) {
+		NetplayStatistics connectionStats = connection->GetStatistics();
+		stats.BytesSent += connectionStats.BytesSent;
+		stats.BytesReceived += connectionStats.BytesReceived;
+		stats.MessagesSent += connectionStats.MessagesSent;
+		stats.MessagesReceived += connectionStats.MessagesReceived;
+		stats.InputMessagesSent += connectionStats.InputMessagesSent;
+		stats.InputFramesSent += connectionStats.InputFramesSent;
+		stats.InputFramesResent += connectionStats.InputFramesResent;
+		stats.DroppedMessages += connectionStats.DroppedMessages;
+	}
+
+	if(_rollback) {
+		stats.StallCount = _console->GetRollbackManager()->GetStatistics().StallCount;
+	}
+	return stats;
+}
+
+void GameServer::SetSimulatedPacketLoss(uint32_t lossRate)
+{
+	_packetLossRate = lossRate;
+	auto lock = _connectionLock.AcquireSafe();
+	for(shared_ptr<GameServerConnection> &connection : _openConnections) {
+		connection->SetSimulatedPacketLoss(lossRate);
+	}
+}
+
 void GameServer::ProcessNotification(ConsoleNotificationType type, void * parameter)
 {
-	if(type == ConsoleNotificationType::GameLoaded) {
+	if(type == ConsoleNotificationType::GameLoaded && _serverThread) {
 		//Register the server as an input provider/recorder
 		RegisterServerInput();
 	}
@@ -144,7 +196,6 @@ void GameServer::Exec()
 	_listener.reset(new Socket());
 	_listener->Bind(_port);
 	_listener->Listen(10);
-	_stop = false;
 	_initialized = true;
 	MessageManager::DisplayMessage("NetPlay" , "ServerStarted", std::to_string(_port));
 
@@ -163,55 +214,87 @@ void GameServer::Stop()
 	MessageManager::DisplayMessage("NetPlay", "ServerStopped");
 }
 
-void GameServer::StartServer(shared_ptr<Console> console, uint16_t port, string password, string hostPlayerName)
+void GameServer::StartServer(uint16_t port, string password, string hostPlayerName, bool rollback)
 {
-	Instance.reset(new GameServer(console, port, password, hostPlayerName));
-	console->GetNotificationManager()->RegisterNotificationListener(Instance);
-	Instance->_serverThread.reset(new thread(&GameServer::Exec, Instance.get()));
+	StopServer();
+
+	_port = port;
+	_password = password;
+	_hostPlayerName = hostPlayerName;
+	_hostControllerPort = 0;
+	_rollback = rollback;
+	_stop = false;
+
+	if(_rollback) {
+		auto lock = _console->AcquireLock();
+		_console->GetRollbackManager()->Start(this, GetLocalPorts());
+	}
+
+	//If a game is already running, register ourselves as an input recorder/provider right away
+	RegisterServerInput();
+
+	_serverThread.reset(new thread(&GameServer::Exec, this));
 }
 
 void GameServer::StopServer()
 {
-	if(Instance) {
-		Instance.reset();
+	if(_serverThread) {
+		_stop = true;
+		_serverThread->join();
+		_serverThread.reset();
+
+		Stop();
+		if(_rollback) {
+			_console->GetRollbackManager()->Stop();
+			_rollback = false;
+		}
+
+		list<shared_ptr<GameServerConnection>> connections;
+		{
+			auto lock = _connectionLock.AcquireSafe();
+			connections.swap(_openConnections);
+		}
+		connections.clear();
+		UnregisterServerInput();
 	}
 }
 
 bool GameServer::Started()
 {
-	if(Instance) {
-		return Instance->_initialized;
-	} else {
-		return false;
-	}
+	return _initialized;
+}
+
+bool GameServer::IsRollbackEnabled()
+{
+	return _rollback;
 }
 
 string GameServer::GetHostPlayerName()
 {
-	if(GameServer::Started()) {
-		return Instance->_hostPlayerName;
+	if(Started()) {
+		return _hostPlayerName;
 	}
 	return "";
 }
 
 uint8_t GameServer::GetHostControllerPort()
 {
-	if(GameServer::Started()) {
-		return Instance->_hostControllerPort;
+	if(Started()) {
+		return _hostControllerPort;
 	}
 	return GameConnection::SpectatorPort;
 }
 
 void GameServer::SetHostControllerPort(uint8_t port)
 {
-	if(GameServer::Started()) {
-		Instance->_console->Lock();
+	if(Started()) {
+		_console->Lock();
 		if(port == GameConnection::SpectatorPort || GetAvailableControllers() & (1 << port)) {
 			//Port is available
-			Instance->_hostControllerPort = port;
+			_hostControllerPort = port;
 			SendPlayerList();
 		}
-		Instance->_console->Unlock();
+		_console->Unlock();
 	}
 }
 
@@ -255,4 +338,64 @@ void GameServer::SendPlayerList()
 		PlayerListMessage message(playerList);
 		connection->SendNetMessage(message);
 	}
-}
\ No newline at end of file
+}
+
+void GameServer::RegisterNetPlayDevice(GameServerConnection* connection, uint8_t port)
+{
+	_netPlayDevices[port] = connection;
+	UpdateLocalPorts();
+}
+
+void GameServer::UnregisterNetPlayDevice(GameServerConnection* connection)
+{
+	if(connection != nullptr) {
+		for(int i = 0; i < BaseControlDevice::PortCount; i++) {
+			if(_netPlayDevices[i] == connection) {
+				_netPlayDevices[i] = nullptr;
+				break;
+			}
+		}
+		UpdateLocalPorts();
+	}
+}
+
+uint8_t GameServer::GetLocalPorts()
+{
+	//The server provides the input for all ports that aren't controlled by a client
+	uint8_t localPorts = 0xFF;
+	for(int i = 0; i < BaseControlDevice::PortCount; i++) {
+		if(_netPlayDevices[i]) {
+			localPorts &= ~(1 << i);
+		}
+	}
+	return localPorts;
+}
+
+void GameServer::UpdateLocalPorts()
+{
+	if(_rollback) {
+		auto lock = _console->AcquireLock();
+		_console->GetRollbackManager()->SetLocalPorts(GetLocalPorts());
+	}
+}
+
+GameServerConnection* GameServer::GetNetPlayDevice(uint8_t port)
+{
+	return _netPlayDevices[port];
+}
+
+uint8_t GameServer::GetFirstFreeControllerPort()
+{
+	uint8_t hostPost = GetHostControllerPort();
+	for(int i = 0; i < GetControllerPortCount(); i++) {
+		if(hostPost != i && _netPlayDevices[i] == nullptr) {
+			return i;
+		}
+	}
+	return GameConnection::SpectatorPort;
+}
+uint8_t GameServer::GetControllerPortCount()
+{
+	//Rollback mode only supports the 2 controller ports (not the multitap's extra controllers)
+	return _rollback ? 2 : BaseControlDevice::PortCount;
+}
@@ -5,25 +5,31 @@
 #include "INotificationListener.h"
 #include "IInputProvider.h"
 #include "IInputRecorder.h"
+#include "IRollbackSender.h"
+#include "../Utilities/SimpleLock.h"
 
 using std::thread;
 class Console;
 
-class GameServer : public IInputRecorder, public IInputProvider, public INotificationListener
+class GameServer : public IInputRecorder, public IInputProvider, public INotificationListener, public IRollbackSender
 {
 private:
-	static shared_ptr<GameServer> Instance;
-	shared_ptr<Console> _console;
+	Console* _console;
 	unique_ptr<thread> _serverThread;
 	atomic<bool> _stop;
 	unique_ptr<Socket> _listener;
-	uint16_t _port;
+	uint16_t _port = 0;
 	string _password;
 	list<shared_ptr<GameServerConnection>> _openConnections;
+	SimpleLock _connectionLock;
 	bool _initialized = false;
+	bool _rollback = false;
+	uint32_t _packetLossRate = 0;
 
 	string _hostPlayerName;
-	uint8_t _hostControllerPort;
+	uint8_t _hostControllerPort = 0;
+
+	GameServerConnection* _netPlayDevices[BaseControlDevice::PortCount] = {};
 
 	void AcceptConnections();
 	void UpdateConnections();
@@ -31,28 +37,45 @@ private:
 	void Exec();
 	void Stop();
 
+	void RegisterServerInput();
+	void UnregisterServerInput();
+
+	uint8_t GetLocalPorts();
+	void UpdateLocalPorts();
+
 public:
-	GameServer(shared_ptr<Console> console, uint16_t port, string password, string hostPlayerName);
+	GameServer(Console* console);
 	virtual ~GameServer();
 
-	void RegisterServerInput();
+	void StartServer(uint16_t port, string password, string hostPlayerName, bool rollback = false);
+	void StopServer();
+	bool Started();
+	bool IsRollbackEnabled();
 
-	static void StartServer(shared_ptr<Console> console, uint16_t port, string password, string hostPlayerName);
-	static void StopServer();
-	static bool Started();
+	string GetHostPlayerName();
+	uint8_t GetHostControllerPort();
+	void SetHostControllerPort(uint8_t port);
+	uint8_t GetAvailableControllers();
+	vector<PlayerInfo> GetPlayerList();
+	void SendPlayerList();
 
-	static string GetHostPlayerName();
-	static uint8_t GetHostControllerPort();
-	static void SetHostControllerPort(uint8_t port);
-	static uint8_t GetAvailableControllers();
-	static vector<PlayerInfo> GetPlayerList();
-	static void SendPlayerList();
+	list<shared_ptr<GameServerConnection>> GetConnectionList();
 
-	static list<shared_ptr<GameServerConnection>> GetConnectionList();
+	void RegisterNetPlayDevice(GameServerConnection* connection, uint8_t port);
+	void UnregisterNetPlayDevice(GameServerConnection* connection);
+	GameServerConnection* GetNetPlayDevice(uint8_t port);
+	uint8_t GetFirstFreeControllerPort();
+	uint8_t GetControllerPortCount();
 
 	bool SetInput(BaseControlDevice *device) override;
 	void RecordInput(vector<shared_ptr<BaseControlDevice>> devices) override;
 
+	void SendStateHash(uint32_t frame, uint32_t hash) override;
+
+	//Totals for all clients
+	NetplayStatistics GetStatistics();
+	void SetSimulatedPacketLoss(uint32_t lossRate);
+
 	// Inherited via INotificationListener
 	virtual void ProcessNotification(ConsoleNotificationType type, void * parameter) override;
 };
\ No newline at end of file
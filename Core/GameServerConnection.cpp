@@ -18,12 +18,14 @@
 #include "ForceDisconnectMessage.h"
 #include "BaseControlDevice.h"
 #include "ServerInformationMessage.h"
+#include "RollbackInputMessage.h"
+#include "StateHashMessage.h"
+#include "RollbackManager.h"
 
-GameServerConnection* GameServerConnection::_netPlayDevices[BaseControlDevice::PortCount] = { };
-
-GameServerConnection::GameServerConnection(shared_ptr<Console> console, shared_ptr<Socket> socket, string serverPassword) : GameConnection(console, socket)
+GameServerConnection::GameServerConnection(GameServer* server, shared_ptr<Console> console, shared_ptr<Socket> socket, string serverPassword) : GameConnection(console, socket)
 {
 	//Server-side connection
+	_server = server;
 	_serverPassword = serverPassword;
 	_controllerPort = GameConnection::SpectatorPort;
 	SendServerInformation();
@@ -35,7 +37,7 @@ GameServerConnection::~GameServerConnection()
 		MessageManager::DisplayMessage("NetPlay", _playerName + " (Player " + std::to_string(_controllerPort + 1) + ") disconnected.");
 	}
 
-	UnregisterNetPlayDevice(this);
+	_server->UnregisterNetPlayDevice(this);
 }
 
 void GameServerConnection::SendServerInformation()
@@ -59,21 +61,64 @@ void GameServerConnection::SendGameInformation()
 {
 	_console->Lock();
 	RomInfo romInfo = _console->GetRomInfo();
-	GameInformationMessage gameInfo(romInfo.RomFile.GetFileName(), _console->GetCartridge()->GetSha1Hash(), _controllerPort, _console->IsPaused());
+	bool rollback = _server->IsRollbackEnabled();
+	GameInformationMessage gameInfo(romInfo.RomFile.GetFileName(), _console->GetCartridge()->GetSha1Hash(), _controllerPort, _console->IsPaused(), rollback);
 	SendNetMessage(gameInfo);
 	SaveStateMessage saveState(_console);
-	SendNetMessage(saveState);
+	if(rollback) {
+		shared_ptr<RollbackManager> rollbackManager = _console->GetRollbackManager();
+		RollbackSyncState syncState = rollbackManager->GetSyncState(_controllerPort);
+
+		//Input sent to this client (see SendRollbackInput) before this point uses the previous sync ID and is ignored by the client,
+		//the input stream restarts from the state's frame (the input already received from the other players for the next frames is sent again)
+		auto lock = _rollbackLock.AcquireSafe();
+		saveState.SetSyncState(_syncId + 1, syncState);
+		SendNetMessage(saveState);
+		ResetRollbackStream(_syncId + 1, syncState);
+	} else {
+		SendNetMessage(saveState);
+	}
 	_console->Unlock();
 }
 
-void GameServerConnection::SendMovieData(uint8_t port, ControlDeviceState state)
+void GameServerConnection::SendMovieData(MovieDataMessage &message)
 {
 	if(_handshakeCompleted) {
-		MovieDataMessage message(state, port);
 		SendNetMessage(message);
 	}
 }
 
+void GameServerConnection::SendRollbackInput()
+{
+	//Called by the server thread: sends the input of all the other players (server and other clients) to this client
+	if(_handshakeCompleted && _syncId > 0) {
+		uint8_t clientPort = _controllerPort < BaseControlDevice::PortCount ? (1 << _controllerPort) : 0;
+		GameConnection::SendRollbackInput((1 << BaseControlDevice::PortCount) - 1 - clientPort, clientPort);
+	}
+}
+
+void GameServerConnection::ProcessStateHashes()
+{
+	//Called by the server thread (which also receives the hashes)
+	shared_ptr<RollbackManager> rollbackManager = _console->GetRollbackManager();
+	while(!_pendingHashes.empty()) {
+		PendingStateHash &stateHash = _pendingHashes.front();
+		if(stateHash.SyncId == _syncId) {
+			StateHashCheck result = rollbackManager->CheckStateHash(stateHash.Frame, stateHash.Hash);
+			if(result == StateHashCheck::Pending) {
+				//The server hasn't reached this frame yet
+				break;
+			} else if(result == StateHashCheck::Desync) {
+				//The client's state doesn't match the server's, send it the server's state again
+				_pendingHashes.clear();
+				SendGameInformation();
+				break;
+			}
+		}
+		_pendingHashes.pop_front();
+	}
+}
+
 void GameServerConnection::SendForceDisconnectMessage(string disconnectMessage)
 {
 	ForceDisconnectMessage message(disconnectMessage);
@@ -110,7 +155,7 @@ void GameServerConnection::ProcessHandshakeResponse(HandShakeMessage* message)
 		if(message->CheckPassword(_serverPassword, _connectionHash)) {
 			_console->Lock();
 
-			_controllerPort = message->IsSpectator() ? GameConnection::SpectatorPort : GetFirstFreeControllerPort();
+			_controllerPort = message->IsSpectator() ? GameConnection::SpectatorPort : _server->GetFirstFreeControllerPort();
 			_playerName = message->GetPlayerName();
 
 			string playerPortMessage = _controllerPort == GameConnection::SpectatorPort ? "Spectator" : "Player " + std::to_string(_controllerPort + 1);
@@ -122,8 +167,8 @@ void GameServerConnection::ProcessHandshakeResponse(HandShakeMessage* message)
 			}
 
 			_handshakeCompleted = true;
-			RegisterNetPlayDevice(this, _controllerPort);
-			GameServer::SendPlayerList();
+			_server->RegisterNetPlayDevice(this, _controllerPort);
+			_server->SendPlayerList();
 			_console->Unlock();
 		} else {
 			SendForceDisconnectMessage("The password you provided did not match - you have been disconnected.");
@@ -149,6 +194,35 @@ void GameServerConnection::ProcessMessage(NetMessage* message)
 			PushState(((InputDataMessage*)message)->GetInputState());
 			break;
 
+		case MessageType::RollbackInput: {
+			if(!_handshakeCompleted) {
+				SendForceDisconnectMessage("Handshake has not been completed - invalid packet");
+				return;
+			}
+
+			if(_server->IsRollbackEnabled() && _controllerPort < BaseControlDevice::PortCount) {
+				//The input is sent to the other clients by the server thread (see GameServer::UpdateConnections)
+				ProcessRollbackInput((RollbackInputMessage*)message, 1 << _controllerPort);
+			}
+			break;
+		}
+
+		case MessageType::StateHash: {
+			if(!_handshakeCompleted) {
+				SendForceDisconnectMessage("Handshake has not been completed - invalid packet");
+				return;
+			}
+
+			StateHashMessage* hashMessage = (StateHashMessage*)message;
+			if(hashMessage->GetSyncId() == _syncId) {
+				if(_pendingHashes.size() >= 256) {
+					_pendingHashes.pop_front();
+				}
+				_pendingHashes.push_back({ hashMessage->GetSyncId(), hashMessage->GetFrame(), hashMessage->GetHash() });
+			}
+			break;
+		}
+
 		case MessageType::SelectController:
 			if(!_handshakeCompleted) {
 				SendForceDisconnectMessage("Handshake has not been completed - invalid packet");
@@ -167,23 +241,23 @@ void GameServerConnection::SelectControllerPort(uint8_t port)
 	_console->Lock();
 	if(port == GameConnection::SpectatorPort) {
 		//Client wants to be a spectator, make sure we are not using any controller
-		UnregisterNetPlayDevice(this);
+		_server->UnregisterNetPlayDevice(this);
 		_controllerPort = port;
-	} else {
-		GameServerConnection* netPlayDevice = GetNetPlayDevice(port);
+	} else if(port < _server->GetControllerPortCount()) {
+		GameServerConnection* netPlayDevice = _server->GetNetPlayDevice(port);
 		if(netPlayDevice == this) {
 			//Nothing to do, we're already this player
 		} else if(netPlayDevice == nullptr) {
 			//This port is free, we can switch
-			UnregisterNetPlayDevice(this);
-			RegisterNetPlayDevice(this, port);
+			_server->UnregisterNetPlayDevice(this);
+			_server->RegisterNetPlayDevice(this, port);
 			_controllerPort = port;
 		} else {
 			//Another player is using this port, we can't use it
 		}
 	}
 	SendGameInformation();
-	GameServer::SendPlayerList();
+	_server->SendPlayerList();
 	_console->Unlock();
 }
 
@@ -212,39 +286,6 @@ void GameServerConnection::ProcessNotification(ConsoleNotificationType type, voi
 	}
 }
 
-void GameServerConnection::RegisterNetPlayDevice(GameServerConnection* device, uint8_t port)
-{
-	GameServerConnection::_netPlayDevices[port] = device;
-}
-
-void GameServerConnection::UnregisterNetPlayDevice(GameServerConnection* device)
-{
-	if(device != nullptr) {
-		for(int i = 0; i < BaseControlDevice::PortCount; i++) {
-			if(GameServerConnection::_netPlayDevices[i] == device) {
-				GameServerConnection::_netPlayDevices[i] = nullptr;
-				break;
-			}
-		}
-	}
-}
-
-GameServerConnection* GameServerConnection::GetNetPlayDevice(uint8_t port)
-{
-	return GameServerConnection::_netPlayDevices[port];
-}
-
-uint8_t GameServerConnection::GetFirstFreeControllerPort()
-{
-	uint8_t hostPost = GameServer::GetHostControllerPort();
-	for(int i = 0; i < BaseControlDevice::PortCount; i++) {
-		if(hostPost != i && GameServerConnection::_netPlayDevices[i] == nullptr) {
-			return i;
-		}
-	}
-	return GameConnection::SpectatorPort;
-}
-
 string GameServerConnection::GetPlayerName()
 {
 	return _playerName;
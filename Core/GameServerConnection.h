@@ -5,13 +5,16 @@
 #include "INotificationListener.h"
 #include "BaseControlDevice.h"
 #include "ControlDeviceState.h"
+#include "../Utilities/SimpleLock.h"
 
 class HandShakeMessage;
+class MovieDataMessage;
+class GameServer;
 
 class GameServerConnection : public GameConnection, public INotificationListener
 {
 private:
-	static GameServerConnection* _netPlayDevices[BaseControlDevice::PortCount];
+	GameServer* _server;
 
 	list<ControlDeviceState> _inputData;
 	string _playerName;
@@ -20,6 +23,15 @@ private:
 	string _serverPassword;
 	bool _handshakeCompleted = false;
 
+	//Rollback mode: hashes received from the client, compared by the server thread
+	struct PendingStateHash
+	{
+		uint32_t SyncId;
+		uint32_t Frame;
+		uint32_t Hash;
+	};
+	std::deque<PendingStateHash> _pendingHashes;
+
 	void PushState(ControlDeviceState state);
 	void SendServerInformation();
 	void SendGameInformation();
@@ -29,24 +41,20 @@ private:
 
 	void ProcessHandshakeResponse(HandShakeMessage* message);
 
-	static void RegisterNetPlayDevice(GameServerConnection* connection, uint8_t port);
-	static void UnregisterNetPlayDevice(GameServerConnection* device);
-	static uint8_t GetFirstFreeControllerPort();
-
 protected:
 	void ProcessMessage(NetMessage* message) override;
 	
 public:
-	GameServerConnection(shared_ptr<Console> console, shared_ptr<Socket> socket, string serverPassword);
+	GameServerConnection(GameServer* server, shared_ptr<Console> console, shared_ptr<Socket> socket, string serverPassword);
 	virtual ~GameServerConnection();
 
 	ControlDeviceState GetState();
-	void SendMovieData(uint8_t port, ControlDeviceState state);
+	void SendMovieData(MovieDataMessage &message);
+	void SendRollbackInput();
+	void ProcessStateHashes();
 
 	string GetPlayerName();
 	uint8_t GetControllerPort();
 
 	virtual void ProcessNotification(ConsoleNotificationType type, void* parameter) override;
-
-	static GameServerConnection* GetNetPlayDevice(uint8_t port);
 };
@@ -71,11 +71,8 @@ void GbDebugger::ProcessRead(uint16_t addr, uint8_t value, MemoryOperationType t
 			}
 
 			if(_traceLogger->IsCpuLogged(CpuType::Gameboy)) {
-				DebugState debugState;
-				_debugger->GetState(debugState, true);
-
 				DisassemblyInfo disInfo = _disassembler->GetDisassemblyInfo(addressInfo, addr, 0, CpuType::Gameboy);
-				_traceLogger->Log(CpuType::Gameboy, debugState, disInfo);
+				_traceLogger->Log(gbState, disInfo);
 			}
 		}
 
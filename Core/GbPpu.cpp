@@ -644,15 +644,7 @@ void GbPpu::SendFrame()
 	}
 	_isFirstFrame = false;
 
-#ifdef LIBRETRO
-	_console->GetVideoDecoder()->UpdateFrameSync(_currentBuffer, 256, 239, _state.FrameCount, false);
-#else
-	if(_console->GetRewindManager()->IsRewinding()) {
-		_console->GetVideoDecoder()->UpdateFrameSync(_currentBuffer, 256, 239, _state.FrameCount, true);
-	} else {
-		_console->GetVideoDecoder()->UpdateFrame(_currentBuffer, 256, 239, _state.FrameCount);
-	}
-#endif
+	_console->GetVideoDecoder()->UpdateFrame(_currentBuffer, 256, 239, _state.FrameCount, _console->GetRewindManager()->IsRewinding());
 
 	//TODO move this somewhere that makes more sense
 	uint8_t prevInput = _memoryManager->ReadInputPort();
@@ -55,12 +55,10 @@ void GsuDebugger::ProcessRead(uint32_t addr, uint8_t value, MemoryOperationType
 			_disassembler->BuildCache(addressInfo, gsuState.SFR.GetFlagsHigh() & 0x13, CpuType::Gsu);
 
 			if(_traceLogger->IsCpuLogged(CpuType::Gsu)) {
-				DebugState debugState;
-				_debugger->GetState(debugState, true);
-				debugState.Gsu.R[15] = addr;
+				gsuState.R[15] = addr;
 
 				DisassemblyInfo disInfo = _disassembler->GetDisassemblyInfo(addressInfo, addr, 0, CpuType::Gsu);
-				_traceLogger->Log(CpuType::Gsu, debugState, disInfo);
+				_traceLogger->Log(gsuState, disInfo);
 			}
 		}
 
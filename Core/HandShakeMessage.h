@@ -6,7 +6,7 @@
 class HandShakeMessage : public NetMessage
 {
 private:
-	static constexpr int CurrentVersion = 100; //Use 100+ to distinguish from Mesen
+	static constexpr int CurrentVersion = 102; //Use 100+ to distinguish from Mesen
 	uint32_t _emuVersion = 0;
 	uint32_t _protocolVersion = CurrentVersion;
 	string _playerName;
@@ -5,7 +5,9 @@
 struct AudioStatistics
 {
 	double AverageLatency = 0;
+	double TargetLatency = 0; //Latency the device is trying to keep (0 = the requested latency)
 	uint32_t BufferUnderrunEventCount = 0;
+	uint32_t BufferOverrunEventCount = 0;
 	uint32_t BufferSize = 0;
 };
 
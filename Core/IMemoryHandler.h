@@ -26,4 +26,8 @@ public:
 	}
 
 	virtual AddressInfo GetAbsoluteAddress(uint32_t address) = 0;
+
+	//Returns a pointer to the 4kb page's data if reads (or writes) can be done directly in memory, without any side effects
+	virtual uint8_t* GetDirectReadPage() { return nullptr; }
+	virtual uint8_t* GetDirectWritePage() { return nullptr; }
 };
\ No newline at end of file
@@ -0,0 +1,9 @@
+#pragma once
+#include "stdafx.h"
+
+//The input itself is sent by the netplay threads (see GameConnection::SendRollbackInput)
+class IRollbackSender
+{
+public:
+	virtual void SendStateHash(uint32_t frame, uint32_t hash) = 0;
+};
@@ -0,0 +1,150 @@
+#include "stdafx.h"
+#include "IdleLoopDetector.h"
+#include "Console.h"
+#include "MemoryManager.h"
+#include "MemoryMappings.h"
+#include "InternalRegisters.h"
+#include "DmaController.h"
+
+void IdleLoopDetector::Initialize(Console* console)
+{
+	_memoryManager = console->GetMemoryManager().get();
+	_regs = console->GetInternalRegisters().get();
+	_dmaController = console->GetDmaController().get();
+}
+
+void IdleLoopDetector::SetEnabled(bool enabled)
+{
+	_enabled = enabled;
+	_recording = false;
+}
+
+bool IdleLoopDetector::IsSameState(CpuState &state)
+{
+	//Everything but the cycle counter must match
+	return (
+		state.A == _loopState.A && state.X == _loopState.X && state.Y == _loopState.Y &&
+		state.SP == _loopState.SP && state.D == _loopState.D && state.PC == _loopState.PC &&
+		state.K == _loopState.K && state.DBR == _loopState.DBR && state.PS == _loopState.PS &&
+		state.EmulationMode == _loopState.EmulationMode && state.NmiFlag == _loopState.NmiFlag &&
+		state.PrevNmiFlag == _loopState.PrevNmiFlag && state.IrqLock == _loopState.IrqLock &&
+		state.PrevNeedNmi == _loopState.PrevNeedNmi && state.NeedNmi == _loopState.NeedNmi &&
+		state.IrqSource == _loopState.IrqSource && state.PrevIrqSource == _loopState.PrevIrqSource &&
+		state.StopState == _loopState.StopState
+	);
+}
+
+bool IdleLoopDetector::CanSkip(CpuState &state)
+{
+	//The CPU's interrupt flags must be stable (no NMI edge, no pending interrupt), and nothing can happen
+	//before the next event: no pending DMA/HDMA, no H-IRQ or IRQ about to be triggered by the IRQ counters
+	return (
+		!state.NeedNmi && !state.PrevNeedNmi && !state.PrevIrqSource && !state.IrqLock &&
+		state.NmiFlag == state.PrevNmiFlag &&
+		!_dmaController->HasPendingTransfers() &&
+		_regs->IsIrqCounterIdle()
+	);
+}
+
+void IdleLoopDetector::ProcessRead(uint32_t addr)
+{
+	if(_memoryManager->GetMemoryMappings()->GetDirectReadPage(addr)) {
+		//Plain ROM/RAM, can only be changed by a write
+		return;
+	}
+
+	if((addr & 0x40FFFF) == 0x4212) {
+		//HVBJOY, its value only changes on a new scanline or when the hblank flag changes
+		_readsHvbJoy = true;
+		return;
+	}
+
+	//Other registers may have side effects or return a value that changes over time
+	_recording = false;
+}
+
+void IdleLoopDetector::StartRecording(CpuState &state)
+{
+	//A pending DMA/HDMA would run during the iteration and change its length, wait for the next one
+	_recording = !_dmaController->HasPendingTransfers();
+	_readsHvbJoy = false;
+	_loopAddr = (state.K << 16) | state.PC;
+	_loopState = state;
+	_loopClock = _memoryManager->GetMasterClock();
+	_loopHClock = _memoryManager->GetHClock();
+	_loopEventCount = _memoryManager->GetEventCount();
+	_loopOpenBus = _memoryManager->GetOpenBus();
+}
+
+void IdleLoopDetector::ProcessLoop(CpuState &state)
+{
+	uint32_t addr = (state.K << 16) | state.PC;
+	if(
+		_recording && addr == _loopAddr && state.CycleCount > _loopState.CycleCount &&
+		_memoryManager->GetEventCount() == _loopEventCount && _memoryManager->GetOpenBus() == _loopOpenBus &&
+		IsSameState(state) && CanSkip(state)
+	) {
+		//The iteration that just ran had no side effects and ended in the state it started in
+		uint32_t iterationClocks = (uint32_t)(_memoryManager->GetMasterClock() - _loopClock);
+		uint64_t iterationCycles = state.CycleCount - _loopState.CycleCount;
+		uint16_t hClock = _memoryManager->GetHClock();
+		uint16_t nextEventClock = _memoryManager->GetNextEventClock();
+
+		if(iterationClocks > 0 && (uint32_t)(hClock - _loopHClock) == iterationClocks && nextEventClock > hClock) {
+			//Skip as many iterations as possible without reaching the next event (which is processed normally)
+			uint32_t count = (nextEventClock - hClock - 1) / iterationClocks;
+			if(_readsHvbJoy) {
+				//$4212's hblank flag must keep the value it had during the iteration that was just run
+				uint16_t limit;
+				if(_loopHClock < InternalRegisters::HblankEndClock) {
+					limit = InternalRegisters::HblankEndClock - 1;
+				} else if(_loopHClock <= InternalRegisters::HblankStartClock) {
+					limit = InternalRegisters::HblankStartClock;
+				} else {
+					limit = 0xFFFF;
+				}
+				count = limit >= hClock ? std::min<uint32_t>(count, (limit - hClock) / iterationClocks) : 0;
+			}
+
+			if(count > 0) {
+				_memoryManager->SkipIdleClocks(count * iterationClocks);
+				state.CycleCount += count * iterationCycles;
+				_stats.SkippedClocks += count * iterationClocks;
+				_stats.SkippedCycles += count * iterationCycles;
+				_stats.SkipCount++;
+			}
+		}
+	}
+
+	StartRecording(state);
+}
+
+void IdleLoopDetector::ProcessWait(CpuState &state)
+{
+	//WAI ends when an IRQ or NMI occurs, which can't happen before the next event if the IRQ counters are idle
+	if(state.IrqSource || !CanSkip(state)) {
+		return;
+	}
+
+	uint16_t hClock = _memoryManager->GetHClock();
+	uint16_t nextEventClock = _memoryManager->GetNextEventClock();
+	if(nextEventClock <= hClock) {
+		return;
+	}
+
+	//Each idle cycle takes 6 master clocks
+	uint32_t count = (nextEventClock - hClock - 1) / 6;
+	if(count > 0) {
+		_memoryManager->SetCpuSpeed(6);
+		_memoryManager->SkipIdleClocks(count * 6);
+		state.CycleCount += count;
+		_stats.SkippedClocks += count * 6;
+		_stats.SkippedCycles += count;
+		_stats.SkipCount++;
+	}
+}
+
+IdleLoopStats IdleLoopDetector::GetStats()
+{
+	return _stats;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include "stdafx.h"
+#include "CpuTypes.h"
+
+class Console;
+class MemoryManager;
+class InternalRegisters;
+class DmaController;
+
+struct IdleLoopStats
+{
+	uint64_t SkippedClocks; //Master clocks that were skipped instead of being emulated
+	uint64_t SkippedCycles; //CPU cycles that were skipped
+	uint32_t SkipCount;
+};
+
+//Skips the iterations of the main CPU's polling loops (e.g "LDA $4212 / BPL" or waiting on a flag set by the NMI handler)
+//A loop is detected at the end of a backward branch, and each iteration is confirmed at runtime: if the iteration that was just
+//run ended in the exact same CPU state it started in, only read memory that can't change on its own (ROM/RAM pages, $4212) and
+//didn't contain any scheduled event, the following iterations will do the same thing. The master clock (and the CPU's cycle
+//counter) is then moved forward by a whole number of iterations, up to the next scheduled event (HDMA, DRAM refresh, end of scanline).
+//The SPC and the coprocessors that run on demand catch up with the master clock as usual, so the result is identical to running
+//each iteration. WAI is handled the same way (the CPU waits until the next event).
+//Only used when nothing needs to see each cycle: no debugger/cheats, no coprocessor that runs in parallel with the CPU (SA-1, GSU, etc.)
+class IdleLoopDetector
+{
+private:
+	MemoryManager* _memoryManager = nullptr;
+	InternalRegisters* _regs = nullptr;
+	DmaController* _dmaController = nullptr;
+
+	bool _enabled = false;
+	bool _recording = false;
+	bool _readsHvbJoy = false;
+
+	//State at the start of the iteration being recorded
+	uint32_t _loopAddr = 0;
+	CpuState _loopState = {};
+	uint64_t _loopClock = 0;
+	uint16_t _loopHClock = 0;
+	uint32_t _loopEventCount = 0;
+	uint8_t _loopOpenBus = 0;
+
+	IdleLoopStats _stats = {};
+
+	bool IsSameState(CpuState &state);
+	bool CanSkip(CpuState &state);
+	void ProcessRead(uint32_t addr);
+	void StartRecording(CpuState &state);
+
+public:
+	void Initialize(Console* console);
+
+	void SetEnabled(bool enabled);
+	__forceinline bool IsEnabled() { return _enabled; }
+
+	__forceinline void LogRead(uint32_t addr)
+	{
+		if(_recording) {
+			ProcessRead(addr);
+		}
+	}
+
+	__forceinline void LogWrite()
+	{
+		//Writes may have side effects, the iteration can't be skipped
+		_recording = false;
+	}
+
+	//Called at the end of a backward branch
+	void ProcessLoop(CpuState &state);
+
+	//Called before each cycle spent waiting for an interrupt (WAI)
+	void ProcessWait(CpuState &state);
+
+	IdleLoopStats GetStats();
+};
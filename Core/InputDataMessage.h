@@ -14,6 +14,11 @@ protected:
 		s.StreamVector(_inputState.State);
 	}
 
+	bool IsCompressed() override
+	{
+		return false;
+	}
+
 public:
 	InputDataMessage(void* buffer, uint32_t length) : NetMessage(buffer, length) { }
 
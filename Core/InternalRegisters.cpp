@@ -133,7 +133,7 @@ uint8_t InternalRegisters::Read(uint16_t addr)
 			//TODO TIMING (set/clear timing)
 			return (
 				(scanline >= nmiScanline ? 0x80 : 0) |
-				((hClock >= 1*4 && hClock <= 274*4) ? 0 : 0x40) |
+				((hClock >= HblankEndClock && hClock <= HblankStartClock) ? 0 : 0x40) |
 				((_state.EnableAutoJoypadRead && scanline >= nmiScanline && scanline <= nmiScanline + 2) ? 0x01 : 0) | //Auto joypad read in progress
 				(_memoryManager->GetOpenBus() & 0x3E)
 			);
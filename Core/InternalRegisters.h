@@ -11,6 +11,11 @@ class MemoryManager;
 
 class InternalRegisters final : public ISerializable
 {
+public:
+	//$4212's hblank flag is cleared between these H clocks (inclusive)
+	static constexpr uint16_t HblankEndClock = 1 * 4;
+	static constexpr uint16_t HblankStartClock = 274 * 4;
+
 private:
 	Console* _console;
 	Cpu* _cpu;
@@ -46,6 +51,13 @@ public:
 	bool IsFastRomEnabled() { return _state.EnableFastRom; }
 	uint16_t GetHorizontalTimer() { return _state.HorizontalTimer; }
 	uint16_t GetVerticalTimer() { return _state.VerticalTimer; }
+
+	//True when the IRQ counters can't trigger an IRQ before the end of the scanline (H-IRQ disabled, V-IRQ level already set)
+	bool IsIrqCounterIdle()
+	{
+		bool irqLevel = _state.EnableVerticalIrq && _ppu->GetRealScanline() == _state.VerticalTimer;
+		return _needIrq == 0 && !_state.EnableHorizontalIrq && _irqLevel == irqLevel;
+	}
 	
 	uint8_t Peek(uint16_t addr);
 	uint8_t Read(uint16_t addr);
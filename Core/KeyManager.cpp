@@ -9,7 +9,6 @@ IKeyManager* KeyManager::_keyManager = nullptr;
 MousePosition KeyManager::_mousePosition = { 0, 0 };
 atomic<int16_t> KeyManager::_xMouseMovement;
 atomic<int16_t> KeyManager::_yMouseMovement;
-EmuSettings* KeyManager::_settings = nullptr;
 
 void KeyManager::RegisterKeyManager(IKeyManager* keyManager)
 {
@@ -25,15 +24,10 @@ void KeyManager::RefreshKeyState()
 	}
 }
 
-void KeyManager::SetSettings(EmuSettings *settings)
-{
-	_settings = settings;
-}
-
 bool KeyManager::IsKeyPressed(uint32_t keyCode)
 {
 	if(_keyManager != nullptr) {
-		return _settings->IsInputEnabled() && _keyManager->IsKeyPressed(keyCode);
+		return _keyManager->IsKeyPressed(keyCode);
 	}
 	return false;
 }
@@ -41,7 +35,7 @@ bool KeyManager::IsKeyPressed(uint32_t keyCode)
 bool KeyManager::IsMouseButtonPressed(MouseButton button)
 {
 	if(_keyManager != nullptr) {
-		return _settings->IsInputEnabled() && _keyManager->IsMouseButtonPressed(button);
+		return _keyManager->IsMouseButtonPressed(button);
 	}
 	return false;
 }
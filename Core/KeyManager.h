@@ -3,7 +3,6 @@
 #include "IKeyManager.h"
 
 class Console;
-class EmuSettings;
 
 class KeyManager
 {
@@ -12,11 +11,9 @@ private:
 	static MousePosition _mousePosition;
 	static atomic<int16_t> _xMouseMovement;
 	static atomic<int16_t> _yMouseMovement;
-	static EmuSettings* _settings;
 
 public:
 	static void RegisterKeyManager(IKeyManager* keyManager);
-	static void SetSettings(EmuSettings* settings);
 
 	static void RefreshKeyState();
 	static bool IsKeyPressed(uint32_t keyCode);
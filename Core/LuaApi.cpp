@@ -15,6 +15,7 @@
 #include "RewindManager.h"
 #include "SaveStateManager.h"
 #include "Console.h"
+#include "EmuSettings.h"
 #include "BaseCartridge.h"
 #include "IKeyManager.h"
 #include "ControlManager.h"
@@ -24,6 +25,7 @@
 #include "MemoryAccessCounter.h"
 #include "LabelManager.h"
 #include "DefaultVideoFilter.h"
+#include "SubsystemProfiler.h"
 
 #define lua_pushintvalue(name, value) lua_pushliteral(lua, #name); lua_pushinteger(lua, (int)value); lua_settable(lua, -3);
 #define lua_pushdoublevalue(name, value) lua_pushliteral(lua, #name); lua_pushnumber(lua, (double)value); lua_settable(lua, -3);
@@ -42,11 +44,11 @@
 #define checkinitdone() if(!_context->CheckInitDone()) { error("This function cannot be called outside a callback"); return 0; }
 #define checksavestateconditions() if(!_context->CheckInStartFrameEvent() && !_context->CheckInExecOpEvent()) { error("This function must be called inside a StartFrame event callback or a CpuExec memory operation callback"); return 0; }
 
-Debugger* LuaApi::_debugger = nullptr;
-Console* LuaApi::_console = nullptr;
-Ppu* LuaApi::_ppu = nullptr;
-MemoryDumper* LuaApi::_memoryDumper = nullptr;
-ScriptingContext* LuaApi::_context = nullptr;
+thread_local Debugger* LuaApi::_debugger = nullptr;
+thread_local Console* LuaApi::_console = nullptr;
+thread_local Ppu* LuaApi::_ppu = nullptr;
+thread_local MemoryDumper* LuaApi::_memoryDumper = nullptr;
+thread_local ScriptingContext* LuaApi::_context = nullptr;
 
 void LuaApi::SetContext(ScriptingContext* context)
 {
@@ -95,6 +97,8 @@ int LuaApi::GetLibrary(lua_State *lua)
 		{ "getRomInfo", LuaApi::GetRomInfo },
 		{ "getLogWindowLog", LuaApi::GetLogWindowLog },
 		{ "getLabelAddress", LuaApi::GetLabelAddress },
+		{ "setSubsystemProfilerEnabled", LuaApi::SetSubsystemProfilerEnabled },
+		{ "getSubsystemProfile", LuaApi::GetSubsystemProfile },
 		{ NULL,NULL }
 	};
 
@@ -304,7 +308,8 @@ int LuaApi::GetPrgRomOffset(lua_State *lua)
 int LuaApi::RegisterMemoryCallback(lua_State *lua)
 {
 	LuaCallHelper l(lua);
-	l.ForceParamCount(5);
+	l.ForceParamCount(6);
+	bool batched = l.ReadBool();
 	CpuType cpuType = (CpuType)l.ReadInteger((int)CpuType::Cpu);
 	int32_t endAddr = l.ReadInteger(-1);
 	int32_t startAddr = l.ReadInteger();
@@ -320,7 +325,7 @@ int LuaApi::RegisterMemoryCallback(lua_State *lua)
 	errorCond(callbackType < CallbackType::CpuRead || callbackType > CallbackType::CpuExec, "the specified type is invalid");
 	errorCond(cpuType < CpuType::Cpu || cpuType > CpuType::Gameboy, "the cpu type is invalid");
 	errorCond(reference == LUA_NOREF, "the specified function could not be found");
-	_context->RegisterMemoryCallback(callbackType, startAddr, endAddr, cpuType, reference);
+	_context->RegisterMemoryCallback(callbackType, startAddr, endAddr, cpuType, reference, batched);
 	_context->Log("Registered memory callback from $" + HexUtilities::ToHex((uint32_t)startAddr) + " to $" + HexUtilities::ToHex((uint32_t)endAddr));
 	l.Return(reference);
 	return l.ReturnCount();
@@ -512,12 +517,13 @@ int LuaApi::GetMouseState(lua_State *lua)
 	LuaCallHelper l(lua);
 	MousePosition pos = KeyManager::GetMousePosition();
 	checkparams();
+	bool inputEnabled = _console->GetSettings()->IsInputEnabled();
 	lua_newtable(lua);
 	lua_pushintvalue(x, pos.X);
 	lua_pushintvalue(y, pos.Y);
-	lua_pushboolvalue(left, KeyManager::IsMouseButtonPressed(MouseButton::LeftButton));
-	lua_pushboolvalue(middle, KeyManager::IsMouseButtonPressed(MouseButton::MiddleButton));
-	lua_pushboolvalue(right, KeyManager::IsMouseButtonPressed(MouseButton::RightButton));
+	lua_pushboolvalue(left, inputEnabled && KeyManager::IsMouseButtonPressed(MouseButton::LeftButton));
+	lua_pushboolvalue(middle, inputEnabled && KeyManager::IsMouseButtonPressed(MouseButton::MiddleButton));
+	lua_pushboolvalue(right, inputEnabled && KeyManager::IsMouseButtonPressed(MouseButton::RightButton));
 	return 1;
 }
 
@@ -610,7 +616,7 @@ int LuaApi::IsKeyPressed(lua_State *lua)
 	checkparams();
 	uint32_t keyCode = KeyManager::GetKeyCode(keyName);
 	errorCond(keyCode == 0, "Invalid key name");
-	l.Return(KeyManager::IsKeyPressed(keyCode));
+	l.Return(_console->GetSettings()->IsInputEnabled() && KeyManager::IsKeyPressed(keyCode));
 	return l.ReturnCount();
 }
 
@@ -690,6 +696,39 @@ int LuaApi::ResetAccessCounters(lua_State *lua)
 	return l.ReturnCount();
 }
 
+int LuaApi::SetSubsystemProfilerEnabled(lua_State *lua)
+{
+	LuaCallHelper l(lua);
+	bool enabled = l.ReadBool();
+	checkparams();
+	errorCond(!SubsystemProfiler::IsAvailable(), "The subsystem profiler is not available in this build");
+	_console->GetSubsystemProfiler()->SetEnabled(enabled);
+	return l.ReturnCount();
+}
+
+int LuaApi::GetSubsystemProfile(lua_State *lua)
+{
+	LuaCallHelper l(lua);
+	checkparams();
+
+	shared_ptr<SubsystemProfiler> profiler = _console->GetSubsystemProfiler();
+	SubsystemProfilerStats stats = profiler->GetStats();
+
+	lua_newtable(lua);
+	lua_pushboolvalue(enabled, profiler->IsEnabled());
+	lua_pushintvalue(frameCount, stats.FrameCount);
+	for(int i = 0; i < HostSubsystemCount; i++) {
+		//Times are in microseconds
+		lua_pushstring(lua, SubsystemProfiler::GetSubsystemName((HostSubsystem)i));
+		lua_newtable(lua);
+		lua_pushdoublevalue(total, stats.TotalTime[i]);
+		lua_pushdoublevalue(lastFrame, stats.LastFrameTime[i]);
+		lua_pushdoublevalue(maxFrame, stats.MaxFrameTime[i]);
+		lua_endtable();
+	}
+	return 1;
+}
+
 int LuaApi::GetScriptDataFolder(lua_State *lua)
 {
 	LuaCallHelper l(lua);
@@ -75,10 +75,13 @@ public:
 	static int GetAccessCounters(lua_State *lua);
 	static int ResetAccessCounters(lua_State *lua);
 
+	static int SetSubsystemProfilerEnabled(lua_State *lua);
+	static int GetSubsystemProfile(lua_State *lua);
+
 private:
-	static Console* _console;
-	static Ppu* _ppu;
-	static Debugger* _debugger;
-	static MemoryDumper* _memoryDumper;
-	static ScriptingContext* _context;
+	static thread_local Console* _console;
+	static thread_local Ppu* _ppu;
+	static thread_local Debugger* _debugger;
+	static thread_local MemoryDumper* _memoryDumper;
+	static thread_local ScriptingContext* _context;
 };
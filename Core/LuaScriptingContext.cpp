@@ -10,7 +10,7 @@
 #include "Debugger.h"
 #include "EventType.h"
 
-LuaScriptingContext* LuaScriptingContext::_context = nullptr;
+thread_local LuaScriptingContext* LuaScriptingContext::_context = nullptr;
 uint32_t LuaScriptingContext::_timeout = 1000;
 
 LuaScriptingContext::LuaScriptingContext(Debugger* debugger) : ScriptingContext(debugger)
@@ -26,6 +26,9 @@ LuaScriptingContext::~LuaScriptingContext()
 			for(MemoryCallback &callback : _callbacks[i]) {
 				references.emplace(callback.Reference);
 			}
+			for(BatchedMemoryCallback &callback : _batchedCallbacks[i]) {
+				references.emplace(callback.Reference);
+			}
 		}
 
 		for(int i = (int)EventType::Reset; i < (int)EventType::EventTypeSize; i++) {
@@ -139,6 +142,33 @@ void LuaScriptingContext::InternalCallMemoryCallback(uint32_t addr, uint8_t &val
 	}
 }
 
+void LuaScriptingContext::InternalCallBatchedMemoryCallback(BatchedMemoryCallback &callback)
+{
+	_timer.Reset();
+	_context = this;
+	lua_sethook(_lua, LuaScriptingContext::ExecutionCountHook, LUA_MASKCOUNT, 1000);
+	LuaApi::SetContext(this);
+
+	lua_rawgeti(_lua, LUA_REGISTRYINDEX, callback.Reference);
+
+	//counts: address -> number of accesses during the frame, values: address -> last value read/written
+	lua_createtable(_lua, 0, (int)callback.Accesses.size());
+	for(auto &access : callback.Accesses) {
+		lua_pushinteger(_lua, access.second.Count);
+		lua_rawseti(_lua, -2, access.first);
+	}
+	lua_createtable(_lua, 0, (int)callback.Accesses.size());
+	for(auto &access : callback.Accesses) {
+		lua_pushinteger(_lua, access.second.Value);
+		lua_rawseti(_lua, -2, access.first);
+	}
+
+	if(lua_pcall(_lua, 2, 0, 0) != 0) {
+		Log(lua_tostring(_lua, -1));
+		lua_pop(_lua, 1);
+	}
+}
+
 int LuaScriptingContext::InternalCallEventCallback(EventType type)
 {
 	if(_eventCallbacks[(int)type].empty()) {
@@ -12,7 +12,7 @@ class Debugger;
 class LuaScriptingContext : public ScriptingContext
 {
 private:
-	static LuaScriptingContext* _context;
+	static thread_local LuaScriptingContext* _context;
 	static uint32_t _timeout;
 	lua_State* _lua = nullptr;
 	Timer _timer;
@@ -21,6 +21,7 @@ private:
 
 protected:
 	void InternalCallMemoryCallback(uint32_t addr, uint8_t &value, CallbackType type, CpuType cpuType) override;
+	void InternalCallBatchedMemoryCallback(BatchedMemoryCallback &callback) override;
 	int InternalCallEventCallback(EventType type) override;
 
 public:
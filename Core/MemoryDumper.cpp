@@ -38,6 +38,9 @@ void MemoryDumper::SetMemoryState(SnesMemoryType type, uint8_t *buffer, uint32_t
 	uint8_t* dst = GetMemoryBuffer(type);
 	if(dst) {
 		memcpy(dst, buffer, length);
+		if(type == SnesMemoryType::VideoRam) {
+			_ppu->InvalidateTileCache();
+		}
 	}
 }
 
@@ -215,6 +218,9 @@ void MemoryDumper::SetMemoryValue(SnesMemoryType memoryType, uint32_t address, u
 			if(src) {
 				src[address] = value;
 				invalidateCache();
+				if(memoryType == SnesMemoryType::VideoRam) {
+					_ppu->InvalidateTileCache();
+				}
 			}
 			break;
 	}
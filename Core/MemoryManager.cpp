@@ -126,54 +126,25 @@ void MemoryManager::GenerateMasterClockTable()
 	}
 }
 
-void MemoryManager::IncMasterClock4()
+void MemoryManager::SetInstrumented(bool instrumented)
 {
-	Exec();
-	Exec();
+	_instrumented = instrumented;
 }
 
-void MemoryManager::IncMasterClock6()
+bool MemoryManager::IsInstrumented()
 {
-	Exec();
-	Exec();
-	Exec();
+	return _instrumented;
 }
 
-void MemoryManager::IncMasterClock8()
-{
-	Exec();
-	Exec();
-	Exec();
-	Exec();
-}
-
-void MemoryManager::IncMasterClock40()
+template<bool instrumented>
+void MemoryManager::RunMasterClock(uint16_t cyclesToRun)
 {
-	Exec(); Exec(); Exec(); Exec(); Exec();
-	Exec(); Exec(); Exec(); Exec(); Exec();
-	Exec(); Exec(); Exec(); Exec(); Exec();
-	Exec(); Exec(); Exec(); Exec(); Exec();
-}
-
-void MemoryManager::IncMasterClockStartup()
-{
-	for(int i = 0; i < 182 / 2; i++) {
-		Exec();
-	}
-}
-
-void MemoryManager::IncrementMasterClockValue(uint16_t cyclesToRun)
-{
-	switch(cyclesToRun) {
-		case 12: Exec();
-		case 10: Exec();
-		case 8: Exec();
-		case 6: Exec();
-		case 4: Exec();
-		case 2: Exec();
+	for(uint16_t i = 0; i < cyclesToRun; i += 2) {
+		Exec<instrumented>();
 	}
 }
 
+template<bool instrumented>
 void MemoryManager::Exec()
 {
 	_masterClock += 2;
@@ -184,7 +155,9 @@ void MemoryManager::Exec()
 	} 
 	
 	if((_hClock & 0x03) == 0) {
-		_console->ProcessPpuCycle<CpuType::Cpu>();
+		if(instrumented) {
+			_console->ProcessPpuCycle<CpuType::Cpu>();
+		}
 		_regs->ProcessIrqCounters();
 	}
 
@@ -193,6 +166,8 @@ void MemoryManager::Exec()
 
 void MemoryManager::ProcessEvent()
 {
+	_eventCount++;
+
 	switch(_nextEvent) {
 		case SnesEventType::HdmaInit:
 			_console->GetDmaController()->BeginHdmaInit();
@@ -238,13 +213,20 @@ void MemoryManager::ProcessEvent()
 	}
 }
 
-uint8_t MemoryManager::Read(uint32_t addr, MemoryOperationType type)
+template<bool instrumented>
+uint8_t MemoryManager::ReadBus(uint32_t addr, MemoryOperationType type)
 {
-	IncrementMasterClockValue(_cpuSpeed - 4);
+	RunMasterClock<instrumented>(_cpuSpeed - 4);
 
 	uint8_t value;
 	IMemoryHandler *handler = _mappings.GetHandler(addr);
-	if(handler) {
+	uint8_t* page = _mappings.GetDirectReadPage(addr);
+	if(page) {
+		//Plain RAM/ROM page, read directly without calling the handler
+		value = page[addr & 0xFFF];
+		_memTypeBusA = handler->GetMemoryType();
+		_openBus = value;
+	} else if(handler) {
 		value = handler->Read(addr);
 		_memTypeBusA = handler->GetMemoryType();
 		_openBus = value;
@@ -253,17 +235,20 @@ uint8_t MemoryManager::Read(uint32_t addr, MemoryOperationType type)
 		value = _openBus;
 		LogDebug("[Debug] Read - missing handler: $" + HexUtilities::ToHex(addr));
 	}
-	_cheatManager->ApplyCheat(addr, value);
-	_console->ProcessMemoryRead<CpuType::Cpu>(addr, value, type);
+	if(instrumented) {
+		_cheatManager->ApplyCheat(addr, value);
+		_console->ProcessMemoryRead<CpuType::Cpu>(addr, value, type);
+	}
 
-	IncMasterClock4();
+	RunMasterClock<instrumented>(4);
 	return value;
 }
 
-uint8_t MemoryManager::ReadDma(uint32_t addr, bool forBusA)
+template<bool instrumented>
+uint8_t MemoryManager::ReadDmaBus(uint32_t addr, bool forBusA)
 {
 	_cpu->DetectNmiSignalEdge();
-	IncMasterClock4();
+	RunMasterClock<instrumented>(4);
 
 	uint8_t value;
 	IMemoryHandler* handler = _mappings.GetHandler(addr);
@@ -291,8 +276,10 @@ uint8_t MemoryManager::ReadDma(uint32_t addr, bool forBusA)
 		value = _openBus;
 		LogDebug("[Debug] Read - missing handler: $" + HexUtilities::ToHex(addr));
 	}
-	_cheatManager->ApplyCheat(addr, value);
-	_console->ProcessMemoryRead<CpuType::Cpu>(addr, value, MemoryOperationType::DmaRead);
+	if(instrumented) {
+		_cheatManager->ApplyCheat(addr, value);
+		_console->ProcessMemoryRead<CpuType::Cpu>(addr, value, MemoryOperationType::DmaRead);
+	}
 	return value;
 }
 
@@ -311,13 +298,20 @@ void MemoryManager::PeekBlock(uint32_t addr, uint8_t *dest)
 	_mappings.PeekBlock(addr, dest);
 }
 
-void MemoryManager::Write(uint32_t addr, uint8_t value, MemoryOperationType type)
+template<bool instrumented>
+void MemoryManager::WriteBus(uint32_t addr, uint8_t value, MemoryOperationType type)
 {
-	IncrementMasterClockValue(_cpuSpeed);
+	RunMasterClock<instrumented>(_cpuSpeed);
 
-	_console->ProcessMemoryWrite<CpuType::Cpu>(addr, value, type);
+	if(instrumented) {
+		_console->ProcessMemoryWrite<CpuType::Cpu>(addr, value, type);
+	}
 	IMemoryHandler* handler = _mappings.GetHandler(addr);
-	if(handler) {
+	uint8_t* page = _mappings.GetDirectWritePage(addr);
+	if(page) {
+		page[addr & 0xFFF] = value;
+		_memTypeBusA = handler->GetMemoryType();
+	} else if(handler) {
 		handler->Write(addr, value);
 		_memTypeBusA = handler->GetMemoryType();
 	} else {
@@ -325,11 +319,14 @@ void MemoryManager::Write(uint32_t addr, uint8_t value, MemoryOperationType type
 	}
 }
 
-void MemoryManager::WriteDma(uint32_t addr, uint8_t value, bool forBusA)
+template<bool instrumented>
+void MemoryManager::WriteDmaBus(uint32_t addr, uint8_t value, bool forBusA)
 {
 	_cpu->DetectNmiSignalEdge();
-	IncMasterClock4();
-	_console->ProcessMemoryWrite<CpuType::Cpu>(addr, value, MemoryOperationType::DmaWrite);
+	RunMasterClock<instrumented>(4);
+	if(instrumented) {
+		_console->ProcessMemoryWrite<CpuType::Cpu>(addr, value, MemoryOperationType::DmaWrite);
+	}
 
 	IMemoryHandler* handler = _mappings.GetHandler(addr);
 	if(handler) {
@@ -353,6 +350,70 @@ void MemoryManager::WriteDma(uint32_t addr, uint8_t value, bool forBusA)
 	}
 }
 
+//The variant is picked with a direct branch on _instrumented (which stays the same for the whole frame, so it's always predicted),
+//the selected variant is inlined here - unlike a call through a function pointer, which the compiler can't inline
+uint8_t MemoryManager::Read(uint32_t addr, MemoryOperationType type)
+{
+	return _instrumented ? ReadBus<true>(addr, type) : ReadBus<false>(addr, type);
+}
+
+uint8_t MemoryManager::ReadDma(uint32_t addr, bool forBusA)
+{
+	return _instrumented ? ReadDmaBus<true>(addr, forBusA) : ReadDmaBus<false>(addr, forBusA);
+}
+
+void MemoryManager::Write(uint32_t addr, uint8_t value, MemoryOperationType type)
+{
+	if(_instrumented) {
+		WriteBus<true>(addr, value, type);
+	} else {
+		WriteBus<false>(addr, value, type);
+	}
+}
+
+void MemoryManager::WriteDma(uint32_t addr, uint8_t value, bool forBusA)
+{
+	if(_instrumented) {
+		WriteDmaBus<true>(addr, value, forBusA);
+	} else {
+		WriteDmaBus<false>(addr, value, forBusA);
+	}
+}
+
+void MemoryManager::IncrementMasterClockValue(uint16_t cyclesToRun)
+{
+	if(_instrumented) {
+		RunMasterClock<true>(cyclesToRun);
+	} else {
+		RunMasterClock<false>(cyclesToRun);
+	}
+}
+
+void MemoryManager::IncMasterClock4()
+{
+	IncrementMasterClockValue(4);
+}
+
+void MemoryManager::IncMasterClock6()
+{
+	IncrementMasterClockValue(6);
+}
+
+void MemoryManager::IncMasterClock8()
+{
+	IncrementMasterClockValue(8);
+}
+
+void MemoryManager::IncMasterClock40()
+{
+	IncrementMasterClockValue(40);
+}
+
+void MemoryManager::IncMasterClockStartup()
+{
+	IncrementMasterClockValue(182);
+}
+
 uint8_t MemoryManager::GetOpenBus()
 {
 	return _openBus;
@@ -368,6 +429,54 @@ uint16_t MemoryManager::GetHClock()
 	return _hClock;
 }
 
+uint16_t MemoryManager::GetNextEventClock()
+{
+	return _nextEventClock;
+}
+
+uint32_t MemoryManager::GetEventCount()
+{
+	return _eventCount;
+}
+
+void MemoryManager::SkipIdleClocks(uint32_t clocks)
+{
+	_masterClock += clocks;
+	_hClock += clocks;
+}
+
+uint32_t MemoryManager::GetIdleClockWindow()
+{
+	if(_instrumented || _cart->NeedsCoprocessorSync() || !_regs->IsIrqCounterIdle() || _nextEventClock <= _hClock) {
+		return 0;
+	}
+	return _nextEventClock - _hClock - 1;
+}
+
+bool MemoryManager::IsBlockTransferTarget(uint16_t addressBusB)
+{
+	switch(addressBusB) {
+		case 0x2104: case 0x2118: case 0x2119: case 0x2122:
+			//OAM, VRAM, CGRAM: the PPU catches up with the current cycle on each write outside of vblank
+			return _ppu->GetScanline() >= _ppu->GetVblankStart();
+
+		case 0x2180:
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+void MemoryManager::EndBlockTransfer(uint32_t lastAddressBusA, uint8_t lastValue, uint32_t clocks)
+{
+	//Leave the bus in the same state as if the bytes had been copied one at a time
+	_cpu->DetectNmiSignalEdge();
+	_openBus = lastValue;
+	_memTypeBusA = _mappings.GetHandler(lastAddressBusA)->GetMemoryType();
+	SkipIdleClocks(clocks);
+}
+
 uint8_t * MemoryManager::DebugGetWorkRam()
 {
 	return _workRam;
@@ -47,6 +47,7 @@ private:
 	uint16_t _nextEventClock = 0;
 	uint16_t _dramRefreshPosition = 0;
 	SnesEventType _nextEvent = SnesEventType::DramRefresh;
+	uint32_t _eventCount = 0;
 	SnesMemoryType _memTypeBusA = SnesMemoryType::PrgRom;
 
 	uint8_t _cpuSpeed = 8;
@@ -56,7 +57,16 @@ private:
 	vector<unique_ptr<IMemoryHandler>> _workRamHandlers;
 	uint8_t _masterClockTable[0x800];
 
-	void Exec();
+	//Selects the instrumented or stripped variant of the bus/clock functions - only changed between frames (see Console::RunFrame)
+	bool _instrumented = true;
+
+	template<bool instrumented> void Exec();
+	template<bool instrumented> void RunMasterClock(uint16_t cyclesToRun);
+
+	template<bool instrumented> uint8_t ReadBus(uint32_t addr, MemoryOperationType type);
+	template<bool instrumented> void WriteBus(uint32_t addr, uint8_t value, MemoryOperationType type);
+	template<bool instrumented> uint8_t ReadDmaBus(uint32_t addr, bool forBusA);
+	template<bool instrumented> void WriteDmaBus(uint32_t addr, uint8_t value, bool forBusA);
 
 	void ProcessEvent();
 
@@ -68,6 +78,10 @@ public:
 
 	void GenerateMasterClockTable();
 
+	//When not instrumented, cheats and debugger callbacks (memory accesses, ppu cycles) are compiled out of the bus access code
+	void SetInstrumented(bool instrumented);
+	bool IsInstrumented();
+
 	void IncMasterClock4();
 	void IncMasterClock6();
 	void IncMasterClock8();
@@ -88,6 +102,19 @@ public:
 	uint8_t GetOpenBus();
 	uint64_t GetMasterClock();
 	uint16_t GetHClock();
+	uint16_t GetNextEventClock();
+	uint32_t GetEventCount();
+
+	//Moves the clock forward without running each cycle - the caller must make sure this doesn't skip over the next event
+	void SkipIdleClocks(uint32_t clocks);
+
+	//Number of master clocks that can be skipped without missing anything (no event, IRQ or coprocessor to run, no debugger/cheats)
+	uint32_t GetIdleClockWindow();
+
+	//DMA block transfers (see DmaController::RunBlockTransfer)
+	bool IsBlockTransferTarget(uint16_t addressBusB);
+	void EndBlockTransfer(uint32_t lastAddressBusA, uint8_t lastValue, uint32_t clocks);
+
 	uint8_t* DebugGetWorkRam();
 
 	MemoryMappings* GetMemoryMappings();
@@ -9,11 +9,24 @@ class MemoryMappings
 private:
 	IMemoryHandler* _handlers[0x100 * 0x10] = {};
 
+	//Direct pointers to the pages that can be read/written without going through their handler (plain RAM/ROM)
+	uint8_t* _readPages[0x100 * 0x10] = {};
+	uint8_t* _writePages[0x100 * 0x10] = {};
+	bool _directPagesEnabled = true;
+
+	void SetHandler(uint32_t page, IMemoryHandler* handler);
+
 public:
 	void RegisterHandler(uint8_t startBank, uint8_t endBank, uint16_t startPage, uint16_t endPage, vector<unique_ptr<IMemoryHandler>>& handlers, uint16_t pageIncrement = 0, uint16_t startPageNumber = 0);
 	void RegisterHandler(uint8_t startBank, uint8_t endBank, uint16_t startAddr, uint16_t endAddr, IMemoryHandler* handler);
 
 	IMemoryHandler* GetHandler(uint32_t addr);
+
+	//When disabled, every access goes through the pages' handlers (used to benchmark the direct page tables)
+	void SetDirectPagesEnabled(bool enabled);
+
+	__forceinline uint8_t* GetDirectReadPage(uint32_t addr) { return _readPages[addr >> 12]; }
+	__forceinline uint8_t* GetDirectWritePage(uint32_t addr) { return _writePages[addr >> 12]; }
 	AddressInfo GetAbsoluteAddress(uint32_t addr);
 	int GetRelativeAddress(AddressInfo& absAddress, uint8_t startBank = 0);
 
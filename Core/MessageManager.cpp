@@ -54,6 +54,7 @@ std::unordered_map<string, string> MessageManager::_enResources = {
 	{ "MovieSaved", u8"Movie saved to file: %1" },
 	{ "NetplayVersionMismatch", u8"%1 is not running the same version of Mesen-S and has been disconnected." },
 	{ "NetplayNotAllowed", u8"This action is not allowed while connected to a server." },
+	{ "NetplayDesync", u8"Desync detected at frame %1, sending the game's state to the player again." },
 	{ "OverclockEnabled", u8"Overclocking enabled." },
 	{ "OverclockDisabled", u8"Overclocking disabled." },
 	{ "PrgSizeWarning", u8"PRG size is smaller than 32kb" },
@@ -3,35 +3,73 @@
 #include "NetMessage.h"
 #include "ControlDeviceState.h"
 
+//Input used by all ports on a frame (sent by the server to the clients, when rollback mode is disabled)
 class MovieDataMessage : public NetMessage
 {
 private:
-	uint8_t _portNumber;
-	ControlDeviceState _inputState;
+	vector<uint8_t> _ports;
+	vector<ControlDeviceState> _inputStates;
 
 protected:
 	void Serialize(Serializer &s) override
 	{
-		s.Stream(_portNumber);
-		s.StreamVector(_inputState.State);
+		//The states are concatenated in a single buffer, preceded by their sizes
+		vector<uint8_t> sizes;
+		vector<uint8_t> data;
+		if(s.IsSaving()) {
+			for(ControlDeviceState &state : _inputStates) {
+				sizes.push_back((uint8_t)state.State.size());
+				data.insert(data.end(), state.State.begin(), state.State.end());
+			}
+		}
+
+		s.StreamVector(_ports);
+		s.StreamVector(sizes);
+		s.StreamVector(data);
+
+		if(!s.IsSaving()) {
+			size_t pos = 0;
+			_inputStates.clear();
+			for(size_t i = 0; i < sizes.size() && i < _ports.size() && pos + sizes[i] <= data.size(); i++) {
+				ControlDeviceState state;
+				state.State.insert(state.State.end(), data.begin() + pos, data.begin() + pos + sizes[i]);
+				_inputStates.push_back(state);
+				pos += sizes[i];
+			}
+			_ports.resize(_inputStates.size());
+		}
+	}
+
+	bool IsCompressed() override
+	{
+		return false;
 	}
 
 public:
 	MovieDataMessage(void* buffer, uint32_t length) : NetMessage(buffer, length) { }
 
-	MovieDataMessage(ControlDeviceState state, uint8_t port) : NetMessage(MessageType::MovieData)
+	MovieDataMessage() : NetMessage(MessageType::MovieData)
+	{
+	}
+
+	void AddInputState(uint8_t port, ControlDeviceState state)
+	{
+		_ports.push_back(port);
+		_inputStates.push_back(state);
+	}
+
+	uint32_t GetInputCount()
 	{
-		_portNumber = port;
-		_inputState = state;
+		return (uint32_t)_inputStates.size();
 	}
 
-	uint8_t GetPortNumber()
+	uint8_t GetPortNumber(uint32_t index)
 	{
-		return _portNumber;
+		return _ports[index];
 	}
 
-	ControlDeviceState GetInputState()
+	ControlDeviceState GetInputState(uint32_t index)
 	{
-		return _inputState;
+		return _inputStates[index];
 	}
-};
\ No newline at end of file
+};
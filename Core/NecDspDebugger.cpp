@@ -40,11 +40,9 @@ void NecDspDebugger::ProcessRead(uint16_t addr, uint8_t value, MemoryOperationTy
 			_disassembler->BuildCache(addressInfo, 0, CpuType::NecDsp);
 
 			if(_traceLogger->IsCpuLogged(CpuType::NecDsp)) {
-				DebugState debugState;
-				_debugger->GetState(debugState, true);
-
+				NecDspState dspState = _dsp->GetState();
 				DisassemblyInfo disInfo = _disassembler->GetDisassemblyInfo(addressInfo, addr, 0, CpuType::NecDsp);
-				_traceLogger->Log(CpuType::NecDsp, debugState, disInfo);
+				_traceLogger->Log(dspState, disInfo);
 			}
 		}
 
@@ -29,7 +29,7 @@ public:
 
 	void Initialize()
 	{
-		Serializer s(_receivedData, SaveStateManager::FileFormatVersion);
+		Serializer s(_receivedData, SaveStateManager::FileFormatVersion, IsCompressed());
 		Serialize(s);
 	}
 
@@ -38,20 +38,29 @@ public:
 		return _type;
 	}
 
-	void Send(Socket &socket)
+	//Returns the number of bytes sent
+	uint32_t Send(Socket &socket)
 	{
-		Serializer s(SaveStateManager::FileFormatVersion);
+		//Small messages (input, etc.) are not compressed and don't need the default (large) buffer
+		vector<uint8_t> buffer(IsCompressed() ? 0 : 0x100);
+		Serializer s(SaveStateManager::FileFormatVersion, buffer);
 		Serialize(s);
 
 		stringstream out;
-		s.Save(out);
+		s.Save(out, IsCompressed() ? 1 : 0);
 
 		string data = out.str();
 		uint32_t messageLength = (uint32_t)data.size() + 1;
 		data = string((char*)&messageLength, 4) + (char)_type + data;
 		socket.Send((char*)data.c_str(), (int)data.size(), 0);
+		return (uint32_t)data.size();
 	}
 
 protected:
 	virtual void Serialize(Serializer &s) = 0;
+
+	virtual bool IsCompressed()
+	{
+		return true;
+	}
 };
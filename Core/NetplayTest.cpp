@@ -0,0 +1,141 @@
+#include "stdafx.h"
+#include <random>
+#include "NetplayTest.h"
+#include "Console.h"
+#include "EmuSettings.h"
+#include "BatteryManager.h"
+#include "GameServer.h"
+#include "GameClient.h"
+#include "ClientConnectionData.h"
+#include "RollbackManager.h"
+#include "../Utilities/VirtualFile.h"
+#include "../Utilities/Timer.h"
+
+shared_ptr<Console> NetplayTest::CreateConsole(string romPath)
+{
+	shared_ptr<Console> console(new Console());
+	console->Initialize(true);
+	console->GetBatteryManager()->SetFileAccessEnabled(false);
+
+	InputConfig cfg = console->GetSettings()->GetInputConfig();
+	cfg.Controllers[0].Type = ControllerType::SnesController;
+	cfg.Controllers[1].Type = ControllerType::SnesController;
+	console->GetSettings()->SetInputConfig(cfg);
+
+	if(!console->LoadRom((VirtualFile)romPath, VirtualFile())) {
+		console->Release();
+		return nullptr;
+	}
+	return console;
+}
+
+void NetplayTest::RunConsole(Console* console, uint8_t port, uint32_t seed, uint32_t frameCount, atomic<bool> &timeout)
+{
+	shared_ptr<RollbackManager> rollbackManager = console->GetRollbackManager();
+	std::mt19937 random(seed);
+	ControlDeviceState state;
+	state.State = { 0, 0 };
+
+	while(!timeout && (int32_t)(rollbackManager->GetFrame() - frameCount) < 0) {
+		//Give the netplay threads a chance to lock the console (e.g to send or load a state)
+		std::this_thread::yield();
+
+		if(random() % 8 == 0) {
+			//Change the buttons every few frames on average, so some predictions are correct and others aren't
+			state.State = { (uint8_t)random(), (uint8_t)random() };
+		}
+		rollbackManager->SetLocalInput(port, state);
+
+		auto lock = console->AcquireLock();
+		console->RunSingleFrame();
+	}
+}
+
+string NetplayTest::GetStatisticsJson(RollbackStatistics &stats, NetplayStatistics &networkStats)
+{
+	std::stringstream ss;
+	ss << "{ \"rollbacks\": " << stats.RollbackCount << ", \"rolledBackFrames\": " << stats.RolledBackFrames << ", \"maxRollbackDepth\": " << stats.MaxRollbackDepth;
+	ss << ", \"stalls\": " << stats.StallCount << ", \"checkedHashes\": " << stats.CheckedHashCount << ", \"desyncs\": " << stats.DesyncCount;
+	ss << ", \"bytesSent\": " << networkStats.BytesSent << ", \"bytesReceived\": " << networkStats.BytesReceived << ", \"messagesSent\": " << networkStats.MessagesSent;
+	ss << ", \"inputMessagesSent\": " << networkStats.InputMessagesSent << ", \"inputFramesSent\": " << networkStats.InputFramesSent;
+	ss << ", \"inputFramesResent\": " << networkStats.InputFramesResent << ", \"droppedMessages\": " << networkStats.DroppedMessages << " }";
+	return ss.str();
+}
+
+bool NetplayTest::Run(string romPath, uint32_t frameCount, uint16_t port, uint32_t packetLossRate, string &report)
+{
+	shared_ptr<Console> server = CreateConsole(romPath);
+	shared_ptr<Console> client = CreateConsole(romPath);
+	if(!server || !client) {
+		if(server) {
+			server->Release();
+		}
+		if(client) {
+			client->Release();
+		}
+		report = "{ \"loaded\": false, \"passed\": false }\n";
+		return false;
+	}
+
+	server->GetGameServer()->StartServer(port, "", "Server", true);
+	server->GetGameServer()->SetSimulatedPacketLoss(packetLossRate);
+	Timer timer;
+	while(!server->GetGameServer()->Started() && timer.GetElapsedMS() < 5000) {
+		std::this_thread::sleep_for(std::chrono::duration<int, std::milli>(1));
+	}
+
+	//The client is given the 2nd controller (the server uses the 1st one)
+	ClientConnectionData connectionData("127.0.0.1", port, "", "Client", false);
+	client->GetGameClient()->Connect(connectionData);
+	timer.Reset();
+	while(!client->GetRollbackManager()->IsEnabled() && timer.GetElapsedMS() < 5000) {
+		std::this_thread::sleep_for(std::chrono::duration<int, std::milli>(1));
+	}
+
+	bool connected = client->GetRollbackManager()->IsEnabled();
+	client->GetGameClient()->SetSimulatedPacketLoss(packetLossRate);
+	atomic<bool> timeout(!connected);
+	timer.Reset();
+	if(connected) {
+		std::thread serverThread([&]() { RunConsole(server.get(), 0, 1, frameCount, timeout); });
+		std::thread clientThread([&]() { RunConsole(client.get(), 1, 2, frameCount, timeout); });
+
+		while(!timeout && (
+			(int32_t)(server->GetRollbackManager()->GetFrame() - frameCount) < 0 ||
+			(int32_t)(client->GetRollbackManager()->GetFrame() - frameCount) < 0
+		)) {
+			std::this_thread::sleep_for(std::chrono::duration<int, std::milli>(10));
+			timeout = timer.GetElapsedMS() > 60000;
+		}
+		serverThread.join();
+		clientThread.join();
+
+		//Let the server compare the last hashes sent by the client
+		std::this_thread::sleep_for(std::chrono::duration<int, std::milli>(100));
+	}
+	double elapsedMs = timer.GetElapsedMS();
+
+	RollbackStatistics serverStats = server->GetRollbackManager()->GetStatistics();
+	RollbackStatistics clientStats = client->GetRollbackManager()->GetStatistics();
+	NetplayStatistics serverNetworkStats = server->GetGameServer()->GetStatistics();
+	NetplayStatistics clientNetworkStats = client->GetGameClient()->GetStatistics();
+
+	client->Release();
+	server->Release();
+
+	bool passed = connected && !timeout && serverStats.CheckedHashCount > 0 && serverStats.DesyncCount == 0;
+
+	std::stringstream ss;
+	ss << std::fixed << std::setprecision(3);
+	ss << "{" << std::endl;
+	ss << "\t\"connected\": " << (connected ? "true" : "false") << "," << std::endl;
+	ss << "\t\"frames\": " << frameCount << "," << std::endl;
+	ss << "\t\"packetLoss\": " << packetLossRate << "," << std::endl;
+	ss << "\t\"timeMs\": " << elapsedMs << "," << std::endl;
+	ss << "\t\"server\": " << GetStatisticsJson(serverStats, serverNetworkStats) << "," << std::endl;
+	ss << "\t\"client\": " << GetStatisticsJson(clientStats, clientNetworkStats) << "," << std::endl;
+	ss << "\t\"passed\": " << (passed ? "true" : "false") << std::endl;
+	ss << "}" << std::endl;
+	report = ss.str();
+	return passed;
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include "stdafx.h"
+
+class Console;
+struct RollbackStatistics;
+struct NetplayStatistics;
+
+//Runs a rollback netplay session between 2 headless consoles (a server and a client, connected through the loopback interface),
+//each running on its own thread with randomly generated input, and fills report with a JSON report of both consoles' statistics.
+//The test passes when the client's state hashes were compared with the server's and no desync was detected.
+//A percentage of the input messages sent by both consoles can be discarded, to simulate a lossy connection.
+class NetplayTest
+{
+private:
+	static shared_ptr<Console> CreateConsole(string romPath);
+	static void RunConsole(Console* console, uint8_t port, uint32_t seed, uint32_t frameCount, atomic<bool> &timeout);
+	static string GetStatisticsJson(RollbackStatistics &stats, NetplayStatistics &networkStats);
+
+public:
+	//Returns true when the test passed
+	static bool Run(string romPath, uint32_t frameCount, uint16_t port, uint32_t packetLossRate, string &report);
+};
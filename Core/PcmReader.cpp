@@ -2,6 +2,7 @@
 #include "PcmReader.h"
 #include "../Utilities/VirtualFile.h"
 #include "../Utilities/HermiteResampler.h"
+#include "../Utilities/AudioKernels.h"
 
 PcmReader::PcmReader()
 {
@@ -136,9 +137,7 @@ void PcmReader::ApplySamples(int16_t *buffer, size_t sampleCount, uint8_t volume
 	_pcmBuffer.clear();
 
 	uint32_t samplesToProcess = std::min<uint32_t>((uint32_t)sampleCount * 2, (samplesRead + _leftoverSampleCount) * 2);
-	for(uint32_t i = 0; i < samplesToProcess; i++) {
-		buffer[i] += (int16_t)((int32_t)_outputBuffer[i] * volume / 255);
-	}
+	AudioKernels::MixSamples(buffer, _outputBuffer, samplesToProcess, volume, 255);
 
 	//Calculate count of extra samples that couldn't be mixed with the rest of the audio and copy them to the beginning of the buffer
 	//These will be mixed on the next call to ApplySamples
@@ -1,11 +1,13 @@
 #include "stdafx.h"
 #include "Ppu.h"
+#include "PpuColorMath.h"
 #include "Console.h"
 #include "MemoryManager.h"
 #include "Cpu.h"
 #include "Spc.h"
 #include "InternalRegisters.h"
 #include "EmuSettings.h"
+#include "SubsystemProfiler.h"
 #include "ControlManager.h"
 #include "VideoDecoder.h"
 #include "VideoRenderer.h"
@@ -34,17 +36,17 @@ Ppu::Ppu(Console* console)
 
 	_vram = new uint16_t[Ppu::VideoRamSize >> 1];
 
-	_outputBuffers[0] = new uint16_t[512 * 478];
-	_outputBuffers[1] = new uint16_t[512 * 478];
-	memset(_outputBuffers[0], 0, 512 * 478 * sizeof(uint16_t));
-	memset(_outputBuffers[1], 0, 512 * 478 * sizeof(uint16_t));
+	_outputBuffers[0].resize(512 * 478, 0);
+	_outputBuffers[1].resize(512 * 478, 0);
+
+#if _DEBUG
+	PpuColorMath::RunTests();
+#endif
 }
 
 Ppu::~Ppu()
 {
 	delete[] _vram;
-	delete[] _outputBuffers[0];
-	delete[] _outputBuffers[1];
 }
 
 void Ppu::PowerOn()
@@ -54,17 +56,22 @@ void Ppu::PowerOn()
 	_settings = _console->GetSettings().get();
 	_spc = _console->GetSpc().get();
 	_memoryManager = _console->GetMemoryManager().get();
+	_profiler = _console->GetSubsystemProfiler().get();
 
-	_currentBuffer = _outputBuffers[0];
+	_outputBufferIndex = 0;
+	_currentBuffer = _outputBuffers[0].data();
+	_previousBuffer = _outputBuffers[1].data();
 	
 	_state = {};
 	_state.ForcedVblank = true;
 	_state.VramIncrementValue = 1;
+	_windowMaskDirty = true;
 	if(_settings->GetEmulationConfig().EnableRandomPowerOnState) {
 		RandomizeState();
 	}
 
 	_settings->InitializeRam(_vram, Ppu::VideoRamSize);
+	_tileCache.InvalidateAll();
 	_settings->InitializeRam(_cgram, Ppu::CgRamSize);
 	_settings->InitializeRam(_oamRam, Ppu::SpriteRamSize);
 
@@ -237,6 +244,7 @@ void Ppu::GetChrData(uint8_t layerIndex, uint8_t column, uint8_t plane)
 	uint8_t yOffset = vMirror ? (7 - baseYOffset) : baseYOffset;
 	uint16_t pixelStart = tileStart + yOffset + (plane << 3);
 	tileData.ChrData[plane + (secondTile ? bpp / 2 : 0)] = _vram[pixelStart & 0x7FFF];
+	tileData.ChrAddress[secondTile ? 1 : 0] = (tileStart + yOffset) & 0x7FFF;
 }
 
 void Ppu::GetHorizontalOffsetByte(uint8_t columnIndex)
@@ -391,11 +399,18 @@ bool Ppu::ProcessEndOfScanline(uint16_t hClock)
 				//Update overclock timings once per frame
 				UpdateNmiScanline();
 
+				if(!_skipRender && !_interlacedFrame) {
+					_previousBuffer = _currentBuffer;
+					_outputBufferIndex ^= 1;
+					_currentBuffer = _outputBuffers[_outputBufferIndex].data();
+				} else if(_currentBuffer != _outputBuffers[_outputBufferIndex].data()) {
+					//Interlaced frames draw over the previous frame, and skipped frames send it again - take back a copy
+					//of the frame that was handed over to the video decoder
+					memcpy(_outputBuffers[_outputBufferIndex].data(), _currentBuffer, 512 * 478 * sizeof(uint16_t));
+					_currentBuffer = _outputBuffers[_outputBufferIndex].data();
+				}
+
 				if(!_skipRender) {
-					if(!_interlacedFrame) {
-						_currentBuffer = _currentBuffer == _outputBuffers[0] ? _outputBuffers[1] : _outputBuffers[0];
-					}
-					
 					//If we're not skipping this frame, reset the high resolution/interlace flags
 					_useHighResOutput = IsDoubleWidth() || _state.ScreenInterlace;
 					_interlacedFrame = _state.ScreenInterlace;
@@ -726,6 +741,9 @@ void Ppu::FetchSpriteTile(bool secondCycle)
 	if(!secondCycle) {
 		_currentSprite.FetchAddress = (_currentSprite.FetchAddress + 8) & 0x7FFF;
 	} else {
+		uint8_t pixelBuffer[8];
+		const uint8_t* pixels = GetTileRowPixels<4>(_currentSprite.ChrData, (_currentSprite.FetchAddress - 8) & 0x7FFF, pixelBuffer);
+
 		int16_t xPos = _currentSprite.DrawX;
 		for(int x = 0; x < 8; x++) {
 			if(xPos + x < 0 || xPos + x > 255) {
@@ -733,7 +751,7 @@ void Ppu::FetchSpriteTile(bool secondCycle)
 			}
 
 			uint8_t xOffset = _currentSprite.HorizontalMirror ? ((7 - x) & 0x07) : x;
-			uint8_t color = GetTilePixelColor<4>(_currentSprite.ChrData, 7 - xOffset);
+			uint8_t color = pixels[xOffset];
 
 			if(color != 0) {
 				_spriteColorsCopy[xPos + x] = color;
@@ -826,6 +844,8 @@ void Ppu::RenderMode7()
 
 void Ppu::RenderScanline()
 {
+	SubsystemScope scope(_profiler, HostSubsystem::Ppu);
+
 	int32_t hPos = GetCycle();
 
 	if(hPos <= 255 || _spriteEvalEnd < 255) {
@@ -849,6 +869,10 @@ void Ppu::RenderScanline()
 	if(!_skipRender && _drawStartX <= 255 && hPos > 22 && _scanline > 0) {
 		_drawEndX = std::min(hPos - 22, 255);
 
+		if(_windowMaskDirty) {
+			UpdateWindowMasks();
+		}
+
 		if(_state.ForcedVblank) {
 			//Forced blank, output black
 			memset(_mainScreenBuffer + _drawStartX, 0, (_drawEndX - _drawStartX + 1) * 2);
@@ -908,25 +932,19 @@ void Ppu::RenderSprites(const uint8_t priority[4])
 	bool drawMain = (bool)(((_state.MainScreenLayers & _configVisibleLayers) >> Ppu::SpriteLayerIndex) & 0x01);
 	bool drawSub = (bool)(((_state.SubScreenLayers & _configVisibleLayers) >> Ppu::SpriteLayerIndex) & 0x01);
 
-	uint8_t mainWindowCount = 0;
-	uint8_t subWindowCount = 0;
-	if(_state.WindowMaskMain[Ppu::SpriteLayerIndex]) {
-		mainWindowCount = (uint8_t)_state.Window[0].ActiveLayers[Ppu::SpriteLayerIndex] + (uint8_t)_state.Window[1].ActiveLayers[Ppu::SpriteLayerIndex];
-	}
-	if(_state.WindowMaskSub[Ppu::SpriteLayerIndex]) {
-		subWindowCount = (uint8_t)_state.Window[0].ActiveLayers[Ppu::SpriteLayerIndex] + (uint8_t)_state.Window[1].ActiveLayers[Ppu::SpriteLayerIndex];
-	}
+	const uint8_t* mainWindowMask = GetWindowMask(Ppu::SpriteLayerIndex, _state.WindowMaskMain[Ppu::SpriteLayerIndex]);
+	const uint8_t* subWindowMask = GetWindowMask(Ppu::SpriteLayerIndex, _state.WindowMaskSub[Ppu::SpriteLayerIndex]);
 
 	for(int x = _drawStartX; x <= _drawEndX; x++) {
 		if(_spritePriority[x] <= 3) {
 			uint8_t spritePrio = priority[_spritePriority[x]];
-			if(drawMain && ((_mainScreenFlags[x] & 0x0F) < spritePrio) && !ProcessMaskWindow<Ppu::SpriteLayerIndex>(mainWindowCount, x)) {
+			if(drawMain && ((_mainScreenFlags[x] & 0x0F) < spritePrio) && !mainWindowMask[x]) {
 				uint16_t paletteRamOffset = 128 + (_spritePalette[x] << 4) + _spriteColors[x];
 				_mainScreenBuffer[x] = _cgram[paletteRamOffset];
 				_mainScreenFlags[x] = spritePrio | (((_state.ColorMathEnabled & 0x10) && _spritePalette[x] > 3) ? PixelFlags::AllowColorMath : 0);
 			}
 
-			if(drawSub && (_subScreenPriority[x] < spritePrio) && !ProcessMaskWindow<Ppu::SpriteLayerIndex>(subWindowCount, x)) {
+			if(drawSub && (_subScreenPriority[x] < spritePrio) && !subWindowMask[x]) {
 				uint16_t paletteRamOffset = 128 + (_spritePalette[x] << 4) + _spriteColors[x];
 				_subScreenBuffer[x] = _cgram[paletteRamOffset];
 				_subScreenPriority[x] = spritePrio;
@@ -941,8 +959,8 @@ void Ppu::RenderTilemap()
 	bool drawMain = (bool)(((_state.MainScreenLayers & _configVisibleLayers) >> layerIndex) & 0x01);
 	bool drawSub = (bool)(((_state.SubScreenLayers & _configVisibleLayers) >> layerIndex) & 0x01);
 
-	uint8_t mainWindowCount = _state.WindowMaskMain[layerIndex] ? (uint8_t)_state.Window[0].ActiveLayers[layerIndex] + (uint8_t)_state.Window[1].ActiveLayers[layerIndex] : 0;
-	uint8_t subWindowCount = _state.WindowMaskSub[layerIndex] ? (uint8_t)_state.Window[0].ActiveLayers[layerIndex] + (uint8_t)_state.Window[1].ActiveLayers[layerIndex] : 0;
+	const uint8_t* mainWindowMask = GetWindowMask(layerIndex, _state.WindowMaskMain[layerIndex]);
+	const uint8_t* subWindowMask = GetWindowMask(layerIndex, _state.WindowMaskSub[layerIndex]);
 
 	uint16_t hScrollOriginal = _state.Layers[layerIndex].HScroll;
 	uint16_t hScroll = hiResMode ? (hScrollOriginal << 1) : hScrollOriginal;
@@ -952,36 +970,45 @@ void Ppu::RenderTilemap()
 	uint8_t mosaicCounter = applyMosaic ? (_drawStartX % _state.MosaicSize) : 0;
 
 	uint8_t lookupIndex;
-	uint8_t chrDataOffset;
 	uint8_t hiresSubColor;
 	uint8_t pixelFlags = (((_state.ColorMathEnabled >> layerIndex) & 0x01) ? PixelFlags::AllowColorMath : 0);
 
+	//Pixels for the current tile - only need to be looked up once per tile
+	int16_t currentTile = -1;
+	const uint8_t* tilePixels = nullptr;
+	uint8_t tilePixelBuffer[8];
+
 	for(int x = _drawStartX; x <= _drawEndX; x++) {
+		uint8_t tileHalf = 0;
 		if(hiResMode) {
 			lookupIndex = (x + (hScrollOriginal & 0x07)) >> 2;
-			chrDataOffset = (lookupIndex & 0x01) * bpp / 2;
+			tileHalf = lookupIndex & 0x01;
+			if(currentTile != lookupIndex) {
+				currentTile = lookupIndex;
+				tilePixels = GetTileRowPixels<bpp>(tileData[lookupIndex >> 1].ChrData + tileHalf * bpp / 2, tileData[lookupIndex >> 1].ChrAddress[tileHalf], tilePixelBuffer);
+			}
 			lookupIndex >>= 1;
 		} else {
 			lookupIndex = (x + (hScrollOriginal & 0x07)) >> 3;
+			if(currentTile != lookupIndex) {
+				currentTile = lookupIndex;
+				tilePixels = GetTileRowPixels<bpp>(tileData[lookupIndex].ChrData, tileData[lookupIndex].ChrAddress[0], tilePixelBuffer);
+			}
 		}
 
 		uint16_t tilemapData = tileData[lookupIndex].TilemapData;
-		uint16_t* chrData = tileData[lookupIndex].ChrData;
 		bool hMirror = (tilemapData & 0x4000) != 0;
 
 		uint8_t color;
 		if(hiResMode) {
 			uint8_t xOffset = ((x << 1) + 1 + hScroll) & 0x07;
-			uint8_t shift = hMirror ? xOffset : (7 - xOffset);
-			color = GetTilePixelColor<bpp>(chrData + chrDataOffset, shift);
+			color = tilePixels[hMirror ? (7 - xOffset) : xOffset];
 			
 			xOffset = ((x << 1) + hScroll) & 0x07;
-			shift = hMirror ? xOffset : (7 - xOffset);
-			hiresSubColor = GetTilePixelColor<bpp>(chrData + chrDataOffset, shift);
+			hiresSubColor = tilePixels[hMirror ? (7 - xOffset) : xOffset];
 		} else {
 			uint8_t xOffset = (x + hScroll) & 0x07;
-			uint8_t shift = hMirror ? xOffset : (7 - xOffset);
-			color = GetTilePixelColor<bpp>(chrData, shift);
+			color = tilePixels[hMirror ? (7 - xOffset) : xOffset];
 		}
 
 		uint8_t paletteIndex = (tilemapData >> 10) & 0x07;
@@ -1011,16 +1038,16 @@ void Ppu::RenderTilemap()
 
 		if(color > 0) {
 			uint16_t rgbColor = GetRgbColor<bpp, directColorMode, basePaletteOffset>(paletteIndex, color);
-			if(drawMain && (_mainScreenFlags[x] & 0x0F) < priority && !ProcessMaskWindow<layerIndex>(mainWindowCount, x)) {
+			if(drawMain && (_mainScreenFlags[x] & 0x0F) < priority && !mainWindowMask[x]) {
 				DrawMainPixel(x, rgbColor, priority | pixelFlags);
 			}
-			if(!hiResMode && drawSub && _subScreenPriority[x] < priority && !ProcessMaskWindow<layerIndex>(subWindowCount, x)) {
+			if(!hiResMode && drawSub && _subScreenPriority[x] < priority && !subWindowMask[x]) {
 				DrawSubPixel(x, rgbColor, priority);
 			}
 		}
 
 		if(hiResMode) {
-			if(hiresSubColor > 0 && drawSub && _subScreenPriority[x] < priority && !ProcessMaskWindow<layerIndex>(subWindowCount, x)) {
+			if(hiresSubColor > 0 && drawSub && _subScreenPriority[x] < priority && !subWindowMask[x]) {
 				uint16_t hiresSubRgbColor = GetRgbColor<bpp, directColorMode, basePaletteOffset>(paletteIndex, hiresSubColor);
 				DrawSubPixel(x, hiresSubRgbColor, priority);
 			}
@@ -1058,37 +1085,29 @@ bool Ppu::IsRenderRequired(uint8_t layerIndex)
 }
 
 template<uint8_t bpp>
-uint8_t Ppu::GetTilePixelColor(const uint16_t chrData[4], const uint8_t shift)
-{
-	uint8_t color;
-	if(bpp == 2) {
-		color = (chrData[0] >> shift) & 0x01;
-		color |= (chrData[0] >> (7 + shift)) & 0x02;
-	} else if(bpp == 4) {
-		color = (chrData[0] >> shift) & 0x01;
-		color |= (chrData[0] >> (7 + shift)) & 0x02;
-		color |= ((chrData[1] >> shift) & 0x01) << 2;
-		color |= ((chrData[1] >> (7 + shift)) & 0x02) << 2;
-	} else if(bpp == 8) {
-		color = (chrData[0] >> shift) & 0x01;
-		color |= (chrData[0] >> (7 + shift)) & 0x02;
-		color |= ((chrData[1] >> shift) & 0x01) << 2;
-		color |= ((chrData[1] >> (7 + shift)) & 0x02) << 2;
-		color |= ((chrData[2] >> shift) & 0x01) << 4;
-		color |= ((chrData[2] >> (7 + shift)) & 0x02) << 4;
-		color |= ((chrData[3] >> shift) & 0x01) << 6;
-		color |= ((chrData[3] >> (7 + shift)) & 0x02) << 6;
+const uint8_t* Ppu::GetTileRowPixels(const uint16_t* chrData, uint16_t rowAddress, uint8_t* buffer)
+{
+	//The cached tile can only be used if the data that was fetched for the tile still matches VRAM
+	//(VRAM can be written to during forced blank after the fetch) and the address is aligned on a tile row
+	//for this bpp (the address may have been fetched for a different BG mode, if the mode was changed mid-scanline)
+	bool useCache = _tileCache.IsEnabled() && (rowAddress & (bpp * 4 - 8)) == 0;
+	for(int i = 0; useCache && i < bpp / 2; i++) {
+		useCache = chrData[i] == _vram[(rowAddress + (i << 3)) & 0x7FFF];
+	}
+
+	if(useCache) {
+		return _tileCache.GetTileRow<bpp>(_vram, rowAddress);
 	} else {
-		throw std::runtime_error("unsupported bpp");
+		PpuTileCache::DecodeRow<bpp>(chrData, buffer);
+		return buffer;
 	}
-	return color;
 }
 
 template<uint8_t layerIndex, uint8_t normalPriority, uint8_t highPriority, bool applyMosaic, bool directColorMode>
 void Ppu::RenderTilemapMode7()
 {
-	uint8_t mainWindowCount = _state.WindowMaskMain[layerIndex] ? (uint8_t)_state.Window[0].ActiveLayers[layerIndex] + (uint8_t)_state.Window[1].ActiveLayers[layerIndex] : 0;
-	uint8_t subWindowCount = _state.WindowMaskSub[layerIndex] ? (uint8_t)_state.Window[0].ActiveLayers[layerIndex] + (uint8_t)_state.Window[1].ActiveLayers[layerIndex] : 0;
+	const uint8_t* mainWindowMask = GetWindowMask(layerIndex, _state.WindowMaskMain[layerIndex]);
+	const uint8_t* subWindowMask = GetWindowMask(layerIndex, _state.WindowMaskSub[layerIndex]);
 	
 	bool drawMain = (bool)(((_state.MainScreenLayers & _configVisibleLayers) >> layerIndex) & 0x01);
 	bool drawSub = (bool)(((_state.SubScreenLayers & _configVisibleLayers) >> layerIndex) & 0x01);
@@ -1200,11 +1219,11 @@ void Ppu::RenderTilemapMode7()
 				paletteColor = _cgram[colorIndex];
 			}
 			
-			if(drawMain && (_mainScreenFlags[x] & 0x0F) < priority && !ProcessMaskWindow<layerIndex>(mainWindowCount, x)) {
+			if(drawMain && (_mainScreenFlags[x] & 0x0F) < priority && !mainWindowMask[x]) {
 				DrawMainPixel(x, paletteColor, priority | pixelFlags);
 			} 
 
-			if(drawSub && _subScreenPriority[x] < priority && !ProcessMaskWindow<layerIndex>(subWindowCount, x)) {
+			if(drawSub && _subScreenPriority[x] < priority && !subWindowMask[x]) {
 				DrawSubPixel(x, paletteColor, priority);
 			}
 		}
@@ -1225,107 +1244,33 @@ void Ppu::DrawSubPixel(uint8_t x, uint16_t color, uint8_t priority)
 
 void Ppu::ApplyColorMath()
 {
-	uint8_t activeWindowCount = (uint8_t)_state.Window[0].ActiveLayers[Ppu::ColorWindowIndex] + (uint8_t)_state.Window[1].ActiveLayers[Ppu::ColorWindowIndex];
-	bool hiResMode = _state.HiResMode || _state.BgMode == 5 || _state.BgMode == 6;
-
-	if(hiResMode) {
-		for(int x = _drawStartX; x <= _drawEndX; x++) {
-			bool isInsideWindow = ProcessMaskWindow<Ppu::ColorWindowIndex>(activeWindowCount, x);
-
-			//Keep original subscreen color, which is used to apply color math to the main screen after
-			uint16_t subPixel = _subScreenBuffer[x];
-			//Apply the color math based on the previous main pixel
-			uint16_t prevMainPixel = x > 0 ? _mainScreenBuffer[x - 1] : 0;
-			int prevX = x > 0 ? x - 1 : 0;
-			ApplyColorMathToPixel(_subScreenBuffer[x], prevMainPixel, prevX, isInsideWindow);
-
-			ApplyColorMathToPixel(_mainScreenBuffer[x], subPixel, x, isInsideWindow);
-		}
-	} else {
-		for(int x = _drawStartX; x <= _drawEndX; x++) {
-			bool isInsideWindow = ProcessMaskWindow<Ppu::ColorWindowIndex>(activeWindowCount, x);
-			ApplyColorMathToPixel(_mainScreenBuffer[x], _subScreenBuffer[x], x, isInsideWindow);
-		}
-	}
-}
-
-void Ppu::ApplyColorMathToPixel(uint16_t &pixelA, uint16_t pixelB, int x, bool isInsideWindow)
-{
-	uint8_t halfShift = (uint8_t)_state.ColorMathHalveResult;
-
-	//Set color to black as needed based on clip mode
-	switch(_state.ColorMathClipMode) {
-		default:
-		case ColorWindowMode::Never: break;
-
-		case ColorWindowMode::OutsideWindow:
-			if(!isInsideWindow) {
-				pixelA = 0;
-				halfShift = 0;
-			}
-			break;
+	ColorMathSettings cfg;
+	cfg.ClipMode = _state.ColorMathClipMode;
+	cfg.PreventMode = _state.ColorMathPreventMode;
+	cfg.AddSubscreen = _state.ColorMathAddSubscreen;
+	cfg.SubtractMode = _state.ColorMathSubstractMode;
+	cfg.HalveResult = _state.ColorMathHalveResult;
+	cfg.FixedColor = _state.FixedColor;
 
-		case ColorWindowMode::InsideWindow:
-			if(isInsideWindow) {
-				pixelA = 0;
-				halfShift = 0;
-			}
-			break;
+	const uint8_t* windowMask = _windowMask[Ppu::ColorWindowIndex];
 
-		case ColorWindowMode::Always: pixelA = 0; break;
-	}
 
-	if(!(_mainScreenFlags[x] & PixelFlags::AllowColorMath)) {
-		//Color math doesn't apply to this pixel
-		return;
-	}
-
-	//Prevent color math as needed based on mode
-	switch(_state.ColorMathPreventMode) {
-		default:
-		case ColorWindowMode::Never: break;
+	//Main screen: color math is applied using the subscreen's pixels
+	int x = _drawStartX;
+	PpuColorMath::ApplyColorMath(cfg, _mainScreenBuffer + x, _subScreenBuffer + x, _mainScreenFlags + x, _subScreenPriority + x, windowMask + x, _drawEndX - x + 1);
 
-		case ColorWindowMode::OutsideWindow:
-			if(!isInsideWindow) {
-				return;
-			}
-			break;
-
-		case ColorWindowMode::InsideWindow:
-			if(isInsideWindow) {
-				return;
-			}
-			break;
-
-		case ColorWindowMode::Always: return;
-	}
-
-	uint16_t otherPixel;
-	if(_state.ColorMathAddSubscreen) {
-		if(_subScreenPriority[x] > 0) {
-			otherPixel = pixelB;
-		} else {
-			//there's nothing in the subscreen at this pixel, use the fixed color and disable halve operation
-			otherPixel = _state.FixedColor;
-			halfShift = 0;
+	bool hiResMode = _state.HiResMode || _state.BgMode == 5 || _state.BgMode == 6;
+	if(hiResMode) {
+		//Subscreen: color math is applied based on the previous main pixel (after color math was applied to it)
+		//This uses the original subscreen colors that were used on the main screen above
+		if(x == 0) {
+			uint16_t prevMainPixel = 0;
+			PpuColorMath::ApplyColorMath(cfg, _subScreenBuffer, &prevMainPixel, _mainScreenFlags, _subScreenPriority, windowMask, 1);
+			x++;
+		}
+		if(x <= _drawEndX) {
+			PpuColorMath::ApplyColorMath(cfg, _subScreenBuffer + x, _mainScreenBuffer + x - 1, _mainScreenFlags + x - 1, _subScreenPriority + x - 1, windowMask + x, _drawEndX - x + 1);
 		}
-	} else {
-		otherPixel = _state.FixedColor;
-	}
-
-	constexpr unsigned int mask = 0x1F;
-	if(_state.ColorMathSubstractMode) {
-		uint16_t r = std::max((int)((pixelA & mask) - (otherPixel & mask)), 0) >> halfShift;
-		uint16_t g = std::max((int)(((pixelA >> 5U) & mask) - ((otherPixel >> 5U) & mask)), 0) >> halfShift;
-		uint16_t b = std::max((int)(((pixelA >> 10U) & mask) - ((otherPixel >> 10U) & mask)), 0) >> halfShift;
-
-		pixelA = r | (g << 5U) | (b << 10U);
-	} else {
-		uint16_t r = std::min(((pixelA & mask) + (otherPixel & mask)) >> halfShift, mask);
-		uint16_t g = std::min((((pixelA >> 5U) & mask) + ((otherPixel >> 5U) & mask)) >> halfShift, mask);
-		uint16_t b = std::min((((pixelA >> 10U) & mask) + ((otherPixel >> 10U) & mask)) >> halfShift, mask);
-
-		pixelA = r | (g << 5U) | (b << 10U);
 	}
 }
 
@@ -1333,13 +1278,8 @@ template<bool forMainScreen>
 void Ppu::ApplyBrightness()
 {
 	if(_state.ScreenBrightness != 15) {
-		for(int x = _drawStartX; x <= _drawEndX; x++) {
-			uint16_t &pixel = (forMainScreen ? _mainScreenBuffer : _subScreenBuffer)[x];
-			uint16_t r = (pixel & 0x1F) * _state.ScreenBrightness / 15;
-			uint16_t g = ((pixel >> 5) & 0x1F) * _state.ScreenBrightness / 15;
-			uint16_t b = ((pixel >> 10) & 0x1F) * _state.ScreenBrightness / 15;
-			pixel = r | (g << 5) | (b << 10);
-		}
+		uint16_t *buffer = forMainScreen ? _mainScreenBuffer : _subScreenBuffer;
+		PpuColorMath::ApplyBrightness(buffer + _drawStartX, _drawEndX - _drawStartX + 1, _state.ScreenBrightness);
 	}
 }
 
@@ -1408,26 +1348,48 @@ void Ppu::ApplyHiResMode()
 	}
 }
 
-template<uint8_t layerIndex>
-bool Ppu::ProcessMaskWindow(uint8_t activeWindowCount, int x)
+void Ppu::UpdateWindowMasks()
 {
-	switch(activeWindowCount) {
-		case 1: 
-			if(_state.Window[0].ActiveLayers[layerIndex]) {
-				return _state.Window[0].PixelNeedsMasking<layerIndex>(x);
+	//Build the mask for both windows, and then combine them for each layer based on the layer's settings
+	uint8_t windowMasks[2][256];
+	for(int i = 0; i < 2; i++) {
+		memset(windowMasks[i], 0, sizeof(windowMasks[i]));
+		if(_state.Window[i].Left <= _state.Window[i].Right) {
+			memset(windowMasks[i] + _state.Window[i].Left, 1, _state.Window[i].Right - _state.Window[i].Left + 1);
+		}
+	}
+
+	for(int layer = 0; layer < 6; layer++) {
+		uint8_t* mask = _windowMask[layer];
+		bool active0 = _state.Window[0].ActiveLayers[layer];
+		bool active1 = _state.Window[1].ActiveLayers[layer];
+		uint8_t invert0 = _state.Window[0].InvertedLayers[layer] ? 1 : 0;
+		uint8_t invert1 = _state.Window[1].InvertedLayers[layer] ? 1 : 0;
+
+		if(!active0 && !active1) {
+			memset(mask, 0, 256);
+		} else if(active0 != active1) {
+			uint8_t* windowMask = windowMasks[active0 ? 0 : 1];
+			uint8_t invert = active0 ? invert0 : invert1;
+			for(int x = 0; x < 256; x++) {
+				mask[x] = windowMask[x] ^ invert;
 			}
-			return _state.Window[1].PixelNeedsMasking<layerIndex>(x);
-
-		case 2:
-			switch(_state.MaskLogic[layerIndex]) {
-				default:
-				case WindowMaskLogic::Or: return _state.Window[0].PixelNeedsMasking<layerIndex>(x) | _state.Window[1].PixelNeedsMasking<layerIndex>(x);
-				case WindowMaskLogic::And: return _state.Window[0].PixelNeedsMasking<layerIndex>(x) & _state.Window[1].PixelNeedsMasking<layerIndex>(x);
-				case WindowMaskLogic::Xor: return _state.Window[0].PixelNeedsMasking<layerIndex>(x) ^ _state.Window[1].PixelNeedsMasking<layerIndex>(x);
-				case WindowMaskLogic::Xnor: return !(_state.Window[0].PixelNeedsMasking<layerIndex>(x) ^ _state.Window[1].PixelNeedsMasking<layerIndex>(x));
+		} else {
+			for(int x = 0; x < 256; x++) {
+				uint8_t a = windowMasks[0][x] ^ invert0;
+				uint8_t b = windowMasks[1][x] ^ invert1;
+				switch(_state.MaskLogic[layer]) {
+					default:
+					case WindowMaskLogic::Or: mask[x] = a | b; break;
+					case WindowMaskLogic::And: mask[x] = a & b; break;
+					case WindowMaskLogic::Xor: mask[x] = a ^ b; break;
+					case WindowMaskLogic::Xnor: mask[x] = (a ^ b) ^ 1; break;
+				}
 			}
+		}
 	}
-	return false;
+
+	_windowMaskDirty = false;
 }
 
 void Ppu::ProcessWindowMaskSettings(uint8_t value, uint8_t offset)
@@ -1441,6 +1403,8 @@ void Ppu::ProcessWindowMaskSettings(uint8_t value, uint8_t offset)
 	_state.Window[1].ActiveLayers[1 + offset] = (value & 0x80) != 0;
 	_state.Window[1].InvertedLayers[0 + offset] = (value & 0x04) != 0;
 	_state.Window[1].InvertedLayers[1 + offset] = (value & 0x40) != 0;
+
+	_windowMaskDirty = true;
 }
 
 void Ppu::SendFrame()
@@ -1459,16 +1423,7 @@ void Ppu::SendFrame()
 	_console->GetNotificationManager()->SendNotification(ConsoleNotificationType::PpuFrameDone);
 
 	bool isRewinding = _console->GetRewindManager()->IsRewinding();
-
-#ifdef LIBRETRO
-	_console->GetVideoDecoder()->UpdateFrameSync(_currentBuffer, width, height, _frameCount, isRewinding);
-#else
-	if(isRewinding || _interlacedFrame) {
-		_console->GetVideoDecoder()->UpdateFrameSync(_currentBuffer, width, height, _frameCount, isRewinding);
-	} else {
-		_console->GetVideoDecoder()->UpdateFrame(_currentBuffer, width, height, _frameCount);
-	}
-#endif
+	_console->GetVideoDecoder()->UpdateFrame(_outputBuffers[_outputBufferIndex], width, height, _frameCount, isRewinding);
 
 	if(!_skipRender) {
 		_frameSkipTimer.Reset();
@@ -1488,7 +1443,7 @@ uint16_t* Ppu::GetScreenBuffer()
 
 uint16_t* Ppu::GetPreviousScreenBuffer()
 {
-	return _currentBuffer == _outputBuffers[0] ? _outputBuffers[1] : _outputBuffers[0];
+	return _previousBuffer;
 }
 
 uint8_t* Ppu::GetVideoRam()
@@ -1496,6 +1451,22 @@ uint8_t* Ppu::GetVideoRam()
 	return (uint8_t*)_vram;
 }
 
+void Ppu::InvalidateTileCache()
+{
+	//Needed when VRAM is modified directly (e.g by the debugger)
+	_tileCache.InvalidateAll();
+}
+
+void Ppu::SetTileCacheEnabled(bool enabled)
+{
+	_tileCache.SetEnabled(enabled);
+}
+
+TileCacheStats Ppu::GetTileCacheStats()
+{
+	return _tileCache.GetStats();
+}
+
 uint8_t* Ppu::GetCgRam()
 {
 	return (uint8_t*)_cgram;
@@ -1919,6 +1890,7 @@ void Ppu::Write(uint32_t addr, uint8_t value)
 				//Only write the value if in vblank or forced blank (writes to VRAM outside vblank/forced blank are not allowed)
 				_console->ProcessPpuWrite(GetVramAddress() << 1, value, SnesMemoryType::VideoRam);
 				_vram[GetVramAddress()] = value | (_vram[GetVramAddress()] & 0xFF00);
+				_tileCache.Invalidate(GetVramAddress());
 			}
 
 			//The VRAM address is incremented even outside of vblank/forced blank
@@ -1933,6 +1905,7 @@ void Ppu::Write(uint32_t addr, uint8_t value)
 				//Only write the value if in vblank or forced blank (writes to VRAM outside vblank/forced blank are not allowed)
 				_console->ProcessPpuWrite((GetVramAddress() << 1) + 1, value, SnesMemoryType::VideoRam);
 				_vram[GetVramAddress()] = (value << 8) | (_vram[GetVramAddress()] & 0xFF); 
+				_tileCache.Invalidate(GetVramAddress());
 			}
 			
 			//The VRAM address is incremented even outside of vblank/forced blank
@@ -2006,21 +1979,25 @@ void Ppu::Write(uint32_t addr, uint8_t value)
 		case 0x2126:
 			//WH0 - Window 1 Left Position
 			_state.Window[0].Left = value;
+			_windowMaskDirty = true;
 			break;
 		
 		case 0x2127:
 			//WH1 - Window 1 Right Position
 			_state.Window[0].Right = value;
+			_windowMaskDirty = true;
 			break;
 
 		case 0x2128:
 			//WH2 - Window 2 Left Position
 			_state.Window[1].Left = value;
+			_windowMaskDirty = true;
 			break;
 
 		case 0x2129:
 			//WH3 - Window 2 Right Position
 			_state.Window[1].Right = value;
+			_windowMaskDirty = true;
 			break;
 
 		case 0x212A:
@@ -2029,12 +2006,14 @@ void Ppu::Write(uint32_t addr, uint8_t value)
 			_state.MaskLogic[1] = (WindowMaskLogic)((value >> 2) & 0x03);
 			_state.MaskLogic[2] = (WindowMaskLogic)((value >> 4) & 0x03);
 			_state.MaskLogic[3] = (WindowMaskLogic)((value >> 6) & 0x03);
+			_windowMaskDirty = true;
 			break;
 
 		case 0x212B:
 			//WOBJLOG - Window mask logic for OBJs and Color Window
 			_state.MaskLogic[4] = (WindowMaskLogic)((value >> 0) & 0x03);
 			_state.MaskLogic[5] = (WindowMaskLogic)((value >> 2) & 0x03);
+			_windowMaskDirty = true;
 			break;
 
 		case 0x212C:
@@ -2102,7 +2081,8 @@ void Ppu::Write(uint32_t addr, uint8_t value)
 				_state.ScreenInterlace = interlace;
 				if(_scanline >= _vblankStartScanline && interlace) {
 					//Clear buffer when turning on interlace mode during vblank
-					memset(GetPreviousScreenBuffer(), 0, 512 * 478 * sizeof(uint16_t));
+					//(the buffer the next frame will be drawn into)
+					std::fill(_outputBuffers[_outputBufferIndex ^ 1].begin(), _outputBuffers[_outputBufferIndex ^ 1].end(), 0);
 				}
 			}
 			ConvertToHiRes();
@@ -2153,6 +2133,9 @@ void Ppu::Serialize(Serializer &s)
 	}
 
 	s.StreamArray(_vram, Ppu::VideoRamSize >> 1);
+	if(!s.IsSaving()) {
+		_tileCache.InvalidateAll();
+	}
 	s.StreamArray(_oamRam, Ppu::SpriteRamSize);
 	s.StreamArray(_cgram, Ppu::CgRamSize >> 1);
 	
@@ -2165,6 +2148,8 @@ void Ppu::Serialize(Serializer &s)
 		}
 	}
 	s.Stream(_hOffset, _vOffset, _fetchBgStart, _fetchBgEnd, _fetchSpriteStart, _fetchSpriteEnd);
+
+	_windowMaskDirty = true;
 }
 
 void Ppu::RandomizeState()
@@ -2213,6 +2198,7 @@ void Ppu::RandomizeState()
 	for(int i = 0; i < 6; i++) {
 		_state.MaskLogic[i] = (WindowMaskLogic)_settings->GetRandomValue(3);
 	}
+	_windowMaskDirty = true;
 
 	for(int i = 0; i < 5; i++) {
 		_state.WindowMaskMain[i] = _settings->GetRandomBool();
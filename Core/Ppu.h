@@ -1,6 +1,7 @@
 #pragma once
 #include "stdafx.h"
 #include "PpuTypes.h"
+#include "PpuTileCache.h"
 #include "../Utilities/ISerializable.h"
 #include "../Utilities/Timer.h"
 
@@ -9,6 +10,7 @@ class InternalRegisters;
 class MemoryManager;
 class Spc;
 class EmuSettings;
+class SubsystemProfiler;
 
 class Ppu : public ISerializable
 {
@@ -26,6 +28,7 @@ private:
 	MemoryManager* _memoryManager;
 	Spc* _spc;
 	EmuSettings* _settings;
+	SubsystemProfiler* _profiler;
 
 	//Temporary data used for the tilemap/tile fetching
 	LayerData _layerData[4] = {};
@@ -67,10 +70,15 @@ private:
 	
 	uint16_t *_vram = nullptr;
 	uint16_t _cgram[Ppu::CgRamSize >> 1] = {};
+	PpuTileCache _tileCache;
 	uint8_t _oamRam[Ppu::SpriteRamSize] = {};
 
-	uint16_t *_outputBuffers[2] = {};
+	//The buffer sent to the video decoder is swapped with one of its own (see VideoDecoder::UpdateFrame), so _currentBuffer
+	//and _previousBuffer can point to memory the PPU no longer owns - it only draws into _outputBuffers[_outputBufferIndex]
+	vector<uint16_t> _outputBuffers[2];
+	uint8_t _outputBufferIndex = 0;
 	uint16_t *_currentBuffer = nullptr;
+	uint16_t *_previousBuffer = nullptr;
 	bool _useHighResOutput = false;
 	bool _interlacedFrame = false;
 	bool _overscanFrame = false;
@@ -114,6 +122,12 @@ private:
 	uint8_t _spritePaletteCopy[256] = {};
 	uint8_t _spriteColorsCopy[256] = {};
 
+	//Window masks for each layer (BG1-4, sprites, color window) - 1 when the pixel is masked
+	//Only depends on the window registers, so they are rebuilt when one of them is written to
+	uint8_t _windowMask[6][256] = {};
+	uint8_t _emptyWindowMask[256] = {};
+	bool _windowMaskDirty = true;
+
 	void RenderSprites(const uint8_t priorities[4]);
 
 	template<bool hiResMode>
@@ -155,7 +169,7 @@ private:
 	__forceinline bool IsRenderRequired(uint8_t layerIndex);
 
 	template<uint8_t bpp>
-	__forceinline uint8_t GetTilePixelColor(const uint16_t chrData[4], const uint8_t shift);
+	__forceinline const uint8_t* GetTileRowPixels(const uint16_t* chrData, uint16_t rowAddress, uint8_t* buffer);
 
 	template<uint8_t layerIndex, uint8_t normalPriority, uint8_t highPriority>
 	__forceinline void RenderTilemapMode7();
@@ -170,7 +184,6 @@ private:
 	__forceinline void DrawSubPixel(uint8_t x, uint16_t color, uint8_t priority);
 
 	void ApplyColorMath();
-	void ApplyColorMathToPixel(uint16_t &pixelA, uint16_t pixelB, int x, bool isInsideWindow);
 	
 	template<bool forMainScreen>
 	void ApplyBrightness();
@@ -178,8 +191,8 @@ private:
 	void ConvertToHiRes();
 	void ApplyHiResMode();
 
-	template<uint8_t layerIndex>
-	bool ProcessMaskWindow(uint8_t activeWindowCount, int x);
+	void UpdateWindowMasks();
+	__forceinline const uint8_t* GetWindowMask(uint8_t layerIndex, bool enabled) { return enabled ? _windowMask[layerIndex] : _emptyWindowMask; }
 
 	void ProcessWindowMaskSettings(uint8_t value, uint8_t offset);
 
@@ -234,6 +247,10 @@ public:
 	uint8_t* GetCgRam();
 	uint8_t* GetSpriteRam();
 
+	void InvalidateTileCache();
+	void SetTileCacheEnabled(bool enabled);
+	TileCacheStats GetTileCacheStats();
+
 	void SetLocationLatchRequest(uint16_t x, uint16_t y);
 	void ProcessLocationLatchRequest();
 	void LatchLocationValues();
@@ -0,0 +1,250 @@
+#include "stdafx.h"
+#include "PpuColorMath.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define PPU_COLOR_MATH_SSE2
+	#include <emmintrin.h>
+#endif
+
+static __forceinline bool IsMaskedByWindow(ColorWindowMode mode, bool isInsideWindow)
+{
+	switch(mode) {
+		default:
+		case ColorWindowMode::Never: return false;
+		case ColorWindowMode::OutsideWindow: return !isInsideWindow;
+		case ColorWindowMode::InsideWindow: return isInsideWindow;
+		case ColorWindowMode::Always: return true;
+	}
+}
+
+void PpuColorMath::ApplyColorMathScalar(const ColorMathSettings &cfg, uint16_t *pixelA, const uint16_t *pixelB, const uint8_t *flags, const uint8_t *subPriority, const uint8_t *window, uint32_t count)
+{
+	constexpr unsigned int mask = 0x1F;
+
+	for(uint32_t i = 0; i < count; i++) {
+		bool isInsideWindow = window[i] != 0;
+		uint8_t halfShift = (uint8_t)cfg.HalveResult;
+		uint16_t pixel = pixelA[i];
+
+		//Set color to black as needed based on clip mode
+		if(IsMaskedByWindow(cfg.ClipMode, isInsideWindow)) {
+			pixel = 0;
+			if(cfg.ClipMode != ColorWindowMode::Always) {
+				halfShift = 0;
+			}
+		}
+
+		//Prevent color math as needed based on mode, or if color math doesn't apply to this pixel
+		if(!(flags[i] & PixelFlags::AllowColorMath) || IsMaskedByWindow(cfg.PreventMode, isInsideWindow)) {
+			pixelA[i] = pixel;
+			continue;
+		}
+
+		uint16_t otherPixel;
+		if(cfg.AddSubscreen) {
+			if(subPriority[i] > 0) {
+				otherPixel = pixelB[i];
+			} else {
+				//there's nothing in the subscreen at this pixel, use the fixed color and disable halve operation
+				otherPixel = cfg.FixedColor;
+				halfShift = 0;
+			}
+		} else {
+			otherPixel = cfg.FixedColor;
+		}
+
+		if(cfg.SubtractMode) {
+			uint16_t r = std::max((int)((pixel & mask) - (otherPixel & mask)), 0) >> halfShift;
+			uint16_t g = std::max((int)(((pixel >> 5U) & mask) - ((otherPixel >> 5U) & mask)), 0) >> halfShift;
+			uint16_t b = std::max((int)(((pixel >> 10U) & mask) - ((otherPixel >> 10U) & mask)), 0) >> halfShift;
+
+			pixelA[i] = r | (g << 5U) | (b << 10U);
+		} else {
+			uint16_t r = std::min(((pixel & mask) + (otherPixel & mask)) >> halfShift, mask);
+			uint16_t g = std::min((((pixel >> 5U) & mask) + ((otherPixel >> 5U) & mask)) >> halfShift, mask);
+			uint16_t b = std::min((((pixel >> 10U) & mask) + ((otherPixel >> 10U) & mask)) >> halfShift, mask);
+
+			pixelA[i] = r | (g << 5U) | (b << 10U);
+		}
+	}
+}
+
+void PpuColorMath::ApplyBrightnessScalar(uint16_t *pixels, uint32_t count, uint8_t brightness)
+{
+	for(uint32_t i = 0; i < count; i++) {
+		uint16_t pixel = pixels[i];
+		uint16_t r = (pixel & 0x1F) * brightness / 15;
+		uint16_t g = ((pixel >> 5) & 0x1F) * brightness / 15;
+		uint16_t b = ((pixel >> 10) & 0x1F) * brightness / 15;
+		pixels[i] = r | (g << 5) | (b << 10);
+	}
+}
+
+#ifdef PPU_COLOR_MATH_SSE2
+static __forceinline __m128i GetWindowMask(ColorWindowMode mode, __m128i insideWindow)
+{
+	switch(mode) {
+		default:
+		case ColorWindowMode::Never: return _mm_setzero_si128();
+		case ColorWindowMode::OutsideWindow: return _mm_xor_si128(insideWindow, _mm_set1_epi16(-1));
+		case ColorWindowMode::InsideWindow: return insideWindow;
+		case ColorWindowMode::Always: return _mm_set1_epi16(-1);
+	}
+}
+
+static __forceinline __m128i LoadByteMask(const uint8_t *src, __m128i byteMask)
+{
+	//Loads 8 bytes and expands them to 16-bit lanes that are all 1s when (value & byteMask) != 0
+	__m128i zero = _mm_setzero_si128();
+	__m128i values = _mm_and_si128(_mm_loadl_epi64((const __m128i*)src), byteMask);
+	return _mm_xor_si128(_mm_cmpeq_epi16(_mm_unpacklo_epi8(values, zero), zero), _mm_set1_epi16(-1));
+}
+
+static __forceinline __m128i Select(__m128i mask, __m128i a, __m128i b)
+{
+	//Returns a for lanes where mask is set, b otherwise
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+#endif
+
+void PpuColorMath::ApplyColorMath(const ColorMathSettings &cfg, uint16_t *pixelA, const uint16_t *pixelB, const uint8_t *flags, const uint8_t *subPriority, const uint8_t *window, uint32_t count)
+{
+	if(cfg.ClipMode == ColorWindowMode::Never && cfg.PreventMode == ColorWindowMode::Always) {
+		//Nothing to do
+		return;
+	}
+
+	uint32_t i = 0;
+
+#ifdef PPU_COLOR_MATH_SSE2
+	const __m128i allBits = _mm_set1_epi16(-1);
+	const __m128i channelMask = _mm_set1_epi16(0x1F);
+	const __m128i fixedColor = _mm_set1_epi16((int16_t)cfg.FixedColor);
+	const __m128i halveResult = cfg.HalveResult ? allBits : _mm_setzero_si128();
+	const bool clipDisablesHalve = cfg.ClipMode == ColorWindowMode::OutsideWindow || cfg.ClipMode == ColorWindowMode::InsideWindow;
+
+	for(; i + 8 <= count; i += 8) {
+		__m128i insideWindow = LoadByteMask(window + i, _mm_set1_epi8((char)0xFF));
+		__m128i allowMath = LoadByteMask(flags + i, _mm_set1_epi8((char)PixelFlags::AllowColorMath));
+
+		//Set color to black as needed based on clip mode
+		__m128i clip = GetWindowMask(cfg.ClipMode, insideWindow);
+		__m128i pixel = _mm_andnot_si128(clip, _mm_loadu_si128((const __m128i*)(pixelA + i)));
+		__m128i halve = clipDisablesHalve ? _mm_andnot_si128(clip, halveResult) : halveResult;
+
+		//Color math only applies to pixels that allow it and aren't prevented by the window
+		__m128i applyMath = _mm_andnot_si128(GetWindowMask(cfg.PreventMode, insideWindow), allowMath);
+
+		__m128i otherPixel;
+		if(cfg.AddSubscreen) {
+			//Use the fixed color (and disable halve operation) when there's nothing in the subscreen
+			__m128i hasSubPixel = LoadByteMask(subPriority + i, _mm_set1_epi8((char)0xFF));
+			otherPixel = Select(hasSubPixel, _mm_loadu_si128((const __m128i*)(pixelB + i)), fixedColor);
+			halve = _mm_and_si128(halve, hasSubPixel);
+		} else {
+			otherPixel = fixedColor;
+		}
+
+		__m128i result = _mm_setzero_si128();
+		for(int shift = 0; shift <= 10; shift += 5) {
+			__m128i a = _mm_and_si128(_mm_srli_epi16(pixel, shift), channelMask);
+			__m128i b = _mm_and_si128(_mm_srli_epi16(otherPixel, shift), channelMask);
+			__m128i channel;
+			if(cfg.SubtractMode) {
+				channel = _mm_subs_epu16(a, b);
+				channel = Select(halve, _mm_srli_epi16(channel, 1), channel);
+			} else {
+				channel = _mm_add_epi16(a, b);
+				channel = _mm_min_epi16(Select(halve, _mm_srli_epi16(channel, 1), channel), channelMask);
+			}
+			result = _mm_or_si128(result, _mm_slli_epi16(channel, shift));
+		}
+
+		_mm_storeu_si128((__m128i*)(pixelA + i), Select(applyMath, result, pixel));
+	}
+#endif
+
+	if(i < count) {
+		ApplyColorMathScalar(cfg, pixelA + i, pixelB + i, flags + i, subPriority + i, window + i, count - i);
+	}
+}
+
+void PpuColorMath::ApplyBrightness(uint16_t *pixels, uint32_t count, uint8_t brightness)
+{
+	uint32_t i = 0;
+
+#ifdef PPU_COLOR_MATH_SSE2
+	const __m128i channelMask = _mm_set1_epi16(0x1F);
+	const __m128i factor = _mm_set1_epi16(brightness);
+	//(value * 4370) >> 16 == value / 15 for all values in the 0-465 range (31*15)
+	const __m128i divideBy15 = _mm_set1_epi16(4370);
+
+	for(; i + 8 <= count; i += 8) {
+		__m128i pixel = _mm_loadu_si128((const __m128i*)(pixels + i));
+		__m128i result = _mm_setzero_si128();
+		for(int shift = 0; shift <= 10; shift += 5) {
+			__m128i channel = _mm_mullo_epi16(_mm_and_si128(_mm_srli_epi16(pixel, shift), channelMask), factor);
+			channel = _mm_mulhi_epu16(channel, divideBy15);
+			result = _mm_or_si128(result, _mm_slli_epi16(channel, shift));
+		}
+		_mm_storeu_si128((__m128i*)(pixels + i), result);
+	}
+#endif
+
+	if(i < count) {
+		ApplyBrightnessScalar(pixels + i, count - i, brightness);
+	}
+}
+
+#if _DEBUG
+#include <assert.h>
+void PpuColorMath::RunTests()
+{
+	//Compares the vectorized code against the scalar implementation (run in debug mode)
+	uint32_t seed = 0x12345678;
+	auto random = [&seed]() {
+		seed = seed * 1103515245 + 12345;
+		return (seed >> 8) & 0xFFFF;
+	};
+
+	uint16_t pixelA[256];
+	uint16_t pixelB[256];
+	uint8_t flags[256];
+	uint8_t subPriority[256];
+	uint8_t window[256];
+	uint16_t expected[256];
+
+	for(int test = 0; test < 2000; test++) {
+		ColorMathSettings cfg;
+		cfg.ClipMode = (ColorWindowMode)(test & 0x03);
+		cfg.PreventMode = (ColorWindowMode)((test >> 2) & 0x03);
+		cfg.AddSubscreen = (test & 0x10) != 0;
+		cfg.SubtractMode = (test & 0x20) != 0;
+		cfg.HalveResult = (test & 0x40) != 0;
+		cfg.FixedColor = random() & 0x7FFF;
+
+		for(int i = 0; i < 256; i++) {
+			pixelA[i] = random() & 0x7FFF;
+			pixelB[i] = random() & 0x7FFF;
+			flags[i] = (random() & 0x01) ? (PixelFlags::AllowColorMath | (random() & 0x0F)) : (random() & 0x0F);
+			subPriority[i] = (random() & 0x03) ? (random() & 0x7F) : 0;
+			window[i] = random() & 0x01;
+		}
+
+		uint32_t start = random() & 0xFF;
+		uint32_t count = 256 - start;
+
+		memcpy(expected, pixelA, sizeof(pixelA));
+		if(cfg.ClipMode != ColorWindowMode::Never || cfg.PreventMode != ColorWindowMode::Always) {
+			ApplyColorMathScalar(cfg, expected + start, pixelB + start, flags + start, subPriority + start, window + start, count);
+		}
+		ApplyColorMath(cfg, pixelA + start, pixelB + start, flags + start, subPriority + start, window + start, count);
+		assert(memcmp(expected, pixelA, sizeof(pixelA)) == 0);
+
+		uint8_t brightness = test % 15;
+		ApplyBrightnessScalar(expected + start, count, brightness);
+		ApplyBrightness(pixelA + start, count, brightness);
+		assert(memcmp(expected, pixelA, sizeof(pixelA)) == 0);
+	}
+}
+#endif
@@ -0,0 +1,30 @@
+#pragma once
+#include "stdafx.h"
+#include "PpuTypes.h"
+
+struct ColorMathSettings
+{
+	ColorWindowMode ClipMode;
+	ColorWindowMode PreventMode;
+	bool AddSubscreen;
+	bool SubtractMode;
+	bool HalveResult;
+	uint16_t FixedColor;
+};
+
+//Applies color math/brightness to a whole scanline segment at once (SSE2 when available, with a scalar fallback)
+class PpuColorMath
+{
+private:
+	static void ApplyColorMathScalar(const ColorMathSettings &cfg, uint16_t *pixelA, const uint16_t *pixelB, const uint8_t *flags, const uint8_t *subPriority, const uint8_t *window, uint32_t count);
+	static void ApplyBrightnessScalar(uint16_t *pixels, uint32_t count, uint8_t brightness);
+
+public:
+	//For each pixel: pixelA = pixelA (+/-) pixelB (or the fixed color), based on the pixel's flags, subscreen priority and color window mask (0 or 1)
+	static void ApplyColorMath(const ColorMathSettings &cfg, uint16_t *pixelA, const uint16_t *pixelB, const uint8_t *flags, const uint8_t *subPriority, const uint8_t *window, uint32_t count);
+	static void ApplyBrightness(uint16_t *pixels, uint32_t count, uint8_t brightness);
+
+#if _DEBUG
+	static void RunTests();
+#endif
+};
@@ -0,0 +1,38 @@
+#include "stdafx.h"
+#include "PpuTileCache.h"
+
+PpuTileCache::PpuTileCache()
+{
+	_tiles[0] = new uint8_t[TileCount2bpp * 64];
+	_tiles[1] = new uint8_t[TileCount2bpp / 2 * 64];
+	_tiles[2] = new uint8_t[TileCount2bpp / 4 * 64];
+}
+
+PpuTileCache::~PpuTileCache()
+{
+	delete[] _tiles[0];
+	delete[] _tiles[1];
+	delete[] _tiles[2];
+}
+
+void PpuTileCache::InvalidateAll()
+{
+	memset(_valid, 0, sizeof(_valid));
+}
+
+void PpuTileCache::SetEnabled(bool enabled)
+{
+	//VRAM writes still invalidate tiles while the cache is disabled, but start from scratch to be safe
+	InvalidateAll();
+	_enabled = enabled;
+}
+
+TileCacheStats PpuTileCache::GetStats()
+{
+	return _stats;
+}
+
+void PpuTileCache::ResetStats()
+{
+	_stats = {};
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include "stdafx.h"
+
+struct TileCacheStats
+{
+	uint64_t Hits;
+	uint64_t Misses;
+	uint64_t Invalidations;
+};
+
+//Keeps a copy of the VRAM tiles decoded to 8x8 color indexes (for each bpp), so the PPU doesn't need to
+//extract every pixel from the bitplanes on every scanline. Tiles are invalidated as VRAM is written to.
+class PpuTileCache
+{
+private:
+	static constexpr uint32_t VramWordCount = 0x8000;
+	static constexpr uint32_t TileCount2bpp = VramWordCount / 8;
+
+	//Decoded pixels for 2bpp, 4bpp and 8bpp tiles (64 bytes per tile)
+	uint8_t* _tiles[3] = {};
+	uint8_t _valid[3][TileCount2bpp] = {};
+	TileCacheStats _stats = {};
+	bool _enabled = true;
+
+	template<uint8_t bpp>
+	static constexpr int GetBppIndex() { return bpp == 2 ? 0 : (bpp == 4 ? 1 : 2); }
+
+	template<uint8_t bpp>
+	static constexpr int GetTileShift() { return bpp == 2 ? 3 : (bpp == 4 ? 4 : 5); }
+
+	template<uint8_t bpp>
+	void DecodeTile(const uint16_t* vram, uint32_t tileIndex);
+
+public:
+	PpuTileCache();
+	~PpuTileCache();
+
+	//Decodes a single row of a tile (chrData contains the row's word for each pair of bitplanes) - pixels[0] is the leftmost pixel
+	template<uint8_t bpp>
+	static void DecodeRow(const uint16_t* chrData, uint8_t* pixels);
+
+	//Returns the decoded pixels for the tile row that starts at the given VRAM word address (first bitplane pair)
+	template<uint8_t bpp>
+	__forceinline const uint8_t* GetTileRow(const uint16_t* vram, uint16_t rowAddress)
+	{
+		constexpr int index = GetBppIndex<bpp>();
+		uint32_t tileIndex = (rowAddress & 0x7FFF) >> GetTileShift<bpp>();
+		if(_valid[index][tileIndex]) {
+			_stats.Hits++;
+		} else {
+			_stats.Misses++;
+			DecodeTile<bpp>(vram, tileIndex);
+		}
+		return _tiles[index] + (tileIndex << 6) + ((rowAddress & 0x07) << 3);
+	}
+
+	__forceinline void Invalidate(uint16_t wordAddress)
+	{
+		wordAddress &= 0x7FFF;
+		_valid[0][wordAddress >> 3] = 0;
+		_valid[1][wordAddress >> 4] = 0;
+		_valid[2][wordAddress >> 5] = 0;
+		_stats.Invalidations++;
+	}
+
+	void InvalidateAll();
+
+	//When disabled, the PPU decodes every tile row from the bitplanes (used to benchmark the cache)
+	void SetEnabled(bool enabled);
+	bool IsEnabled() { return _enabled; }
+
+	TileCacheStats GetStats();
+	void ResetStats();
+};
+
+template<uint8_t bpp>
+void PpuTileCache::DecodeRow(const uint16_t* chrData, uint8_t* pixels)
+{
+	for(int x = 0; x < 8; x++) {
+		uint8_t shift = 7 - x;
+		uint8_t color = 0;
+		for(int i = 0; i < bpp / 2; i++) {
+			color |= ((chrData[i] >> shift) & 0x01) << (i * 2);
+			color |= ((chrData[i] >> (7 + shift)) & 0x02) << (i * 2);
+		}
+		pixels[x] = color;
+	}
+}
+
+template<uint8_t bpp>
+void PpuTileCache::DecodeTile(const uint16_t* vram, uint32_t tileIndex)
+{
+	constexpr int index = GetBppIndex<bpp>();
+	uint32_t tileStart = tileIndex << GetTileShift<bpp>();
+	uint8_t* pixels = _tiles[index] + (tileIndex << 6);
+
+	for(int y = 0; y < 8; y++) {
+		uint16_t chrData[4];
+		for(int i = 0; i < bpp / 2; i++) {
+			chrData[i] = vram[tileStart + y + (i << 3)];
+		}
+		DecodeRow<bpp>(chrData, pixels + (y << 3));
+	}
+
+	_valid[index][tileIndex] = 1;
+}
@@ -52,6 +52,7 @@ struct TileData
 	uint16_t TilemapData;
 	uint16_t VScroll;
 	uint16_t ChrData[4];
+	uint16_t ChrAddress[2];
 };
 
 struct LayerData
@@ -52,6 +52,17 @@ public:
 		_ram[addr & _mask] = value;
 	}
 
+	uint8_t* GetDirectReadPage() override
+	{
+		//Mirrored pages (smaller than 4kb) can't be accessed directly
+		return _mask == 0xFFF ? _ram : nullptr;
+	}
+
+	uint8_t* GetDirectWritePage() override
+	{
+		return _mask == 0xFFF ? _ram : nullptr;
+	}
+
 	AddressInfo GetAbsoluteAddress(uint32_t address) override
 	{
 		AddressInfo info;
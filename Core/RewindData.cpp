@@ -1,31 +1,159 @@
 #include "stdafx.h"
 #include "RewindData.h"
 #include "Console.h"
-#include "SaveStateManager.h"
+#include "NotificationManager.h"
 #include "../Utilities/miniz.h"
 
-void RewindData::GetStateData(stringstream &stateData)
+void RewindData::LoadState(shared_ptr<Console> &console, RewindStateBuffers &buffers)
 {
-	stateData.write((char*)SaveStateData.data(), SaveStateData.size());
+	if(!_keyframe) {
+		return;
+	}
+
+	if(buffers.LoadedKeyframe != _keyframe) {
+		buffers.LoadedKeyframeState.resize(_keyframe->StateSize);
+		unsigned long size = _keyframe->StateSize;
+		uncompress(buffers.LoadedKeyframeState.data(), &size, _keyframe->CompressedState.data(), (unsigned long)_keyframe->CompressedState.size());
+		buffers.LoadedKeyframe = _keyframe;
+	}
+
+	uint8_t* state = buffers.LoadedKeyframeState.data();
+	if(_deltaCount > 0) {
+		//Apply the modified pages of each block since the keyframe on top of a copy of the keyframe
+		buffers.State.resize(std::max<size_t>(buffers.State.size(), _keyframe->StateSize));
+		memcpy(buffers.State.data(), state, _keyframe->StateSize);
+		state = buffers.State.data();
+
+		for(uint32_t i = 0; i < _deltaCount; i++) {
+			ApplyDelta(_keyframe->Deltas[i], state, buffers);
+		}
+	}
+
+	console->LoadSnapshot(state, _keyframe->StateSize);
+
+	//The emulation is now running from an older state, start the next delta from a new keyframe
+	buffers.Keyframe.reset();
+
+	console->GetNotificationManager()->SendNotification(ConsoleNotificationType::StateLoaded);
 }
 
-void RewindData::LoadState(shared_ptr<Console> &console)
+void RewindData::ApplyDelta(vector<uint8_t> &delta, uint8_t* state, RewindStateBuffers &buffers)
 {
-	if(SaveStateData.size() > 0) {
-		stringstream stream;
-		stream.write((char*)SaveStateData.data(), SaveStateData.size());
-		stream.seekg(0, ios::beg);
+	uint32_t deltaSize;
+	memcpy(&deltaSize, delta.data(), sizeof(uint32_t));
+	buffers.DeltaBuffer.resize(std::max<size_t>(buffers.DeltaBuffer.size(), deltaSize));
+	unsigned long size = deltaSize;
+	uncompress(buffers.DeltaBuffer.data(), &size, delta.data() + sizeof(uint32_t), (unsigned long)delta.size() - sizeof(uint32_t));
 
-		console->Deserialize(stream, SaveStateManager::FileFormatVersion);
+	uint32_t pageCount;
+	memcpy(&pageCount, buffers.DeltaBuffer.data(), sizeof(uint32_t));
+	uint32_t* pages = (uint32_t*)(buffers.DeltaBuffer.data() + sizeof(uint32_t));
+	uint8_t* pageData = (uint8_t*)(pages + pageCount);
+	for(uint32_t i = 0; i < pageCount; i++) {
+		uint32_t offset = pages[i] * PageSize;
+		uint32_t length = std::min(PageSize, _keyframe->StateSize - offset);
+		for(uint32_t j = 0; j < length; j++) {
+			state[offset + j] ^= pageData[j];
+		}
+		pageData += length;
 	}
 }
 
-void RewindData::SaveState(shared_ptr<Console> &console)
+void RewindData::SaveState(shared_ptr<Console> &console, RewindStateBuffers &buffers)
 {
-	std::stringstream state;
-	console->Serialize(state);
-
-	string data = state.str();
-	SaveStateData = vector<uint8_t>(data.c_str(), data.c_str()+data.size());
+	uint32_t stateSize = console->SaveSnapshot(buffers.State);
+	if(!SaveDelta(buffers, stateSize)) {
+		SaveKeyframe(buffers, stateSize);
+	}
 	FrameCount = 0;
 }
+
+bool RewindData::SaveDelta(RewindStateBuffers &buffers, uint32_t stateSize)
+{
+	if(!buffers.Keyframe || buffers.Keyframe->StateSize != stateSize || buffers.Keyframe->Deltas.size() >= RewindData::KeyframeInterval) {
+		return false;
+	}
+
+	//Compare the state with the previous block's state, one page at a time, and keep only the pages that changed
+	uint32_t totalPageCount = (stateSize + PageSize - 1) / PageSize;
+	buffers.DeltaBuffer.resize(std::max<size_t>(buffers.DeltaBuffer.size(), sizeof(uint32_t) * (totalPageCount + 1) + stateSize));
+
+	uint32_t* pages = (uint32_t*)(buffers.DeltaBuffer.data() + sizeof(uint32_t));
+	uint32_t pageCount = 0;
+	for(uint32_t i = 0; i < totalPageCount; i++) {
+		uint32_t offset = i * PageSize;
+		if(memcmp(buffers.State.data() + offset, buffers.PreviousState.data() + offset, std::min(PageSize, stateSize - offset)) != 0) {
+			pages[pageCount++] = i;
+		}
+	}
+
+	if(pageCount > totalPageCount / 2) {
+		//Too much has changed since the previous block, save a new keyframe instead
+		return false;
+	}
+
+	memcpy(buffers.DeltaBuffer.data(), &pageCount, sizeof(uint32_t));
+	uint8_t* pageData = (uint8_t*)(pages + pageCount);
+	for(uint32_t i = 0; i < pageCount; i++) {
+		uint32_t offset = pages[i] * PageSize;
+		uint32_t length = std::min(PageSize, stateSize - offset);
+		for(uint32_t j = 0; j < length; j++) {
+			pageData[j] = buffers.State[offset + j] ^ buffers.PreviousState[offset + j];
+		}
+		pageData += length;
+	}
+
+	uint32_t deltaSize = (uint32_t)(pageData - buffers.DeltaBuffer.data());
+	unsigned long compressedSize = compressBound(deltaSize);
+	vector<uint8_t> delta(sizeof(uint32_t) + compressedSize);
+	memcpy(delta.data(), &deltaSize, sizeof(uint32_t));
+	compress2(delta.data() + sizeof(uint32_t), &compressedSize, buffers.DeltaBuffer.data(), deltaSize, MZ_BEST_SPEED);
+	delta.resize(sizeof(uint32_t) + compressedSize);
+	delta.shrink_to_fit();
+
+	buffers.Keyframe->Deltas.push_back(std::move(delta));
+	buffers.PreviousState.swap(buffers.State);
+
+	_keyframe = buffers.Keyframe;
+	_deltaCount = (uint32_t)_keyframe->Deltas.size();
+	return true;
+}
+
+void RewindData::SaveKeyframe(RewindStateBuffers &buffers, uint32_t stateSize)
+{
+	shared_ptr<RewindKeyframe> keyframe(new RewindKeyframe());
+	keyframe->StateSize = stateSize;
+
+	unsigned long compressedSize = compressBound(stateSize);
+	keyframe->CompressedState.resize(compressedSize);
+	compress2(keyframe->CompressedState.data(), &compressedSize, buffers.State.data(), stateSize, MZ_BEST_SPEED);
+	keyframe->CompressedState.resize(compressedSize);
+	keyframe->CompressedState.shrink_to_fit();
+
+	buffers.PreviousState.swap(buffers.State);
+	buffers.Keyframe = keyframe;
+
+	_keyframe = keyframe;
+	_deltaCount = 0;
+}
+
+bool RewindData::IsKeyframe()
+{
+	return _keyframe && _deltaCount == 0;
+}
+
+uint32_t RewindData::GetMemoryUsage(bool includeKeyframe)
+{
+	if(!_keyframe) {
+		return 0;
+	}
+
+	uint32_t size = 0;
+	if(includeKeyframe || IsKeyframe()) {
+		size += (uint32_t)_keyframe->CompressedState.size();
+	}
+	for(uint32_t i = includeKeyframe ? 0 : _deltaCount - 1; i < _deltaCount; i++) {
+		size += (uint32_t)_keyframe->Deltas[i].size();
+	}
+	return size;
+}
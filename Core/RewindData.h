@@ -5,18 +5,57 @@
 
 class Console;
 
+struct RewindKeyframe
+{
+	vector<uint8_t> CompressedState;
+	uint32_t StateSize;
+
+	//(Compressed) list of the pages that differ from the previous block's state, for each of the blocks that follow the keyframe
+	//The pages are XORed with the previous state, the bytes that didn't change are zeros (most of them, in most pages)
+	vector<vector<uint8_t>> Deltas;
+};
+
+//Buffers shared by all the rewind data of a RewindManager
+//Used to build deltas against the previous block's state, and to rebuild states from a keyframe + deltas
+struct RewindStateBuffers
+{
+	vector<uint8_t> State;
+
+	shared_ptr<RewindKeyframe> Keyframe;
+	vector<uint8_t> PreviousState;
+
+	shared_ptr<RewindKeyframe> LoadedKeyframe;
+	vector<uint8_t> LoadedKeyframeState;
+
+	vector<uint8_t> DeltaBuffer;
+};
+
 class RewindData
 {
 private:
-	vector<uint8_t> SaveStateData;
+	static constexpr uint32_t PageSize = 0x100;
+	static constexpr uint32_t KeyframeInterval = 120; //Max number of deltas after a keyframe (restoring a block applies every delta before it)
+
+	//Every entry points to a keyframe (a full compressed save state)
+	//Entries that aren't keyframes are restored by applying the keyframe's first _deltaCount deltas, in order
+	shared_ptr<RewindKeyframe> _keyframe;
+	uint32_t _deltaCount = 0;
+
+	bool SaveDelta(RewindStateBuffers &buffers, uint32_t stateSize);
+	void SaveKeyframe(RewindStateBuffers &buffers, uint32_t stateSize);
+	void ApplyDelta(vector<uint8_t> &delta, uint8_t* state, RewindStateBuffers &buffers);
 
 public:
 	std::deque<ControlDeviceState> InputLogs[BaseControlDevice::PortCount];
 	int32_t FrameCount = 0;
 	bool EndOfSegment = false;
 
-	void GetStateData(stringstream &stateData);
+	void LoadState(shared_ptr<Console> &console, RewindStateBuffers &buffers);
+	void SaveState(shared_ptr<Console> &console, RewindStateBuffers &buffers);
+
+	bool IsKeyframe();
 
-	void LoadState(shared_ptr<Console> &console);
-	void SaveState(shared_ptr<Console> &console);
+	//Size of the compressed data saved by this block (its keyframe or its delta)
+	//includeKeyframe also includes the keyframe & the deltas of the previous blocks, which the oldest block still needs after they are removed from the history
+	uint32_t GetMemoryUsage(bool includeKeyframe);
 };
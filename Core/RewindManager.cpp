@@ -15,6 +15,9 @@ RewindManager::RewindManager(shared_ptr<Console> console)
 	_rewindState = RewindState::Stopped;
 	_framesToFastForward = 0;
 	_hasHistory = false;
+	_historyKeyframeCount = 0;
+	_historyMemoryUsage = 0;
+	_historyBlockCount = 0;
 	AddHistoryBlock();
 
 	_console->GetControlManager()->RegisterInputProvider(this);
@@ -34,12 +37,13 @@ void RewindManager::ClearBuffer()
 	_historyBackup.clear();
 	_currentHistory = RewindData();
 	_framesToFastForward = 0;
-	_videoHistory.clear();
-	_videoHistoryBuilder.clear();
+	_videoBuffer.Clear();
 	_audioHistory.clear();
 	_audioHistoryBuilder.clear();
 	_rewindState = RewindState::Stopped;
 	_currentHistory = RewindData();
+	_stateBuffers = RewindStateBuffers();
+	UpdateHistoryStatistics();
 }
 
 void RewindManager::ProcessNotification(ConsoleNotificationType type, void * parameter)
@@ -103,10 +107,28 @@ void RewindManager::AddHistoryBlock()
 			_history.push_back(_currentHistory);
 		}
 		_currentHistory = RewindData();
-		_currentHistory.SaveState(_console);
+		_currentHistory.SaveState(_console, _stateBuffers);
+		UpdateHistoryStatistics();
 	}
 }
 
+void RewindManager::UpdateHistoryStatistics()
+{
+	//The oldest block's keyframe (and the deltas before it) are still in memory when the blocks that saved them have been removed
+	uint32_t memoryUsage = 0;
+	uint32_t keyframeCount = 0;
+	for(size_t i = 0; i < _history.size(); i++) {
+		memoryUsage += _history[i].GetMemoryUsage(i == 0);
+		if(i == 0 || _history[i].IsKeyframe()) {
+			keyframeCount++;
+		}
+	}
+
+	_historyMemoryUsage = memoryUsage;
+	_historyKeyframeCount = keyframeCount;
+	_historyBlockCount = (uint32_t)_history.size();
+}
+
 void RewindManager::PopHistory()
 {
 	if(_history.empty() && _currentHistory.FrameCount <= 0) {
@@ -115,10 +137,11 @@ void RewindManager::PopHistory()
 		if(_currentHistory.FrameCount <= 0) {
 			_currentHistory = _history.back();
 			_history.pop_back();
+			UpdateHistoryStatistics();
 		}
 
 		_historyBackup.push_front(_currentHistory);
-		_currentHistory.LoadState(_console);
+		_currentHistory.LoadState(_console, _stateBuffers);
 		if(!_audioHistoryBuilder.empty()) {
 			_audioHistory.insert(_audioHistory.begin(), _audioHistoryBuilder.begin(), _audioHistoryBuilder.end());
 			_audioHistoryBuilder.clear();
@@ -132,8 +155,8 @@ void RewindManager::Start(bool forDebugger)
 		auto lock = _console->AcquireLock();
 
 		_rewindState = forDebugger ? RewindState::Debugging : RewindState::Starting;
-		_videoHistoryBuilder.clear();
-		_videoHistory.clear();
+		_videoBuffer.SetBufferSize(_settings->GetRewindVideoBufferSize());
+		_videoBuffer.Clear();
 		_audioHistoryBuilder.clear();
 		_audioHistory.clear();
 		_historyBackup.clear();
@@ -167,7 +190,7 @@ void RewindManager::Stop()
 		if(_rewindState == RewindState::Started) {
 			//Move back to the save state containing the frame currently shown on the screen
 			if(_historyBackup.size() > 1) {
-				_framesToFastForward = (uint32_t)_videoHistory.size() + _historyBackup.front().FrameCount;
+				_framesToFastForward = _videoBuffer.GetFrameCount() + _historyBackup.front().FrameCount;
 				do {
 					_history.push_back(_historyBackup.front());
 					_framesToFastForward -= _historyBackup.front().FrameCount;
@@ -188,7 +211,7 @@ void RewindManager::Stop()
 			_framesToFastForward = _historyBackup.front().FrameCount;
 		}
 
-		_currentHistory.LoadState(_console);
+		_currentHistory.LoadState(_console, _stateBuffers);
 		if(_framesToFastForward > 0) {
 			_rewindState = RewindState::Stopping;
 			_currentHistory.FrameCount = 0;
@@ -200,8 +223,7 @@ void RewindManager::Stop()
 			_settings->ClearFlag(EmulationFlags::Rewind);
 		}
 
-		_videoHistoryBuilder.clear();
-		_videoHistory.clear();
+		_videoBuffer.Clear();
 		_audioHistoryBuilder.clear();
 		_audioHistory.clear();
 	}
@@ -220,43 +242,24 @@ void RewindManager::ProcessEndOfFrame()
 	}
 }
 
-void RewindManager::ProcessFrame(void * frameBuffer, uint32_t width, uint32_t height, bool forRewind)
+bool RewindManager::ProcessFrame(uint16_t* &frameBuffer, uint32_t &width, uint32_t &height)
 {
+	//Receives the PPU's output for frames emulated while rewinding - returns false if nothing should be displayed
+	//When frames are available for playback, frameBuffer/width/height are replaced by the (older) frame that needs to be displayed
 	if(_rewindState == RewindState::Starting || _rewindState == RewindState::Started) {
-		if(!forRewind) {
-			//Ignore any frames that occur between start of rewind process & first rewinded frame completed
-			//These are caused by the fact that VideoDecoder is asynchronous - a previous (extra) frame can end up
-			//in the rewind queue, which causes display glitches
-			return;
-		}
-
-		VideoFrame newFrame;
-		newFrame.Data = vector<uint32_t>((uint32_t*)frameBuffer, (uint32_t*)frameBuffer + width * height);
-		newFrame.Width = width;
-		newFrame.Height = height;
-		_videoHistoryBuilder.push_back(newFrame);
+		_videoBuffer.AddFrame(frameBuffer, width, height, _historyBackup.front().FrameCount);
 
-		if(_videoHistoryBuilder.size() == (size_t)_historyBackup.front().FrameCount) {
-			for(int i = (int)_videoHistoryBuilder.size() - 1; i >= 0; i--) {
-				_videoHistory.push_front(_videoHistoryBuilder[i]);
-			}
-			_videoHistoryBuilder.clear();
-		}
-
-		if(_rewindState == RewindState::Started || _videoHistory.size() >= RewindManager::BufferSize) {
+		if(_rewindState == RewindState::Started || _videoBuffer.GetFrameCount() >= RewindManager::BufferSize) {
 			_rewindState = RewindState::Started;
 			_settings->ClearFlag(EmulationFlags::MaximumSpeed);
-			if(!_videoHistory.empty()) {
-				VideoFrame &frameData = _videoHistory.back();
-				_console->GetVideoRenderer()->UpdateFrame(frameData.Data.data(), frameData.Width, frameData.Height);
-				_videoHistory.pop_back();
-			}
+			return _videoBuffer.GetNextFrame(frameBuffer, width, height);
 		}
+		return false;
 	} else if(_rewindState == RewindState::Stopping || _rewindState == RewindState::Debugging) {
 		//Display nothing while resyncing
-	} else {
-		_console->GetVideoRenderer()->UpdateFrame(frameBuffer, width, height);
+		return false;
 	}
+	return true;
 }
 
 bool RewindManager::ProcessAudio(int16_t * soundBuffer, uint32_t sampleCount)
@@ -343,7 +346,7 @@ void RewindManager::RewindSeconds(uint32_t seconds)
 				break;
 			}
 		}
-		_currentHistory.LoadState(_console);
+		_currentHistory.LoadState(_console, _stateBuffers);
 	}
 }
 
@@ -352,9 +355,31 @@ bool RewindManager::HasHistory()
 	return _hasHistory;
 }
 
-void RewindManager::SendFrame(void * frameBuffer, uint32_t width, uint32_t height, bool forRewind)
+RewindStatistics RewindManager::GetStatistics()
 {
-	ProcessFrame(frameBuffer, width, height, forRewind);
+	RewindStatistics stats = _videoBuffer.GetStatistics();
+	stats.HistoryBlockCount = _historyBlockCount;
+	stats.HistoryKeyframeCount = _historyKeyframeCount;
+	stats.HistoryMemoryUsage = _historyMemoryUsage;
+	return stats;
+}
+
+void RewindManager::SendFrame(void * frameBuffer, uint32_t width, uint32_t height, uint64_t timestamp, bool forRewind)
+{
+	if(_rewindState == RewindState::Starting || _rewindState == RewindState::Started) {
+		if(forRewind) {
+			//Frame selected by ProcessFrame
+			_console->GetVideoRenderer()->UpdateFrame(frameBuffer, width, height, timestamp);
+		} else {
+			//Ignore any frames that occur between start of rewind process & first rewinded frame completed
+			//These are caused by the fact that VideoDecoder is asynchronous - a previous (extra) frame can end up
+			//being decoded after rewinding has started, which causes display glitches
+		}
+	} else if(_rewindState == RewindState::Stopping || _rewindState == RewindState::Debugging) {
+		//Display nothing while resyncing
+	} else {
+		_console->GetVideoRenderer()->UpdateFrame(frameBuffer, width, height, timestamp);
+	}
 }
 
 bool RewindManager::SendAudio(int16_t * soundBuffer, uint32_t sampleCount)
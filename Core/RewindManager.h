@@ -3,6 +3,7 @@
 #include <deque>
 #include "INotificationListener.h"
 #include "RewindData.h"
+#include "RewindVideoBuffer.h"
 #include "IInputProvider.h"
 #include "IInputRecorder.h"
 
@@ -18,13 +19,6 @@ enum class RewindState
 	Debugging = 4
 };
 
-struct VideoFrame
-{
-	vector<uint32_t> Data;
-	uint32_t Width;
-	uint32_t Height;
-};
-
 class RewindManager : public INotificationListener, public IInputProvider, public IInputRecorder
 {
 private:
@@ -38,23 +32,28 @@ private:
 	std::deque<RewindData> _history;
 	std::deque<RewindData> _historyBackup;
 	RewindData _currentHistory;
+	RewindStateBuffers _stateBuffers;
 
 	RewindState _rewindState;
 	int32_t _framesToFastForward;
 
-	std::deque<VideoFrame> _videoHistory;
-	vector<VideoFrame> _videoHistoryBuilder;
+	RewindVideoBuffer _videoBuffer;
 	std::deque<int16_t> _audioHistory;
 	vector<int16_t> _audioHistoryBuilder;
 
+	//Updated by the emulation thread, read by GetStatistics
+	atomic<uint32_t> _historyKeyframeCount;
+	atomic<uint32_t> _historyMemoryUsage;
+	atomic<uint32_t> _historyBlockCount;
+
 	void AddHistoryBlock();
 	void PopHistory();
+	void UpdateHistoryStatistics();
 
 	void Start(bool forDebugger);
 	void Stop();
 	void ForceStop();
 
-	void ProcessFrame(void *frameBuffer, uint32_t width, uint32_t height, bool forRewind);
 	bool ProcessAudio(int16_t *soundBuffer, uint32_t sampleCount);
 	
 	void ClearBuffer();
@@ -76,7 +75,9 @@ public:
 	void RewindSeconds(uint32_t seconds);
 
 	bool HasHistory();
+	RewindStatistics GetStatistics();
 
-	void SendFrame(void *frameBuffer, uint32_t width, uint32_t height, bool forRewind);
+	bool ProcessFrame(uint16_t* &frameBuffer, uint32_t &width, uint32_t &height);
+	void SendFrame(void *frameBuffer, uint32_t width, uint32_t height, uint64_t timestamp, bool forRewind);
 	bool SendAudio(int16_t *soundBuffer, uint32_t sampleCount);
 };
\ No newline at end of file
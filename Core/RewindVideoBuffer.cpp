@@ -0,0 +1,163 @@
+#include "stdafx.h"
+#include "RewindVideoBuffer.h"
+
+void RewindVideoBuffer::SetBufferSize(uint32_t byteSize)
+{
+	uint32_t size = byteSize / sizeof(uint16_t);
+	if(_buffer.size() != size) {
+		Clear();
+		_buffer = vector<uint16_t>(size);
+	}
+}
+
+bool RewindVideoBuffer::Allocate(uint32_t size, uint32_t &offset)
+{
+	uint32_t capacity = (uint32_t)_buffer.size();
+	if(size > capacity - _usedSize) {
+		return false;
+	}
+
+	if(_usedSize == 0) {
+		_readPosition = 0;
+		_writePosition = 0;
+	}
+
+	uint32_t wastedSize = 0;
+	if(_writePosition >= _readPosition) {
+		if(capacity - _writePosition >= size) {
+			offset = _writePosition;
+		} else if(_readPosition >= size) {
+			//Not enough room at the end of the buffer, wrap around (the end of the buffer is unused until this block is released)
+			wastedSize = capacity - _writePosition;
+			offset = 0;
+		} else {
+			return false;
+		}
+	} else if(_readPosition - _writePosition >= size) {
+		offset = _writePosition;
+	} else {
+		return false;
+	}
+
+	_writePosition = offset + size;
+	_pendingSize += wastedSize + size;
+	_usedSize += wastedSize + size;
+	return true;
+}
+
+void RewindVideoBuffer::AddFrame(uint16_t* frameBuffer, uint32_t width, uint32_t height, uint32_t blockFrameCount)
+{
+	uint32_t frameSize = width * height;
+	uint32_t frameIndex = (uint32_t)_pendingFrames.size();
+
+	if(frameIndex == 0) {
+		//Keep only 1 out of every X frames if the whole block can't fit in the remaining space
+		uint32_t maxFrameCount = ((uint32_t)_buffer.size() - _usedSize) / frameSize;
+		if(maxFrameCount >= blockFrameCount) {
+			_decimation = 1;
+		} else if(maxFrameCount == 0) {
+			_decimation = blockFrameCount;
+		} else {
+			_decimation = (blockFrameCount + maxFrameCount - 1) / maxFrameCount;
+		}
+	}
+
+	FrameEntry frame = {};
+	frame.Width = width;
+	frame.Height = height;
+	if(frameIndex % _decimation == 0 && Allocate(frameSize, frame.Offset)) {
+		memcpy(_buffer.data() + frame.Offset, frameBuffer, frameSize * sizeof(uint16_t));
+		frame.HasData = true;
+	} else {
+		//Frame dropped, display the previous frame again instead
+		_droppedFrameCount++;
+		if(frameIndex > 0) {
+			frame = _pendingFrames.back();
+		}
+	}
+	_pendingFrames.push_back(frame);
+
+	if(_pendingFrames.size() >= blockFrameCount) {
+		EndBlock();
+	}
+}
+
+void RewindVideoBuffer::EndBlock()
+{
+	if(_pendingFrames.empty()) {
+		return;
+	}
+
+	//The block's memory is released once its first frame (the last one to be displayed) has been displayed
+	_pendingFrames[0].EndOfBlock = true;
+	_pendingFrames[0].BlockSize = _pendingSize;
+	_pendingFrames[0].BlockEnd = _writePosition;
+
+	for(int i = (int)_pendingFrames.size() - 1; i >= 0; i--) {
+		_frames.push_back(_pendingFrames[i]);
+	}
+	_pendingFrames.clear();
+	_pendingSize = 0;
+}
+
+void RewindVideoBuffer::Release()
+{
+	if(_releaseSize > 0) {
+		_usedSize -= _releaseSize;
+		_readPosition = _releasePosition;
+		_releaseSize = 0;
+	}
+}
+
+bool RewindVideoBuffer::GetNextFrame(uint16_t* &frameBuffer, uint32_t &width, uint32_t &height)
+{
+	//Memory for the previous block is only released now, to make sure the last frame returned stays valid until the next call
+	Release();
+
+	if(_frames.empty()) {
+		return false;
+	}
+
+	FrameEntry frame = _frames.front();
+	_frames.pop_front();
+
+	if(frame.EndOfBlock) {
+		_releaseSize = frame.BlockSize;
+		_releasePosition = frame.BlockEnd;
+	}
+
+	if(!frame.HasData) {
+		return false;
+	}
+
+	frameBuffer = _buffer.data() + frame.Offset;
+	width = frame.Width;
+	height = frame.Height;
+	return true;
+}
+
+uint32_t RewindVideoBuffer::GetFrameCount()
+{
+	return (uint32_t)_frames.size();
+}
+
+void RewindVideoBuffer::Clear()
+{
+	_frames.clear();
+	_pendingFrames.clear();
+	_pendingSize = 0;
+	_releaseSize = 0;
+	_usedSize = 0;
+	_readPosition = 0;
+	_writePosition = 0;
+}
+
+RewindStatistics RewindVideoBuffer::GetStatistics()
+{
+	RewindStatistics stats = {};
+	stats.VideoBufferSize = (uint32_t)_buffer.size() * sizeof(uint16_t);
+	stats.VideoBufferUsage = _usedSize * sizeof(uint16_t);
+	stats.VideoFrameCount = (uint32_t)_frames.size();
+	stats.DroppedFrameCount = _droppedFrameCount;
+	return stats;
+}
\ No newline at end of file
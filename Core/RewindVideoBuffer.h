@@ -0,0 +1,61 @@
+#pragma once
+#include "stdafx.h"
+
+struct RewindStatistics
+{
+	uint32_t VideoBufferSize;
+	uint32_t VideoBufferUsage;
+	uint32_t VideoFrameCount;
+	uint32_t DroppedFrameCount;
+
+	//Save states kept in the rewind history (see RewindData)
+	uint32_t HistoryBlockCount;
+	uint32_t HistoryKeyframeCount;
+	uint32_t HistoryMemoryUsage;
+};
+
+//Fixed-size ring buffer that holds the (15-bit) PPU frames that are displayed while rewinding
+//Frames are added one history block at a time (in emulation order), and played back in reverse order
+class RewindVideoBuffer
+{
+private:
+	struct FrameEntry
+	{
+		uint32_t Offset;
+		uint16_t Width;
+		uint16_t Height;
+		bool HasData;
+		bool EndOfBlock;
+		uint32_t BlockSize;
+		uint32_t BlockEnd;
+	};
+
+	vector<uint16_t> _buffer;
+	uint32_t _readPosition = 0;
+	uint32_t _writePosition = 0;
+	uint32_t _usedSize = 0;
+
+	std::deque<FrameEntry> _frames;
+	vector<FrameEntry> _pendingFrames;
+	uint32_t _pendingSize = 0;
+	uint32_t _decimation = 1;
+
+	uint32_t _releaseSize = 0;
+	uint32_t _releasePosition = 0;
+
+	uint32_t _droppedFrameCount = 0;
+
+	bool Allocate(uint32_t size, uint32_t &offset);
+	void EndBlock();
+	void Release();
+
+public:
+	void SetBufferSize(uint32_t byteSize);
+
+	void AddFrame(uint16_t* frameBuffer, uint32_t width, uint32_t height, uint32_t blockFrameCount);
+	bool GetNextFrame(uint16_t* &frameBuffer, uint32_t &width, uint32_t &height);
+	uint32_t GetFrameCount();
+
+	void Clear();
+	RewindStatistics GetStatistics();
+};
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include "stdafx.h"
+#include <random>
+#include "RingBufferTest.h"
+#include "../Utilities/SpscRingBuffer.h"
+#include "../Utilities/Timer.h"
+
+RingBufferTest::PassResult RingBufferTest::RunPass(bool lossless, uint32_t durationMs, uint32_t seed)
+{
+	//Small buffer and large chunks, so the buffer is often full or empty and the cursors wrap around constantly
+	constexpr uint32_t BufferSize = 0x1000;
+	constexpr uint32_t MaxChunkSize = 0x600;
+
+	SpscRingBuffer<uint32_t> buffer;
+	buffer.Reset(BufferSize);
+
+	PassResult result;
+	atomic<bool> stop(false);
+	atomic<bool> producerDone(false);
+	uint32_t nextValue = 0;
+
+	Timer timer;
+	std::thread producer([&]() {
+		std::mt19937 random(seed);
+		vector<uint32_t> chunk(MaxChunkSize);
+		while(!stop) {
+			uint32_t count = random() % MaxChunkSize + 1;
+			for(uint32_t i = 0; i < count; i++) {
+				chunk[i] = nextValue + i;
+			}
+
+			uint32_t writtenCount = buffer.Write(chunk.data(), count);
+			if(lossless) {
+				while(writtenCount < count && !stop) {
+					std::this_thread::yield();
+					writtenCount += buffer.Write(chunk.data() + writtenCount, count - writtenCount);
+				}
+			}
+
+			//In the lossless pass, the end of the chunk is only missing when the test is stopped
+			result.WrittenCount += writtenCount;
+			nextValue += lossless ? writtenCount : count;
+
+			if(random() % 4 == 0) {
+				//Write several chunks in a row most of the time, to fill the buffer faster than the consumer empties it
+				std::this_thread::yield();
+			}
+		}
+		producerDone = true;
+	});
+
+	std::thread consumer([&]() {
+		std::mt19937 random(seed + 1);
+		vector<uint32_t> chunk(MaxChunkSize);
+		uint32_t expectedValue = 0;
+		while(true) {
+			//Once the producer is done, stop after the first read that empties the buffer
+			bool done = producerDone;
+
+			uint32_t count = random() % MaxChunkSize + 1;
+			uint32_t readCount = buffer.Read(chunk.data(), count);
+			for(uint32_t i = 0; i < readCount; i++) {
+				int32_t gap = (int32_t)(chunk[i] - expectedValue);
+				if(gap > 0 && !lossless) {
+					//Values dropped by the producer because the buffer was full
+					result.DroppedCount += gap;
+				} else if(gap != 0) {
+					result.ErrorCount++;
+				}
+				expectedValue = chunk[i] + 1;
+			}
+			result.ReadCount += readCount;
+
+			if(readCount < count && done) {
+				break;
+			}
+			std::this_thread::yield();
+		}
+
+		//Values dropped at the end of the last chunks (after the last value that was received)
+		result.DroppedCount += nextValue - expectedValue;
+	});
+
+	while(timer.GetElapsedMS() < durationMs) {
+		std::this_thread::sleep_for(std::chrono::duration<int, std::milli>(10));
+	}
+	stop = true;
+	producer.join();
+	consumer.join();
+	result.ElapsedMs = timer.GetElapsedMS();
+
+	result.OverrunCount = buffer.GetOverrunCount();
+	result.UnderrunCount = buffer.GetUnderrunCount();
+	result.ReportedDroppedCount = buffer.GetDroppedCount();
+	result.Passed = (
+		result.ErrorCount == 0 && result.ReadCount == result.WrittenCount && result.ReadCount > 0 &&
+		(lossless ? result.DroppedCount == 0 : result.DroppedCount == result.ReportedDroppedCount)
+	);
+	return result;
+}
+
+string RingBufferTest::GetPassJson(PassResult &result)
+{
+	std::stringstream ss;
+	ss << std::fixed << std::setprecision(3);
+	ss << "{ \"written\": " << result.WrittenCount << ", \"read\": " << result.ReadCount << ", \"dropped\": " << result.DroppedCount;
+	ss << ", \"reportedDropped\": " << result.ReportedDroppedCount << ", \"overruns\": " << result.OverrunCount << ", \"underruns\": " << result.UnderrunCount;
+	ss << ", \"errors\": " << result.ErrorCount << ", \"timeMs\": " << result.ElapsedMs << ", \"passed\": " << (result.Passed ? "true" : "false") << " }";
+	return ss.str();
+}
+
+bool RingBufferTest::Run(uint32_t durationMs, string &report)
+{
+	PassResult lossless = RunPass(true, durationMs, 1);
+	PassResult lossy = RunPass(false, durationMs, 2);
+
+	bool passed = lossless.Passed && lossy.Passed;
+	std::stringstream ss;
+	ss << "{" << std::endl;
+	ss << "\t\"lossless\": " << GetPassJson(lossless) << "," << std::endl;
+	ss << "\t\"lossy\": " << GetPassJson(lossy) << "," << std::endl;
+	ss << "\t\"passed\": " << (passed ? "true" : "false") << std::endl;
+	ss << "}" << std::endl;
+	report = ss.str();
+	return passed;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include "stdafx.h"
+
+//Stress test for SpscRingBuffer (used to send samples to the audio callback): a producer and a consumer thread transfer
+//a sequence of numbers through a small buffer, in chunks of random sizes, and the consumer checks every value it receives.
+//-Lossless pass: the producer retries until each chunk is fully written, the consumer must receive the exact sequence
+//-Lossy pass (like the audio device): the producer never waits, the values that don't fit are dropped - the consumer must
+// receive an increasing sequence, and the values missing from it must match the buffer's overrun/dropped counters
+//The test passes when no value was corrupted, reordered or lost without being counted.
+class RingBufferTest
+{
+private:
+	struct PassResult
+	{
+		uint64_t WrittenCount = 0;
+		uint64_t ReadCount = 0;
+		uint64_t DroppedCount = 0;
+		uint64_t ReportedDroppedCount = 0;
+		uint32_t OverrunCount = 0;
+		uint32_t UnderrunCount = 0;
+		uint32_t ErrorCount = 0;
+		double ElapsedMs = 0;
+		bool Passed = false;
+	};
+
+	static PassResult RunPass(bool lossless, uint32_t durationMs, uint32_t seed);
+	static string GetPassJson(PassResult &result);
+
+public:
+	//Returns true when both passes succeeded, report contains the results of both passes (JSON)
+	static bool Run(uint32_t durationMs, string &report);
+};
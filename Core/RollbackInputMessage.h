@@ -0,0 +1,225 @@
+#pragma once
+#include "stdafx.h"
+#include "NetMessage.h"
+#include "ControlDeviceState.h"
+#include "BaseControlDevice.h"
+
+//Consecutive frames of a port's input, starting at StartFrame
+struct RollbackInputRun
+{
+	uint8_t Port = 0;
+	uint32_t StartFrame = 0;
+	vector<ControlDeviceState> States;
+};
+
+//Input stream used in rollback mode - each message contains:
+//-The last frame received from the other side, for each port (acknowledgements)
+//-All the input frames that the other side hasn't acknowledged yet, for each port
+//The input is packed: each run of frames (for a port) is stored as the XOR of each frame's state with the previous frame's state,
+//followed by a run-length encoding of the zeroes (the buttons rarely change from a frame to the next, so this is mostly zeroes)
+class RollbackInputMessage : public NetMessage
+{
+private:
+	uint32_t _syncId = 0;
+	uint8_t _ackPorts = 0;
+	uint32_t _ackFrames[BaseControlDevice::PortCount] = {};
+	vector<RollbackInputRun> _inputs;
+
+	static void WriteFrame(vector<uint8_t> &data, uint32_t frame)
+	{
+		for(int i = 0; i < 4; i++) {
+			data.push_back((uint8_t)(frame >> (i * 8)));
+		}
+	}
+
+	static bool ReadFrame(vector<uint8_t> &data, size_t &pos, uint32_t &frame)
+	{
+		if(pos + 4 > data.size()) {
+			return false;
+		}
+		frame = data[pos] | (data[pos + 1] << 8) | (data[pos + 2] << 16) | ((uint32_t)data[pos + 3] << 24);
+		pos += 4;
+		return true;
+	}
+
+	static void EncodeRun(vector<uint8_t> &data, uint8_t port, uint32_t startFrame, vector<ControlDeviceState> &states, size_t start, size_t count)
+	{
+		uint8_t stateSize = (uint8_t)states[start].State.size();
+		data.push_back(port);
+		WriteFrame(data, startFrame);
+		data.push_back((uint8_t)count);
+		data.push_back(stateSize);
+
+		uint8_t zeroCount = 0;
+		for(size_t i = start; i < start + count; i++) {
+			for(int j = 0; j < stateSize; j++) {
+				uint8_t delta = states[i].State[j] ^ (i > start ? states[i - 1].State[j] : 0);
+				if(delta == 0) {
+					zeroCount++;
+					if(zeroCount == 0xFF) {
+						data.push_back(0);
+						data.push_back(zeroCount);
+						zeroCount = 0;
+					}
+				} else {
+					if(zeroCount > 0) {
+						data.push_back(0);
+						data.push_back(zeroCount);
+						zeroCount = 0;
+					}
+					data.push_back(delta);
+				}
+			}
+		}
+		if(zeroCount > 0) {
+			data.push_back(0);
+			data.push_back(zeroCount);
+		}
+	}
+
+	static bool DecodeRun(vector<uint8_t> &data, size_t &pos, RollbackInputRun &run)
+	{
+		if(pos + 7 > data.size()) {
+			return false;
+		}
+
+		run.Port = data[pos++];
+		ReadFrame(data, pos, run.StartFrame);
+		uint8_t count = data[pos++];
+		uint8_t stateSize = data[pos++];
+		if(run.Port >= BaseControlDevice::PortCount) {
+			return false;
+		}
+
+		vector<uint8_t> deltas;
+		deltas.reserve(count * stateSize);
+		while(deltas.size() < (size_t)(count * stateSize)) {
+			if(pos >= data.size()) {
+				return false;
+			}
+			uint8_t value = data[pos++];
+			if(value == 0) {
+				if(pos >= data.size()) {
+					return false;
+				}
+				deltas.insert(deltas.end(), (size_t)data[pos++], (uint8_t)0);
+			} else {
+				deltas.push_back(value);
+			}
+		}
+		if(deltas.size() != (size_t)(count * stateSize)) {
+			return false;
+		}
+
+		run.States.resize(count);
+		for(int i = 0; i < count; i++) {
+			run.States[i].State.resize(stateSize);
+			for(int j = 0; j < stateSize; j++) {
+				run.States[i].State[j] = deltas[i * stateSize + j] ^ (i > 0 ? run.States[i - 1].State[j] : 0);
+			}
+		}
+		return true;
+	}
+
+	void Encode(vector<uint8_t> &data)
+	{
+		data.push_back(_ackPorts);
+		for(int i = 0; i < BaseControlDevice::PortCount; i++) {
+			if(_ackPorts & (1 << i)) {
+				WriteFrame(data, _ackFrames[i]);
+			}
+		}
+
+		for(RollbackInputRun &run : _inputs) {
+			//A new run is started whenever the state's size changes (and every 255 frames)
+			size_t start = 0;
+			for(size_t i = 1; i <= run.States.size(); i++) {
+				if(i == run.States.size() || i - start == 0xFF || run.States[i].State.size() != run.States[start].State.size()) {
+					EncodeRun(data, run.Port, run.StartFrame + (uint32_t)start, run.States, start, i - start);
+					start = i;
+				}
+			}
+		}
+	}
+
+	void Decode(vector<uint8_t> &data)
+	{
+		size_t pos = 0;
+		if(data.empty()) {
+			return;
+		}
+
+		_ackPorts = data[pos++];
+		for(int i = 0; i < BaseControlDevice::PortCount; i++) {
+			if((_ackPorts & (1 << i)) && !ReadFrame(data, pos, _ackFrames[i])) {
+				_ackPorts = 0;
+				return;
+			}
+		}
+
+		while(pos < data.size()) {
+			RollbackInputRun run;
+			if(!DecodeRun(data, pos, run)) {
+				//Invalid data, ignore the rest of the message
+				break;
+			}
+			_inputs.push_back(run);
+		}
+	}
+
+protected:
+	void Serialize(Serializer &s) override
+	{
+		vector<uint8_t> data;
+		if(s.IsSaving()) {
+			Encode(data);
+		}
+
+		s.Stream(_syncId);
+		s.StreamVector(data);
+
+		if(!s.IsSaving()) {
+			Decode(data);
+		}
+	}
+
+	bool IsCompressed() override
+	{
+		return false;
+	}
+
+public:
+	RollbackInputMessage(void* buffer, uint32_t length) : NetMessage(buffer, length) { }
+
+	RollbackInputMessage(uint32_t syncId) : NetMessage(MessageType::RollbackInput)
+	{
+		_syncId = syncId;
+	}
+
+	void SetAck(uint8_t port, uint32_t frame)
+	{
+		_ackPorts |= 1 << port;
+		_ackFrames[port] = frame;
+	}
+
+	void AddInput(uint8_t port, uint32_t startFrame, vector<ControlDeviceState> &states)
+	{
+		_inputs.push_back({ port, startFrame, states });
+	}
+
+	uint32_t GetSyncId()
+	{
+		return _syncId;
+	}
+
+	bool GetAck(uint8_t port, uint32_t &frame)
+	{
+		frame = _ackFrames[port];
+		return (_ackPorts & (1 << port)) != 0;
+	}
+
+	vector<RollbackInputRun>& GetInputs()
+	{
+		return _inputs;
+	}
+};
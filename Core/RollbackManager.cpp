@@ -0,0 +1,447 @@
+#include "stdafx.h"
+#include "RollbackManager.h"
+#include "IRollbackSender.h"
+#include "Console.h"
+#include "ControlManager.h"
+#include "MessageManager.h"
+#include "../Utilities/CRC32.h"
+
+RollbackManager::RollbackManager(Console* console)
+{
+	_console = console;
+	_enabled = false;
+}
+
+void RollbackManager::Start(IRollbackSender* sender, uint8_t localPorts)
+{
+	Stop();
+
+	auto lock = _lock.AcquireSafe();
+	_sender = sender;
+	_localPorts = localPorts;
+	_stats = {};
+	ClearHistory();
+	for(int i = 0; i < BaseControlDevice::PortCount; i++) {
+		_confirmedFrame[i] = _frame;
+		_lastConfirmedState[i] = ControlDeviceState();
+		_hasLocalInput[i] = false;
+	}
+
+	shared_ptr<ControlManager> controlManager = _console->GetControlManager();
+	if(controlManager) {
+		controlManager->RegisterInputProvider(this);
+	}
+	_enabled = true;
+
+	if(_console->GetCartridge()) {
+		//Poll the input for the current frame again, so it is sent to the other players
+		ResetSession();
+	}
+}
+
+void RollbackManager::Stop()
+{
+	auto lock = _lock.AcquireSafe();
+	if(_enabled) {
+		_enabled = false;
+		_sender = nullptr;
+
+		shared_ptr<ControlManager> controlManager = _console->GetControlManager();
+		if(controlManager) {
+			controlManager->UnregisterInputProvider(this);
+		}
+		_inputReceived.Signal();
+	}
+}
+
+bool RollbackManager::IsEnabled()
+{
+	return _enabled;
+}
+
+void RollbackManager::ClearHistory()
+{
+	for(int i = 0; i < BaseControlDevice::PortCount; i++) {
+		for(uint32_t j = 0; j < InputHistorySize; j++) {
+			_inputs[i][j] = RollbackInput();
+		}
+	}
+	for(RollbackSnapshot &snapshot : _snapshots) {
+		snapshot.Frame = InvalidFrame;
+	}
+	for(RollbackStateHash &hash : _hashes) {
+		hash = RollbackStateHash();
+	}
+
+	_devicePorts = 0;
+	_rollbackPending = false;
+	_lastStalledFrame = InvalidFrame;
+	_nextHashFrame = _frame;
+}
+
+void RollbackManager::SetLocalPorts(uint8_t localPorts)
+{
+	auto lock = _lock.AcquireSafe();
+	for(int i = 0; i < BaseControlDevice::PortCount; i++) {
+		if((localPorts & ~_localPorts) & (1 << i)) {
+			//A remote player stopped using this port, the input that was predicted for it is now the actual input
+			ConfirmPredictedInput(i);
+		}
+	}
+	_localPorts = localPorts;
+}
+
+void RollbackManager::SetLocalInput(uint8_t port, ControlDeviceState state)
+{
+	auto lock = _lock.AcquireSafe();
+	_localInput[port] = state;
+	_hasLocalInput[port] = true;
+}
+
+void RollbackManager::ResetSession()
+{
+	auto lock = _lock.AcquireSafe();
+
+	//Snapshots saved before the state was loaded are no longer valid
+	for(RollbackSnapshot &snapshot : _snapshots) {
+		snapshot.Frame = InvalidFrame;
+	}
+	for(RollbackStateHash &hash : _hashes) {
+		hash = RollbackStateHash();
+	}
+	_nextHashFrame = _frame;
+	SaveSnapshot(_frame);
+
+	//The loaded state contains the input that was polled when it was saved, poll the input again
+	_rollbackPending = false;
+	RequestRollback(_frame);
+}
+
+RollbackSyncState RollbackManager::GetSyncState(uint8_t clientPort)
+{
+	auto lock = _lock.AcquireSafe();
+
+	RollbackSyncState syncState;
+	syncState.Frame = _frame;
+	for(int i = 0; i < BaseControlDevice::PortCount; i++) {
+		RollbackInput &input = _inputs[i][_frame % InputHistorySize];
+		if(input.Frame == _frame) {
+			syncState.Inputs[i] = input.State;
+			syncState.Confirmed[i] = input.Confirmed;
+		} else {
+			//No input was polled for this port yet (e.g the session just started), use the same (empty) input as the client
+			ControlDeviceState emptyState;
+			ConfirmInput(i, _frame, emptyState);
+			syncState.Confirmed[i] = true;
+		}
+	}
+
+	if(clientPort < BaseControlDevice::PortCount) {
+		//The client sends its input starting from the next frame, the input that was used until now is kept
+		ConfirmPredictedInput(clientPort);
+		for(uint32_t i = 0; i < InputHistorySize; i++) {
+			RollbackInput &input = _inputs[clientPort][i];
+			if(input.Frame != InvalidFrame && (int32_t)(input.Frame - _frame) > 0) {
+				input = RollbackInput();
+			}
+		}
+		if((int32_t)(_confirmedFrame[clientPort] - _frame) > 0) {
+			_confirmedFrame[clientPort] = _frame;
+			_lastConfirmedState[clientPort] = syncState.Inputs[clientPort];
+		}
+		syncState.Confirmed[clientPort] = true;
+	}
+
+	return syncState;
+}
+
+void RollbackManager::GetConfirmedInput(uint8_t port, uint32_t startFrame, vector<ControlDeviceState> &states, uint32_t maxFrames)
+{
+	auto lock = _lock.AcquireSafe();
+	for(uint32_t frame = startFrame; (int32_t)(frame - _confirmedFrame[port]) <= 0 && states.size() < maxFrames; frame++) {
+		RollbackInput &input = _inputs[port][frame % InputHistorySize];
+		if(input.Frame != frame || !input.Confirmed) {
+			break;
+		}
+		states.push_back(input.State);
+	}
+}
+
+uint32_t RollbackManager::GetConfirmedFrame(uint8_t port)
+{
+	auto lock = _lock.AcquireSafe();
+	return _confirmedFrame[port];
+}
+
+uint8_t RollbackManager::GetDevicePorts()
+{
+	//Ports whose input is polled by the emulation
+	auto lock = _lock.AcquireSafe();
+	return _devicePorts;
+}
+
+void RollbackManager::LoadSyncState(RollbackSyncState &syncState)
+{
+	auto lock = _lock.AcquireSafe();
+
+	_frame = syncState.Frame;
+	ClearHistory();
+	for(int i = 0; i < BaseControlDevice::PortCount; i++) {
+		RollbackInput &input = _inputs[i][_frame % InputHistorySize];
+		input.Frame = _frame;
+		input.Confirmed = syncState.Confirmed[i];
+		input.State = syncState.Inputs[i];
+		_confirmedFrame[i] = syncState.Confirmed[i] ? _frame : _frame - 1;
+		_lastConfirmedState[i] = syncState.Inputs[i];
+	}
+	SaveSnapshot(_frame);
+
+	//The server may poll this frame's input again after sending its state, do the same here
+	RequestRollback(_frame);
+}
+
+bool RollbackManager::AddRemoteInput(uint32_t frame, uint8_t port, ControlDeviceState &state)
+{
+	auto lock = _lock.AcquireSafe();
+	if(!_enabled || port >= BaseControlDevice::PortCount || (_localPorts & (1 << port))) {
+		return false;
+	}
+
+	if(frame != _confirmedFrame[port] + 1) {
+		//Each port's input is received in order, anything else was already received
+		return false;
+	}
+
+	RollbackInput &input = _inputs[port][frame % InputHistorySize];
+	if(input.Frame == frame && !input.Confirmed && input.State != state) {
+		//The input that was predicted for this frame was wrong (the frame may have been polled, but not saved yet)
+		RequestRollback(frame);
+	}
+	ConfirmInput(port, frame, state);
+
+	_inputReceived.Signal();
+	return true;
+}
+
+StateHashCheck RollbackManager::CheckStateHash(uint32_t frame, uint32_t hash)
+{
+	auto lock = _lock.AcquireSafe();
+	if((int32_t)(frame - _nextHashFrame) >= 0) {
+		return StateHashCheck::Pending;
+	}
+
+	RollbackStateHash &stateHash = _hashes[frame % HashHistorySize];
+	if(stateHash.Frame != frame) {
+		//Too old (or the frame's snapshot was no longer available), ignore it
+		return StateHashCheck::Match;
+	}
+
+	_stats.CheckedHashCount++;
+	if(stateHash.Hash != hash) {
+		_stats.DesyncCount++;
+		MessageManager::DisplayMessage("NetPlay", "NetplayDesync", std::to_string(frame));
+		return StateHashCheck::Desync;
+	}
+	return StateHashCheck::Match;
+}
+
+uint32_t RollbackManager::GetFrame()
+{
+	return _frame;
+}
+
+bool RollbackManager::GetRollbackFrame(uint32_t &frame)
+{
+	auto lock = _lock.AcquireSafe();
+	if(_rollbackPending) {
+		_rollbackPending = false;
+		frame = _rollbackFrame;
+		return true;
+	}
+	return false;
+}
+
+bool RollbackManager::LoadFrame(uint32_t frame)
+{
+	auto lock = _lock.AcquireSafe();
+
+	RollbackSnapshot &snapshot = _snapshots[frame % SnapshotCount];
+	if(snapshot.Frame != frame) {
+		//Should not happen, the emulation waits for the remote input before running too far ahead of it
+		MessageManager::Log("[Netplay] Could not roll back to frame " + std::to_string(frame));
+		return false;
+	}
+
+	uint32_t depth = _frame - frame;
+	if(depth > 0) {
+		_stats.RollbackCount++;
+		_stats.RolledBackFrames += depth;
+		_stats.MaxRollbackDepth = std::max(_stats.MaxRollbackDepth, depth);
+	}
+
+	_console->LoadSnapshot(snapshot.Data.data(), snapshot.Size);
+	_frame = frame - 1;
+	return true;
+}
+
+void RollbackManager::SaveFrame()
+{
+	auto lock = _lock.AcquireSafe();
+	_frame++;
+	SaveSnapshot(_frame);
+}
+
+void RollbackManager::SaveSnapshot(uint32_t frame)
+{
+	RollbackSnapshot &snapshot = _snapshots[frame % SnapshotCount];
+	snapshot.Frame = frame;
+	snapshot.Size = _console->SaveSnapshot(snapshot.Data);
+}
+
+void RollbackManager::RequestRollback(uint32_t frame)
+{
+	if(!_rollbackPending || (int32_t)(frame - _rollbackFrame) < 0) {
+		_rollbackFrame = frame;
+	}
+	_rollbackPending = true;
+}
+
+void RollbackManager::ConfirmInput(uint8_t port, uint32_t frame, ControlDeviceState &state)
+{
+	RollbackInput &input = _inputs[port][frame % InputHistorySize];
+	input.Frame = frame;
+	input.Confirmed = true;
+	input.State = state;
+
+	_confirmedFrame[port] = frame;
+	_lastConfirmedState[port] = state;
+}
+
+void RollbackManager::ConfirmPredictedInput(uint8_t port)
+{
+	//Used when a port stops being controlled by a remote player: the input predicted for it becomes its actual input and is sent to the others
+	for(uint32_t frame = _confirmedFrame[port] + 1; (int32_t)(frame - _frame) <= 0; frame++) {
+		RollbackInput &input = _inputs[port][frame % InputHistorySize];
+		ControlDeviceState state = input.Frame == frame ? input.State : _lastConfirmedState[port];
+		ConfirmInput(port, frame, state);
+	}
+}
+
+bool RollbackManager::IsRemotePort(uint8_t port)
+{
+	return ((_devicePorts & ~_localPorts) & (1 << port)) != 0;
+}
+
+bool RollbackManager::IsStalled()
+{
+	auto lock = _lock.AcquireSafe();
+	for(int i = 0; i < BaseControlDevice::PortCount; i++) {
+		if(IsRemotePort(i) && (int32_t)(_frame - _confirmedFrame[i]) >= (int32_t)MaxRollbackFrames) {
+			if(_lastStalledFrame != _frame) {
+				_lastStalledFrame = _frame;
+				_stats.StallCount++;
+			}
+			return true;
+		}
+	}
+	return false;
+}
+
+void RollbackManager::WaitForInput()
+{
+	_inputReceived.Wait(1);
+}
+
+void RollbackManager::UpdateStateHashes()
+{
+	auto lock = _lock.AcquireSafe();
+
+	//A frame's snapshot can be hashed once all players' input up to that frame is known (and matches what was used)
+	int64_t endFrame = (int64_t)_frame + 1;
+	for(int i = 0; i < BaseControlDevice::PortCount; i++) {
+		if(IsRemotePort(i)) {
+			endFrame = std::min(endFrame, (int64_t)_confirmedFrame[i] + 1);
+		}
+	}
+	if(_rollbackPending) {
+		endFrame = std::min(endFrame, (int64_t)_rollbackFrame);
+	}
+
+	for(; (int64_t)_nextHashFrame < endFrame; _nextHashFrame++) {
+		RollbackSnapshot &snapshot = _snapshots[_nextHashFrame % SnapshotCount];
+		if(snapshot.Frame == _nextHashFrame) {
+			RollbackStateHash &stateHash = _hashes[_nextHashFrame % HashHistorySize];
+			stateHash.Frame = _nextHashFrame;
+			stateHash.Hash = CRC32::GetCRC(snapshot.Data.data(), snapshot.Size);
+			if(_sender) {
+				_sender->SendStateHash(stateHash.Frame, stateHash.Hash);
+			}
+		}
+	}
+}
+
+RollbackStatistics RollbackManager::GetStatistics()
+{
+	auto lock = _lock.AcquireSafe();
+	return _stats;
+}
+
+bool RollbackManager::SetInput(BaseControlDevice *device)
+{
+	uint8_t port = device->GetPort();
+	if(port >= BaseControlDevice::PortCount) {
+		return false;
+	}
+
+	auto lock = _lock.AcquireSafe();
+	if(!_enabled) {
+		return false;
+	}
+
+	uint32_t frame = _frame + 1;
+	_devicePorts |= 1 << port;
+
+	RollbackInput &input = _inputs[port][frame % InputHistorySize];
+	if(input.Frame == frame && input.Confirmed) {
+		//Remote input that was already received, or local input that was polled before a rollback
+		device->SetRawState(input.State);
+	} else if(_localPorts & (1 << port)) {
+		//First time this frame's local input is polled, it will be sent to the other players
+		ControlDeviceState state = _hasLocalInput[port] ? _localInput[port] : device->GetRawState();
+		ConfirmInput(port, frame, state);
+		device->SetRawState(state);
+	} else {
+		//Remote input that hasn't been received yet, assume the player is still pressing the same buttons
+		input.Frame = frame;
+		input.Confirmed = false;
+		input.State = _lastConfirmedState[port];
+		device->SetRawState(input.State);
+	}
+	return true;
+}
+
+void RollbackManager::ProcessNotification(ConsoleNotificationType type, void* parameter)
+{
+	if(!_enabled) {
+		return;
+	}
+
+	switch(type) {
+		case ConsoleNotificationType::GameLoaded: {
+			//A new control manager is created for each game
+			shared_ptr<ControlManager> controlManager = _console->GetControlManager();
+			controlManager->UnregisterInputProvider(this);
+			controlManager->RegisterInputProvider(this);
+			ResetSession();
+			break;
+		}
+
+		case ConsoleNotificationType::StateLoaded:
+		case ConsoleNotificationType::GameReset:
+			ResetSession();
+			break;
+
+		default:
+			break;
+	}
+}
@@ -0,0 +1,161 @@
+#pragma once
+#include "stdafx.h"
+#include "INotificationListener.h"
+#include "IInputProvider.h"
+#include "ControlDeviceState.h"
+#include "BaseControlDevice.h"
+#include "../Utilities/SimpleLock.h"
+#include "../Utilities/AutoResetEvent.h"
+
+class Console;
+class IRollbackSender;
+
+struct RollbackStatistics
+{
+	uint32_t RollbackCount;
+	uint32_t RolledBackFrames; //Number of frames that were run again after a misprediction
+	uint32_t MaxRollbackDepth;
+	uint32_t StallCount; //Number of frames that were delayed because the remote players' input was too far behind
+	uint32_t CheckedHashCount;
+	uint32_t DesyncCount;
+};
+
+//Input used by each port on a frame - sent to clients along with the save state when they (re)synchronize with the server
+struct RollbackSyncState
+{
+	uint32_t Frame = 0;
+	ControlDeviceState Inputs[BaseControlDevice::PortCount];
+	bool Confirmed[BaseControlDevice::PortCount] = {};
+};
+
+enum class StateHashCheck
+{
+	Pending,
+	Match,
+	Desync
+};
+
+//Netplay rollback mode (the server and all clients run the emulation):
+//-The local players' input is used as soon as it is polled, and sent to the other players by the netplay threads
+//-The remote players' input is predicted (by repeating their last known input) until it is received
+//-A snapshot is saved every frame, right after the input is polled. When the input received for a frame doesn't
+// match the prediction, the console loads that frame's snapshot and runs the following frames again (see Console::RunFrameWithRollback)
+//-Once all players' input for a frame is known, the frame's snapshot is hashed - the clients send their hashes to the
+// server, which sends its state again to any client whose hash doesn't match
+//Frame numbers are counted from the start of the server's session and are sent to clients with the save state.
+class RollbackManager : public IInputProvider, public INotificationListener
+{
+public:
+	//Maximum number of frames the emulation can run ahead of the last input received from a remote player
+	static constexpr uint32_t MaxRollbackFrames = 8;
+
+	//Number of frames of input kept for each port (input that the other players haven't acknowledged yet is sent from this history)
+	static constexpr uint32_t InputHistorySize = 64;
+
+private:
+	static constexpr uint32_t InvalidFrame = 0xFFFFFFFF;
+	static constexpr uint32_t SnapshotCount = MaxRollbackFrames + 2;
+	static constexpr uint32_t HashHistorySize = 128;
+
+	struct RollbackInput
+	{
+		uint32_t Frame = InvalidFrame;
+		bool Confirmed = false;
+		ControlDeviceState State;
+	};
+
+	struct RollbackSnapshot
+	{
+		uint32_t Frame = InvalidFrame;
+		uint32_t Size = 0;
+		vector<uint8_t> Data;
+	};
+
+	struct RollbackStateHash
+	{
+		uint32_t Frame = InvalidFrame;
+		uint32_t Hash = 0;
+	};
+
+	Console* _console;
+	IRollbackSender* _sender = nullptr;
+	atomic<bool> _enabled;
+
+	//Protects everything below, the remote input is received on the netplay threads
+	SimpleLock _lock;
+	AutoResetEvent _inputReceived;
+
+	uint32_t _frame = 0; //Last frame whose input was polled
+	uint8_t _localPorts = 0;
+	uint8_t _devicePorts = 0;
+
+	RollbackInput _inputs[BaseControlDevice::PortCount][InputHistorySize];
+	uint32_t _confirmedFrame[BaseControlDevice::PortCount] = {};
+	ControlDeviceState _lastConfirmedState[BaseControlDevice::PortCount];
+	ControlDeviceState _localInput[BaseControlDevice::PortCount];
+	bool _hasLocalInput[BaseControlDevice::PortCount] = {};
+
+	bool _rollbackPending = false;
+	uint32_t _rollbackFrame = 0;
+	uint32_t _lastStalledFrame = InvalidFrame;
+
+	RollbackSnapshot _snapshots[SnapshotCount];
+	RollbackStateHash _hashes[HashHistorySize];
+	uint32_t _nextHashFrame = 0;
+
+	RollbackStatistics _stats = {};
+
+	void ClearHistory();
+	void SaveSnapshot(uint32_t frame);
+	void RequestRollback(uint32_t frame);
+	void ConfirmInput(uint8_t port, uint32_t frame, ControlDeviceState &state);
+	void ConfirmPredictedInput(uint8_t port);
+	bool IsRemotePort(uint8_t port);
+
+public:
+	RollbackManager(Console* console);
+
+	void Start(IRollbackSender* sender, uint8_t localPorts);
+	void Stop();
+	bool IsEnabled();
+
+	//Server: all ports that aren't used by clients, clients: the port they control (if any)
+	void SetLocalPorts(uint8_t localPorts);
+
+	//Overrides the input read from the local devices (used by clients and headless consoles)
+	void SetLocalInput(uint8_t port, ControlDeviceState state);
+
+	//Server-side: restarts the session at the current frame (after a state was loaded, etc.)
+	void ResetSession();
+
+	//Server-side, when a client (re)synchronizes: the client's port is considered confirmed up to the current frame (it will send its input for the following frames)
+	RollbackSyncState GetSyncState(uint8_t clientPort);
+
+	//Used by the netplay threads to send the input that the other side hasn't acknowledged yet
+	void GetConfirmedInput(uint8_t port, uint32_t startFrame, vector<ControlDeviceState> &states, uint32_t maxFrames = InputHistorySize);
+	uint32_t GetConfirmedFrame(uint8_t port);
+	uint8_t GetDevicePorts();
+
+	//Client-side, after loading the save state sent by the server
+	void LoadSyncState(RollbackSyncState &syncState);
+
+	//Called by the netplay threads when another player's input is received - returns false if the input was already received
+	bool AddRemoteInput(uint32_t frame, uint8_t port, ControlDeviceState &state);
+
+	//Server-side: compares a client's hash with the server's own hash for the same frame
+	StateHashCheck CheckStateHash(uint32_t frame, uint32_t hash);
+
+	//Used by the emulation thread, between frames
+	uint32_t GetFrame();
+	bool GetRollbackFrame(uint32_t &frame);
+	bool LoadFrame(uint32_t frame);
+	void SaveFrame();
+	bool IsStalled();
+	void WaitForInput();
+	void UpdateStateHashes();
+
+	RollbackStatistics GetStatistics();
+
+	bool SetInput(BaseControlDevice *device) override;
+	void ProcessNotification(ConsoleNotificationType type, void* parameter) override;
+};
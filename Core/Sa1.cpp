@@ -451,8 +451,13 @@ void Sa1::WriteSa1(uint32_t addr, uint8_t value, MemoryOperationType type)
 uint8_t Sa1::ReadSa1(uint32_t addr, MemoryOperationType type)
 {
 	IMemoryHandler *handler = _mappings.GetHandler(addr);
+	uint8_t* page = _mappings.GetDirectReadPage(addr);
 	uint8_t value;
-	if(handler) {
+	if(page) {
+		value = page[addr & 0xFFF];
+		_lastAccessMemType = handler->GetMemoryType();
+		_openBus = value;
+	} else if(handler) {
 		value = handler->Read(addr);
 		_lastAccessMemType = handler->GetMemoryType();
 		_openBus = value;
@@ -13,6 +13,7 @@
 #include "EventType.h"
 #include "Debugger.h"
 #include "GameClient.h"
+#include "NotificationManager.h"
 #include "Ppu.h"
 #include "DefaultVideoFilter.h"
 
@@ -157,7 +158,7 @@ bool SaveStateManager::GetScreenshotData(vector<uint8_t>& out, uint32_t &width,
 
 bool SaveStateManager::LoadState(istream &stream, bool hashCheckRequired)
 {
-	if(GameClient::Connected()) {
+	if(_console->GetGameClient()->Connected()) {
 		MessageManager::DisplayMessage("Netplay", "NetplayNotAllowed");
 		return false;
 	}
@@ -196,7 +197,7 @@ bool SaveStateManager::LoadState(istream &stream, bool hashCheckRequired)
 				uint32_t width = 0;
 				uint32_t height = 0;
 				if(GetScreenshotData(frameData, width, height, stream)) {
-					_console->GetVideoDecoder()->UpdateFrameSync((uint16_t*)frameData.data(), width, height, 0, true);
+					_console->GetVideoDecoder()->UpdateFrame((uint16_t*)frameData.data(), width, height, 0, true);
 				}
 				#endif
 			}
@@ -262,6 +263,77 @@ bool SaveStateManager::LoadState(int stateIndex)
 	return false;
 }
 
+uint32_t SaveStateManager::GetMemoryStateSize()
+{
+	vector<uint8_t> buffer;
+	return MemoryStateHeaderSize + _console->SaveSnapshot(buffer) + MemoryStateReserve;
+}
+
+bool SaveStateManager::SaveStateToMemory(uint8_t* data, uint32_t size)
+{
+	if(size < MemoryStateHeaderSize) {
+		return false;
+	}
+
+	uint32_t formatVersion = SaveStateManager::FileFormatVersion;
+	bool isGameboyMode = _console->GetSettings()->CheckFlag(EmulationFlags::GameboyMode);
+	memcpy(data, "MSR", 3);
+	memcpy(data + 3, &formatVersion, sizeof(uint32_t));
+	memcpy(data + 3 + sizeof(uint32_t), &isGameboyMode, sizeof(bool));
+
+	uint32_t stateSize;
+	try {
+		stateSize = _console->SaveSnapshot(data + MemoryStateHeaderSize, size - MemoryStateHeaderSize);
+	} catch(std::exception &ex) {
+		MessageManager::Log(string("[Save State] Could not save state: ") + ex.what());
+		return false;
+	}
+
+	//Clear the unused part of the buffer, the content of the buffer only depends on the emulation state
+	uint32_t usedSize = MemoryStateHeaderSize + stateSize;
+	memset(data + usedSize, 0, size - usedSize);
+	return true;
+}
+
+bool SaveStateManager::LoadStateFromMemory(const uint8_t* data, uint32_t size)
+{
+	if(size >= 3 && memcmp(data, "MSS", 3) == 0) {
+		//Regular (compressed) save state
+		std::stringstream ss;
+		ss.write((const char*)data, size);
+		return LoadState(ss);
+	}
+
+	if(size < MemoryStateHeaderSize || memcmp(data, "MSR", 3) != 0) {
+		MessageManager::DisplayMessage("SaveStates", "SaveStateInvalidFile");
+		return false;
+	}
+
+	uint32_t formatVersion;
+	bool isGameboyMode;
+	memcpy(&formatVersion, data + 3, sizeof(uint32_t));
+	memcpy(&isGameboyMode, data + 3 + sizeof(uint32_t), sizeof(bool));
+
+	if(formatVersion != SaveStateManager::FileFormatVersion) {
+		//Memory states are not meant to be kept across versions
+		MessageManager::DisplayMessage("SaveStates", "SaveStateIncompatibleVersion");
+		return false;
+	} else if(isGameboyMode != _console->GetSettings()->CheckFlag(EmulationFlags::GameboyMode)) {
+		MessageManager::DisplayMessage("SaveStates", isGameboyMode ? "SaveStateWrongSystemGb" : "SaveStateWrongSystemSnes");
+		return false;
+	} else if(_console->GetGameClient()->Connected()) {
+		MessageManager::DisplayMessage("Netplay", "NetplayNotAllowed");
+		return false;
+	}
+
+	_console->GetMovieManager()->Stop();
+
+	//The state is read in place, without copying it
+	_console->LoadSnapshot((uint8_t*)data + MemoryStateHeaderSize, size - MemoryStateHeaderSize);
+	_console->GetNotificationManager()->SendNotification(ConsoleNotificationType::StateLoaded);
+	return true;
+}
+
 void SaveStateManager::SaveRecentGame(string romName, string romPath, string patchPath)
 {
 #ifndef LIBRETRO
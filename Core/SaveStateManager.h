@@ -8,6 +8,12 @@ class SaveStateManager
 private:
 	static constexpr uint32_t MaxIndex = 10;
 
+	//"MSR" + format version + gameboy mode flag
+	static constexpr uint32_t MemoryStateHeaderSize = 3 + sizeof(uint32_t) + sizeof(bool);
+
+	//Room left for the parts of the state that can change size after the game is loaded (e.g controller states)
+	static constexpr uint32_t MemoryStateReserve = 0x100;
+
 	atomic<uint32_t> _lastIndex;
 	shared_ptr<Console> _console;
 
@@ -32,6 +38,11 @@ public:
 	bool LoadState(string filepath, bool hashCheckRequired = true);
 	bool LoadState(int stateIndex);
 
+	//Uncompressed states saved to/loaded from a caller-owned buffer (used by libretro for run-ahead, rewind and netplay)
+	uint32_t GetMemoryStateSize();
+	bool SaveStateToMemory(uint8_t* data, uint32_t size);
+	bool LoadStateFromMemory(const uint8_t* data, uint32_t size);
+
 	void SaveRecentGame(string romName, string romPath, string patchPath);
 	void LoadRecentGame(string filename, bool resetGame);
 
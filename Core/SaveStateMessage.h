@@ -5,6 +5,7 @@
 #include "EmuSettings.h"
 #include "CheatManager.h"
 #include "SaveStateManager.h"
+#include "RollbackManager.h"
 
 class SaveStateMessage : public NetMessage
 {
@@ -18,6 +19,10 @@ private:
 	uint32_t _ppuExtraScanlinesBeforeNmi;
 	uint32_t _gsuClockSpeed;
 
+	//Rollback mode only
+	uint32_t _syncId = 0;
+	RollbackSyncState _syncState;
+
 protected:
 	void Serialize(Serializer &s) override
 	{
@@ -25,6 +30,12 @@ protected:
 		s.Stream(_region, _ppuExtraScanlinesAfterNmi, _ppuExtraScanlinesBeforeNmi, _gsuClockSpeed);
 		s.StreamArray(_controllerTypes, 5);
 		s.StreamVector(_activeCheats);
+
+		s.Stream(_syncId, _syncState.Frame);
+		for(int i = 0; i < BaseControlDevice::PortCount; i++) {
+			s.StreamVector(_syncState.Inputs[i].State);
+		}
+		s.StreamArray(_syncState.Confirmed, BaseControlDevice::PortCount);
 	}
 
 public:
@@ -56,6 +67,22 @@ public:
 		state.read((char*)_stateData.data(), dataSize);
 	}
 	
+	void SetSyncState(uint32_t syncId, RollbackSyncState &syncState)
+	{
+		_syncId = syncId;
+		_syncState = syncState;
+	}
+
+	uint32_t GetSyncId()
+	{
+		return _syncId;
+	}
+
+	RollbackSyncState& GetSyncState()
+	{
+		return _syncState;
+	}
+
 	void LoadState(shared_ptr<Console> console)
 	{
 		std::stringstream ss;
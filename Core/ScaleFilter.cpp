@@ -4,13 +4,16 @@
 #include "../Utilities/HQX/hqx.h"
 #include "../Utilities/Scale2x/scalebit.h"
 #include "../Utilities/KreedSaiEagle/SaiEagle.h"
+#include "../Utilities/Timer.h"
+#include "../Utilities/CRC32.h"
 
 bool ScaleFilter::_hqxInitDone = false;
 
-ScaleFilter::ScaleFilter(ScaleFilterType scaleFilterType, uint32_t scale)
+ScaleFilter::ScaleFilter(ScaleFilterType scaleFilterType, uint32_t scale, uint32_t threadCount)
 {
 	_scaleFilterType = scaleFilterType;
 	_filterScale = scale;
+	_workerPool.reset(new WorkerPool(threadCount == 0 ? GetDefaultThreadCount() : threadCount));
 
 	if(!_hqxInitDone && _scaleFilterType == ScaleFilterType::HQX) {
 		hqxInit();
@@ -28,11 +31,23 @@ uint32_t ScaleFilter::GetScale()
 	return _filterScale;
 }
 
-void ScaleFilter::ApplyPrescaleFilter(uint32_t *inputArgbBuffer)
+uint32_t ScaleFilter::GetDefaultThreadCount()
 {
-	uint32_t* outputBuffer = _outputBuffer;
+#ifdef LIBRETRO
+	return 1;
+#else
+	//The emulation, decode and render threads are already busy, only use the remaining cores
+	uint32_t coreCount = std::thread::hardware_concurrency();
+	return std::max<uint32_t>(1, std::min<uint32_t>(coreCount > 2 ? coreCount - 2 : 1, 8));
+#endif
+}
+
+void ScaleFilter::ApplyPrescaleFilter(uint32_t *inputArgbBuffer, uint32_t yFirst, uint32_t yLast)
+{
+	uint32_t* outputBuffer = _outputBuffer + yFirst * _width * _filterScale * _filterScale;
+	inputArgbBuffer += yFirst * _width;
 
-	for(uint32_t y = 0; y < _height; y++) {
+	for(uint32_t y = yFirst; y < yLast; y++) {
 		for(uint32_t x = 0; x < _width; x++) {
 			for(uint32_t i = 0; i < _filterScale; i++) {
 				*(outputBuffer++) = *inputArgbBuffer;
@@ -46,6 +61,22 @@ void ScaleFilter::ApplyPrescaleFilter(uint32_t *inputArgbBuffer)
 	}
 }
 
+void ScaleFilter::ApplyScanlines(uint32_t yFirst, uint32_t yLast, double scanlineIntensity)
+{
+	//Darken the odd rows of the output, between rows yFirst and yLast of the source image
+	int xMax = _width * _filterScale;
+	for(int y = (yFirst * _filterScale) | 1, yMax = yLast * _filterScale; y < yMax; y += 2) {
+		for(int x = 0; x < xMax; x++) {
+			uint32_t &color = _outputBuffer[y*xMax + x];
+			uint8_t r = (color >> 16) & 0xFF, g = (color >> 8) & 0xFF, b = color & 0xFF;
+			r = (uint8_t)(r * scanlineIntensity);
+			g = (uint8_t)(g * scanlineIntensity);
+			b = (uint8_t)(b * scanlineIntensity);
+			color = 0xFF000000 | (r << 16) | (g << 8) | b;
+		}
+	}
+}
+
 void ScaleFilter::UpdateOutputBuffer(uint32_t width, uint32_t height)
 {
 	if(!_outputBuffer || width != _width || height != _height) {
@@ -56,40 +87,49 @@ void ScaleFilter::UpdateOutputBuffer(uint32_t width, uint32_t height)
 	}
 }
 
-uint32_t* ScaleFilter::ApplyFilter(uint32_t *inputArgbBuffer, uint32_t width, uint32_t height, double scanlineIntensity)
+void ScaleFilter::ApplyFilterSlice(uint32_t *inputArgbBuffer, uint32_t yFirst, uint32_t yLast, double scanlineIntensity)
 {
-	UpdateOutputBuffer(width, height);
+	//Each filter reads the rows around the slice from the input, but only writes the slice's own output rows,
+	//so the slices can be processed in parallel and the result matches processing the whole image at once
+	uint32_t width = _width;
+	uint32_t height = _height;
 
 	if(_scaleFilterType == ScaleFilterType::xBRZ) {
-		xbrz::scale(_filterScale, inputArgbBuffer, _outputBuffer, width, height, xbrz::ColorFormat::ARGB);
+		xbrz::scale(_filterScale, inputArgbBuffer, _outputBuffer, width, height, xbrz::ColorFormat::ARGB, xbrz::ScalerCfg(), yFirst, yLast);
 	} else if(_scaleFilterType == ScaleFilterType::HQX) {
-		hqx(_filterScale, inputArgbBuffer, _outputBuffer, width, height);
+		hqx_slice(_filterScale, inputArgbBuffer, _outputBuffer, width, height, yFirst, yLast);
 	} else if(_scaleFilterType == ScaleFilterType::Scale2x) {
-		scale(_filterScale, _outputBuffer, width*sizeof(uint32_t)*_filterScale, inputArgbBuffer, width*sizeof(uint32_t), 4, width, height);
+		scale_slice(_filterScale, _outputBuffer, width*sizeof(uint32_t)*_filterScale, inputArgbBuffer, width*sizeof(uint32_t), 4, width, height, yFirst, yLast);
 	} else if(_scaleFilterType == ScaleFilterType::_2xSai) {
-		twoxsai_generic_xrgb8888(width, height, inputArgbBuffer, width, _outputBuffer, width * _filterScale);
+		twoxsai_generic_xrgb8888(width, height, inputArgbBuffer, width, _outputBuffer, width * _filterScale, yFirst, yLast);
 	} else if(_scaleFilterType == ScaleFilterType::Super2xSai) {
-		supertwoxsai_generic_xrgb8888(width, height, inputArgbBuffer, width, _outputBuffer, width * _filterScale);
+		supertwoxsai_generic_xrgb8888(width, height, inputArgbBuffer, width, _outputBuffer, width * _filterScale, yFirst, yLast);
 	} else if(_scaleFilterType == ScaleFilterType::SuperEagle) {
-		supereagle_generic_xrgb8888(width, height, inputArgbBuffer, width, _outputBuffer, width * _filterScale);
+		supereagle_generic_xrgb8888(width, height, inputArgbBuffer, width, _outputBuffer, width * _filterScale, yFirst, yLast);
 	} else if(_scaleFilterType == ScaleFilterType::Prescale) {
-		ApplyPrescaleFilter(inputArgbBuffer);
+		ApplyPrescaleFilter(inputArgbBuffer, yFirst, yLast);
 	}
 
-	scanlineIntensity = 1.0 - scanlineIntensity;
-
 	if(scanlineIntensity < 1.0) {
-		for(int y = 1, yMax = height * _filterScale; y < yMax; y += 2) {
-			for(int x = 0, xMax = width * _filterScale; x < xMax; x++) {
-				uint32_t &color = _outputBuffer[y*xMax + x];
-				uint8_t r = (color >> 16) & 0xFF, g = (color >> 8) & 0xFF, b = color & 0xFF;
-				r = (uint8_t)(r * scanlineIntensity);
-				g = (uint8_t)(g * scanlineIntensity);
-				b = (uint8_t)(b * scanlineIntensity);
-				color = 0xFF000000 | (r << 16) | (g << 8) | b;
-			}
-		}
+		ApplyScanlines(yFirst, yLast, scanlineIntensity);
 	}
+}
+
+uint32_t* ScaleFilter::ApplyFilter(uint32_t *inputArgbBuffer, uint32_t width, uint32_t height, double scanlineIntensity)
+{
+	UpdateOutputBuffer(width, height);
+
+	scanlineIntensity = 1.0 - scanlineIntensity;
+
+	//Use twice as many bands as threads, to balance the load when some parts of the image are slower to process
+	//(bands need to be at least a few rows tall, otherwise reading the rows around them costs more than it saves)
+	constexpr uint32_t minBandHeight = 16;
+	uint32_t threadCount = _workerPool->GetThreadCount();
+	uint32_t bandCount = threadCount > 1 ? std::max<uint32_t>(1, std::min(threadCount * 2, height / minBandHeight)) : 1;
+
+	_workerPool->Run(bandCount, [=](uint32_t band) {
+		ApplyFilterSlice(inputArgbBuffer, height * band / bandCount, height * (band + 1) / bandCount, scanlineIntensity);
+	});
 
 	return _outputBuffer;
 }
@@ -133,4 +173,171 @@ FrameInfo ScaleFilter::GetFrameInfo(FrameInfo baseFrameInfo)
 	info.Height *= this->GetScale();
 	info.Width *= this->GetScale();
 	return info;
-}
\ No newline at end of file
+}
+
+string ScaleFilter::RunBenchmark(uint32_t frameCount, uint32_t maxThreadCount)
+{
+	struct BenchmarkFilter
+	{
+		const char* Name;
+		ScaleFilterType Type;
+		uint32_t Scale;
+	};
+
+	BenchmarkFilter filters[] = {
+		{ "xBRZ", ScaleFilterType::xBRZ, 2 }, { "xBRZ", ScaleFilterType::xBRZ, 3 }, { "xBRZ", ScaleFilterType::xBRZ, 4 },
+		{ "xBRZ", ScaleFilterType::xBRZ, 5 }, { "xBRZ", ScaleFilterType::xBRZ, 6 },
+		{ "HQX", ScaleFilterType::HQX, 2 }, { "HQX", ScaleFilterType::HQX, 3 }, { "HQX", ScaleFilterType::HQX, 4 },
+		{ "Scale2x", ScaleFilterType::Scale2x, 2 }, { "Scale2x", ScaleFilterType::Scale2x, 3 }, { "Scale2x", ScaleFilterType::Scale2x, 4 },
+		{ "2xSai", ScaleFilterType::_2xSai, 2 }, { "Super2xSai", ScaleFilterType::Super2xSai, 2 }, { "SuperEagle", ScaleFilterType::SuperEagle, 2 }
+	};
+
+	//Build a 256x239 frame that looks like typical SNES output: 8x8 tiles, each using a few colors from a small palette
+	constexpr uint32_t width = 256;
+	constexpr uint32_t height = 239;
+	vector<uint32_t> frame(width * height);
+	uint32_t seed = 0x12345678;
+	auto random = [&seed]() {
+		seed = seed * 1103515245 + 12345;
+		return (seed >> 8) & 0xFFFF;
+	};
+	uint32_t palette[32];
+	for(int i = 0; i < 32; i++) {
+		palette[i] = 0xFF000000 | (random() << 8) | (random() & 0xFF);
+	}
+	for(uint32_t tileY = 0; tileY < height; tileY += 8) {
+		for(uint32_t tileX = 0; tileX < width; tileX += 8) {
+			uint32_t colorOffset = random() & 0x1C;
+			for(uint32_t y = tileY; y < std::min(tileY + 8, height); y++) {
+				for(uint32_t x = tileX; x < tileX + 8; x++) {
+					frame[y * width + x] = palette[colorOffset + ((random() & 0x07) < 5 ? 0 : (random() & 0x03))];
+				}
+			}
+		}
+	}
+
+	if(!_hqxInitDone) {
+		hqxInit();
+		_hqxInitDone = true;
+	}
+
+	std::stringstream ss;
+	ss << "Filter\tScale";
+	for(uint32_t threads = 1; threads <= maxThreadCount; threads++) {
+		ss << "\t" << threads << " thread" << (threads > 1 ? "s" : "");
+	}
+	ss << " (ms/frame)" << std::endl;
+
+	for(BenchmarkFilter &filter : filters) {
+		ss << filter.Name << "\t" << filter.Scale << "x";
+		for(uint32_t threads = 1; threads <= maxThreadCount; threads++) {
+			ScaleFilter scaleFilter(filter.Type, filter.Scale, threads);
+
+			//Run one frame before starting the timer, to allocate the output buffer
+			scaleFilter.ApplyFilter(frame.data(), width, height, 0);
+
+			Timer timer;
+			for(uint32_t i = 0; i < frameCount; i++) {
+				scaleFilter.ApplyFilter(frame.data(), width, height, 0);
+			}
+			ss << "\t" << std::fixed << std::setprecision(3) << (timer.GetElapsedMS() / frameCount);
+		}
+		ss << std::endl;
+	}
+
+	return ss.str();
+}
+
+bool ScaleFilter::RunTests(string &report)
+{
+	//Checks that splitting the image in bands (processed by any number of threads) produces the same output as
+	//each filter's own entry point processing the whole image at once
+	constexpr uint32_t width = 64;
+	constexpr uint32_t height = 61;
+	uint32_t input[width * height];
+	uint32_t seed = 0x87654321;
+	for(uint32_t i = 0; i < width * height; i++) {
+		seed = seed * 1103515245 + 12345;
+		input[i] = 0xFF000000 | (((seed >> 16) & 0x03) * 0x3F4A21);
+	}
+
+	//CRC32 of the output of the 2xSaI filters (for the image above), before they could process a range of rows
+	constexpr uint32_t saiCrc[3] = { 0xBEC9DABE, 0xF3F9E63A, 0x538A0650 };
+	const char* filterNames[] = { "xBRZ", "HQX", "Scale2x", "2xSai", "Super2xSai", "SuperEagle", "Prescale" };
+
+	if(!_hqxInitDone) {
+		hqxInit();
+		_hqxInitDone = true;
+	}
+
+	std::stringstream ss;
+	ss << "{" << std::endl << "\t\"tests\": [";
+
+	bool passed = true;
+	bool firstTest = true;
+	for(int type = (int)ScaleFilterType::xBRZ; type <= (int)ScaleFilterType::Prescale; type++) {
+		for(uint32_t scale = 2; scale <= 6; scale++) {
+			ScaleFilterType filterType = (ScaleFilterType)type;
+			if((filterType == ScaleFilterType::HQX || filterType == ScaleFilterType::Scale2x) && scale > 4) {
+				continue;
+			} else if((filterType == ScaleFilterType::_2xSai || filterType == ScaleFilterType::Super2xSai || filterType == ScaleFilterType::SuperEagle) && scale > 2) {
+				continue;
+			}
+
+			uint32_t outputSize = width * height * scale * scale;
+			vector<uint32_t> expected(outputSize);
+			bool referenceMatches = true;
+			switch(filterType) {
+				case ScaleFilterType::xBRZ: xbrz::scale(scale, input, expected.data(), width, height, xbrz::ColorFormat::ARGB); break;
+				case ScaleFilterType::HQX: hqx(scale, input, expected.data(), width, height); break;
+				case ScaleFilterType::Scale2x: ::scale(scale, expected.data(), width*sizeof(uint32_t)*scale, input, width*sizeof(uint32_t), 4, width, height); break;
+				case ScaleFilterType::_2xSai: twoxsai_generic_xrgb8888(width, height, input, width, expected.data(), width * scale, 0, height); break;
+				case ScaleFilterType::Super2xSai: supertwoxsai_generic_xrgb8888(width, height, input, width, expected.data(), width * scale, 0, height); break;
+				case ScaleFilterType::SuperEagle: supereagle_generic_xrgb8888(width, height, input, width, expected.data(), width * scale, 0, height); break;
+
+				case ScaleFilterType::Prescale:
+					//Each pixel is repeated to fill a scale x scale square
+					for(uint32_t y = 0; y < height * scale; y++) {
+						for(uint32_t x = 0; x < width * scale; x++) {
+							expected[y * width * scale + x] = input[(y / scale) * width + x / scale];
+						}
+					}
+					break;
+			}
+
+			if(filterType == ScaleFilterType::_2xSai || filterType == ScaleFilterType::Super2xSai || filterType == ScaleFilterType::SuperEagle) {
+				uint32_t crc = saiCrc[type - (int)ScaleFilterType::_2xSai];
+				referenceMatches = CRC32::GetCRC((uint8_t*)expected.data(), outputSize * sizeof(uint32_t)) == crc;
+			}
+
+			bool bandsMatch = true;
+			for(uint32_t threads = 1; threads <= 4; threads++) {
+				ScaleFilter filter(filterType, scale, threads);
+				uint32_t bandCount = threads * 3;
+				filter.UpdateOutputBuffer(width, height);
+				for(uint32_t band = 0; band < bandCount; band++) {
+					filter.ApplyFilterSlice(input, height * band / bandCount, height * (band + 1) / bandCount, 1.0);
+				}
+				bandsMatch &= memcmp(expected.data(), filter._outputBuffer, outputSize * sizeof(uint32_t)) == 0;
+				bandsMatch &= memcmp(expected.data(), filter.ApplyFilter(input, width, height, 0), outputSize * sizeof(uint32_t)) == 0;
+
+				//Scanlines are applied to each band separately
+				ScaleFilter singleThread(filterType, scale, 1);
+				uint32_t* singleThreadOutput = singleThread.ApplyFilter(input, width, height, 0.4);
+				bandsMatch &= memcmp(singleThreadOutput, filter.ApplyFilter(input, width, height, 0.4), outputSize * sizeof(uint32_t)) == 0;
+			}
+
+			bool testPassed = referenceMatches && bandsMatch;
+			passed &= testPassed;
+
+			ss << (firstTest ? "" : ",") << std::endl << "\t\t{ \"filter\": \"" << filterNames[type] << "\", \"scale\": " << scale;
+			ss << ", \"referenceMatches\": " << (referenceMatches ? "true" : "false") << ", \"bandsMatch\": " << (bandsMatch ? "true" : "false");
+			ss << ", \"passed\": " << (testPassed ? "true" : "false") << " }";
+			firstTest = false;
+		}
+	}
+
+	ss << std::endl << "\t]," << std::endl << "\t\"passed\": " << (passed ? "true" : "false") << std::endl << "}" << std::endl;
+	report = ss.str();
+	return passed;
+}
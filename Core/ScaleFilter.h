@@ -2,6 +2,7 @@
 
 #include "stdafx.h"
 #include "DefaultVideoFilter.h"
+#include "../Utilities/WorkerPool.h"
 
 class ScaleFilter
 {
@@ -12,12 +13,16 @@ private:
 	uint32_t *_outputBuffer = nullptr;
 	uint32_t _width = 0;
 	uint32_t _height = 0;
+	unique_ptr<WorkerPool> _workerPool;
 
-	void ApplyPrescaleFilter(uint32_t *inputArgbBuffer);
+	void ApplyPrescaleFilter(uint32_t *inputArgbBuffer, uint32_t yFirst, uint32_t yLast);
+	void ApplyScanlines(uint32_t yFirst, uint32_t yLast, double scanlineIntensity);
+	void ApplyFilterSlice(uint32_t *inputArgbBuffer, uint32_t yFirst, uint32_t yLast, double scanlineIntensity);
 	void UpdateOutputBuffer(uint32_t width, uint32_t height);
 
 public:
-	ScaleFilter(ScaleFilterType scaleFilterType, uint32_t scale);
+	//threadCount: number of threads used to process the bands of the image (0 = automatic)
+	ScaleFilter(ScaleFilterType scaleFilterType, uint32_t scale, uint32_t threadCount = 0);
 	~ScaleFilter();
 
 	uint32_t GetScale();
@@ -25,4 +30,12 @@ public:
 	FrameInfo GetFrameInfo(FrameInfo baseFrameInfo);
 
 	static shared_ptr<ScaleFilter> GetScaleFilter(VideoFilterType filter);
-};
\ No newline at end of file
+	static uint32_t GetDefaultThreadCount();
+
+	//Returns a report of the average time (ms/frame) taken by each filter & scale, for 1 to maxThreadCount threads
+	static string RunBenchmark(uint32_t frameCount, uint32_t maxThreadCount);
+
+	//Checks that the output is the same no matter how many threads/bands are used, and that it matches each filter's own entry point
+	//Returns true when all tests passed, report contains the result of each filter & scale (JSON)
+	static bool RunTests(string &report);
+};
@@ -16,7 +16,7 @@ int ScriptHost::GetScriptId()
 	return _scriptId;
 }
 
-const char* ScriptHost::GetLog()
+string ScriptHost::GetLog()
 {
 	shared_ptr<ScriptingContext> context = _context;
 	return context ? context->GetLog() : "";
@@ -69,3 +69,10 @@ bool ScriptHost::CheckStateLoadedFlag()
 	}
 	return false;
 }
+
+void ScriptHost::AddMemoryCallbackPages(MemoryCallbackPageMap &pageMap)
+{
+	if(_context) {
+		_context->AddMemoryCallbackPages(pageMap);
+	}
+}
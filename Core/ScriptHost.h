@@ -5,6 +5,7 @@
 
 class ScriptingContext;
 class Debugger;
+class MemoryCallbackPageMap;
 
 class ScriptHost
 {
@@ -16,7 +17,7 @@ public:
 	ScriptHost(int scriptId);
 
 	int GetScriptId();
-	const char* GetLog();
+	string GetLog();
 
 	bool LoadScript(string scriptName, string scriptContent, Debugger* debugger);
 
@@ -25,4 +26,6 @@ public:
 	bool ProcessSavestate();
 
 	bool CheckStateLoadedFlag();
+
+	void AddMemoryCallbackPages(MemoryCallbackPageMap &pageMap);
 };
\ No newline at end of file
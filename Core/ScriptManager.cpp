@@ -24,6 +24,7 @@ int ScriptManager::LoadScript(string name, string content, int32_t scriptId)
 		script->LoadScript(name, content, _debugger);
 		_scripts.push_back(script);
 		_hasScript = true;
+		RefreshMemoryCallbackPages();
 		return script->GetScriptId();
 	} else {
 		auto result = std::find_if(_scripts.begin(), _scripts.end(), [=](shared_ptr<ScriptHost> &script) {
@@ -34,6 +35,7 @@ int ScriptManager::LoadScript(string name, string content, int32_t scriptId)
 			(*result)->ProcessEvent(EventType::ScriptEnded);
 
 			(*result)->LoadScript(name, content, _debugger);
+			RefreshMemoryCallbackPages();
 			return scriptId;
 		}
 	}
@@ -55,9 +57,10 @@ void ScriptManager::RemoveScript(int32_t scriptId)
 		return false;
 	}), _scripts.end());
 	_hasScript = _scripts.size() > 0;
+	RefreshMemoryCallbackPages();
 }
 
-const char* ScriptManager::GetScriptLog(int32_t scriptId)
+string ScriptManager::GetScriptLog(int32_t scriptId)
 {
 	auto lock = _scriptLock.AcquireSafe();
 	for(shared_ptr<ScriptHost> &script : _scripts) {
@@ -85,3 +88,12 @@ void ScriptManager::ProcessMemoryOperation(uint32_t address, uint8_t &value, Mem
 		}
 	}
 }
+
+void ScriptManager::RefreshMemoryCallbackPages()
+{
+	_callbackPages.Clear();
+	for(shared_ptr<ScriptHost> &script : _scripts) {
+		script->AddMemoryCallbackPages(_callbackPages);
+	}
+	_hasMemoryCallback = !_callbackPages.IsEmpty();
+}
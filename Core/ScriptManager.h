@@ -3,16 +3,68 @@
 #include "../Utilities/SimpleLock.h"
 #include "EventType.h"
 #include "DebugTypes.h"
+#include "CpuTypes.h"
+#include "ScriptingContext.h"
 
 class Debugger;
 class ScriptHost;
-enum class MemoryOperationType;
+
+//Bitmaps of the pages that are covered by at least one memory callback, for each callback type and CPU type
+//Memory operations outside of these pages can skip the scripts entirely with a single bit test
+class MemoryCallbackPageMap
+{
+private:
+	static constexpr int PageShift = 8;
+	static constexpr uint32_t MaxAddress = 0xFFFFFF;
+
+	vector<uint64_t> _pages[3][(int)CpuType::Gameboy + 1];
+	bool _empty = true;
+
+public:
+	void Clear()
+	{
+		for(int i = 0; i < 3; i++) {
+			for(int j = 0; j <= (int)CpuType::Gameboy; j++) {
+				_pages[i][j].clear();
+			}
+		}
+		_empty = true;
+	}
+
+	void Add(CallbackType type, CpuType cpuType, uint32_t startAddr, uint32_t endAddr)
+	{
+		uint32_t startPage = std::min(startAddr, (uint32_t)MaxAddress) >> PageShift;
+		uint32_t endPage = std::min(endAddr, (uint32_t)MaxAddress) >> PageShift;
+		vector<uint64_t> &pages = _pages[(int)type][(int)cpuType];
+		if(pages.size() <= (endPage >> 6)) {
+			pages.resize((endPage >> 6) + 1, 0);
+		}
+		for(uint32_t page = startPage; page <= endPage; page++) {
+			pages[page >> 6] |= (uint64_t)1 << (page & 0x3F);
+		}
+		_empty = false;
+	}
+
+	bool IsEmpty()
+	{
+		return _empty;
+	}
+
+	__forceinline bool Contains(CallbackType type, CpuType cpuType, uint32_t addr)
+	{
+		vector<uint64_t> &pages = _pages[(int)type][(int)cpuType];
+		uint32_t page = addr >> PageShift;
+		return (page >> 6) < pages.size() && (pages[page >> 6] & ((uint64_t)1 << (page & 0x3F)));
+	}
+};
 
 class ScriptManager
 {
 private:
 	Debugger *_debugger;
 	bool _hasScript;
+	bool _hasMemoryCallback = false;
+	MemoryCallbackPageMap _callbackPages;
 	SimpleLock _scriptLock;
 	int _nextScriptId;
 	vector<shared_ptr<ScriptHost>> _scripts;
@@ -21,9 +73,17 @@ public:
 	ScriptManager(Debugger *debugger);
 
 	__forceinline bool HasScript() { return _hasScript; }
+
+	__forceinline bool HasMemoryCallback(uint32_t address, MemoryOperationType type, CpuType cpuType)
+	{
+		//Read, Write and ExecOpCode have the same values as the matching CallbackType, other operations never trigger callbacks
+		return _hasMemoryCallback && type <= MemoryOperationType::ExecOpCode && _callbackPages.Contains((CallbackType)type, cpuType, address);
+	}
+
 	int32_t LoadScript(string name, string content, int32_t scriptId);
 	void RemoveScript(int32_t scriptId);
-	const char* GetScriptLog(int32_t scriptId);
+	string GetScriptLog(int32_t scriptId);
 	void ProcessEvent(EventType type);
 	void ProcessMemoryOperation(uint32_t address, uint8_t &value, MemoryOperationType type, CpuType cpuType);
+	void RefreshMemoryCallbackPages();
 };
\ No newline at end of file
@@ -3,11 +3,10 @@
 #include "ScriptingContext.h"
 #include "DebugTypes.h"
 #include "Debugger.h"
+#include "ScriptManager.h"
 #include "Console.h"
 #include "SaveStateManager.h"
 
-string ScriptingContext::_log = "";
-
 ScriptingContext::ScriptingContext(Debugger *debugger)
 {
 	_debugger = debugger;
@@ -22,15 +21,14 @@ void ScriptingContext::Log(string message)
 	}
 }
 
-const char* ScriptingContext::GetLog()
+string ScriptingContext::GetLog()
 {
 	auto lock = _logLock.AcquireSafe();
 	stringstream ss;
 	for(string &msg : _logRows) {
 		ss << msg << "\n";
 	}
-	_log = ss.str();
-	return _log.c_str();
+	return ss.str();
 }
 
 Debugger* ScriptingContext::GetDebugger()
@@ -45,6 +43,14 @@ string ScriptingContext::GetScriptName()
 
 void ScriptingContext::CallMemoryCallback(uint32_t addr, uint8_t &value, CallbackType type, CpuType cpuType)
 {
+	for(BatchedMemoryCallback &callback : _batchedCallbacks[(int)type]) {
+		if(callback.Type == cpuType && addr >= callback.StartAddress && addr <= callback.EndAddress) {
+			BatchedMemoryAccess &access = callback.Accesses[addr];
+			access.Count++;
+			access.Value = value;
+		}
+	}
+
 	_inExecOpEvent = type == CallbackType::CpuExec;
 	InternalCallMemoryCallback(addr, value, type, cpuType);
 	_inExecOpEvent = false;
@@ -52,6 +58,11 @@ void ScriptingContext::CallMemoryCallback(uint32_t addr, uint8_t &value, Callbac
 
 int ScriptingContext::CallEventCallback(EventType type)
 {
+	if(type == EventType::EndFrame) {
+		//Send the accesses recorded during the frame before the EndFrame callbacks are called
+		FlushBatchedMemoryCallbacks();
+	}
+
 	_inStartFrameEvent = type == EventType::StartFrame;
 	int returnValue = InternalCallEventCallback(type);
 	_inStartFrameEvent = false;
@@ -81,7 +92,24 @@ bool ScriptingContext::CheckStateLoadedFlag()
 	return stateLoaded;
 }
 
-void ScriptingContext::RegisterMemoryCallback(CallbackType type, int startAddr, int endAddr, CpuType cpuType, int reference)
+void ScriptingContext::FlushBatchedMemoryCallbacks()
+{
+	for(int i = (int)CallbackType::CpuRead; i <= (int)CallbackType::CpuExec; i++) {
+		for(size_t j = 0; j < _batchedCallbacks[i].size(); j++) {
+			if(_batchedCallbacks[i][j].Accesses.empty()) {
+				continue;
+			}
+
+			//Take the accesses out of the list first, the script can add or remove callbacks while it runs
+			BatchedMemoryCallback callback;
+			(MemoryCallback&)callback = _batchedCallbacks[i][j];
+			callback.Accesses.swap(_batchedCallbacks[i][j].Accesses);
+			InternalCallBatchedMemoryCallback(callback);
+		}
+	}
+}
+
+void ScriptingContext::RegisterMemoryCallback(CallbackType type, int startAddr, int endAddr, CpuType cpuType, int reference, bool batched)
 {
 	if(endAddr < startAddr) {
 		return;
@@ -96,7 +124,14 @@ void ScriptingContext::RegisterMemoryCallback(CallbackType type, int startAddr,
 	callback.EndAddress = (uint32_t)endAddr;
 	callback.Reference = reference;
 	callback.Type = cpuType;
-	_callbacks[(int)type].push_back(callback);
+	if(batched) {
+		BatchedMemoryCallback batchedCallback;
+		(MemoryCallback&)batchedCallback = callback;
+		_batchedCallbacks[(int)type].push_back(batchedCallback);
+	} else {
+		_callbacks[(int)type].push_back(callback);
+	}
+	RefreshMemoryCallbackPages();
 }
 
 void ScriptingContext::UnregisterMemoryCallback(CallbackType type, int startAddr, int endAddr, CpuType cpuType, int reference)
@@ -116,6 +151,32 @@ void ScriptingContext::UnregisterMemoryCallback(CallbackType type, int startAddr
 			break;
 		}
 	}
+
+	for(size_t i = 0; i < _batchedCallbacks[(int)type].size(); i++) {
+		BatchedMemoryCallback &callback = _batchedCallbacks[(int)type][i];
+		if(callback.Reference == reference && callback.Type == cpuType && (int)callback.StartAddress == startAddr && (int)callback.EndAddress == endAddr) {
+			_batchedCallbacks[(int)type].erase(_batchedCallbacks[(int)type].begin() + i);
+			break;
+		}
+	}
+	RefreshMemoryCallbackPages();
+}
+
+void ScriptingContext::AddMemoryCallbackPages(MemoryCallbackPageMap &pageMap)
+{
+	for(int i = (int)CallbackType::CpuRead; i <= (int)CallbackType::CpuExec; i++) {
+		for(MemoryCallback &callback : _callbacks[i]) {
+			pageMap.Add((CallbackType)i, callback.Type, callback.StartAddress, callback.EndAddress);
+		}
+		for(BatchedMemoryCallback &callback : _batchedCallbacks[i]) {
+			pageMap.Add((CallbackType)i, callback.Type, callback.StartAddress, callback.EndAddress);
+		}
+	}
+}
+
+void ScriptingContext::RefreshMemoryCallbackPages()
+{
+	_debugger->GetScriptManager()->RefreshMemoryCallbackPages();
 }
 
 void ScriptingContext::RegisterEventCallback(EventType type, int reference)
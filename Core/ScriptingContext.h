@@ -22,13 +22,23 @@ struct MemoryCallback
 	int Reference;
 };
 
+struct BatchedMemoryAccess
+{
+	uint32_t Count;
+	uint8_t Value;
+};
+
+//Callback that is called once per frame with the accesses that occurred in its range since the previous call
+struct BatchedMemoryCallback : MemoryCallback
+{
+	std::unordered_map<uint32_t, BatchedMemoryAccess> Accesses;
+};
+
+class MemoryCallbackPageMap;
+
 class ScriptingContext
 {
 private:
-	//Must be static to be thread-safe when switching game
-	//UI updates all script windows in a single thread, so this is safe
-	static string _log;
-
 	std::deque<string> _logRows;
 	SimpleLock _logLock;
 	bool _inStartFrameEvent = false;
@@ -46,18 +56,23 @@ protected:
 	bool _initDone = false;
 
 	vector<MemoryCallback> _callbacks[3];
+	vector<BatchedMemoryCallback> _batchedCallbacks[3];
 	vector<int> _eventCallbacks[(int)EventType::EventTypeSize];
 
 	virtual void InternalCallMemoryCallback(uint32_t addr, uint8_t &value, CallbackType type, CpuType cpuType) = 0;
+	virtual void InternalCallBatchedMemoryCallback(BatchedMemoryCallback &callback) = 0;
 	virtual int InternalCallEventCallback(EventType type) = 0;
 
+	void FlushBatchedMemoryCallbacks();
+	void RefreshMemoryCallbackPages();
+
 public:
 	ScriptingContext(Debugger* debugger);
 	virtual ~ScriptingContext() {}
 	virtual bool LoadScript(string scriptName, string scriptContent, Debugger* debugger) = 0;
 
 	void Log(string message);
-	const char* GetLog();
+	string GetLog();
 
 	Debugger* GetDebugger();
 	string GetScriptName();
@@ -78,8 +93,10 @@ public:
 	bool CheckInExecOpEvent();
 	bool CheckStateLoadedFlag();
 	
-	void RegisterMemoryCallback(CallbackType type, int startAddr, int endAddr, CpuType cpuType, int reference);
+	void RegisterMemoryCallback(CallbackType type, int startAddr, int endAddr, CpuType cpuType, int reference, bool batched = false);
 	virtual void UnregisterMemoryCallback(CallbackType type, int startAddr, int endAddr, CpuType cpuType, int reference);
 	void RegisterEventCallback(EventType type, int reference);
 	virtual void UnregisterEventCallback(EventType type, int reference);
+
+	void AddMemoryCallbackPages(MemoryCallbackPageMap &pageMap);
 };
@@ -307,6 +307,9 @@ struct EmulationConfig
 	int64_t BsxCustomDate = -1;
 
 	bool AllowInvalidInput = false;
+
+	//Skips the iterations of the CPU's polling loops (see IdleLoopDetector)
+	bool EnableIdleLoopSkip = false;
 };
 
 struct GameboyConfig
@@ -339,6 +342,7 @@ struct PreferencesConfig
 	bool DisableGameSelectionScreen = false;
 
 	uint32_t RewindBufferSize = 30;
+	uint32_t RewindVideoBufferSize = 64;
 
 	const char* SaveFolderOverride = nullptr;
 	const char* SaveStateFolderOverride = nullptr;
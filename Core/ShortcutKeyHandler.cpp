@@ -63,7 +63,7 @@ bool ShortcutKeyHandler::IsKeyPressed(KeyCombination comb)
 
 bool ShortcutKeyHandler::IsKeyPressed(uint32_t keyCode)
 {
-	return KeyManager::IsKeyPressed(keyCode);
+	return _console->GetSettings()->IsInputEnabled() && KeyManager::IsKeyPressed(keyCode);
 }
 
 bool ShortcutKeyHandler::DetectKeyPress(EmulatorShortcut shortcut)
@@ -104,7 +104,7 @@ void ShortcutKeyHandler::ProcessRunSingleFrame()
 void ShortcutKeyHandler::CheckMappedKeys()
 {
 	shared_ptr<EmuSettings> settings = _console->GetSettings();
-	bool isNetplayClient = GameClient::Connected();
+	bool isNetplayClient = _console->GetGameClient()->Connected();
 	bool isMovieActive = _console->GetMovieManager()->Playing() || _console->GetMovieManager()->Recording();
 	bool isMovieRecording = _console->GetMovieManager()->Recording();
 
@@ -29,8 +29,8 @@ protected:
 
 	void InternalSetStateFromInput() override
 	{
-		SetPressedState(Buttons::Left, KeyManager::IsMouseButtonPressed(MouseButton::LeftButton));
-		SetPressedState(Buttons::Right, KeyManager::IsMouseButtonPressed(MouseButton::RightButton));
+		SetPressedState(Buttons::Left, IsMouseButtonPressed(MouseButton::LeftButton));
+		SetPressedState(Buttons::Right, IsMouseButtonPressed(MouseButton::RightButton));
 		SetMovement(KeyManager::GetMouseMovement(
 			_console->GetSettings()->GetVideoConfig().VideoScale,
 			_console->GetSettings()->GetInputConfig().MouseSensitivity + 1
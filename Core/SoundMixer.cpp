@@ -4,24 +4,28 @@
 #include "EmuSettings.h"
 #include "SoundResampler.h"
 #include "RewindManager.h"
-#include "VideoRenderer.h"
 #include "WaveRecorder.h"
+#include "SoundRecordingStream.h"
 #include "Spc.h"
 #include "Msu1.h"
 #include "BaseCartridge.h"
 #include "SuperGameboy.h"
 #include "../Utilities/Equalizer.h"
+#include "../Utilities/AudioKernels.h"
 
 SoundMixer::SoundMixer(Console *console)
 {
 	_console = console;
 	_audioDevice = nullptr;
 	_resampler.reset(new SoundResampler(console));
+	_recordingStream.reset(new SoundRecordingStream(console));
+	_mixBuffer = new int16_t[0x10000];
 	_sampleBuffer = new int16_t[0x10000];
 }
 
 SoundMixer::~SoundMixer()
 {
+	delete[] _mixBuffer;
 	delete[] _sampleBuffer;
 }
 
@@ -72,35 +76,30 @@ void SoundMixer::PlayAudioBuffer(int16_t* samples, uint32_t sampleCount, uint32_
 	_leftSample = samples[0];
 	_rightSample = samples[1];
 
-	int16_t *out = _sampleBuffer;
-	uint32_t count = _resampler->Resample(samples, sampleCount, sourceRate, cfg.SampleRate, out);
+	//The SPC's output is resampled to the selected sample rate, and the SGB/MSU-1 audio is mixed into it once per frame (it consumes emulated state)
+	//This mix is sent to the recordings as is, and resampled again for the speakers, whose rate is adjusted to keep the latency stable
+	int16_t *mix = _mixBuffer;
+	uint32_t mixCount = _resampler->Resample(samples, sampleCount, sourceRate, cfg.SampleRate, mix);
 
 	SuperGameboy* sgb = _console->GetCartridge()->GetSuperGameboy();
 	if(sgb) {
-		uint32_t targetRate = (uint32_t)(cfg.SampleRate * _resampler->GetRateAdjustment());
-		sgb->MixAudio(targetRate, out, count);
+		sgb->MixAudio(cfg.SampleRate, mix, mixCount);
 	}
 
 	shared_ptr<Msu1> msu1 = _console->GetMsu1();
 	if(msu1) {
-		msu1->MixAudio(out, count, cfg.SampleRate);
+		msu1->MixAudio(mix, mixCount, cfg.SampleRate);
 	}
 	
 	if(masterVolume < 100) {
 		//Apply volume if not using the default value
-		for(uint32_t i = 0; i < count * 2; i++) {
-			out[i] = (int32_t)out[i] * (int32_t)masterVolume / 100;
-		}
+		AudioKernels::ApplyVolume(mix, mixCount * 2, masterVolume, 100);
 	}
 
 	shared_ptr<RewindManager> rewindManager = _console->GetRewindManager();
-	if(!_console->IsRunAheadFrame() && rewindManager && rewindManager->SendAudio(out, count)) {
-		bool isRecording = _waveRecorder || _console->GetVideoRenderer()->IsRecording();
-		if(isRecording) {
-			if(_waveRecorder) {
-				_waveRecorder->WriteSamples(out, count, cfg.SampleRate, true);
-			}
-			_console->GetVideoRenderer()->AddRecordingSound(out, count, cfg.SampleRate);
+	if(!_console->IsRunAheadFrame() && rewindManager && rewindManager->SendAudio(mix, mixCount)) {
+		if(_recordingStream->IsActive()) {
+			_recordingStream->AddSamples(mix, mixCount, cfg.SampleRate);
 		}
 
 		if(_audioDevice) {
@@ -109,6 +108,8 @@ void SoundMixer::PlayAudioBuffer(int16_t* samples, uint32_t sampleCount, uint32_
 				return;
 			}
 
+			int16_t *out = _sampleBuffer;
+			uint32_t count = _resampler->ResampleForSpeakers(mix, mixCount, cfg.SampleRate, out);
 			_audioDevice->PlayBuffer(out, count, cfg.SampleRate, true);
 			_audioDevice->ProcessEndOfFrame();
 		}
@@ -138,17 +139,22 @@ double SoundMixer::GetRateAdjustment()
 
 void SoundMixer::StartRecording(string filepath)
 {
-	_waveRecorder.reset(new WaveRecorder(filepath, _console->GetSettings()->GetAudioConfig().SampleRate, true));
+	_recordingStream->SetWaveRecorder(shared_ptr<WaveRecorder>(new WaveRecorder(filepath, _console->GetSettings()->GetAudioConfig().SampleRate, true)));
 }
 
 void SoundMixer::StopRecording()
 {
-	_waveRecorder.reset();
+	_recordingStream->SetWaveRecorder(nullptr);
 }
 
 bool SoundMixer::IsRecording()
 {
-	return _waveRecorder.get() != nullptr;
+	return _recordingStream->IsWaveRecording();
+}
+
+void SoundMixer::FlushRecordingSamples()
+{
+	_recordingStream->Flush();
 }
 
 void SoundMixer::GetLastSamples(int16_t &left, int16_t &right)
@@ -5,7 +5,7 @@
 class Console;
 class Equalizer;
 class SoundResampler;
-class WaveRecorder;
+class SoundRecordingStream;
 
 class SoundMixer 
 {
@@ -14,8 +14,9 @@ private:
 	Console *_console;
 	unique_ptr<Equalizer> _equalizer;
 	unique_ptr<SoundResampler> _resampler;
-	shared_ptr<WaveRecorder> _waveRecorder;
-	int16_t *_sampleBuffer = nullptr;
+	unique_ptr<SoundRecordingStream> _recordingStream;
+	int16_t *_mixBuffer = nullptr; //At the selected sample rate (sent to the recordings)
+	int16_t *_sampleBuffer = nullptr; //At the speakers' adjusted rate
 
 	int16_t _leftSample = 0;
 	int16_t _rightSample = 0;
@@ -36,5 +37,6 @@ public:
 	void StartRecording(string filepath);
 	void StopRecording();
 	bool IsRecording();
+	void FlushRecordingSamples();
 	void GetLastSamples(int16_t &left, int16_t &right);
 };
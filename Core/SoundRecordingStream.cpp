@@ -0,0 +1,94 @@
+#include "stdafx.h"
+#include "SoundRecordingStream.h"
+#include "Console.h"
+#include "VideoRenderer.h"
+#include "WaveRecorder.h"
+#include "MessageManager.h"
+
+SoundRecordingStream::SoundRecordingStream(Console* console)
+{
+	_console = console;
+	_sampleRate = 0;
+	_stopFlag = false;
+	_waveRecording = false;
+
+	_buffer.Reset(BufferSize);
+}
+
+SoundRecordingStream::~SoundRecordingStream()
+{
+	if(_thread.joinable()) {
+		_stopFlag = true;
+		_signal.Signal();
+		_thread.join();
+	}
+
+	SetWaveRecorder(nullptr);
+}
+
+bool SoundRecordingStream::IsActive()
+{
+	return _waveRecording || _console->GetVideoRenderer()->IsRecording();
+}
+
+void SoundRecordingStream::AddSamples(int16_t* samples, uint32_t sampleCount, uint32_t sampleRate)
+{
+	if(!_thread.joinable()) {
+		//Started by the emulation thread (the only thread that calls AddSamples) when the first recording starts
+		_thread = std::thread([this]() {
+			while(!_stopFlag) {
+				_signal.Wait();
+
+				auto lock = _lock.AcquireSafe();
+				WriteSamples();
+			}
+		});
+	}
+
+	_sampleRate = sampleRate;
+	if(_buffer.Write(samples, sampleCount * 2) < sampleCount * 2 && _buffer.GetOverrunCount() == 1) {
+		//Only logged the first time, the worker thread can't keep up with the emulation (e.g the disk is too slow)
+		MessageManager::Log("[Audio] Recording buffer is full, samples were dropped");
+	}
+	_signal.Signal();
+}
+
+void SoundRecordingStream::WriteSamples()
+{
+	//Must be called with the lock held
+	uint32_t sampleRate = _sampleRate;
+	int16_t samples[0x2000];
+
+	uint32_t count;
+	while((count = std::min<uint32_t>(_buffer.GetAvailableCount(), 0x2000)) > 0) {
+		_buffer.Read(samples, count);
+
+		if(_waveRecorder) {
+			_waveRecorder->WriteSamples(samples, count / 2, sampleRate, true);
+		}
+
+		shared_ptr<VideoRenderer> videoRenderer = _console->GetVideoRenderer();
+		if(videoRenderer) {
+			videoRenderer->AddRecordingSound(samples, count / 2, sampleRate);
+		}
+	}
+}
+
+void SoundRecordingStream::Flush()
+{
+	auto lock = _lock.AcquireSafe();
+	WriteSamples();
+}
+
+void SoundRecordingStream::SetWaveRecorder(shared_ptr<WaveRecorder> recorder)
+{
+	auto lock = _lock.AcquireSafe();
+	WriteSamples();
+	_waveRecorder = recorder;
+	_waveRecording = recorder != nullptr;
+}
+
+bool SoundRecordingStream::IsWaveRecording()
+{
+	return _waveRecording;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include "stdafx.h"
+#include "../Utilities/SpscRingBuffer.h"
+#include "../Utilities/AutoResetEvent.h"
+#include "../Utilities/SimpleLock.h"
+
+class Console;
+class WaveRecorder;
+
+//Audio sent to the WAV and AVI recorders, at the sample rate selected in the options (SoundMixer sends the mix before the
+//adjustments made to the speakers' rate). The samples are queued in a ring buffer, and written to the recorders by a worker
+//thread (the emulation thread never waits on disk I/O) - the thread is only started once a recording is active.
+class SoundRecordingStream
+{
+private:
+	static constexpr uint32_t BufferSize = 0x40000;
+
+	Console* _console;
+
+	//Written by the emulation thread, read by the worker thread
+	SpscRingBuffer<int16_t> _buffer;
+	atomic<uint32_t> _sampleRate;
+
+	std::thread _thread;
+	AutoResetEvent _signal;
+	atomic<bool> _stopFlag;
+
+	//Protects the recorder and the buffer's consumer side (the worker thread, or a thread flushing the buffer)
+	SimpleLock _lock;
+	shared_ptr<WaveRecorder> _waveRecorder;
+	atomic<bool> _waveRecording;
+
+	void WriteSamples();
+
+public:
+	SoundRecordingStream(Console* console);
+	~SoundRecordingStream();
+
+	//Emulation thread: returns true when the samples are needed (a WAV or AVI recording is active)
+	bool IsActive();
+
+	//Emulation thread: queues the samples (at the selected sample rate)
+	void AddSamples(int16_t* samples, uint32_t sampleCount, uint32_t sampleRate);
+
+	//Writes the queued samples to the recorders (before a recording is stopped)
+	void Flush();
+
+	//Writes the queued samples to the previous recorder (if any) before replacing it
+	void SetWaveRecorder(shared_ptr<WaveRecorder> recorder);
+	bool IsWaveRecording();
+};
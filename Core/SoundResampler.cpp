@@ -4,7 +4,6 @@
 #include "Spc.h"
 #include "EmuSettings.h"
 #include "SoundMixer.h"
-#include "VideoRenderer.h"
 #include "../Utilities/HermiteResampler.h"
 
 SoundResampler::SoundResampler(Console *console)
@@ -24,10 +23,8 @@ double SoundResampler::GetRateAdjustment()
 double SoundResampler::GetTargetRateAdjustment()
 {
 	AudioConfig cfg = _console->GetSettings()->GetAudioConfig();
-	bool isRecording = _console->GetSoundMixer()->IsRecording() || _console->GetVideoRenderer()->IsRecording();
-	if(!isRecording && !cfg.DisableDynamicSampleRate) {
-		//Don't deviate from selected sample rate while recording
-		//TODO: Have 2 output streams (one for recording, one for the speakers)
+	if(!cfg.DisableDynamicSampleRate) {
+		//Recordings aren't affected, they are recorded before this adjustment is applied (see SoundMixer)
 		AudioStatistics stats = _console->GetSoundMixer()->GetStatistics();
 
 		if(stats.AverageLatency > 0 && _console->GetSettings()->GetEmulationSpeed() == 100) {
@@ -35,7 +32,8 @@ double SoundResampler::GetTargetRateAdjustment()
 			constexpr int32_t maxGap = 3;
 			constexpr int32_t maxSubAdjustment = 3600;
 
-			int32_t requestedLatency = (int32_t)cfg.AudioLatency;
+			//The device can ask for more than the requested latency, if it can't keep up with it (see AudioLatencyController)
+			double requestedLatency = stats.TargetLatency > 0 ? stats.TargetLatency : cfg.AudioLatency;
 			double latencyGap = stats.AverageLatency - requestedLatency;
 			double adjustment = std::min(0.0025, (std::ceil((std::abs(latencyGap) - maxGap) * 8)) * 0.00003125);
 
@@ -70,7 +68,7 @@ double SoundResampler::GetTargetRateAdjustment()
 	return _rateAdjustment;
 }
 
-void SoundResampler::UpdateTargetSampleRate(uint32_t sourceRate, uint32_t sampleRate)
+uint32_t SoundResampler::Resample(int16_t *inSamples, uint32_t sampleCount, uint32_t sourceRate, uint32_t sampleRate, int16_t *outSamples)
 {
 	double spcSampleRate = sourceRate;
 	if(_console->GetSettings()->GetVideoConfig().IntegerFpsMode) {
@@ -82,16 +80,20 @@ void SoundResampler::UpdateTargetSampleRate(uint32_t sourceRate, uint32_t sample
 		}
 	}
 
-	double targetRate = sampleRate * GetTargetRateAdjustment();
-	if(targetRate != _previousTargetRate || spcSampleRate != _prevSpcSampleRate) {
-		_previousTargetRate = targetRate;
+	if(spcSampleRate != _prevSpcSampleRate || sampleRate != _prevSampleRate) {
 		_prevSpcSampleRate = spcSampleRate;
-		_resampler.SetSampleRates(spcSampleRate, targetRate);
+		_prevSampleRate = sampleRate;
+		_resampler.SetSampleRates(spcSampleRate, sampleRate);
 	}
+	return _resampler.Resample(inSamples, sampleCount, outSamples);
 }
 
-uint32_t SoundResampler::Resample(int16_t *inSamples, uint32_t sampleCount, uint32_t sourceRate, uint32_t sampleRate, int16_t *outSamples)
+uint32_t SoundResampler::ResampleForSpeakers(int16_t *inSamples, uint32_t sampleCount, uint32_t sampleRate, int16_t *outSamples)
 {
-	UpdateTargetSampleRate(sourceRate, sampleRate);
-	return _resampler.Resample(inSamples, sampleCount, outSamples);
-}
\ No newline at end of file
+	double targetRate = sampleRate * GetTargetRateAdjustment();
+	if(targetRate != _previousTargetRate) {
+		_previousTargetRate = targetRate;
+		_speakerResampler.SetSampleRates(sampleRate, targetRate);
+	}
+	return _speakerResampler.Resample(inSamples, sampleCount, outSamples);
+}
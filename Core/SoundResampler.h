@@ -12,12 +12,13 @@ private:
 	double _rateAdjustment = 1.0;
 	double _previousTargetRate = 0;
 	double _prevSpcSampleRate = 0;
+	uint32_t _prevSampleRate = 0;
 	int32_t _underTarget = 0;
 
 	HermiteResampler _resampler;
+	HermiteResampler _speakerResampler;
 
 	double GetTargetRateAdjustment();
-	void UpdateTargetSampleRate(uint32_t sourceRate, uint32_t sampleRate);
 
 public:
 	SoundResampler(Console *console);
@@ -25,5 +26,9 @@ public:
 
 	double GetRateAdjustment();
 
+	//Resamples the SPC's output to the selected sample rate (the rate used by the recordings)
 	uint32_t Resample(int16_t *inSamples, uint32_t sampleCount, uint32_t sourceRate, uint32_t sampleRate, int16_t *outSamples);
+
+	//Resamples the output of Resample to the speakers' rate, which is adjusted to keep the audio latency stable (exact copy when it isn't adjusted)
+	uint32_t ResampleForSpeakers(int16_t *inSamples, uint32_t sampleCount, uint32_t sampleRate, int16_t *outSamples);
 };
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "MemoryManager.h"
 #include "SoundMixer.h"
 #include "EmuSettings.h"
+#include "SubsystemProfiler.h"
 #include "SpcFileData.h"
 #ifndef DUMMYSPC
 #include "SPC_DSP.h"
@@ -18,6 +19,7 @@ Spc::Spc(Console* console)
 {
 	_console = console;
 	_memoryManager = console->GetMemoryManager().get();
+	_profiler = console->GetSubsystemProfiler().get();
 	_soundBuffer = new int16_t[Spc::SampleBufferSize];
 
 	_ram = new uint8_t[Spc::SpcRamSize];
@@ -351,6 +353,8 @@ void Spc::Run()
 		return;
 	}
 
+	SubsystemScope scope(_profiler, HostSubsystem::Spc);
+
 	uint64_t targetCycle = (uint64_t)(_memoryManager->GetMasterClock() * _clockRatio);
 	while(_state.Cycle < targetCycle) {
 		ProcessCycle();
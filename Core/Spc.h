@@ -15,6 +15,7 @@ class Console;
 class MemoryManager;
 class SpcFileData;
 class SPC_DSP;
+class SubsystemProfiler;
 struct AddressInfo;
 
 class Spc : public ISerializable
@@ -30,6 +31,7 @@ private:
 
 	Console* _console;
 	MemoryManager* _memoryManager;
+	SubsystemProfiler* _profiler;
 	unique_ptr<SPC_DSP> _dsp;
 
 	double _clockRatio;
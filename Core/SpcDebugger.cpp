@@ -52,10 +52,8 @@ void SpcDebugger::ProcessRead(uint16_t addr, uint8_t value, MemoryOperationType
 			_disassembler->BuildCache(addressInfo, 0, CpuType::Spc);
 
 			if(_traceLogger->IsCpuLogged(CpuType::Spc)) {
-				_debugger->GetState(_debugState, true);
-
 				DisassemblyInfo disInfo = _disassembler->GetDisassemblyInfo(addressInfo, addr, 0, CpuType::Spc);
-				_traceLogger->Log(CpuType::Spc, _debugState, disInfo);
+				_traceLogger->Log(spcState, disInfo);
 			}
 		}
 
@@ -30,7 +30,6 @@ class SpcDebugger final : public IDebugger
 	uint8_t _prevOpCode = 0xFF;
 	uint32_t _prevProgramCounter = 0;
 	
-	DebugState _debugState;
 
 public:
 	SpcDebugger(Debugger* debugger);
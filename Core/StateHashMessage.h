@@ -0,0 +1,48 @@
+#pragma once
+#include "stdafx.h"
+#include "NetMessage.h"
+
+//Hash of a client's state at the start of a frame (rollback mode), compared with the server's own state to detect desyncs
+class StateHashMessage : public NetMessage
+{
+private:
+	uint32_t _syncId = 0;
+	uint32_t _frame = 0;
+	uint32_t _hash = 0;
+
+protected:
+	void Serialize(Serializer &s) override
+	{
+		s.Stream(_syncId, _frame, _hash);
+	}
+
+	bool IsCompressed() override
+	{
+		return false;
+	}
+
+public:
+	StateHashMessage(void* buffer, uint32_t length) : NetMessage(buffer, length) { }
+
+	StateHashMessage(uint32_t syncId, uint32_t frame, uint32_t hash) : NetMessage(MessageType::StateHash)
+	{
+		_syncId = syncId;
+		_frame = frame;
+		_hash = hash;
+	}
+
+	uint32_t GetSyncId()
+	{
+		return _syncId;
+	}
+
+	uint32_t GetFrame()
+	{
+		return _frame;
+	}
+
+	uint32_t GetHash()
+	{
+		return _hash;
+	}
+};
@@ -0,0 +1,112 @@
+#include "stdafx.h"
+#include <chrono>
+#include "SubsystemProfiler.h"
+
+SubsystemProfiler::SubsystemProfiler()
+{
+	_enabled = false;
+	for(int i = 0; i < HostSubsystemCount; i++) {
+		_asyncTicks[i] = 0;
+	}
+}
+
+uint64_t SubsystemProfiler::GetTime()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char* SubsystemProfiler::GetSubsystemName(HostSubsystem subsystem)
+{
+	static const char* names[HostSubsystemCount] = { "cpu", "dma", "ppu", "spc", "sa1", "gsu", "cx4", "coprocessor", "videoFilter", "idle" };
+	return names[(int)subsystem];
+}
+
+double SubsystemProfiler::GetNanosecondsPerTick()
+{
+#ifdef SUBSYSTEMPROFILER_RDTSC
+	//The TSC's frequency is calibrated against the steady clock, over the time elapsed since the last reset
+	uint64_t elapsedTicks = GetTicks() - _resetTicks;
+	uint64_t elapsedTime = GetTime() - _resetTime;
+	return elapsedTicks > 0 ? (double)elapsedTime / elapsedTicks : 1.0;
+#else
+	return 1.0;
+#endif
+}
+
+void SubsystemProfiler::SetEnabled(bool enabled)
+{
+	if(!IsAvailable()) {
+		return;
+	}
+
+	//Can be called by the UI thread - the counters are reset before the emulation thread sees the flag (release/acquire)
+	if(enabled && !_enabled.load(std::memory_order_acquire)) {
+		Reset();
+	}
+	_enabled.store(enabled, std::memory_order_release);
+}
+
+void SubsystemProfiler::Reset()
+{
+	auto lock = _statsLock.AcquireSafe();
+
+	_frameCount = 0;
+	memset(_frameTicks, 0, sizeof(_frameTicks));
+	memset(_totalTicks, 0, sizeof(_totalTicks));
+	memset(_lastFrameTicks, 0, sizeof(_lastFrameTicks));
+	memset(_maxFrameTicks, 0, sizeof(_maxFrameTicks));
+	for(int i = 0; i < HostSubsystemCount; i++) {
+		_asyncTicks[i] = 0;
+	}
+
+	_resetTime = GetTime();
+	_resetTicks = GetTicks();
+	_lastTicks = _resetTicks;
+}
+
+void SubsystemProfiler::EndFrame()
+{
+	if(!_enabled.load(std::memory_order_acquire)) {
+		return;
+	}
+
+	Switch(_current);
+
+	auto lock = _statsLock.AcquireSafe();
+	for(int i = 0; i < HostSubsystemCount; i++) {
+		uint64_t ticks = _frameTicks[i] + _asyncTicks[i].exchange(0);
+		_lastFrameTicks[i] = ticks;
+		_maxFrameTicks[i] = std::max(_maxFrameTicks[i], ticks);
+		_totalTicks[i] += ticks;
+		_frameTicks[i] = 0;
+	}
+	_frameCount++;
+}
+
+void SubsystemProfiler::AddAsyncTime(HostSubsystem subsystem, uint64_t startTicks)
+{
+	if(_enabled.load(std::memory_order_acquire)) {
+		_asyncTicks[(int)subsystem] += GetTicks() - startTicks;
+	}
+}
+
+uint64_t SubsystemProfiler::GetTotalTime(HostSubsystem subsystem)
+{
+	auto lock = _statsLock.AcquireSafe();
+	return (uint64_t)(_totalTicks[(int)subsystem] * GetNanosecondsPerTick());
+}
+
+SubsystemProfilerStats SubsystemProfiler::GetStats()
+{
+	SubsystemProfilerStats stats = {};
+
+	auto lock = _statsLock.AcquireSafe();
+	double usPerTick = GetNanosecondsPerTick() / 1000;
+	stats.FrameCount = _frameCount;
+	for(int i = 0; i < HostSubsystemCount; i++) {
+		stats.TotalTime[i] = _totalTicks[i] * usPerTick;
+		stats.LastFrameTime[i] = _lastFrameTicks[i] * usPerTick;
+		stats.MaxFrameTime[i] = _maxFrameTicks[i] * usPerTick;
+	}
+	return stats;
+}
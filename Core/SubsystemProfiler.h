@@ -0,0 +1,155 @@
+#pragma once
+#include "stdafx.h"
+#include "../Utilities/SimpleLock.h"
+
+//The profiler is compiled out by default (scopes are empty), build with SUBSYSTEMPROFILER defined to enable it
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	#include <intrin.h>
+	#define SUBSYSTEMPROFILER_RDTSC
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	#include <x86intrin.h>
+	#define SUBSYSTEMPROFILER_RDTSC
+#endif
+
+enum class HostSubsystem
+{
+	Cpu = 0, //Everything that isn't attributed to another subsystem (CPU, memory mappings, input, etc.)
+	Dma,
+	Ppu,
+	Spc,
+	Sa1,
+	Gsu,
+	Cx4,
+	Coprocessor, //All other coprocessors (DSP-n, ST01x, SGB, etc.)
+	VideoFilter,
+	Idle //Frame limiter
+};
+
+static constexpr int HostSubsystemCount = (int)HostSubsystem::Idle + 1;
+
+struct SubsystemProfilerStats
+{
+	uint32_t FrameCount;
+
+	//Host time spent in each subsystem (in microseconds), indexed by HostSubsystem
+	double TotalTime[HostSubsystemCount];
+	double LastFrameTime[HostSubsystemCount];
+	double MaxFrameTime[HostSubsystemCount];
+};
+
+//Measures the host time spent emulating each chip, aggregated per frame. Only used on the emulation thread (except for
+//AddAsyncTime, SetEnabled and the stats getters), and does nothing unless enabled. Time is attributed to the subsystem that was entered last, e.g PPU
+//rendering triggered by a CPU write counts as PPU time. Timestamps are TSC ticks where available.
+class SubsystemProfiler
+{
+private:
+	atomic<bool> _enabled;
+	HostSubsystem _current = HostSubsystem::Cpu;
+	uint64_t _lastTicks = 0;
+	uint64_t _frameTicks[HostSubsystemCount] = {};
+	atomic<uint64_t> _asyncTicks[HostSubsystemCount];
+
+	uint64_t _resetTicks = 0;
+	uint64_t _resetTime = 0;
+
+	SimpleLock _statsLock;
+	uint32_t _frameCount = 0;
+	uint64_t _totalTicks[HostSubsystemCount] = {};
+	uint64_t _lastFrameTicks[HostSubsystemCount] = {};
+	uint64_t _maxFrameTicks[HostSubsystemCount] = {};
+
+	static uint64_t GetTime();
+	double GetNanosecondsPerTick();
+
+	__forceinline void Switch(HostSubsystem subsystem)
+	{
+		uint64_t ticks = GetTicks();
+		_frameTicks[(int)_current] += ticks - _lastTicks;
+		_lastTicks = ticks;
+		_current = subsystem;
+	}
+
+public:
+	SubsystemProfiler();
+
+	__forceinline static uint64_t GetTicks()
+	{
+#ifdef SUBSYSTEMPROFILER_RDTSC
+		return __rdtsc();
+#else
+		return GetTime();
+#endif
+	}
+
+	static constexpr bool IsAvailable()
+	{
+#ifdef SUBSYSTEMPROFILER
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	static const char* GetSubsystemName(HostSubsystem subsystem);
+
+	void SetEnabled(bool enabled);
+	bool IsEnabled() { return _enabled.load(std::memory_order_acquire); }
+
+	//Clears the counters, the time spent from this point on is attributed to the current subsystem
+	void Reset();
+
+	//Called by the emulation thread at the end of each frame, to update the per-frame stats
+	void EndFrame();
+
+	//Adds time spent by another thread (e.g the video decoder's) to the current frame - startTicks is a GetTicks() value
+	void AddAsyncTime(HostSubsystem subsystem, uint64_t startTicks);
+
+	//Total time (in nanoseconds) spent in the subsystem, over all frames completed since the last reset
+	uint64_t GetTotalTime(HostSubsystem subsystem);
+
+	SubsystemProfilerStats GetStats();
+
+	__forceinline HostSubsystem Enter(HostSubsystem subsystem)
+	{
+		HostSubsystem previous = _current;
+#ifdef SUBSYSTEMPROFILER
+		if(_enabled.load(std::memory_order_acquire)) {
+			Switch(subsystem);
+		}
+#endif
+		return previous;
+	}
+
+	__forceinline void Leave(HostSubsystem previous)
+	{
+#ifdef SUBSYSTEMPROFILER
+		if(_enabled.load(std::memory_order_acquire)) {
+			Switch(previous);
+		}
+#endif
+	}
+};
+
+class SubsystemScope
+{
+#ifdef SUBSYSTEMPROFILER
+private:
+	SubsystemProfiler* _profiler;
+	HostSubsystem _previous;
+
+public:
+	__forceinline SubsystemScope(SubsystemProfiler* profiler, HostSubsystem subsystem)
+	{
+		_profiler = profiler;
+		_previous = profiler->Enter(subsystem);
+	}
+
+	__forceinline ~SubsystemScope()
+	{
+		_profiler->Leave(_previous);
+	}
+#else
+public:
+	__forceinline SubsystemScope(SubsystemProfiler*, HostSubsystem) {}
+#endif
+};
@@ -11,6 +11,7 @@
 #include "MessageManager.h"
 #include "../Utilities/HexUtilities.h"
 #include "../Utilities/HermiteResampler.h"
+#include "../Utilities/AudioKernels.h"
 
 SuperGameboy::SuperGameboy(Console* console) : BaseCoprocessor(SnesMemoryType::Register)
 {
@@ -276,9 +277,7 @@ void SuperGameboy::MixAudio(uint32_t targetRate, int16_t* soundSamples, uint32_t
 
 	int32_t copyCount = (int32_t)std::min(_mixSampleCount, sampleCount*2);
 	if(!_spc->IsMuted()) {
-		for(int32_t i = 0; i < copyCount; i++) {
-			soundSamples[i] += _mixBuffer[i];
-		}
+		AudioKernels::MixSamples(soundSamples, _mixBuffer, (uint32_t)copyCount);
 	}
 
 	int32_t remainingSamples = (int32_t)_mixSampleCount - copyCount;
@@ -26,11 +26,11 @@ protected:
 
 	void InternalSetStateFromInput() override
 	{
-		SetPressedState(Buttons::Fire, KeyManager::IsMouseButtonPressed(MouseButton::LeftButton));
-		SetPressedState(Buttons::Cursor, KeyManager::IsMouseButtonPressed(MouseButton::RightButton));
-		SetPressedState(Buttons::Turbo, KeyManager::IsMouseButtonPressed(MouseButton::MiddleButton));
+		SetPressedState(Buttons::Fire, IsMouseButtonPressed(MouseButton::LeftButton));
+		SetPressedState(Buttons::Cursor, IsMouseButtonPressed(MouseButton::RightButton));
+		SetPressedState(Buttons::Turbo, IsMouseButtonPressed(MouseButton::MiddleButton));
 		for(KeyMapping keyMapping : _keyMappings) {
-			SetPressedState(Buttons::Pause, KeyManager::IsKeyPressed(keyMapping.Start));
+			SetPressedState(Buttons::Pause, IsKeyPressed(keyMapping.Start));
 		}
 
 		MousePosition pos = KeyManager::GetMousePosition();
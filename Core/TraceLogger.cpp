@@ -12,9 +12,13 @@
 #include "CpuTypes.h"
 #include "SpcTypes.h"
 #include "NecDspTypes.h"
+#include "Ppu.h"
+#include "BaseCartridge.h"
+#include "Gameboy.h"
+#include "GbPpu.h"
 #include "../Utilities/HexUtilities.h"
 
-string TraceLogger::_executionTrace = "";
+constexpr char TraceLogger::BinaryLogSignature[4];
 
 TraceLogger::TraceLogger(Debugger* debugger, shared_ptr<Console> console)
 {
@@ -22,30 +26,29 @@ TraceLogger::TraceLogger(Debugger* debugger, shared_ptr<Console> console)
 	_settings = console->GetSettings().get();
 	_labelManager = debugger->GetLabelManager().get();
 	_memoryDumper = debugger->GetMemoryDumper().get();
+	_ppu = console->GetPpu().get();
+	_memoryManager = console->GetMemoryManager().get();
+	Gameboy* gameboy = console->GetCartridge()->GetGameboy();
+	_gbPpu = gameboy ? gameboy->GetPpu() : nullptr;
 	_options = {};
 	_currentPos = 0;
 	_logCount = 0;
 	_logToFile = false;
-	_pendingLog = false;
+	_binaryLog = false;
+	_fileBufferWritePos = 0;
+	_fileBufferReadPos = 0;
+	_stopWriter = false;
 
-	_stateCache = new DebugState[TraceLogger::ExecutionLogSize];
-	_stateCacheCopy = new DebugState[TraceLogger::ExecutionLogSize];
-	_disassemblyCache = new DisassemblyInfo[TraceLogger::ExecutionLogSize];
-	_disassemblyCacheCopy = new DisassemblyInfo[TraceLogger::ExecutionLogSize];
-	_logCpuType = new CpuType[TraceLogger::ExecutionLogSize];
-	_logCpuTypeCopy = new CpuType[TraceLogger::ExecutionLogSize];
+	_records = new TraceRecord[TraceLogger::ExecutionLogSize];
+	_recordsCopy = new TraceRecord[TraceLogger::ExecutionLogSize];
 }
 
 TraceLogger::~TraceLogger()
 {
 	StopLogging();
 
-	delete[] _stateCache;
-	delete[] _stateCacheCopy;
-	delete[] _disassemblyCache;
-	delete[] _disassemblyCacheCopy;
-	delete[] _logCpuType;
-	delete[] _logCpuTypeCopy;
+	delete[] _records;
+	delete[] _recordsCopy;
 }
 
 template<typename T>
@@ -82,7 +85,8 @@ void TraceLogger::SetOptions(TraceLoggerOptions options)
 	string condition = _options.Condition;
 	string format = _options.Format;
 
-	auto lock = _lock.AcquireSafe();
+	//The log file's writer thread uses the row formats, wait until it's done with the current batch
+	auto lock = _formatLock.AcquireSafe();
 	/*_conditionData = ExpressionData();
 	if(!condition.empty()) {
 		bool success = false;
@@ -98,6 +102,17 @@ void TraceLogger::SetOptions(TraceLoggerOptions options)
 	ParseFormatString(_gsuRowParts, "[PC,6h]   [ByteCode,11h] [Disassembly] [Align,50] SRC:[X,2] DST:[Y,2] R0:[A,2h] H:[Cycle,3] V:[Scanline,3]");
 	ParseFormatString(_cx4RowParts, "[PC,6h]   [ByteCode,11h] [Disassembly] [Align,45] [A,2h] H:[Cycle,3] V:[Scanline,3]");
 	ParseFormatString(_gbRowParts, "[PC,6h]   [ByteCode,11h] [Disassembly] [Align,45] A:[A,2h] B:[B,2h] C:[C,2h] D:[D,2h] E:[E,2h] HL:[H,2h][L,2h] F:[F,2h] SP:[SP,4h] CYC:[Cycle,3] LY:[Scanline,3]");
+
+	//Effective addresses and memory values depend on the state of memory when the instruction runs,
+	//so they need to be read when the instruction is logged (the rest of the row is built by the writer thread)
+	_formatUsesMemoryInfo = false;
+	for(vector<RowPart>* rowParts : { &_rowParts, &_spcRowParts, &_gbRowParts }) {
+		for(RowPart &part : *rowParts) {
+			if(part.DataType == RowDataType::EffectiveAddress || part.DataType == RowDataType::MemoryValue) {
+				_formatUsesMemoryInfo = true;
+			}
+		}
+	}
 }
 
 void TraceLogger::ParseFormatString(vector<RowPart> &rowParts, string format)
@@ -188,36 +203,236 @@ void TraceLogger::ParseFormatString(vector<RowPart> &rowParts, string format)
 	}
 }
 
-void TraceLogger::StartLogging(string filename)
+void TraceLogger::StartLogging(string filename, bool binaryFormat)
 {
-	_outputBuffer.clear();
+	StopLogging();
+
 	_outputFile.open(filename, ios::out | ios::binary);
+	if(!_outputFile) {
+		return;
+	}
+
+	_binaryLog = binaryFormat;
+	if(_binaryLog) {
+		uint32_t header[BinaryLogHeaderSize];
+		GetBinaryLogHeader(header);
+		_outputFile.write(BinaryLogSignature, sizeof(BinaryLogSignature));
+		_outputFile.write((char*)header, sizeof(header));
+	}
+
+	_fileBuffer = new uint8_t[FileBufferSize];
+	_fileBufferWritePos = 0;
+	_fileBufferReadPos = 0;
+	_fileBufferSignalPos = 0;
+	_stopWriter = false;
+	_writerThread.reset(new std::thread(&TraceLogger::WriterThread, this));
+
+	auto lock = _lock.AcquireSafe();
 	_logToFile = true;
 }
 
 void TraceLogger::StopLogging()
 {
 	if(_logToFile) {
-		_logToFile = false;
-		if(_outputFile) {
-			if(!_outputBuffer.empty()) {
-				_outputFile << _outputBuffer;
-			}
-			_outputFile.close();
+		{
+			auto lock = _lock.AcquireSafe();
+			_logToFile = false;
 		}
+
+		//The writer thread empties the buffer before exiting
+		_stopWriter = true;
+		_writerSignal.Signal();
+		_writerThread->join();
+		_writerThread.reset();
+
+		delete[] _fileBuffer;
+		_fileBuffer = nullptr;
+		_outputFile.close();
 	}
 }
 
 void TraceLogger::LogExtraInfo(const char *log, uint32_t cycleCount)
 {
+	auto lock = _lock.AcquireSafe();
 	if(_logToFile && _options.ShowExtraInfo) {
-		//Flush current buffer
-		_outputFile << _outputBuffer;
-		_outputBuffer.clear();
-		_outputFile << "[" << log << " - Cycle: " << std::to_string(cycleCount) << "]" << (_options.UseWindowsEol ? "\r\n" : "\n");
+		string text = string(log) + " - Cycle: " + std::to_string(cycleCount);
+		TraceRecordInfo info = {};
+		info.RecordType = TraceRecordType::ExtraInfo;
+		info.MasterClock = _console->GetMasterClock();
+		info.TextLength = (uint32_t)text.size();
+		PushToFileBuffer(&info, sizeof(info), text.c_str(), (uint32_t)text.size());
 	}
 }
 
+uint32_t TraceLogger::GetStateSize(CpuType cpuType)
+{
+	switch(cpuType) {
+		case CpuType::Cpu: case CpuType::Sa1: return sizeof(CpuState);
+		case CpuType::Spc: return sizeof(SpcState);
+		case CpuType::NecDsp: return sizeof(NecDspState);
+		case CpuType::Gsu: return sizeof(GsuState);
+		case CpuType::Cx4: return sizeof(Cx4State);
+		case CpuType::Gameboy: return sizeof(GbCpuState);
+	}
+	return 0;
+}
+
+void TraceLogger::GetBinaryLogHeader(uint32_t header[BinaryLogHeaderSize])
+{
+	//The records are stored as is, a log can only be read by a build that uses the same format version & struct sizes
+	header[0] = BinaryLogVersion;
+	header[1] = sizeof(TraceRecordInfo);
+	header[2] = GetStateSize(CpuType::Cpu);
+	header[3] = GetStateSize(CpuType::Spc);
+	header[4] = GetStateSize(CpuType::NecDsp);
+	header[5] = GetStateSize(CpuType::Gsu);
+	header[6] = GetStateSize(CpuType::Cx4);
+	header[7] = GetStateSize(CpuType::Gameboy);
+}
+
+void TraceLogger::WriteToFileBuffer(uint32_t pos, const void* data, uint32_t size)
+{
+	uint32_t offset = pos & FileBufferMask;
+	uint32_t firstPart = std::min(size, FileBufferSize - offset);
+	memcpy(_fileBuffer + offset, data, firstPart);
+	memcpy(_fileBuffer, (uint8_t*)data + firstPart, size - firstPart);
+}
+
+void TraceLogger::PushToFileBuffer(const void* header, uint32_t headerSize, const void* data, uint32_t dataSize)
+{
+	uint32_t size = headerSize + dataSize;
+	uint32_t writePos = _fileBufferWritePos.load(std::memory_order_relaxed);
+	while(writePos + size - _fileBufferReadPos.load(std::memory_order_acquire) > FileBufferSize) {
+		//Buffer is full, wait for the writer thread to catch up
+		_writerSignal.Signal();
+		std::this_thread::yield();
+	}
+
+	//Both parts are published at once, the writer thread never sees a partial record
+	WriteToFileBuffer(writePos, header, headerSize);
+	WriteToFileBuffer(writePos + headerSize, data, dataSize);
+	_fileBufferWritePos.store(writePos + size, std::memory_order_release);
+
+	if(writePos + size - _fileBufferSignalPos >= FileBufferSize / 8) {
+		//Wake up the writer thread once in a while (it also wakes up on its own every few milliseconds)
+		_fileBufferSignalPos = writePos + size;
+		_writerSignal.Signal();
+	}
+}
+
+void TraceLogger::ReadFromFileBuffer(uint32_t pos, void* dest, uint32_t size)
+{
+	uint32_t offset = pos & FileBufferMask;
+	uint32_t firstPart = std::min(size, FileBufferSize - offset);
+	memcpy(dest, _fileBuffer + offset, firstPart);
+	memcpy((uint8_t*)dest + firstPart, _fileBuffer, size - firstPart);
+}
+
+void TraceLogger::WriterThread()
+{
+	string textBuffer;
+	while(true) {
+		bool stopping = _stopWriter;
+		uint32_t readPos = _fileBufferReadPos.load(std::memory_order_relaxed);
+		uint32_t writePos = _fileBufferWritePos.load(std::memory_order_acquire);
+		if(readPos != writePos) {
+			WriteFileBuffer(readPos, writePos, textBuffer);
+			_fileBufferReadPos.store(writePos, std::memory_order_release);
+		} else if(stopping) {
+			break;
+		} else {
+			_writerSignal.Wait(20);
+		}
+	}
+}
+
+void TraceLogger::WriteFileBuffer(uint32_t startPos, uint32_t endPos, string &textBuffer)
+{
+	if(_binaryLog) {
+		//The buffer already contains the records in the binary log's format
+		uint32_t offset = startPos & FileBufferMask;
+		uint32_t size = endPos - startPos;
+		uint32_t firstPart = std::min(size, FileBufferSize - offset);
+		_outputFile.write((char*)_fileBuffer + offset, firstPart);
+		_outputFile.write((char*)_fileBuffer, size - firstPart);
+		return;
+	}
+
+	auto lock = _formatLock.AcquireSafe();
+	TraceRecord record;
+	string text;
+	for(uint32_t pos = startPos; pos != endPos;) {
+		ReadFromFileBuffer(pos, &record.Info, sizeof(TraceRecordInfo));
+		pos += sizeof(TraceRecordInfo);
+
+		if(record.Info.RecordType == TraceRecordType::ExtraInfo) {
+			text.resize(record.Info.TextLength);
+			ReadFromFileBuffer(pos, &text[0], (uint32_t)text.size());
+			pos += (uint32_t)text.size();
+			GetExtraInfoRow(textBuffer, text.c_str(), (uint32_t)text.size());
+		} else {
+			uint32_t stateSize = GetStateSize(record.Info.Type);
+			ReadFromFileBuffer(pos, &record.State, stateSize);
+			pos += stateSize;
+			GetTraceRow(textBuffer, record);
+		}
+
+		if(textBuffer.size() > 32768) {
+			_outputFile << textBuffer;
+			textBuffer.clear();
+		}
+	}
+
+	_outputFile << textBuffer;
+	textBuffer.clear();
+}
+
+bool TraceLogger::ConvertBinaryLog(string inputFile, string outputFile)
+{
+	ifstream input(inputFile, ios::in | ios::binary);
+	if(!input) {
+		return false;
+	}
+
+	char signature[4];
+	uint32_t header[BinaryLogHeaderSize];
+	uint32_t expectedHeader[BinaryLogHeaderSize];
+	GetBinaryLogHeader(expectedHeader);
+	input.read(signature, sizeof(signature));
+	input.read((char*)header, sizeof(header));
+	if(!input || memcmp(signature, BinaryLogSignature, sizeof(signature)) != 0 || memcmp(header, expectedHeader, sizeof(header)) != 0) {
+		//Not a binary log, or it was created by a different version (or a build where the records' layout is different)
+		return false;
+	}
+
+	ofstream output(outputFile, ios::out | ios::binary);
+	if(!output) {
+		return false;
+	}
+
+	auto lock = _formatLock.AcquireSafe();
+	TraceRecord record;
+	string text;
+	string outputBuffer;
+	while(input.read((char*)&record.Info, sizeof(TraceRecordInfo))) {
+		if(record.Info.RecordType == TraceRecordType::ExtraInfo) {
+			text.resize(record.Info.TextLength);
+			input.read(&text[0], text.size());
+			GetExtraInfoRow(outputBuffer, text.c_str(), (uint32_t)text.size());
+		} else {
+			input.read((char*)&record.State, GetStateSize(record.Info.Type));
+			GetTraceRow(outputBuffer, record);
+		}
+
+		if(outputBuffer.size() > 32768) {
+			output << outputBuffer;
+			outputBuffer.clear();
+		}
+	}
+	output << outputBuffer;
+	return true;
+}
+
 template<CpuType cpuType>
 void TraceLogger::GetStatusFlag(string &output, uint8_t ps, RowPart& part)
 {
@@ -272,9 +487,13 @@ void TraceLogger::WriteDisassembly(DisassemblyInfo &info, RowPart &rowPart, uint
 	WriteValue(output, code, rowPart);
 }
 
-void TraceLogger::WriteEffectiveAddress(DisassemblyInfo &info, RowPart &rowPart, void *cpuState, string &output, SnesMemoryType cpuMemoryType, CpuType cpuType)
+void TraceLogger::WriteEffectiveAddress(TraceRecord &record, RowPart &rowPart, string &output, SnesMemoryType cpuMemoryType)
 {
-	int32_t effectiveAddress = info.GetEffectiveAddress(_console, cpuState, cpuType);
+	if(!record.Info.HasMemoryInfo) {
+		FillMemoryInfo(record);
+	}
+
+	int32_t effectiveAddress = record.Info.EffectiveAddress;
 	if(effectiveAddress >= 0) {
 		if(_options.UseLabels) {
 			AddressInfo addr { effectiveAddress, cpuMemoryType };
@@ -288,18 +507,19 @@ void TraceLogger::WriteEffectiveAddress(DisassemblyInfo &info, RowPart &rowPart,
 	}
 }
 
-void TraceLogger::WriteMemoryValue(DisassemblyInfo &info, RowPart &rowPart, void *cpuState, string &output, SnesMemoryType memType, CpuType cpuType)
+void TraceLogger::WriteMemoryValue(TraceRecord &record, RowPart &rowPart, string &output, SnesMemoryType memType)
 {
-	int32_t address = info.GetEffectiveAddress(_console, cpuState, cpuType);
-	if(address >= 0) {
-		uint8_t valueSize;
-		uint16_t value = info.GetMemoryValue(address, _memoryDumper, memType, valueSize);
+	if(!record.Info.HasMemoryInfo) {
+		FillMemoryInfo(record);
+	}
+
+	if(record.Info.EffectiveAddress >= 0) {
 		if(rowPart.DisplayInHex) {
 			output += "= $";
-			if(valueSize == 2) {
-				WriteValue(output, (uint16_t)value, rowPart);
+			if(record.Info.MemoryValueSize == 2) {
+				WriteValue(output, (uint16_t)record.Info.MemoryValue, rowPart);
 			} else {
-				WriteValue(output, (uint8_t)value, rowPart);
+				WriteValue(output, (uint8_t)record.Info.MemoryValue, rowPart);
 			}
 		} else {
 			output += "= ";
@@ -314,8 +534,9 @@ void TraceLogger::WriteAlign(int originalSize, RowPart &rowPart, string &output)
 	}
 }
 
-void TraceLogger::GetTraceRow(string &output, CpuState &cpuState, PpuState &ppuState, DisassemblyInfo &disassemblyInfo, SnesMemoryType memType, CpuType cpuType)
+void TraceLogger::GetTraceRow(string &output, CpuState &cpuState, TraceRecord &record, SnesMemoryType memType)
 {
+	DisassemblyInfo &disassemblyInfo = record.Info.Disassembly;
 	int originalSize = (int)output.size();
 	uint32_t pcAddress = (cpuState.K << 16) | cpuState.PC;
 	for(RowPart& rowPart : _rowParts) {
@@ -323,8 +544,8 @@ void TraceLogger::GetTraceRow(string &output, CpuState &cpuState, PpuState &ppuS
 			case RowDataType::Text: output += rowPart.Text; break;
 			case RowDataType::ByteCode: WriteByteCode(disassemblyInfo, rowPart, output); break;
 			case RowDataType::Disassembly: WriteDisassembly(disassemblyInfo, rowPart, (uint8_t)cpuState.SP, pcAddress, output); break;
-			case RowDataType::EffectiveAddress: WriteEffectiveAddress(disassemblyInfo, rowPart, &cpuState, output, memType, cpuType); break;
-			case RowDataType::MemoryValue: WriteMemoryValue(disassemblyInfo, rowPart, &cpuState, output, memType, cpuType); break;
+			case RowDataType::EffectiveAddress: WriteEffectiveAddress(record, rowPart, output, memType); break;
+			case RowDataType::MemoryValue: WriteMemoryValue(record, rowPart, output, memType); break;
 			case RowDataType::Align: WriteAlign(originalSize, rowPart, output); break;
 
 			case RowDataType::PC: WriteValue(output, HexUtilities::ToHex24(pcAddress), rowPart); break;
@@ -335,10 +556,10 @@ void TraceLogger::GetTraceRow(string &output, CpuState &cpuState, PpuState &ppuS
 			case RowDataType::DB: WriteValue(output, cpuState.DBR, rowPart); break;
 			case RowDataType::SP: WriteValue(output, cpuState.SP, rowPart); break;
 			case RowDataType::PS: GetStatusFlag<CpuType::Cpu>(output, cpuState.PS, rowPart); break;
-			case RowDataType::Cycle: WriteValue(output, ppuState.Cycle, rowPart); break;
-			case RowDataType::Scanline: WriteValue(output, ppuState.Scanline, rowPart); break;
-			case RowDataType::HClock: WriteValue(output, ppuState.HClock, rowPart); break;
-			case RowDataType::FrameCount: WriteValue(output, ppuState.FrameCount, rowPart); break;
+			case RowDataType::Cycle: WriteValue(output, record.Info.Cycle, rowPart); break;
+			case RowDataType::Scanline: WriteValue(output, record.Info.Scanline, rowPart); break;
+			case RowDataType::HClock: WriteValue(output, record.Info.HClock, rowPart); break;
+			case RowDataType::FrameCount: WriteValue(output, record.Info.FrameCount, rowPart); break;
 			case RowDataType::CycleCount: WriteValue(output, (uint32_t)cpuState.CycleCount, rowPart); break;
 			default: break;
 		}
@@ -346,8 +567,9 @@ void TraceLogger::GetTraceRow(string &output, CpuState &cpuState, PpuState &ppuS
 	output += _options.UseWindowsEol ? "\r\n" : "\n";
 }
 
-void TraceLogger::GetTraceRow(string &output, SpcState &cpuState, PpuState &ppuState, DisassemblyInfo &disassemblyInfo)
+void TraceLogger::GetTraceRow(string &output, SpcState &cpuState, TraceRecord &record)
 {
+	DisassemblyInfo &disassemblyInfo = record.Info.Disassembly;
 	int originalSize = (int)output.size();
 	uint32_t pcAddress = cpuState.PC;
 	for(RowPart& rowPart : _spcRowParts) {
@@ -355,8 +577,8 @@ void TraceLogger::GetTraceRow(string &output, SpcState &cpuState, PpuState &ppuS
 			case RowDataType::Text: output += rowPart.Text; break;
 			case RowDataType::ByteCode: WriteByteCode(disassemblyInfo, rowPart, output); break;
 			case RowDataType::Disassembly: WriteDisassembly(disassemblyInfo, rowPart, cpuState.SP, pcAddress, output); break;
-			case RowDataType::EffectiveAddress: WriteEffectiveAddress(disassemblyInfo, rowPart, &cpuState, output, SnesMemoryType::SpcMemory, CpuType::Spc); break;
-			case RowDataType::MemoryValue: WriteMemoryValue(disassemblyInfo, rowPart, &cpuState, output, SnesMemoryType::SpcMemory, CpuType::Spc); break;
+			case RowDataType::EffectiveAddress: WriteEffectiveAddress(record, rowPart, output, SnesMemoryType::SpcMemory); break;
+			case RowDataType::MemoryValue: WriteMemoryValue(record, rowPart, output, SnesMemoryType::SpcMemory); break;
 			case RowDataType::Align: WriteAlign(originalSize, rowPart, output); break;
 
 			case RowDataType::PC: WriteValue(output, HexUtilities::ToHex((uint16_t)pcAddress), rowPart); break;
@@ -365,10 +587,10 @@ void TraceLogger::GetTraceRow(string &output, SpcState &cpuState, PpuState &ppuS
 			case RowDataType::Y: WriteValue(output, cpuState.Y, rowPart); break;
 			case RowDataType::SP: WriteValue(output, cpuState.SP, rowPart); break;
 			case RowDataType::PS: GetStatusFlag<CpuType::Spc>(output, cpuState.PS, rowPart); break;
-			case RowDataType::Cycle: WriteValue(output, ppuState.Cycle, rowPart); break;
-			case RowDataType::Scanline: WriteValue(output, ppuState.Scanline, rowPart); break;
-			case RowDataType::HClock: WriteValue(output, ppuState.HClock, rowPart); break;
-			case RowDataType::FrameCount: WriteValue(output, ppuState.FrameCount, rowPart); break;
+			case RowDataType::Cycle: WriteValue(output, record.Info.Cycle, rowPart); break;
+			case RowDataType::Scanline: WriteValue(output, record.Info.Scanline, rowPart); break;
+			case RowDataType::HClock: WriteValue(output, record.Info.HClock, rowPart); break;
+			case RowDataType::FrameCount: WriteValue(output, record.Info.FrameCount, rowPart); break;
 
 			default: break;
 		}
@@ -376,8 +598,9 @@ void TraceLogger::GetTraceRow(string &output, SpcState &cpuState, PpuState &ppuS
 	output += _options.UseWindowsEol ? "\r\n" : "\n";
 }
 
-void TraceLogger::GetTraceRow(string &output, NecDspState &cpuState, PpuState &ppuState, DisassemblyInfo &disassemblyInfo)
+void TraceLogger::GetTraceRow(string &output, NecDspState &cpuState, TraceRecord &record)
 {
+	DisassemblyInfo &disassemblyInfo = record.Info.Disassembly;
 	int originalSize = (int)output.size();
 	uint32_t pcAddress = cpuState.PC;
 	for(RowPart& rowPart : _dspRowParts) {
@@ -406,18 +629,19 @@ void TraceLogger::GetTraceRow(string &output, NecDspState &cpuState, PpuState &p
 				WriteValue(output, cpuState.A, rowPart); 
 				break;
 			case RowDataType::SP: WriteValue(output, cpuState.SP, rowPart); break;
-			case RowDataType::Cycle: WriteValue(output, ppuState.Cycle, rowPart); break;
-			case RowDataType::Scanline: WriteValue(output, ppuState.Scanline, rowPart); break;
-			case RowDataType::HClock: WriteValue(output, ppuState.HClock, rowPart); break;
-			case RowDataType::FrameCount: WriteValue(output, ppuState.FrameCount, rowPart); break;
+			case RowDataType::Cycle: WriteValue(output, record.Info.Cycle, rowPart); break;
+			case RowDataType::Scanline: WriteValue(output, record.Info.Scanline, rowPart); break;
+			case RowDataType::HClock: WriteValue(output, record.Info.HClock, rowPart); break;
+			case RowDataType::FrameCount: WriteValue(output, record.Info.FrameCount, rowPart); break;
 			default: break;
 		}
 	}
 	output += _options.UseWindowsEol ? "\r\n" : "\n";
 }
 
-void TraceLogger::GetTraceRow(string &output, GsuState &gsuState, PpuState &ppuState, DisassemblyInfo &disassemblyInfo)
+void TraceLogger::GetTraceRow(string &output, GsuState &gsuState, TraceRecord &record)
 {
+	DisassemblyInfo &disassemblyInfo = record.Info.Disassembly;
 	int originalSize = (int)output.size();
 	uint32_t pcAddress = (gsuState.ProgramBank << 16) | gsuState.R[15];
 	for(RowPart& rowPart : _gsuRowParts) {
@@ -437,19 +661,19 @@ void TraceLogger::GetTraceRow(string &output, GsuState &gsuState, PpuState &ppuS
 			case RowDataType::X: WriteValue(output, gsuState.SrcReg, rowPart); break;
 			case RowDataType::Y: WriteValue(output, gsuState.DestReg, rowPart); break;
 
-			case RowDataType::Cycle: WriteValue(output, ppuState.Cycle, rowPart); break;
-			case RowDataType::Scanline: WriteValue(output, ppuState.Scanline, rowPart); break;
-			case RowDataType::HClock: WriteValue(output, ppuState.HClock, rowPart); break;
-			case RowDataType::FrameCount: WriteValue(output, ppuState.FrameCount, rowPart); break;
+			case RowDataType::Cycle: WriteValue(output, record.Info.Cycle, rowPart); break;
+			case RowDataType::Scanline: WriteValue(output, record.Info.Scanline, rowPart); break;
+			case RowDataType::HClock: WriteValue(output, record.Info.HClock, rowPart); break;
+			case RowDataType::FrameCount: WriteValue(output, record.Info.FrameCount, rowPart); break;
 			default: break;
 		}
 	}
 	output += _options.UseWindowsEol ? "\r\n" : "\n";
 }
 
-
-void TraceLogger::GetTraceRow(string &output, Cx4State &cx4State, PpuState &ppuState, DisassemblyInfo &disassemblyInfo)
+void TraceLogger::GetTraceRow(string &output, Cx4State &cx4State, TraceRecord &record)
 {
+	DisassemblyInfo &disassemblyInfo = record.Info.Disassembly;
 	int originalSize = (int)output.size();
 	uint32_t pcAddress = (cx4State.Cache.Address[cx4State.Cache.Page] + (cx4State.PC * 2)) & 0xFFFFFF;
 	for(RowPart& rowPart : _cx4RowParts) {
@@ -475,18 +699,19 @@ void TraceLogger::GetTraceRow(string &output, Cx4State &cx4State, PpuState &ppuS
 				}
 				break;
 
-			case RowDataType::Cycle: WriteValue(output, ppuState.Cycle, rowPart); break;
-			case RowDataType::Scanline: WriteValue(output, ppuState.Scanline, rowPart); break;
-			case RowDataType::HClock: WriteValue(output, ppuState.HClock, rowPart); break;
-			case RowDataType::FrameCount: WriteValue(output, ppuState.FrameCount, rowPart); break;
+			case RowDataType::Cycle: WriteValue(output, record.Info.Cycle, rowPart); break;
+			case RowDataType::Scanline: WriteValue(output, record.Info.Scanline, rowPart); break;
+			case RowDataType::HClock: WriteValue(output, record.Info.HClock, rowPart); break;
+			case RowDataType::FrameCount: WriteValue(output, record.Info.FrameCount, rowPart); break;
 			default: break;
 		}
 	}
 	output += _options.UseWindowsEol ? "\r\n" : "\n";
 }
 
-void TraceLogger::GetTraceRow(string& output, GbCpuState& cpuState, GbPpuState& ppuState, DisassemblyInfo& disassemblyInfo)
+void TraceLogger::GetTraceRow(string &output, GbCpuState &cpuState, TraceRecord &record)
 {
+	DisassemblyInfo &disassemblyInfo = record.Info.Disassembly;
 	int originalSize = (int)output.size();
 	uint32_t pcAddress = cpuState.PC;
 	for(RowPart& rowPart : _gbRowParts) {
@@ -494,8 +719,8 @@ void TraceLogger::GetTraceRow(string& output, GbCpuState& cpuState, GbPpuState&
 			case RowDataType::Text: output += rowPart.Text; break;
 			case RowDataType::ByteCode: WriteByteCode(disassemblyInfo, rowPart, output); break;
 			case RowDataType::Disassembly: WriteDisassembly(disassemblyInfo, rowPart, (uint8_t)cpuState.SP, pcAddress, output); break;
-			case RowDataType::EffectiveAddress: WriteEffectiveAddress(disassemblyInfo, rowPart, &cpuState, output, SnesMemoryType::GameboyMemory, CpuType::Gameboy); break;
-			case RowDataType::MemoryValue: WriteMemoryValue(disassemblyInfo, rowPart, &cpuState, output, SnesMemoryType::GameboyMemory, CpuType::Gameboy); break;
+			case RowDataType::EffectiveAddress: WriteEffectiveAddress(record, rowPart, output, SnesMemoryType::GameboyMemory); break;
+			case RowDataType::MemoryValue: WriteMemoryValue(record, rowPart, output, SnesMemoryType::GameboyMemory); break;
 			case RowDataType::Align: WriteAlign(originalSize, rowPart, output); break;
 
 			case RowDataType::PC: WriteValue(output, HexUtilities::ToHex((uint16_t)pcAddress), rowPart); break;
@@ -508,9 +733,9 @@ void TraceLogger::GetTraceRow(string& output, GbCpuState& cpuState, GbPpuState&
 			case RowDataType::H: WriteValue(output, cpuState.H, rowPart); break;
 			case RowDataType::L: WriteValue(output, cpuState.L, rowPart); break;
 			case RowDataType::SP: WriteValue(output, cpuState.SP, rowPart); break;
-			case RowDataType::Cycle: WriteValue(output, ppuState.Cycle, rowPart); break;
-			case RowDataType::Scanline: WriteValue(output, ppuState.Scanline, rowPart); break;
-			case RowDataType::FrameCount: WriteValue(output, ppuState.FrameCount, rowPart); break;
+			case RowDataType::Cycle: WriteValue(output, record.Info.Cycle, rowPart); break;
+			case RowDataType::Scanline: WriteValue(output, (uint8_t)record.Info.Scanline, rowPart); break;
+			case RowDataType::FrameCount: WriteValue(output, record.Info.FrameCount, rowPart); break;
 
 			default: break;
 		}
@@ -518,79 +743,93 @@ void TraceLogger::GetTraceRow(string& output, GbCpuState& cpuState, GbPpuState&
 	output += _options.UseWindowsEol ? "\r\n" : "\n";
 }
 
-/*
-bool TraceLogger::ConditionMatches(DebugState &state, DisassemblyInfo &disassemblyInfo, OperationInfo &operationInfo)
+void TraceLogger::GetTraceRow(string &output, TraceRecord &record)
 {
-	if(!_conditionData.RpnQueue.empty()) {
-		EvalResultType type;
-		if(!_expEvaluator->Evaluate(_conditionData, state, type, operationInfo)) {
-			if(operationInfo.OperationType == MemoryOperationType::ExecOpCode) {
-				//Condition did not match, keep state/disassembly info for instruction's subsequent cycles
-				_lastState = state;
-				_lastDisassemblyInfo = disassemblyInfo;
-				_pendingLog = true;
-			}
-			return false;
-		}
+	switch(record.Info.Type) {
+		case CpuType::Cpu: GetTraceRow(output, record.State.Cpu, record, SnesMemoryType::CpuMemory); break;
+		case CpuType::Spc: GetTraceRow(output, record.State.Spc, record); break;
+		case CpuType::NecDsp: GetTraceRow(output, record.State.NecDsp, record); break;
+		case CpuType::Sa1: GetTraceRow(output, record.State.Cpu, record, SnesMemoryType::Sa1Memory); break;
+		case CpuType::Gsu: GetTraceRow(output, record.State.Gsu, record); break;
+		case CpuType::Cx4: GetTraceRow(output, record.State.Cx4, record); break;
+		case CpuType::Gameboy: GetTraceRow(output, record.State.Gameboy, record); break;
 	}
-	return true;
 }
-*/
 
-void TraceLogger::GetTraceRow(string &output, CpuType cpuType, DisassemblyInfo &disassemblyInfo, DebugState &state)
+void TraceLogger::GetExtraInfoRow(string &output, const char* text, uint32_t length)
 {
-	switch(cpuType) {
-		case CpuType::Cpu: GetTraceRow(output, state.Cpu, state.Ppu, disassemblyInfo, SnesMemoryType::CpuMemory, cpuType); break;
-		case CpuType::Spc: GetTraceRow(output, state.Spc, state.Ppu, disassemblyInfo); break;
-		case CpuType::NecDsp: GetTraceRow(output, state.NecDsp, state.Ppu, disassemblyInfo); break;
-		case CpuType::Sa1: GetTraceRow(output, state.Sa1.Cpu, state.Ppu, disassemblyInfo, SnesMemoryType::Sa1Memory, cpuType); break;
-		case CpuType::Gsu: GetTraceRow(output, state.Gsu, state.Ppu, disassemblyInfo); break;
-		case CpuType::Cx4: GetTraceRow(output, state.Cx4, state.Ppu, disassemblyInfo); break;
-		case CpuType::Gameboy: GetTraceRow(output, state.Gameboy.Cpu, state.Gameboy.Ppu, disassemblyInfo); break;
-	}
+	output += "[";
+	output.append(text, length);
+	output += "]";
+	output += _options.UseWindowsEol ? "\r\n" : "\n";
 }
 
-void TraceLogger::AddRow(CpuType cpuType, DisassemblyInfo &disassemblyInfo, DebugState &state)
+void TraceLogger::FillMemoryInfo(TraceRecord &record)
 {
-	_logCpuType[_currentPos] = cpuType;
-	_disassemblyCache[_currentPos] = disassemblyInfo;
-	_stateCache[_currentPos] = state;
-	_pendingLog = false;
+	record.Info.HasMemoryInfo = true;
+	record.Info.EffectiveAddress = -1;
+	record.Info.MemoryValue = 0;
+	record.Info.MemoryValueSize = 0;
+
+	SnesMemoryType memType;
+	switch(record.Info.Type) {
+		case CpuType::Cpu: memType = SnesMemoryType::CpuMemory; break;
+		case CpuType::Sa1: memType = SnesMemoryType::Sa1Memory; break;
+		case CpuType::Spc: memType = SnesMemoryType::SpcMemory; break;
+		case CpuType::Gameboy: memType = SnesMemoryType::GameboyMemory; break;
+		default: return;
+	}
 
-	if(_logCount < ExecutionLogSize) {
-		_logCount++;
+	//GetEffectiveAddress can alter the state it's given, use a copy
+	TraceCpuState state = record.State;
+	record.Info.EffectiveAddress = record.Info.Disassembly.GetEffectiveAddress(_console, &state, record.Info.Type);
+	if(record.Info.EffectiveAddress >= 0) {
+		record.Info.MemoryValue = record.Info.Disassembly.GetMemoryValue(record.Info.EffectiveAddress, _memoryDumper, memType, record.Info.MemoryValueSize);
 	}
+}
 
+void TraceLogger::AddRow(CpuType cpuType, void* cpuState, uint32_t stateSize, DisassemblyInfo &disassemblyInfo)
+{
+	if(!_logCpu[(int)cpuType]) {
+		//For the sake of performance, only log data for the CPUs we're actively displaying/logging
+		return;
+	}
+
+	auto lock = _lock.AcquireSafe();
+	TraceRecord &record = _records[_currentPos];
 	if(_logToFile) {
-		GetTraceRow(_outputBuffer, cpuType, _disassemblyCache[_currentPos], _stateCache[_currentPos]);
-		if(_outputBuffer.size() > 32768) {
-			_outputFile << _outputBuffer;
-			_outputBuffer.clear();
-		}
+		//Records are written to the file as is, clear the fields that aren't set below (only stateSize bytes of the state are written)
+		record.Info = {};
+	}
+	record.Info.RecordType = TraceRecordType::Instruction;
+	record.Info.Type = cpuType;
+	record.Info.Disassembly = disassemblyInfo;
+	record.Info.MasterClock = _console->GetMasterClock();
+	record.Info.HasMemoryInfo = false;
+	if(cpuType == CpuType::Gameboy) {
+		record.Info.Cycle = _gbPpu->GetCycle();
+		record.Info.Scanline = _gbPpu->GetScanline();
+		record.Info.HClock = 0;
+		record.Info.FrameCount = _gbPpu->GetFrameCount();
+	} else {
+		record.Info.Cycle = _ppu->GetCycle();
+		record.Info.Scanline = _ppu->GetScanline();
+		record.Info.HClock = _memoryManager->GetHClock();
+		record.Info.FrameCount = _ppu->GetFrameCount();
 	}
+	memcpy(&record.State, cpuState, stateSize);
 
-	_currentPos = (_currentPos + 1) % ExecutionLogSize;
-}
-/*
-void TraceLogger::LogNonExec(OperationInfo& operationInfo)
-{
-	if(_pendingLog) {
-		auto lock = _lock.AcquireSafe();
-		if(ConditionMatches(_lastState, _lastDisassemblyInfo, operationInfo)) {
-			AddRow(_lastDisassemblyInfo, _lastState);
+	if(_logToFile) {
+		if(_binaryLog || _formatUsesMemoryInfo) {
+			FillMemoryInfo(record);
 		}
+		PushToFileBuffer(&record.Info, sizeof(TraceRecordInfo), &record.State, stateSize);
 	}
-}*/
 
-void TraceLogger::Log(CpuType cpuType, DebugState &state, DisassemblyInfo &disassemblyInfo)
-{
-	if(_logCpu[(int)cpuType]) {
-		//For the sake of performance, only log data for the CPUs we're actively displaying/logging
-		auto lock = _lock.AcquireSafe();
-		//if(ConditionMatches(state, disassemblyInfo, operationInfo)) {
-			AddRow(cpuType, disassemblyInfo, state);
-		//}
+	if(_logCount < ExecutionLogSize) {
+		_logCount++;
 	}
+	_currentPos = (_currentPos + 1) % ExecutionLogSize;
 }
 
 void TraceLogger::Clear()
@@ -598,17 +837,14 @@ void TraceLogger::Clear()
 	_logCount = 0;
 }
 
-const char* TraceLogger::GetExecutionTrace(uint32_t lineCount)
+string TraceLogger::GetExecutionTrace(uint32_t lineCount)
 {
 	int startPos;
-
-	_executionTrace.clear();
+	string executionTrace;
 	{
 		auto lock = _lock.AcquireSafe();
 		lineCount = std::min(lineCount, _logCount);
-		memcpy(_stateCacheCopy, _stateCache, sizeof(DebugState) * TraceLogger::ExecutionLogSize);
-		memcpy(_disassemblyCacheCopy, _disassemblyCache, sizeof(DisassemblyInfo) * TraceLogger::ExecutionLogSize);
-		memcpy(_logCpuTypeCopy, _logCpuType, sizeof(CpuType) * TraceLogger::ExecutionLogSize);
+		memcpy(_recordsCopy, _records, sizeof(TraceRecord) * TraceLogger::ExecutionLogSize);
 		startPos = (_currentPos > 0 ? _currentPos : TraceLogger::ExecutionLogSize) - 1;
 	}
 
@@ -618,38 +854,40 @@ const char* TraceLogger::GetExecutionTrace(uint32_t lineCount)
 	}
 
 	if(enabled && lineCount > 0) {
+		auto lock = _formatLock.AcquireSafe();
 		for(int i = 0; i < TraceLogger::ExecutionLogSize; i++) {
 			int index = (startPos - i);
 			if(index < 0) {
 				index = TraceLogger::ExecutionLogSize + index;
 			}
 
-			if((i > 0 && startPos == index) || !_disassemblyCacheCopy[index].IsInitialized()) {
+			TraceRecord &record = _recordsCopy[index];
+			if((i > 0 && startPos == index) || !record.Info.Disassembly.IsInitialized()) {
 				//If the entire array was checked, or this element is not initialized, stop
 				break;
 			}
 
-			CpuType cpuType = _logCpuTypeCopy[index];
+			CpuType cpuType = record.Info.Type;
 			if(!_logCpu[(int)cpuType]) {
 				//This line isn't for a CPU currently being logged
 				continue;
 			}
 
-			DebugState &state = _stateCacheCopy[index];
+			TraceCpuState &state = record.State;
 			switch(cpuType) {
-				case CpuType::Cpu: _executionTrace += "\x2\x1" + HexUtilities::ToHex24((state.Cpu.K << 16) | state.Cpu.PC) + "\x1"; break;
-				case CpuType::Spc: _executionTrace += "\x3\x1" + HexUtilities::ToHex(state.Spc.PC) + "\x1"; break;
-				case CpuType::NecDsp: _executionTrace += "\x4\x1" + HexUtilities::ToHex(state.NecDsp.PC) + "\x1"; break;
-				case CpuType::Sa1: _executionTrace += "\x4\x1" + HexUtilities::ToHex24((state.Sa1.Cpu.K << 16) | state.Sa1.Cpu.PC) + "\x1"; break;
-				case CpuType::Gsu: _executionTrace += "\x4\x1" + HexUtilities::ToHex24((state.Gsu.ProgramBank << 16) | state.Gsu.R[15]) + "\x1"; break;
-				case CpuType::Cx4: _executionTrace += "\x4\x1" + HexUtilities::ToHex24((state.Cx4.Cache.Address[state.Cx4.Cache.Page] + (state.Cx4.PC * 2)) & 0xFFFFFF) + "\x1"; break;
-				case CpuType::Gameboy: _executionTrace += "\x4\x1" + HexUtilities::ToHex(state.Gameboy.Cpu.PC) + "\x1"; break;
+				case CpuType::Cpu: executionTrace += "\x2\x1" + HexUtilities::ToHex24((state.Cpu.K << 16) | state.Cpu.PC) + "\x1"; break;
+				case CpuType::Spc: executionTrace += "\x3\x1" + HexUtilities::ToHex(state.Spc.PC) + "\x1"; break;
+				case CpuType::NecDsp: executionTrace += "\x4\x1" + HexUtilities::ToHex(state.NecDsp.PC) + "\x1"; break;
+				case CpuType::Sa1: executionTrace += "\x4\x1" + HexUtilities::ToHex24((state.Cpu.K << 16) | state.Cpu.PC) + "\x1"; break;
+				case CpuType::Gsu: executionTrace += "\x4\x1" + HexUtilities::ToHex24((state.Gsu.ProgramBank << 16) | state.Gsu.R[15]) + "\x1"; break;
+				case CpuType::Cx4: executionTrace += "\x4\x1" + HexUtilities::ToHex24((state.Cx4.Cache.Address[state.Cx4.Cache.Page] + (state.Cx4.PC * 2)) & 0xFFFFFF) + "\x1"; break;
+				case CpuType::Gameboy: executionTrace += "\x4\x1" + HexUtilities::ToHex(state.Gameboy.PC) + "\x1"; break;
 			}
 
 			string byteCode;
-			_disassemblyCacheCopy[index].GetByteCode(byteCode);
-			_executionTrace += byteCode + "\x1";
-			GetTraceRow(_executionTrace, cpuType, _disassemblyCacheCopy[index], _stateCacheCopy[index]);
+			record.Info.Disassembly.GetByteCode(byteCode);
+			executionTrace += byteCode + "\x1";
+			GetTraceRow(executionTrace, record);
 
 			lineCount--;
 			if(lineCount == 0) {
@@ -657,5 +895,5 @@ const char* TraceLogger::GetExecutionTrace(uint32_t lineCount)
 			}
 		}
 	}
-	return _executionTrace.c_str();
+	return executionTrace;
 }
\ No newline at end of file
@@ -8,13 +8,16 @@
 #include "DisassemblyInfo.h"
 #include "DebugUtilities.h"
 #include "../Utilities/SimpleLock.h"
+#include "../Utilities/AutoResetEvent.h"
 
 class Console;
 class Debugger;
 class LabelManager;
 class MemoryDumper;
 class EmuSettings;
-struct DebugState;
+class Ppu;
+class MemoryManager;
+class GbPpu;
 
 struct TraceLoggerOptions
 {
@@ -73,22 +76,76 @@ struct RowPart
 	int MinWidth;
 };
 
+enum class TraceRecordType : uint8_t
+{
+	Instruction = 0,
+	ExtraInfo = 1
+};
+
+struct TraceRecordInfo
+{
+	uint64_t MasterClock;
+	uint32_t FrameCount;
+	uint16_t Scanline;
+	uint16_t Cycle;
+	uint16_t HClock;
+	TraceRecordType RecordType;
+	CpuType Type;
+
+	//Set when the effective address/memory value were read when the instruction was logged
+	bool HasMemoryInfo;
+	uint8_t MemoryValueSize;
+	uint16_t MemoryValue;
+	int32_t EffectiveAddress;
+
+	//ExtraInfo records: length of the text stored after the record (instead of the CPU state)
+	uint32_t TextLength;
+
+	DisassemblyInfo Disassembly;
+};
+
+union TraceCpuState
+{
+	CpuState Cpu;
+	SpcState Spc;
+	NecDspState NecDsp;
+	GsuState Gsu;
+	Cx4State Cx4;
+	GbCpuState Gameboy;
+
+	TraceCpuState() {}
+};
+
+//Everything needed to produce a single row of the trace log (only the state of the CPU that ran the instruction is kept)
+//In binary logs, each record is stored as its TraceRecordInfo followed by the CPU state (GetStateSize bytes), or by the text of ExtraInfo records
+struct TraceRecord
+{
+	TraceRecordInfo Info;
+	TraceCpuState State;
+};
+
 class TraceLogger
 {
 private:
 	static constexpr int ExecutionLogSize = 30000;
 
-	//Must be static to be thread-safe when switching game
-	static string _executionTrace;
+	//Size of the buffer used to send records to the log file's writer thread (must be a power of 2)
+	static constexpr uint32_t FileBufferSize = 0x400000;
+	static constexpr uint32_t FileBufferMask = FileBufferSize - 1;
+	static constexpr char BinaryLogSignature[4] = { 'M', 'T', 'L', 'G' };
+	static constexpr uint32_t BinaryLogVersion = 3;
+	static constexpr uint32_t BinaryLogHeaderSize = 8;
 
 	TraceLoggerOptions _options;
 	string _outputFilepath;
-	string _outputBuffer;
 	ofstream _outputFile;
 	Console* _console;
 	EmuSettings* _settings;
 	LabelManager* _labelManager;
 	MemoryDumper* _memoryDumper;
+	Ppu* _ppu;
+	MemoryManager* _memoryManager;
+	GbPpu* _gbPpu;
 
 	vector<RowPart> _rowParts;
 	vector<RowPart> _spcRowParts;
@@ -98,60 +155,82 @@ private:
 	vector<RowPart> _gbRowParts;
 
 	bool _logCpu[(int)DebugUtilities::GetLastCpuType() + 1] = {};
-
-	bool _pendingLog;
-	//CpuState _lastState;
-	//DisassemblyInfo _lastDisassemblyInfo;
+	bool _formatUsesMemoryInfo = false;
 
 	bool _logToFile;
+	bool _binaryLog;
 	uint32_t _currentPos;
 	uint32_t _logCount;
-	DebugState *_stateCache = nullptr;
-	DisassemblyInfo *_disassemblyCache = nullptr;
-	CpuType* _logCpuType = nullptr;
-
-	DebugState *_stateCacheCopy = nullptr;
-	DisassemblyInfo *_disassemblyCacheCopy = nullptr;
-	CpuType* _logCpuTypeCopy = nullptr;
+	TraceRecord* _records = nullptr;
+	TraceRecord* _recordsCopy = nullptr;
+
+	//Records are copied to this ring buffer by the emulation thread, and written to the file by the writer thread
+	uint8_t* _fileBuffer = nullptr;
+	atomic<uint32_t> _fileBufferWritePos;
+	atomic<uint32_t> _fileBufferReadPos;
+	uint32_t _fileBufferSignalPos = 0;
+	unique_ptr<std::thread> _writerThread;
+	AutoResetEvent _writerSignal;
+	atomic<bool> _stopWriter;
 
 	SimpleLock _lock;
+	SimpleLock _formatLock;
 
 	template<CpuType cpuType> void GetStatusFlag(string &output, uint8_t ps, RowPart& part);
 
 	void WriteByteCode(DisassemblyInfo &info, RowPart &rowPart, string &output);
 	void WriteDisassembly(DisassemblyInfo &info, RowPart &rowPart, uint8_t sp, uint32_t pc, string &output);
-	void WriteEffectiveAddress(DisassemblyInfo &info, RowPart &rowPart, void *cpuState, string &output, SnesMemoryType cpuMemoryType, CpuType cpuType);
-	void WriteMemoryValue(DisassemblyInfo &info, RowPart &rowPart, void *cpuState, string &output, SnesMemoryType memType, CpuType cpuType);
+	void WriteEffectiveAddress(TraceRecord &record, RowPart &rowPart, string &output, SnesMemoryType cpuMemoryType);
+	void WriteMemoryValue(TraceRecord &record, RowPart &rowPart, string &output, SnesMemoryType memType);
 	void WriteAlign(int originalSize, RowPart &rowPart, string &output);
-	void AddRow(CpuType cpuType, DisassemblyInfo &disassemblyInfo, DebugState &state);
-	//bool ConditionMatches(DebugState &state, DisassemblyInfo &disassemblyInfo, OperationInfo &operationInfo);
-	
+	void AddRow(CpuType cpuType, void* cpuState, uint32_t stateSize, DisassemblyInfo &disassemblyInfo);
+	void FillMemoryInfo(TraceRecord &record);
+
 	void ParseFormatString(vector<RowPart> &rowParts, string format);
 
-	void GetTraceRow(string &output, CpuType cpuType, DisassemblyInfo &disassemblyInfo, DebugState &state);
-	void GetTraceRow(string &output, CpuState &cpuState, PpuState &ppuState, DisassemblyInfo &disassemblyInfo, SnesMemoryType memType, CpuType cpuType);
-	void GetTraceRow(string &output, SpcState &cpuState, PpuState &ppuState, DisassemblyInfo &disassemblyInfo);
-	void GetTraceRow(string &output, NecDspState &cpuState, PpuState &ppuState, DisassemblyInfo &disassemblyInfo);
-	void GetTraceRow(string &output, GsuState &gsuState, PpuState &ppuState, DisassemblyInfo &disassemblyInfo);
-	void GetTraceRow(string& output, Cx4State& cx4State, PpuState& ppuState, DisassemblyInfo& disassemblyInfo);
-	void GetTraceRow(string &output, GbCpuState &gbState, GbPpuState &gbPpuState, DisassemblyInfo &disassemblyInfo);
+	void GetTraceRow(string &output, TraceRecord &record);
+	void GetTraceRow(string &output, CpuState &cpuState, TraceRecord &record, SnesMemoryType memType);
+	void GetTraceRow(string &output, SpcState &cpuState, TraceRecord &record);
+	void GetTraceRow(string &output, NecDspState &cpuState, TraceRecord &record);
+	void GetTraceRow(string &output, GsuState &gsuState, TraceRecord &record);
+	void GetTraceRow(string& output, Cx4State& cx4State, TraceRecord &record);
+	void GetTraceRow(string &output, GbCpuState &gbState, TraceRecord &record);
+	void GetExtraInfoRow(string &output, const char* text, uint32_t length);
 
 	template<typename T> void WriteValue(string &output, T value, RowPart& rowPart);
 
+	static uint32_t GetStateSize(CpuType cpuType);
+	static void GetBinaryLogHeader(uint32_t header[BinaryLogHeaderSize]);
+	void WriteToFileBuffer(uint32_t pos, const void* data, uint32_t size);
+	void PushToFileBuffer(const void* header, uint32_t headerSize, const void* data, uint32_t dataSize);
+	void ReadFromFileBuffer(uint32_t pos, void* dest, uint32_t size);
+	void WriterThread();
+	void WriteFileBuffer(uint32_t startPos, uint32_t endPos, string &textBuffer);
+
 public:
 	TraceLogger(Debugger* debugger, shared_ptr<Console> console);
 	~TraceLogger();
 
 	__forceinline bool IsCpuLogged(CpuType type) { return _logCpu[(int)type]; }
 
-	void Log(CpuType cpuType, DebugState &state, DisassemblyInfo &disassemblyInfo);
+	void Log(CpuType cpuType, CpuState &state, DisassemblyInfo &disassemblyInfo) { AddRow(cpuType, &state, sizeof(state), disassemblyInfo); }
+	void Log(SpcState &state, DisassemblyInfo &disassemblyInfo) { AddRow(CpuType::Spc, &state, sizeof(state), disassemblyInfo); }
+	void Log(NecDspState &state, DisassemblyInfo &disassemblyInfo) { AddRow(CpuType::NecDsp, &state, sizeof(state), disassemblyInfo); }
+	void Log(GsuState &state, DisassemblyInfo &disassemblyInfo) { AddRow(CpuType::Gsu, &state, sizeof(state), disassemblyInfo); }
+	void Log(Cx4State &state, DisassemblyInfo &disassemblyInfo) { AddRow(CpuType::Cx4, &state, sizeof(state), disassemblyInfo); }
+	void Log(GbCpuState &state, DisassemblyInfo &disassemblyInfo) { AddRow(CpuType::Gameboy, &state, sizeof(state), disassemblyInfo); }
+
 	void Clear();
-	//void LogNonExec(OperationInfo& operationInfo);
 	void SetOptions(TraceLoggerOptions options);
-	void StartLogging(string filename);
+
+	//Binary logs are much faster to produce, and can be converted to text later with ConvertBinaryLog
+	void StartLogging(string filename, bool binaryFormat = false);
 	void StopLogging();
 
+	//Renders a binary log to the text format, based on the current options
+	bool ConvertBinaryLog(string inputFile, string outputFile);
+
 	void LogExtraInfo(const char *log, uint32_t cycleCount);
 
-	const char* GetExecutionTrace(uint32_t lineCount);
+	string GetExecutionTrace(uint32_t lineCount);
 };
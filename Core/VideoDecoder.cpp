@@ -13,11 +13,12 @@
 #include "Ppu.h"
 #include "DebugHud.h"
 #include "InputHud.h"
+#include "SubsystemProfiler.h"
+#include "../Utilities/CRC32.h"
 
 VideoDecoder::VideoDecoder(shared_ptr<Console> console)
 {
 	_console = console;
-	_frameChanged = false;
 	_stopFlag = false;
 	_baseFrameInfo = { 512, 478 };
 	_lastFrameInfo = _baseFrameInfo;
@@ -81,7 +82,7 @@ void VideoDecoder::UpdateVideoFilter()
 	}
 }
 
-void VideoDecoder::DecodeFrame(bool forRewind)
+uint32_t* VideoDecoder::ApplyFilters(FrameInfo &frameInfo)
 {
 	UpdateVideoFilter();
 
@@ -89,7 +90,7 @@ void VideoDecoder::DecodeFrame(bool forRewind)
 	_videoFilter->SendFrame(_ppuOutputBuffer, _frameNumber);
 
 	uint32_t* outputBuffer = _videoFilter->GetOutputBuffer();
-	FrameInfo frameInfo = _videoFilter->GetFrameInfo();
+	frameInfo = _videoFilter->GetFrameInfo();
 	
 	_inputHud->DrawControllers(_videoFilter->GetOverscan(), _frameNumber);
 	_console->GetDebugHud()->Draw(outputBuffer, _videoFilter->GetOverscan(), frameInfo.Width, _frameNumber);
@@ -99,6 +100,14 @@ void VideoDecoder::DecodeFrame(bool forRewind)
 		frameInfo = _scaleFilter->GetFrameInfo(frameInfo);
 	}
 
+	return outputBuffer;
+}
+
+void VideoDecoder::DecodeFrame(bool forRewind)
+{
+	FrameInfo frameInfo;
+	uint32_t* outputBuffer = ApplyFilters(frameInfo);
+
 	ScreenSize screenSize = GetScreenSize(true);
 	VideoConfig config = _console->GetSettings()->GetVideoConfig();
 	if(_previousScale != config.VideoScale || screenSize.Height != _previousScreenSize.Height || screenSize.Width != _previousScreenSize.Width) {
@@ -109,24 +118,32 @@ void VideoDecoder::DecodeFrame(bool forRewind)
 	_lastFrameInfo = frameInfo;
 
 	//Rewind manager will take care of sending the correct frame to the video renderer
-	_console->GetRewindManager()->SendFrame(outputBuffer, frameInfo.Width, frameInfo.Height, forRewind);
-
-	_frameChanged = false;
+	_console->GetRewindManager()->SendFrame(outputBuffer, frameInfo.Width, frameInfo.Height, _frameTimestamp, forRewind);
 }
 
 void VideoDecoder::DecodeThread()
 {
 	//This thread will decode the PPU's output (color ID to RGB, intensify r/g/b and produce a HD version of the frame if needed)
 	while(!_stopFlag.load()) {
-		//DecodeFrame returns the final ARGB frame we want to display in the emulator window
-		while(!_frameChanged) {
+		//Only the most recent frame is decoded - if the decoding/filtering is slower than the emulation, older frames are dropped
+		while(!_frames.Consume()) {
 			_waitForFrame.Wait();
 			if(_stopFlag.load()) {
 				return;
 			}
 		}
 
-		DecodeFrame();
+		DecoderFrame &frame = _frames.GetReadBuffer();
+		_baseFrameInfo.Width = frame.Width;
+		_baseFrameInfo.Height = frame.Height;
+		_frameNumber = frame.FrameNumber;
+		_frameTimestamp = frame.Timestamp;
+		_ppuOutputBuffer = frame.Buffer.data();
+
+		//DecodeFrame returns the final ARGB frame we want to display in the emulator window
+		uint64_t startTicks = SubsystemProfiler::GetTicks();
+		DecodeFrame(frame.ForRewind);
+		_console->GetSubsystemProfiler()->AddAsyncTime(HostSubsystem::VideoFilter, startTicks);
 	}
 }
 
@@ -135,51 +152,94 @@ uint32_t VideoDecoder::GetFrameCount()
 	return _frameCount;
 }
 
-void VideoDecoder::UpdateFrameSync(uint16_t *ppuOutputBuffer, uint16_t width, uint16_t height, uint32_t frameNumber, bool forRewind)
+uint32_t VideoDecoder::GetFrameHash()
+{
+	return _frameHash;
+}
+
+void VideoDecoder::SetFilterHeadlessFrames(bool enabled)
+{
+	_filterHeadlessFrames = enabled;
+}
+
+uint32_t VideoDecoder::GetDroppedFrameCount()
+{
+	return _frames.GetDroppedCount();
+}
+
+void VideoDecoder::UpdateFrame(uint16_t *ppuOutputBuffer, uint16_t width, uint16_t height, uint32_t frameNumber, bool forRewind)
+{
+	ProcessFrame(ppuOutputBuffer, nullptr, width, height, frameNumber, forRewind);
+}
+
+void VideoDecoder::UpdateFrame(vector<uint16_t> &ppuOutputBuffer, uint16_t width, uint16_t height, uint32_t frameNumber, bool forRewind)
+{
+	ProcessFrame(ppuOutputBuffer.data(), &ppuOutputBuffer, width, height, frameNumber, forRewind);
+}
+
+void VideoDecoder::ProcessFrame(uint16_t *ppuOutputBuffer, vector<uint16_t> *swapBuffer, uint16_t width, uint16_t height, uint32_t frameNumber, bool forRewind)
 {
 	if(_console->IsRunAheadFrame()) {
 		return;
 	}
 
-	if(_frameChanged) {
-		//Last frame isn't done decoding yet - sometimes Signal() introduces a 25-30ms delay
-		while(_frameChanged) {
-			//Spin until decode is done
-		}
-		//At this point, we are sure that the decode thread is no longer busy
+	uint32_t frameWidth = width;
+	uint32_t frameHeight = height;
+	if(forRewind && !_console->GetRewindManager()->ProcessFrame(ppuOutputBuffer, frameWidth, frameHeight)) {
+		//Rewind manager keeps the frames emulated while rewinding and selects the (older) frame to display instead, if any
+		return;
 	}
-	
-	_frameChanged = true;
-	_baseFrameInfo.Width = width;
-	_baseFrameInfo.Height = height;
-	_frameNumber = frameNumber;
-	_ppuOutputBuffer = ppuOutputBuffer;
-	DecodeFrame(forRewind);
+
 	_frameCount++;
-}
 
-void VideoDecoder::UpdateFrame(uint16_t *ppuOutputBuffer, uint16_t width, uint16_t height, uint32_t frameNumber)
-{
-	if(_console->IsRunAheadFrame()) {
+	if(_console->IsHeadless()) {
+		//Headless consoles don't display anything, only keep a hash of the frame
+		_frameHash = CRC32::GetCRC((uint8_t*)ppuOutputBuffer, frameWidth * frameHeight * sizeof(uint16_t));
+
+		if(_filterHeadlessFrames) {
+			SubsystemScope scope(_console->GetSubsystemProfiler().get(), HostSubsystem::VideoFilter);
+			_baseFrameInfo.Width = frameWidth;
+			_baseFrameInfo.Height = frameHeight;
+			_frameNumber = frameNumber;
+			_ppuOutputBuffer = ppuOutputBuffer;
+			FrameInfo frameInfo;
+			ApplyFilters(frameInfo);
+		}
 		return;
 	}
 
-	if(_frameChanged) {
-		//Last frame isn't done decoding yet - sometimes Signal() introduces a 25-30ms delay
-		while(_frameChanged) {
-			//Spin until decode is done
-		}
-		//At this point, we are sure that the decode thread is no longer busy
+	uint64_t timestamp = VideoRenderer::GetTimestamp();
+
+	if(!_decodeThread) {
+		//No decode thread (e.g libretro), decode the frame right away
+		_baseFrameInfo.Width = frameWidth;
+		_baseFrameInfo.Height = frameHeight;
+		_frameNumber = frameNumber;
+		_frameTimestamp = timestamp;
+		_ppuOutputBuffer = ppuOutputBuffer;
+
+		SubsystemScope scope(_console->GetSubsystemProfiler().get(), HostSubsystem::VideoFilter);
+		DecodeFrame(forRewind);
+		return;
 	}
-	
-	_baseFrameInfo.Width = width;
-	_baseFrameInfo.Height = height;
-	_frameNumber = frameNumber;
-	_ppuOutputBuffer = ppuOutputBuffer;
-	_frameChanged = true;
-	_waitForFrame.Signal();
 
-	_frameCount++;
+	//Give the frame to the triple buffer - the PPU can start drawing the next frame without waiting for the decode thread
+	DecoderFrame &frame = _frames.GetWriteBuffer();
+	if(swapBuffer && ppuOutputBuffer == swapBuffer->data()) {
+		//The caller's buffer becomes the write buffer, and the caller gets the write buffer's memory in exchange (unless
+		//the rewind manager selected another frame to display, in which case that frame is copied)
+		frame.Buffer.resize(swapBuffer->size());
+		frame.Buffer.swap(*swapBuffer);
+	} else {
+		frame.Buffer.assign(ppuOutputBuffer, ppuOutputBuffer + frameWidth * frameHeight);
+	}
+	frame.Width = frameWidth;
+	frame.Height = frameHeight;
+	frame.FrameNumber = frameNumber;
+	frame.ForRewind = forRewind;
+	frame.Timestamp = timestamp;
+	_frames.Publish();
+	_waitForFrame.Signal();
 }
 
 void VideoDecoder::StartThread()
@@ -187,8 +247,8 @@ void VideoDecoder::StartThread()
 #ifndef LIBRETRO
 	if(!_decodeThread) {	
 		_stopFlag = false;
-		_frameChanged = false;
 		_frameCount = 0;
+		_frames.ResetDroppedCount();
 		_waitForFrame.Reset();
 		
 		_decodeThread.reset(new thread(&VideoDecoder::DecodeThread, this));
@@ -2,6 +2,7 @@
 #include "stdafx.h"
 #include "../Utilities/SimpleLock.h"
 #include "../Utilities/AutoResetEvent.h"
+#include "../Utilities/TripleBuffer.h"
 #include "SettingTypes.h"
 
 class BaseVideoFilter;
@@ -11,6 +12,16 @@ class IRenderingDevice;
 class InputHud;
 class Console;
 
+struct DecoderFrame
+{
+	vector<uint16_t> Buffer;
+	uint16_t Width;
+	uint16_t Height;
+	uint32_t FrameNumber;
+	bool ForRewind;
+	uint64_t Timestamp;
+};
+
 class VideoDecoder
 {
 private:
@@ -18,13 +29,17 @@ private:
 
 	uint16_t *_ppuOutputBuffer = nullptr;
 	uint32_t _frameNumber = 0;
+	uint64_t _frameTimestamp = 0;
+	uint32_t _frameHash = 0;
+	bool _filterHeadlessFrames = false;
 
 	unique_ptr<thread> _decodeThread;
 	unique_ptr<InputHud> _inputHud;
 
+	//Frames sent by the PPU (emulation thread) to the decode thread
+	TripleBuffer<DecoderFrame> _frames;
 	AutoResetEvent _waitForFrame;
 	
-	atomic<bool> _frameChanged;
 	atomic<bool> _stopFlag;
 	uint32_t _frameCount = 0;
 
@@ -39,24 +54,34 @@ private:
 	//shared_ptr<RotateFilter> _rotateFilter;
 
 	void UpdateVideoFilter();
+	uint32_t* ApplyFilters(FrameInfo &frameInfo);
 
 	void DecodeThread();
+	void ProcessFrame(uint16_t *ppuOutputBuffer, vector<uint16_t> *swapBuffer, uint16_t width, uint16_t height, uint32_t frameNumber, bool forRewind);
 
 public:
 	VideoDecoder(shared_ptr<Console> console);
 	~VideoDecoder();
 
-	void DecodeFrame(bool synchronous = false);
+	void DecodeFrame(bool forRewind = false);
 	void TakeScreenshot();
 	void TakeScreenshot(std::stringstream &stream);
 
 	uint32_t GetFrameCount();
+	uint32_t GetFrameHash();
+
+	//Headless consoles only keep a hash of each frame - when enabled, the frames also go through the video filters (for benchmarks)
+	void SetFilterHeadlessFrames(bool enabled);
+	uint32_t GetDroppedFrameCount();
 
 	FrameInfo GetFrameInfo();
 	ScreenSize GetScreenSize(bool ignoreScale);
 
-	void UpdateFrameSync(uint16_t *ppuOutputBuffer, uint16_t width, uint16_t height, uint32_t frameNumber, bool forRewind);
-	void UpdateFrame(uint16_t *ppuOutputBuffer, uint16_t width, uint16_t height, uint32_t frameNumber);
+	void UpdateFrame(uint16_t *ppuOutputBuffer, uint16_t width, uint16_t height, uint32_t frameNumber, bool forRewind);
+
+	//Same as above, but when the frame goes to the decode thread, the buffer is swapped with an unused one instead of being copied
+	//The frame's memory stays valid (read-only) until the next call, ppuOutputBuffer's content is undefined after the call
+	void UpdateFrame(vector<uint16_t> &ppuOutputBuffer, uint16_t width, uint16_t height, uint32_t frameNumber, bool forRewind);
 
 	bool IsRunning();
 	void StartThread();
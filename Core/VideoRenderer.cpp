@@ -1,10 +1,12 @@
 #include "stdafx.h"
+#include <chrono>
 #include "IRenderingDevice.h"
 #include "VideoRenderer.h"
 #include "VideoDecoder.h"
 #include "Console.h"
 #include "EmuSettings.h"
 #include "MessageManager.h"
+#include "SoundMixer.h"
 #include "../Utilities/IVideoRecorder.h"
 #include "../Utilities/AviRecorder.h"
 #include "../Utilities/GifRecorder.h"
@@ -13,6 +15,7 @@ VideoRenderer::VideoRenderer(shared_ptr<Console> console)
 {
 	_console = console;
 	_stopFlag = false;	
+	ResetStatistics();
 	StartThread();
 }
 
@@ -28,6 +31,7 @@ void VideoRenderer::StartThread()
 	if(!_renderThread) {
 		_stopFlag = false;
 		_waitForRender.Reset();
+		ResetStatistics();
 
 		_renderThread.reset(new std::thread(&VideoRenderer::RenderThread, this));
 	}
@@ -55,12 +59,24 @@ void VideoRenderer::RenderThread()
 		//Wait until a frame is ready, or until 16ms have passed (to allow UI to run at a minimum of 60fps)
 		_waitForRender.Wait(16);
 		if(_renderer) {
+			if(_frames.Consume()) {
+				RendererFrame &frame = _frames.GetReadBuffer();
+				uint64_t latency = GetTimestamp() - frame.Timestamp;
+				_lastLatency = latency;
+				_totalLatency += latency;
+				if(latency > _maxLatency) {
+					_maxLatency = latency;
+				}
+				_renderedFrames++;
+
+				_renderer->UpdateFrame(frame.Buffer.data(), frame.Width, frame.Height);
+			}
 			_renderer->Render();
 		}
 	}
 }
 
-void VideoRenderer::UpdateFrame(void* frameBuffer, uint32_t width, uint32_t height)
+void VideoRenderer::UpdateFrame(void* frameBuffer, uint32_t width, uint32_t height, uint64_t timestamp)
 {
 	shared_ptr<IVideoRecorder> recorder = _recorder;
 	if(recorder) {
@@ -68,11 +84,48 @@ void VideoRenderer::UpdateFrame(void* frameBuffer, uint32_t width, uint32_t heig
 	}
 
 	if(_renderer) {
+#ifdef LIBRETRO
 		_renderer->UpdateFrame(frameBuffer, width, height);
+#else
+		//Copy the frame to the triple buffer, the render thread will pick up the most recent frame when it's ready
+		//(the decode thread never needs to wait for the renderer)
+		RendererFrame &frame = _frames.GetWriteBuffer();
+		frame.Buffer.assign((uint32_t*)frameBuffer, (uint32_t*)frameBuffer + width * height);
+		frame.Width = width;
+		frame.Height = height;
+		frame.Timestamp = timestamp;
+		_frames.Publish();
 		_waitForRender.Signal();
+#endif
 	}
 }
 
+VideoPipelineStatistics VideoRenderer::GetStatistics()
+{
+	VideoPipelineStatistics stats = {};
+	stats.RenderedFrames = _renderedFrames;
+	stats.DecoderDroppedFrames = _console->GetVideoDecoder()->GetDroppedFrameCount();
+	stats.RendererDroppedFrames = _frames.GetDroppedCount();
+	stats.LastLatency = _lastLatency / 1000.0;
+	stats.AverageLatency = stats.RenderedFrames > 0 ? (_totalLatency / 1000.0 / stats.RenderedFrames) : 0;
+	stats.MaxLatency = _maxLatency / 1000.0;
+	return stats;
+}
+
+void VideoRenderer::ResetStatistics()
+{
+	_renderedFrames = 0;
+	_lastLatency = 0;
+	_maxLatency = 0;
+	_totalLatency = 0;
+	_frames.ResetDroppedCount();
+}
+
+uint64_t VideoRenderer::GetTimestamp()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 void VideoRenderer::RegisterRenderingDevice(IRenderingDevice *renderer)
 {
 	_renderer = renderer;
@@ -116,6 +169,8 @@ void VideoRenderer::StopRecording()
 {
 	shared_ptr<IVideoRecorder> recorder = _recorder;
 	if(recorder) {
+		//Write the audio that's still queued by the recording stream before closing the file
+		_console->GetSoundMixer()->FlushRecordingSamples();
 		MessageManager::DisplayMessage("VideoRecorder", "VideoRecorderStopped", recorder->GetOutputFile());
 	}
 	_recorder.reset();
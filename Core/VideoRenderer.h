@@ -2,6 +2,7 @@
 #include "stdafx.h"
 #include <thread>
 #include "../Utilities/AutoResetEvent.h"
+#include "../Utilities/TripleBuffer.h"
 
 class IRenderingDevice;
 class Console;
@@ -9,6 +10,26 @@ class Console;
 class IVideoRecorder;
 enum class VideoCodec;
 
+struct VideoPipelineStatistics
+{
+	uint32_t RenderedFrames;
+	uint32_t DecoderDroppedFrames; //Frames sent by the PPU that were replaced by a newer frame before being decoded
+	uint32_t RendererDroppedFrames; //Decoded frames that were replaced by a newer frame before being rendered
+
+	//Time between the PPU sending the frame and the render thread receiving it (in milliseconds)
+	double LastLatency;
+	double AverageLatency;
+	double MaxLatency;
+};
+
+struct RendererFrame
+{
+	vector<uint32_t> Buffer;
+	uint32_t Width;
+	uint32_t Height;
+	uint64_t Timestamp;
+};
+
 class VideoRenderer
 {
 private:
@@ -19,9 +40,18 @@ private:
 	IRenderingDevice* _renderer = nullptr;
 	atomic<bool> _stopFlag;
 
+	//Frames sent by the decode thread to the render thread
+	TripleBuffer<RendererFrame> _frames;
+
+	atomic<uint32_t> _renderedFrames;
+	atomic<uint64_t> _lastLatency;
+	atomic<uint64_t> _maxLatency;
+	atomic<uint64_t> _totalLatency;
+
 	shared_ptr<IVideoRecorder> _recorder;
 
 	void RenderThread();
+	void ResetStatistics();
 
 public:
 	VideoRenderer(shared_ptr<Console> console);
@@ -30,7 +60,11 @@ public:
 	void StartThread();
 	void StopThread();
 
-	void UpdateFrame(void *frameBuffer, uint32_t width, uint32_t height);
+	void UpdateFrame(void *frameBuffer, uint32_t width, uint32_t height, uint64_t timestamp);
+	VideoPipelineStatistics GetStatistics();
+
+	//Timestamp (in microseconds) used to measure the latency between the PPU and the renderer
+	static uint64_t GetTimestamp();
 	void RegisterRenderingDevice(IRenderingDevice *renderer);
 	void UnregisterRenderingDevice(IRenderingDevice *renderer);
 
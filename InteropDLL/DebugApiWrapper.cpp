@@ -20,6 +20,8 @@
 
 extern shared_ptr<Console> _console;
 static string _logString;
+static string _executionTrace;
+static string _scriptLog;
 
 shared_ptr<Debugger> GetDebugger()
 {
@@ -56,9 +58,15 @@ extern "C"
 
 	DllExport void __stdcall SetTraceOptions(TraceLoggerOptions options) { GetDebugger()->GetTraceLogger()->SetOptions(options); }
 	DllExport void __stdcall StartTraceLogger(char* filename) { GetDebugger()->GetTraceLogger()->StartLogging(filename); }
+	DllExport void __stdcall StartBinaryTraceLogger(char* filename) { GetDebugger()->GetTraceLogger()->StartLogging(filename, true); }
+	DllExport bool __stdcall ConvertBinaryTraceLog(char* inputFile, char* outputFile) { return GetDebugger()->GetTraceLogger()->ConvertBinaryLog(inputFile, outputFile); }
 	DllExport void __stdcall StopTraceLogger() { GetDebugger()->GetTraceLogger()->StopLogging(); }
 	DllExport void __stdcall ClearTraceLog() { GetDebugger()->GetTraceLogger()->Clear(); }
-	DllExport const char* GetExecutionTrace(uint32_t lineCount) { return GetDebugger()->GetTraceLogger()->GetExecutionTrace(lineCount); }
+	DllExport const char* GetExecutionTrace(uint32_t lineCount)
+	{
+		_executionTrace = GetDebugger()->GetTraceLogger()->GetExecutionTrace(lineCount);
+		return _executionTrace.c_str();
+	}
 
 	DllExport void __stdcall SetBreakpoints(Breakpoint breakpoints[], uint32_t length) { GetDebugger()->SetBreakpoints(breakpoints, length); }
 	DllExport int32_t __stdcall EvaluateExpression(char* expression, CpuType cpuType, EvalResultType *resultType, bool useCache) { return GetDebugger()->EvaluateExpression(expression, cpuType, *resultType, useCache); }
@@ -110,7 +118,11 @@ extern "C"
 
 	DllExport int32_t __stdcall LoadScript(char* name, char* content, int32_t scriptId) { return GetDebugger()->GetScriptManager()->LoadScript(name, content, scriptId); }
 	DllExport void __stdcall RemoveScript(int32_t scriptId) { GetDebugger()->GetScriptManager()->RemoveScript(scriptId); }
-	DllExport const char* __stdcall GetScriptLog(int32_t scriptId) { return GetDebugger()->GetScriptManager()->GetScriptLog(scriptId); }
+	DllExport const char* __stdcall GetScriptLog(int32_t scriptId)
+	{
+		_scriptLog = GetDebugger()->GetScriptManager()->GetScriptLog(scriptId);
+		return _scriptLog.c_str();
+	}
 	//DllExport void __stdcall DebugSetScriptTimeout(uint32_t timeout) { LuaScriptingContext::SetScriptTimeout(timeout); }
 
 	DllExport uint32_t __stdcall AssembleCode(CpuType cpuType, char* code, uint32_t startAddress, int16_t* assembledOutput) { return GetDebugger()->GetAssembler(cpuType)->AssembleCode(code, startAddress, assembledOutput); }
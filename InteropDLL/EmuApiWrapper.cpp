@@ -7,12 +7,14 @@
 #include "../Core/SystemActionManager.h"
 #include "../Core/MessageManager.h"
 #include "../Core/SaveStateManager.h"
+#include "../Core/RewindManager.h"
+#include "../Core/VideoRenderer.h"
 #include "../Core/INotificationListener.h"
 #include "../Core/KeyManager.h"
 #include "../Core/ShortcutKeyHandler.h"
 #include "../Core/CheatManager.h"
 #include "../Core/GameClient.h"
-#include "../Core/GameServer.h"
+#include "../Core/SubsystemProfiler.h"
 #include "../Utilities/ArchiveReader.h"
 #include "../Utilities/FolderUtilities.h"
 #include "InteropNotificationListeners.h"
@@ -62,7 +64,6 @@ extern "C" {
 	DllExport void __stdcall InitDll()
 	{
 		_console.reset(new Console());
-		KeyManager::SetSettings(_console->GetSettings().get());
 	}
 
 	DllExport void __stdcall InitializeEmu(const char* homeFolder, void *windowHandle, void *viewerHandle, bool noAudio, bool noVideo, bool noInput)
@@ -113,7 +114,7 @@ extern "C" {
 
 	DllExport bool __stdcall LoadRom(char* filename, char* patchFile)
 	{
-		GameClient::Disconnect();
+		_console->GetGameClient()->Disconnect();
 		return _console->LoadRom((VirtualFile)filename, patchFile ? (VirtualFile)patchFile : VirtualFile());
 	}
 
@@ -160,20 +161,20 @@ extern "C" {
 
 	DllExport void __stdcall Stop()
 	{
-		GameClient::Disconnect();
+		_console->GetGameClient()->Disconnect();
 		_console->Stop(true);
 	}
 
 	DllExport void __stdcall Pause()
 	{
-		if(!GameClient::Connected()) {
+		if(!_console->GetGameClient()->Connected()) {
 			_console->Pause();
 		}
 	}
 
 	DllExport void __stdcall Resume()
 	{
-		if(!GameClient::Connected()) {
+		if(!_console->GetGameClient()->Connected()) {
 			_console->Resume();
 		}
 	}
@@ -189,30 +190,27 @@ extern "C" {
 
 	DllExport void __stdcall Reset()
 	{
-		if(!GameClient::Connected()) {
+		if(!_console->GetGameClient()->Connected()) {
 			_console->GetControlManager()->GetSystemActionManager()->Reset();
 		}
 	}
 
 	DllExport void __stdcall PowerCycle()
 	{
-		if(!GameClient::Connected()) {
+		if(!_console->GetGameClient()->Connected()) {
 			_console->GetControlManager()->GetSystemActionManager()->PowerCycle();
 		}
 	}
 
 	DllExport void __stdcall ReloadRom()
 	{
-		if(!GameClient::Connected()) {
+		if(!_console->GetGameClient()->Connected()) {
 			_console->ReloadRom(false);
 		}
 	}
 
 	DllExport void __stdcall Release()
 	{
-		GameClient::Disconnect();
-		GameServer::StopServer();
-
 		_shortcutKeyHandler.reset();
 		
 		_console->Stop(true);
@@ -259,29 +257,26 @@ extern "C" {
 	DllExport void __stdcall LoadRecentGame(char* filepath, bool resetGame) { _console->GetSaveStateManager()->LoadRecentGame(filepath, resetGame); }
 	DllExport int32_t __stdcall GetSaveStatePreview(char* saveStatePath, uint8_t* pngData) { return _console->GetSaveStateManager()->GetSaveStatePreview(saveStatePath, pngData); }
 
-	DllExport void __stdcall PgoRunTest(vector<string> testRoms, bool enableDebugger)
+	DllExport RewindStatistics __stdcall GetRewindStatistics()
 	{
-		FolderUtilities::SetHomeFolder("../PGOMesenHome");
-
-		for(size_t i = 0; i < testRoms.size(); i++) {
-			std::cout << "Running: " << testRoms[i] << std::endl;
-
-			_console.reset(new Console());
-			KeyManager::SetSettings(_console->GetSettings().get());
-			_console->Initialize();
-			GameboyConfig cfg = _console->GetSettings()->GetGameboyConfig();
-			cfg.Model = GameboyModel::GameboyColor;
-			_console->GetSettings()->SetGameboyConfig(cfg);
-			_console->LoadRom((VirtualFile)testRoms[i], VirtualFile());
-
-			if(enableDebugger) {
-				//turn on debugger to profile the debugger's code too
-				_console->GetDebugger();
-			}
-				
-			std::this_thread::sleep_for(std::chrono::duration<int, std::milli>(5000));
-			_console->Stop(false);
-			_console->Release();
-		}
+		shared_ptr<RewindManager> rewindManager = _console->GetRewindManager();
+		return rewindManager ? rewindManager->GetStatistics() : RewindStatistics {};
+	}
+
+	DllExport VideoPipelineStatistics __stdcall GetVideoPipelineStatistics()
+	{
+		return _console->GetVideoRenderer()->GetStatistics();
+	}
+
+	DllExport void __stdcall SetSubsystemProfilerEnabled(bool enabled)
+	{
+		//The profiler's counters are only modified by the emulation thread, pause it while they are reset
+		auto lock = _console->AcquireLock();
+		_console->GetSubsystemProfiler()->SetEnabled(enabled);
+	}
+
+	DllExport SubsystemProfilerStats __stdcall GetSubsystemProfilerStats()
+	{
+		return _console->GetSubsystemProfiler()->GetStats();
 	}
 }
\ No newline at end of file
@@ -8,43 +8,52 @@
 extern shared_ptr<Console> _console;
 
 extern "C" {
-	DllExport void __stdcall StartServer(uint16_t port, char* password, char* hostPlayerName) { GameServer::StartServer(_console, port, password, hostPlayerName); }
-	DllExport void __stdcall StopServer() { GameServer::StopServer(); }
-	DllExport bool __stdcall IsServerRunning() { return GameServer::Started(); }
+	DllExport void __stdcall StartServer(uint16_t port, char* password, char* hostPlayerName, bool rollback) { _console->GetGameServer()->StartServer(port, password, hostPlayerName, rollback); }
+	DllExport void __stdcall StopServer() { _console->GetGameServer()->StopServer(); }
+	DllExport bool __stdcall IsServerRunning() { return _console->GetGameServer()->Started(); }
 
 	DllExport void __stdcall Connect(char* host, uint16_t port, char* password, char* playerName, bool spectator)
 	{
 		ClientConnectionData connectionData(host, port, password, playerName, spectator);
-		GameClient::Connect(_console, connectionData);
+		_console->GetGameClient()->Connect(connectionData);
 	}
 
-	DllExport void __stdcall Disconnect() { GameClient::Disconnect(); }
-	DllExport bool __stdcall IsConnected() { return GameClient::Connected(); }
+	DllExport void __stdcall Disconnect() { _console->GetGameClient()->Disconnect(); }
+	DllExport bool __stdcall IsConnected() { return _console->GetGameClient()->Connected(); }
 
 	DllExport int32_t __stdcall NetPlayGetAvailableControllers()
 	{
-		if(GameServer::Started()) {
-			return GameServer::GetAvailableControllers();
+		if(_console->GetGameServer()->Started()) {
+			return _console->GetGameServer()->GetAvailableControllers();
 		} else {
-			return GameClient::GetAvailableControllers();
+			return _console->GetGameClient()->GetAvailableControllers();
 		}
 	}
 
 	DllExport void __stdcall NetPlaySelectController(int32_t port)
 	{
-		if(GameServer::Started()) {
-			return GameServer::SetHostControllerPort(port);
+		if(_console->GetGameServer()->Started()) {
+			return _console->GetGameServer()->SetHostControllerPort(port);
 		} else {
-			return GameClient::SelectController(port);
+			return _console->GetGameClient()->SelectController(port);
+		}
+	}
+
+	DllExport NetplayStatistics __stdcall NetPlayGetStatistics()
+	{
+		if(_console->GetGameServer()->Started()) {
+			return _console->GetGameServer()->GetStatistics();
+		} else {
+			return _console->GetGameClient()->GetStatistics();
 		}
 	}
 
 	DllExport int32_t __stdcall NetPlayGetControllerPort()
 	{
-		if(GameServer::Started()) {
-			return GameServer::GetHostControllerPort();
+		if(_console->GetGameServer()->Started()) {
+			return _console->GetGameServer()->GetHostControllerPort();
 		} else {
-			return GameClient::GetControllerPort();
+			return _console->GetGameClient()->GetControllerPort();
 		}
 	}
 }
\ No newline at end of file
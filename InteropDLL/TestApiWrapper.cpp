@@ -1,10 +1,31 @@
 #include "stdafx.h"
 #include "../Core/RecordedRomTest.h"
 #include "../Core/Console.h"
+#include "../Core/BatchRunner.h"
+#include "../Core/Benchmarks.h"
+#include "../Core/ScaleFilter.h"
+#include "../Core/RingBufferTest.h"
+#include "../Core/NetplayTest.h"
+#include "../Utilities/AudioKernels.h"
+#include "../Utilities/FolderUtilities.h"
 
 extern shared_ptr<Console> _console;
 shared_ptr<RecordedRomTest> _recordedRomTest;
 
+//The benchmarks used by the PGO helper run headless consoles that use their own home folder
+static vector<BatchJob> GetPgoJobs(vector<string> &testRoms, uint32_t frameCount, string moviePath = "")
+{
+	FolderUtilities::SetHomeFolder("../PGOMesenHome");
+
+	vector<BatchJob> jobs(testRoms.size());
+	for(size_t i = 0; i < testRoms.size(); i++) {
+		jobs[i].RomPath = testRoms[i];
+		jobs[i].MoviePath = moviePath;
+		jobs[i].FrameCount = frameCount;
+	}
+	return jobs;
+}
+
 extern "C"
 {
 	DllExport int32_t __stdcall RunRecordedTest(char* filename, bool inBackground)
@@ -28,4 +49,92 @@ extern "C"
 	}
 
 	DllExport bool __stdcall RomTestRecording() { return _recordedRomTest != nullptr; }
+
+	//Runs each rom (with the same movie, if any) on its own headless console
+	//frameHashes receives romCount * frameCount hashes (all frames for the 1st rom, then the 2nd rom, etc.)
+	//Returns the number of roms that were loaded & ran successfully
+	DllExport int32_t __stdcall RunBatch(char** romPaths, uint32_t romCount, char* moviePath, uint32_t frameCount, uint32_t threadCount, uint32_t* frameHashes)
+	{
+		vector<BatchJob> jobs(romCount);
+		for(uint32_t i = 0; i < romCount; i++) {
+			jobs[i].RomPath = romPaths[i];
+			jobs[i].MoviePath = moviePath ? moviePath : "";
+			jobs[i].FrameCount = frameCount;
+		}
+
+		int32_t successCount = 0;
+		vector<BatchJobResult> results = BatchRunner::Run(jobs, threadCount);
+		for(uint32_t i = 0; i < romCount; i++) {
+			if(results[i].Success) {
+				memcpy(frameHashes + i * frameCount, results[i].FrameHashes.data(), frameCount * sizeof(uint32_t));
+				successCount++;
+			} else {
+				memset(frameHashes + i * frameCount, 0, frameCount * sizeof(uint32_t));
+			}
+		}
+		return successCount;
+	}
+
+	//Benchmarks & tests used by the PGO helper: each one fills report with a JSON report and returns true when all of its checks passed
+	DllExport bool __stdcall PgoRunTest(vector<string> testRoms, string moviePath, uint32_t frameCount, bool enableDebugger, string &report)
+	{
+		vector<BatchJob> jobs = GetPgoJobs(testRoms, frameCount, moviePath);
+		return Benchmarks::RunEmulationBenchmark(jobs, enableDebugger, report);
+	}
+
+	DllExport bool __stdcall PgoRunRewindBenchmark(vector<string> testRoms, uint32_t frameCount, string &report)
+	{
+		vector<BatchJob> jobs = GetPgoJobs(testRoms, frameCount);
+		return Benchmarks::RunRewindBenchmark(jobs, report);
+	}
+
+	DllExport bool __stdcall PgoRunTileCacheBenchmark(vector<string> testRoms, uint32_t frameCount, string &report)
+	{
+		vector<BatchJob> jobs = GetPgoJobs(testRoms, frameCount);
+		return Benchmarks::RunTileCacheBenchmark(jobs, report);
+	}
+
+	DllExport bool __stdcall PgoRunDirectPageBenchmark(vector<string> testRoms, uint32_t frameCount, string &report)
+	{
+		vector<BatchJob> jobs = GetPgoJobs(testRoms, frameCount);
+		return Benchmarks::RunDirectPageBenchmark(jobs, 3, report);
+	}
+
+	DllExport bool __stdcall PgoRunDmaTest(vector<string> testRoms, string &report)
+	{
+		vector<BatchJob> jobs = GetPgoJobs(testRoms, 60);
+		return Benchmarks::RunDmaTest(jobs, report);
+	}
+
+	DllExport bool __stdcall PgoRunRingBufferTest(uint32_t durationMs, string &report)
+	{
+		return RingBufferTest::Run(durationMs, report);
+	}
+
+	DllExport bool __stdcall PgoRunNetplayTest(string romPath, uint32_t frameCount, uint16_t port, uint32_t packetLossRate, string &report)
+	{
+		FolderUtilities::SetHomeFolder("../PGOMesenHome");
+		return NetplayTest::Run(romPath, frameCount, port, packetLossRate, report);
+	}
+
+	DllExport bool __stdcall RunAudioBenchmark(uint32_t frameCount, string &report)
+	{
+		return AudioKernels::RunBenchmark(frameCount, report);
+	}
+
+	DllExport bool __stdcall RunAudioKernelTests(string &report)
+	{
+		return AudioKernels::RunTests(report);
+	}
+
+	DllExport bool __stdcall RunScaleFilterBenchmark(uint32_t frameCount, uint32_t maxThreadCount, string &report)
+	{
+		report = ScaleFilter::RunBenchmark(frameCount, maxThreadCount);
+		return true;
+	}
+
+	DllExport bool __stdcall RunScaleFilterTests(string &report)
+	{
+		return ScaleFilter::RunTests(report);
+	}
 }
\ No newline at end of file
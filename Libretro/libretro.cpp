@@ -48,6 +48,7 @@ static constexpr const char* MesenCubicInterpolation = "mesen-s_cubic_interpolat
 static constexpr const char* MesenOverscanVertical = "mesen-s_overscan_vertical";
 static constexpr const char* MesenOverscanHorizontal = "mesen-s_overscan_horizontal";
 static constexpr const char* MesenRamState = "mesen-s_ramstate";
+static constexpr const char* MesenIdleLoopSkip = "mesen-s_idleloopskip";
 static constexpr const char* MesenOverclock = "mesen-s_overclock";
 static constexpr const char* MesenOverclockType = "mesen-s_overclock_type";
 static constexpr const char* MesenSuperFxOverclock = "mesen-s_superfx_overclock";
@@ -78,7 +79,6 @@ extern "C" {
 
 		_console.reset(new Console());
 		_console->Initialize();
-		KeyManager::SetSettings(_console->GetSettings().get());
 		
 		_renderer.reset(new LibretroRenderer(_console, retroEnv));
 		_soundManager.reset(new LibretroSoundManager(_console));
@@ -126,6 +126,7 @@ extern "C" {
 			{ MesenOverclockType, "Overclock Type; Before NMI|After NMI" },
 			{ MesenSuperFxOverclock, "Super FX Clock Speed; 100%|200%|300%|400%|500%|1000%" },
 			{ MesenRamState, "Default power-on state for RAM; Random Values (Default)|All 0s|All 1s" },
+			{ MesenIdleLoopSkip, "Skip CPU idle loops (faster); disabled|enabled" },
 			{ NULL, NULL },
 		};
 
@@ -385,6 +386,11 @@ extern "C" {
 			}
 		}
 
+		if(readVariable(MesenIdleLoopSkip, var)) {
+			string value = string(var.value);
+			emulation.EnableIdleLoopSkip = (value == "enabled");
+		}
+
 		if(readVariable(MesenBlendHighRes, var)) {
 			string value = string(var.value);
 			video.BlendHighResolutionModes = (value == "enabled");
@@ -488,21 +494,13 @@ extern "C" {
 
 	RETRO_API bool retro_serialize(void *data, size_t size)
 	{
-		std::stringstream ss;
-		_console->GetSaveStateManager()->SaveState(ss);
-		
-		string saveStateData = ss.str();
-		memset(data, 0, size);
-		memcpy(data, saveStateData.c_str(), std::min(size, saveStateData.size()));
-
-		return true;
+		//Writes an uncompressed state directly into the frontend's buffer
+		return _console->GetSaveStateManager()->SaveStateToMemory((uint8_t*)data, (uint32_t)size);
 	}
 
 	RETRO_API bool retro_unserialize(const void *data, size_t size)
 	{
-		std::stringstream ss;
-		ss.write((const char*)data, size);
-		return _console->GetSaveStateManager()->LoadState(ss);
+		return _console->GetSaveStateManager()->LoadStateFromMemory((const uint8_t*)data, (uint32_t)size);
 	}
 
 	RETRO_API void retro_cheat_reset()
@@ -677,14 +675,10 @@ extern "C" {
 			update_core_controllers();
 			update_input_descriptors();
 
-			//Savestates in Mesen may change size over time
-			//Retroarch doesn't like this for netplay or rewinding - it requires the states to always be the exact same size
-			//So we need to send a large enough size to Retroarch to ensure Mesen's state will always fit within that buffer.
-			std::stringstream ss;
-			_console->Serialize(ss);
-
-			//Round up to the next 1kb multiple
-			_saveStateSize = ((ss.str().size() * 2) + 0x400) & ~0x3FF;
+			//Retroarch requires the states to always be the exact same size for netplay or rewinding
+			//Uncompressed states only change size when a component's variable-size data changes (e.g controller states),
+			//which fits in the small reserve included in the size returned by GetMemoryStateSize.
+			_saveStateSize = _console->GetSaveStateManager()->GetMemoryStateSize();
 			retro_set_memory_maps();
 		}
 
@@ -7,6 +7,9 @@
 SdlSoundManager::SdlSoundManager(shared_ptr<Console> console)
 {
 	_console = console;
+	_buffering = true;
+	_startSampleCount = 0;
+	_lowestSampleCount = UINT32_MAX;
 
 	if(InitializeAudio(44100, false)) {
 		_console->GetSoundMixer()->RegisterAudioDevice(this);
@@ -15,6 +18,9 @@ SdlSoundManager::SdlSoundManager(shared_ptr<Console> console)
 
 SdlSoundManager::~SdlSoundManager()
 {
+	if(_console && _console->GetSoundMixer()) {
+		_console->GetSoundMixer()->RegisterAudioDevice(nullptr);
+	}
 	Release();
 }
 
@@ -30,12 +36,7 @@ void SdlSoundManager::Release()
 	if(_audioDeviceID != 0) {
 		Stop();
 		SDL_CloseAudioDevice(_audioDeviceID);
-	}
-
-	if(_buffer) {
-		delete[] _buffer;
-		_buffer = nullptr;
-		_bufferSize = 0;
+		_audioDeviceID = 0;
 	}
 }
 
@@ -52,18 +53,32 @@ bool SdlSoundManager::InitializeAudio(uint32_t sampleRate, bool isStereo)
 	_isStereo = isStereo;
 	_previousLatency = _console->GetSettings()->GetAudioConfig().AudioLatency;
 
-	int bytesPerSample = 2 * (isStereo ? 2 : 1);
-	int32_t requestedByteLatency = (int32_t)((float)(sampleRate * _previousLatency) / 1000.0f * bytesPerSample);
-	_bufferSize = (int32_t)std::ceil((double)requestedByteLatency * 2 / 0x10000) * 0x10000;
-	_buffer = new uint8_t[_bufferSize];
-	memset(_buffer, 0, _bufferSize);
+	uint32_t channelCount = isStereo ? 2 : 1;
+	uint32_t latencyFrameCount = sampleRate * _previousLatency / 1000;
+	_latencyController.Reset(_previousLatency);
+	UpdateTargetLatency();
+
+	//Leave room for the emulation to run ahead of the highest target latency (e.g while fast forwarding) before samples are dropped
+	uint32_t maxSampleCount = (uint32_t)(sampleRate * (_previousLatency + AudioLatencyController::MaxExtraLatency) / 1000) * channelCount;
+	_buffer.Reset(std::max<uint32_t>(maxSampleCount * 4, 0x1000));
+	_bufferSize = _buffer.GetCapacity() * sizeof(int16_t);
+	_buffering = true;
+	_lowestSampleCount = UINT32_MAX;
+	_lastUnderrunCount = 0;
+
+	//Samples are written once per frame, so the buffer's level drops by up to a frame's worth of samples before the next write.
+	//The callback's period must fit in what remains for low latencies (e.g 20ms) to be usable: use ~1/4 of the requested latency.
+	uint16_t callbackFrameCount = 128;
+	while(callbackFrameCount < 1024 && callbackFrameCount * 2 <= latencyFrameCount / 4) {
+		callbackFrameCount *= 2;
+	}
 
 	SDL_AudioSpec audioSpec;
 	SDL_memset(&audioSpec, 0, sizeof(audioSpec));
 	audioSpec.freq = sampleRate;
 	audioSpec.format = AUDIO_S16SYS; //16-bit samples
 	audioSpec.channels = isStereo ? 2 : 1;
-	audioSpec.samples = 1024;
+	audioSpec.samples = callbackFrameCount;
 	audioSpec.callback = &SdlSoundManager::FillAudioBuffer;
 	audioSpec.userdata = this;
 
@@ -75,9 +90,6 @@ bool SdlSoundManager::InitializeAudio(uint32_t sampleRate, bool isStereo)
 		_audioDeviceID = SDL_OpenAudioDevice(nullptr, isCapture, &audioSpec, &obtainedSpec, 0);
 	}
 
-	_writePosition = 0;
-	_readPosition = 0;
-
 	_needReset = false;
 
 	return _audioDeviceID != 0;
@@ -119,77 +131,104 @@ void SdlSoundManager::SetAudioDevice(string deviceName)
 
 void SdlSoundManager::ReadFromBuffer(uint8_t* output, uint32_t len)
 {
-	if(_readPosition + len < _bufferSize) {
-		memcpy(output, _buffer+_readPosition, len);
-		_readPosition += len;
-	} else {
-		int remainingBytes = (_bufferSize - _readPosition);
-		memcpy(output, _buffer+_readPosition, remainingBytes);
-		memcpy(output+remainingBytes, _buffer, len - remainingBytes);
-		_readPosition = len - remainingBytes;
-	}
+	int16_t* samples = (int16_t*)output;
+	uint32_t sampleCount = len / sizeof(int16_t);
+	uint32_t readCount = 0;
 
-	if(_readPosition >= _writePosition && _readPosition - _writePosition < _bufferSize / 2) {
-		_bufferUnderrunEventCount++;
+	if(_buffering && _buffer.GetAvailableCount() >= _startSampleCount) {
+		_buffering = false;
 	}
-}
 
-void SdlSoundManager::WriteToBuffer(uint8_t* input, uint32_t len)
-{
-	if(_writePosition + len < _bufferSize) {
-		memcpy(_buffer+_writePosition, input, len);
-		_writePosition += len;
-	} else {
-		int remainingBytes = _bufferSize - _writePosition;
-		memcpy(_buffer+_writePosition, input, remainingBytes);
-		memcpy(_buffer, ((uint8_t*)input)+remainingBytes, len - remainingBytes);
-		_writePosition = len - remainingBytes;
+	if(!_buffering) {
+		readCount = _buffer.Read(samples, sampleCount);
+		if(readCount < sampleCount) {
+			//Underrun (counted by the buffer), wait until the target latency is reached again before resuming playback
+			_buffering = true;
+		}
+
+		//Keep track of the margin that was left before an underrun (for AudioLatencyController)
+		uint32_t remainingCount = _buffer.GetAvailableCount();
+		uint32_t lowestCount = _lowestSampleCount;
+		while(remainingCount < lowestCount && !_lowestSampleCount.compare_exchange_weak(lowestCount, remainingCount)) {
+		}
 	}
+
+	//Output silence instead of the samples that are missing
+	memset(samples + readCount, 0, (sampleCount - readCount) * sizeof(int16_t));
 }
+
 void SdlSoundManager::PlayBuffer(int16_t *soundBuffer, uint32_t sampleCount, uint32_t sampleRate, bool isStereo)
 {
-	uint32_t bytesPerSample = 2 * (isStereo ? 2 : 1);
 	uint32_t latency = _console->GetSettings()->GetAudioConfig().AudioLatency;
 	if(_sampleRate != sampleRate || _isStereo != isStereo || _needReset || _previousLatency != latency) {
 		Release();
 		InitializeAudio(sampleRate, isStereo);
 	}
 
-	WriteToBuffer((uint8_t*)soundBuffer, sampleCount * bytesPerSample);
-
-	int32_t byteLatency = (int32_t)((float)(sampleRate * latency) / 1000.0f * bytesPerSample);
-	int32_t playWriteByteLatency = _writePosition - _readPosition;
-	if(playWriteByteLatency < 0) {
-		playWriteByteLatency = _bufferSize - _readPosition + _writePosition;
-	}
+	//Samples that don't fit are dropped (and counted as an overrun by the buffer)
+	_buffer.Write(soundBuffer, sampleCount * (isStereo ? 2 : 1));
 
-	if(playWriteByteLatency > byteLatency) {
-		//Start playing
+	if(!_isPlaying) {
+		//Start playing - the callback outputs silence until the target latency is reached
 		SDL_PauseAudioDevice(_audioDeviceID, 0);
+		_isPlaying = true;
 	}
 }
 
 void SdlSoundManager::Pause()
 {
 	SDL_PauseAudioDevice(_audioDeviceID, 1);
+	_isPlaying = false;
 }
 
 void SdlSoundManager::Stop()
 {
 	Pause();
 
-	_readPosition = 0;
-	_writePosition = 0;
+	//The callback isn't running while the device is paused
+	_buffer.Clear();
+	_buffer.ResetCounters();
+	_buffering = true;
+	_lowestSampleCount = UINT32_MAX;
+	_lastUnderrunCount = 0;
 	ResetStats();
 }
 
+void SdlSoundManager::UpdateTargetLatency()
+{
+	uint32_t channelCount = _isStereo ? 2 : 1;
+	_startSampleCount = (uint32_t)(_sampleRate * _latencyController.GetTargetLatency() / 1000) * channelCount;
+}
+
 void SdlSoundManager::ProcessEndOfFrame()
 {
-	ProcessLatency(_readPosition, _writePosition);
+	ProcessLatency(_buffer.GetAvailableCount() * sizeof(int16_t));
 
 	uint32_t emulationSpeed = _console->GetSettings()->GetEmulationSpeed();
-	if(_averageLatency > 0 && emulationSpeed <= 100 && emulationSpeed > 0 && std::abs(_averageLatency - _console->GetSettings()->GetAudioConfig().AudioLatency) > 50) {
+
+	uint32_t underrunCount = _buffer.GetUnderrunCount();
+	uint32_t lowestSampleCount = _lowestSampleCount.exchange(UINT32_MAX);
+	if(emulationSpeed == 100) {
+		//Underruns are only caused by the device when the emulation runs at normal speed (not slowed down, paused, etc.)
+		double samplesPerMs = _sampleRate * (_isStereo ? 2 : 1) / 1000.0;
+		double lowestLevel = lowestSampleCount == UINT32_MAX ? -1 : lowestSampleCount / samplesPerMs;
+		if(_latencyController.ProcessFrame(underrunCount - _lastUnderrunCount, lowestLevel)) {
+			UpdateTargetLatency();
+		}
+	}
+	_lastUnderrunCount = underrunCount;
+
+	if(_averageLatency > 0 && emulationSpeed <= 100 && emulationSpeed > 0 && std::abs(_averageLatency - _latencyController.GetTargetLatency()) > 50) {
 		//Latency is way off (over 50ms gap), stop audio & start again
 		Stop();
 	}
 }
+
+AudioStatistics SdlSoundManager::GetStatistics()
+{
+	AudioStatistics stats = BaseSoundManager::GetStatistics();
+	stats.BufferUnderrunEventCount = _buffer.GetUnderrunCount();
+	stats.BufferOverrunEventCount = _buffer.GetOverrunCount();
+	stats.TargetLatency = _latencyController.GetTargetLatency();
+	return stats;
+}
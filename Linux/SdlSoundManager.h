@@ -1,6 +1,8 @@
 ﻿#pragma once
 #include <SDL2/SDL.h>
 #include "../Core/BaseSoundManager.h"
+#include "../Core/AudioLatencyController.h"
+#include "../Utilities/SpscRingBuffer.h"
 
 class Console;
 
@@ -15,6 +17,7 @@ public:
 	void Stop();
 
 	void ProcessEndOfFrame();
+	AudioStatistics GetStatistics();
 
 	string GetAvailableDevices();
 	void SetAudioDevice(string deviceName);
@@ -27,17 +30,26 @@ private:
 	static void FillAudioBuffer(void *userData, uint8_t *stream, int len);
 
 	void ReadFromBuffer(uint8_t* output, uint32_t len);
-	void WriteToBuffer(uint8_t* output, uint32_t len);
+	void UpdateTargetLatency();
 
 private:
 	shared_ptr<Console> _console;
-	SDL_AudioDeviceID _audioDeviceID;
+	SDL_AudioDeviceID _audioDeviceID = 0;
 	string _deviceName;
 	bool _needReset = false;
+	bool _isPlaying = false;
 
 	uint16_t _previousLatency = 0;
 
-	uint8_t* _buffer = nullptr;
-	uint32_t _writePosition = 0;
-	uint32_t _readPosition = 0;
+	//Written by the emulation thread, read by SDL's audio callback
+	SpscRingBuffer<int16_t> _buffer;
+
+	//Set when the buffer runs out of samples: the callback outputs silence until the requested latency is buffered again
+	atomic<bool> _buffering;
+	atomic<uint32_t> _startSampleCount;
+
+	//Lowest number of samples left in the buffer after a read by the callback, since the last frame (UINT32_MAX = no reads)
+	atomic<uint32_t> _lowestSampleCount;
+	uint32_t _lastUnderrunCount = 0;
+	AudioLatencyController _latencyController;
 };
@@ -2,6 +2,10 @@
 #include <string>
 #include <algorithm>
 #include <unordered_set>
+#include <thread>
+#include <functional>
+#include <iostream>
+#include <cstdint>
 #if __has_include(<filesystem>)
 	#include <filesystem>
 	namespace fs = std::filesystem;
@@ -14,7 +18,17 @@ using std::string;
 using std::vector;
 
 extern "C" {
-	void __stdcall PgoRunTest(vector<string> testRoms, bool enableDebugger);
+	bool __stdcall PgoRunTest(vector<string> testRoms, string moviePath, uint32_t frameCount, bool enableDebugger, string &report);
+	bool __stdcall RunScaleFilterBenchmark(uint32_t frameCount, uint32_t maxThreadCount, string &report);
+	bool __stdcall RunScaleFilterTests(string &report);
+	bool __stdcall RunAudioBenchmark(uint32_t frameCount, string &report);
+	bool __stdcall RunAudioKernelTests(string &report);
+	bool __stdcall PgoRunRewindBenchmark(vector<string> testRoms, uint32_t frameCount, string &report);
+	bool __stdcall PgoRunDmaTest(vector<string> testRoms, string &report);
+	bool __stdcall PgoRunTileCacheBenchmark(vector<string> testRoms, uint32_t frameCount, string &report);
+	bool __stdcall PgoRunDirectPageBenchmark(vector<string> testRoms, uint32_t frameCount, string &report);
+	bool __stdcall PgoRunNetplayTest(string romPath, uint32_t frameCount, uint16_t port, uint32_t packetLossRate, string &report);
+	bool __stdcall PgoRunRingBufferTest(uint32_t durationMs, string &report);
 }
 
 vector<string> GetFilesInFolder(string rootFolder, std::unordered_set<string> extensions)
@@ -40,15 +54,124 @@ vector<string> GetFilesInFolder(string rootFolder, std::unordered_set<string> ex
 	return files;
 }
 
+vector<string> GetTestRoms(string folder)
+{
+	return GetFilesInFolder(folder, { {".sfc", ".gb", ".gbc"} });
+}
+
+uint32_t GetArg(vector<string> &args, size_t index, uint32_t defaultValue)
+{
+	return index < args.size() ? (uint32_t)std::stoul(args[index]) : defaultValue;
+}
+
+struct TestCommand
+{
+	string Name;
+	string Usage;
+	size_t RequiredArgCount;
+
+	//Receives the arguments that follow the command's name, fills report (JSON) and returns true when all of the test's checks passed
+	std::function<bool(vector<string> &args, string &report)> Run;
+};
+
+vector<TestCommand> _testCommands = {
+	//Time taken to run each game for a fixed number of frames, optionally with a movie's input
+	//Each game is run again with idle loop skipping enabled, the report contains the speedup and whether all frames were identical
+	{ "--benchmark", "<folder> [frames=600] [movie]", 1, [](vector<string> &args, string &report) {
+		return PgoRunTest(GetTestRoms(args[0]), args.size() >= 3 ? args[2] : "", GetArg(args, 1, 600), false, report);
+	} },
+
+	//Time taken by each scale filter, for 1 to N threads (N = number of cores by default)
+	{ "--benchmark-scale-filters", "[maxThreads]", 0, [](vector<string> &args, string &report) {
+		return RunScaleFilterBenchmark(100, GetArg(args, 0, std::max(1u, std::thread::hardware_concurrency())), report);
+	} },
+
+	//Compares each scale filter's output when the image is split in bands (multithreaded) with its output for the whole image at once
+	{ "--test-scale-filters", "", 0, [](vector<string> &args, string &report) {
+		return RunScaleFilterTests(report);
+	} },
+
+	//Memory used by the rewind history of each game, after N minutes of emulation
+	{ "--benchmark-rewind", "<folder> [minutes=30]", 1, [](vector<string> &args, string &report) {
+		return PgoRunRewindBenchmark(GetTestRoms(args[0]), GetArg(args, 1, 30) * 3600, report);
+	} },
+
+	//Time taken to run each game with and without the PPU's tile cache, and the cache's hit rate
+	{ "--benchmark-tile-cache", "<folder> [frames=600]", 1, [](vector<string> &args, string &report) {
+		return PgoRunTileCacheBenchmark(GetFilesInFolder(args[0], { {".sfc"} }), GetArg(args, 1, 600), report);
+	} },
+
+	//FPS of each game with and without the direct RAM/ROM page tables (best of 3 runs each)
+	{ "--benchmark-direct-pages", "<folder> [frames=600]", 1, [](vector<string> &args, string &report) {
+		return PgoRunDirectPageBenchmark(GetFilesInFolder(args[0], { {".sfc"} }), GetArg(args, 1, 600), report);
+	} },
+
+	//Runs 64KB and partial DMA transfers to VRAM in each game, copied in blocks and one byte at a time (see Benchmarks::RunDmaTest)
+	{ "--dma-test", "<folder>", 1, [](vector<string> &args, string &report) {
+		return PgoRunDmaTest(GetFilesInFolder(args[0], { {".sfc"} }), report);
+	} },
+
+	//Hammers the audio ring buffer from a producer and a consumer thread, for the given duration (in ms) of each pass (see RingBufferTest)
+	{ "--ring-buffer-test", "[durationMs=2000]", 0, [](vector<string> &args, string &report) {
+		return PgoRunRingBufferTest(GetArg(args, 0, 2000), report);
+	} },
+
+	//Runs a rollback netplay session between 2 consoles over the loopback interface (see NetplayTest)
+	//The last argument is the percentage of input messages to discard (simulated packet loss)
+	{ "--netplay-test", "<rom> [frames=600] [port=8888] [packetLoss=0]", 1, [](vector<string> &args, string &report) {
+		return PgoRunNetplayTest(args[0], GetArg(args, 1, 600), (uint16_t)GetArg(args, 2, 8888), GetArg(args, 3, 0), report);
+	} },
+
+	//Time taken by the scalar and vectorized audio kernels (resampler, equalizer, volume/mixing), and the largest difference between their outputs
+	{ "--benchmark-audio", "[frames=3600]", 0, [](vector<string> &args, string &report) {
+		return RunAudioBenchmark(GetArg(args, 0, 3600), report);
+	} },
+
+	//Compares the vectorized audio kernels against their scalar implementations
+	{ "--test-audio-kernels", "", 0, [](vector<string> &args, string &report) {
+		return RunAudioKernelTests(report);
+	} },
+};
+
+int RunTestCommand(int argc, char* argv[])
+{
+	vector<string> args(argv + 2, argv + argc);
+	for(TestCommand &command : _testCommands) {
+		if(command.Name == argv[1] && args.size() >= command.RequiredArgCount) {
+			string report;
+			bool passed = command.Run(args, report);
+			std::cout << report;
+			return passed ? 0 : 1;
+		}
+	}
+
+	std::cout << "Usage:" << std::endl;
+	for(TestCommand &command : _testCommands) {
+		std::cout << "  PGOHelper " << command.Name << (command.Usage.empty() ? "" : " " + command.Usage) << std::endl;
+	}
+	std::cout << "  PGOHelper [folder=../PGOGames]" << std::endl;
+	return 1;
+}
+
 int main(int argc, char* argv[])
 {
+	if(argc >= 2 && string(argv[1]).compare(0, 2, "--") == 0) {
+		return RunTestCommand(argc, argv);
+	}
+
 	string romFolder = "../PGOGames";
 	if(argc >= 2) {
 		romFolder = argv[1];
 	}
 
-	vector<string> testRoms = GetFilesInFolder(romFolder, { {".sfc", ".gb", ".gbc"} });
-	PgoRunTest(testRoms, true);
+	vector<string> testRoms = GetTestRoms(romFolder);
+
+	//Run each game without and with the debugger, to profile both the stripped and instrumented emulation loops
+	string report;
+	PgoRunTest(testRoms, "", 600, false, report);
+	std::cout << report;
+	PgoRunTest(testRoms, "", 600, true, report);
+	std::cout << report;
 	return 0;
 }
 
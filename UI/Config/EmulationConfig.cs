@@ -30,6 +30,7 @@ namespace Mesen.GUI.Config
 		public long BsxCustomDate = -1;
 
 		[MarshalAs(UnmanagedType.I1)] public bool AllowInvalidInput = false;
+		[MarshalAs(UnmanagedType.I1)] public bool EnableIdleLoopSkip = false;
 
 		public void ApplyConfig()
 		{
@@ -18,5 +18,6 @@ namespace Mesen.GUI.Config
 		public string ServerName = "Default";
 		public UInt16 ServerPort = 8888;
 		public string ServerPassword = "";
+		public bool ServerRollback = false;
 	}
 }
@@ -30,6 +30,7 @@ namespace Mesen.GUI.Config
 		public bool AssociateMssFiles = false;
 
 		public UInt32 RewindBufferSize = 30;
+		public UInt32 RewindVideoBufferSize = 64;
 
 		public bool AlwaysOnTop = false;
 		public bool AutoHideMenu = false;
@@ -169,7 +170,8 @@ namespace Mesen.GUI.Config
 				SaveFolderOverride = OverrideSaveDataFolder ? SaveDataFolder : "",
 				SaveStateFolderOverride = OverrideSaveStateFolder ? SaveStateFolder : "",
 				ScreenshotFolderOverride = OverrideScreenshotFolder ? ScreenshotFolder : "",
-				RewindBufferSize = RewindBufferSize
+				RewindBufferSize = RewindBufferSize,
+				RewindVideoBufferSize = RewindVideoBufferSize
 			});
 		}
 	}
@@ -186,6 +188,7 @@ namespace Mesen.GUI.Config
 		[MarshalAs(UnmanagedType.I1)] public bool DisableGameSelectionScreen;
 		
 		public UInt32 RewindBufferSize;
+		public UInt32 RewindVideoBufferSize;
 
 		public string SaveFolderOverride;
 		public string SaveStateFolderOverride;
@@ -92,6 +92,10 @@
 			this.lblRewind = new System.Windows.Forms.Label();
 			this.nudRewindBufferSize = new Mesen.GUI.Controls.MesenNumericUpDown();
 			this.lblRewindMinutes = new System.Windows.Forms.Label();
+			this.flowLayoutPanel7 = new System.Windows.Forms.FlowLayoutPanel();
+			this.lblRewindVideoBuffer = new System.Windows.Forms.Label();
+			this.nudRewindVideoBufferSize = new Mesen.GUI.Controls.MesenNumericUpDown();
+			this.lblRewindVideoBufferMb = new System.Windows.Forms.Label();
 			this.chkDisplayTitleBarInfo = new System.Windows.Forms.CheckBox();
 			this.chkShowGameTimer = new System.Windows.Forms.CheckBox();
 			this.chkShowFrameCounter = new System.Windows.Forms.CheckBox();
@@ -121,6 +125,7 @@
 			this.tpgAdvanced.SuspendLayout();
 			this.tableLayoutPanel1.SuspendLayout();
 			this.flowLayoutPanel6.SuspendLayout();
+			this.flowLayoutPanel7.SuspendLayout();
 			this.SuspendLayout();
 			// 
 			// baseConfigPanel
@@ -884,6 +889,7 @@
 			this.tableLayoutPanel1.Controls.Add(this.chkDisableGameSelectionScreen, 0, 4);
 			this.tableLayoutPanel1.Controls.Add(this.lblAdvancedMisc, 0, 10);
 			this.tableLayoutPanel1.Controls.Add(this.flowLayoutPanel6, 0, 11);
+			this.tableLayoutPanel1.Controls.Add(this.flowLayoutPanel7, 0, 12);
 			this.tableLayoutPanel1.Controls.Add(this.chkDisplayTitleBarInfo, 0, 5);
 			this.tableLayoutPanel1.Controls.Add(this.chkShowGameTimer, 0, 8);
 			this.tableLayoutPanel1.Controls.Add(this.chkShowFrameCounter, 0, 7);
@@ -896,7 +902,7 @@
 			this.tableLayoutPanel1.Dock = System.Windows.Forms.DockStyle.Fill;
 			this.tableLayoutPanel1.Location = new System.Drawing.Point(3, 3);
 			this.tableLayoutPanel1.Name = "tableLayoutPanel1";
-			this.tableLayoutPanel1.RowCount = 12;
+			this.tableLayoutPanel1.RowCount = 13;
 			this.tableLayoutPanel1.RowStyles.Add(new System.Windows.Forms.RowStyle(System.Windows.Forms.SizeType.Absolute, 20F));
 			this.tableLayoutPanel1.RowStyles.Add(new System.Windows.Forms.RowStyle());
 			this.tableLayoutPanel1.RowStyles.Add(new System.Windows.Forms.RowStyle(System.Windows.Forms.SizeType.Absolute, 20F));
@@ -908,6 +914,7 @@
 			this.tableLayoutPanel1.RowStyles.Add(new System.Windows.Forms.RowStyle());
 			this.tableLayoutPanel1.RowStyles.Add(new System.Windows.Forms.RowStyle());
 			this.tableLayoutPanel1.RowStyles.Add(new System.Windows.Forms.RowStyle(System.Windows.Forms.SizeType.Absolute, 20F));
+			this.tableLayoutPanel1.RowStyles.Add(new System.Windows.Forms.RowStyle());
 			this.tableLayoutPanel1.RowStyles.Add(new System.Windows.Forms.RowStyle(System.Windows.Forms.SizeType.Percent, 100F));
 			this.tableLayoutPanel1.Size = new System.Drawing.Size(534, 383);
 			this.tableLayoutPanel1.TabIndex = 0;
@@ -1000,6 +1007,71 @@
 			this.lblRewindMinutes.TabIndex = 2;
 			this.lblRewindMinutes.Text = "minutes (Memory Usage ≈5MB/min)";
 			// 
+			// flowLayoutPanel7
+			// 
+			this.flowLayoutPanel7.Controls.Add(this.lblRewindVideoBuffer);
+			this.flowLayoutPanel7.Controls.Add(this.nudRewindVideoBufferSize);
+			this.flowLayoutPanel7.Controls.Add(this.lblRewindVideoBufferMb);
+			this.flowLayoutPanel7.Dock = System.Windows.Forms.DockStyle.Top;
+			this.flowLayoutPanel7.Location = new System.Drawing.Point(10, 273);
+			this.flowLayoutPanel7.Margin = new System.Windows.Forms.Padding(10, 3, 0, 0);
+			this.flowLayoutPanel7.Name = "flowLayoutPanel7";
+			this.flowLayoutPanel7.Size = new System.Drawing.Size(524, 23);
+			this.flowLayoutPanel7.TabIndex = 36;
+			// 
+			// lblRewindVideoBuffer
+			// 
+			this.lblRewindVideoBuffer.Anchor = System.Windows.Forms.AnchorStyles.Left;
+			this.lblRewindVideoBuffer.AutoSize = true;
+			this.lblRewindVideoBuffer.Location = new System.Drawing.Point(3, 4);
+			this.lblRewindVideoBuffer.Name = "lblRewindVideoBuffer";
+			this.lblRewindVideoBuffer.Size = new System.Drawing.Size(139, 13);
+			this.lblRewindVideoBuffer.TabIndex = 3;
+			this.lblRewindVideoBuffer.Text = "Rewind video buffer size:";
+			// 
+			// nudRewindVideoBufferSize
+			// 
+			this.nudRewindVideoBufferSize.Anchor = System.Windows.Forms.AnchorStyles.Left;
+			this.nudRewindVideoBufferSize.DecimalPlaces = 0;
+			this.nudRewindVideoBufferSize.Increment = new decimal(new int[] {
+            1,
+            0,
+            0,
+            0});
+			this.nudRewindVideoBufferSize.IsHex = false;
+			this.nudRewindVideoBufferSize.Location = new System.Drawing.Point(145, 0);
+			this.nudRewindVideoBufferSize.Margin = new System.Windows.Forms.Padding(0);
+			this.nudRewindVideoBufferSize.Maximum = new decimal(new int[] {
+            512,
+            0,
+            0,
+            0});
+			this.nudRewindVideoBufferSize.MaximumSize = new System.Drawing.Size(10000, 20);
+			this.nudRewindVideoBufferSize.Minimum = new decimal(new int[] {
+            16,
+            0,
+            0,
+            0});
+			this.nudRewindVideoBufferSize.MinimumSize = new System.Drawing.Size(0, 21);
+			this.nudRewindVideoBufferSize.Name = "nudRewindVideoBufferSize";
+			this.nudRewindVideoBufferSize.Size = new System.Drawing.Size(42, 21);
+			this.nudRewindVideoBufferSize.TabIndex = 1;
+			this.nudRewindVideoBufferSize.Value = new decimal(new int[] {
+            64,
+            0,
+            0,
+            0});
+			// 
+			// lblRewindVideoBufferMb
+			// 
+			this.lblRewindVideoBufferMb.Anchor = System.Windows.Forms.AnchorStyles.Left;
+			this.lblRewindVideoBufferMb.AutoSize = true;
+			this.lblRewindVideoBufferMb.Location = new System.Drawing.Point(190, 4);
+			this.lblRewindVideoBufferMb.Name = "lblRewindVideoBufferMb";
+			this.lblRewindVideoBufferMb.Size = new System.Drawing.Size(23, 13);
+			this.lblRewindVideoBufferMb.TabIndex = 2;
+			this.lblRewindVideoBufferMb.Text = "MB";
+			// 
 			// chkDisplayTitleBarInfo
 			// 
 			this.chkDisplayTitleBarInfo.AutoSize = true;
@@ -1143,6 +1215,8 @@
 			this.tableLayoutPanel1.PerformLayout();
 			this.flowLayoutPanel6.ResumeLayout(false);
 			this.flowLayoutPanel6.PerformLayout();
+			this.flowLayoutPanel7.ResumeLayout(false);
+			this.flowLayoutPanel7.PerformLayout();
 			this.ResumeLayout(false);
 			this.PerformLayout();
 
@@ -1213,6 +1287,10 @@
 		private System.Windows.Forms.Label lblRewind;
 		private Controls.MesenNumericUpDown nudRewindBufferSize;
 		private System.Windows.Forms.Label lblRewindMinutes;
+		private System.Windows.Forms.FlowLayoutPanel flowLayoutPanel7;
+		private System.Windows.Forms.Label lblRewindVideoBuffer;
+		private Controls.MesenNumericUpDown nudRewindVideoBufferSize;
+		private System.Windows.Forms.Label lblRewindVideoBufferMb;
 		private System.Windows.Forms.CheckBox chkAllowBackgroundInput;
 		private System.Windows.Forms.FlowLayoutPanel flowLayoutPanel8;
 		private System.Windows.Forms.Label lblPauseIn;
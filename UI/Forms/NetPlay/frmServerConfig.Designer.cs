@@ -36,12 +36,13 @@ namespace Mesen.GUI.Forms.NetPlay
 			this.txtServerName = new System.Windows.Forms.TextBox();
 			this.lblPassword = new System.Windows.Forms.Label();
 			this.txtPassword = new System.Windows.Forms.TextBox();
+			this.chkRollback = new System.Windows.Forms.CheckBox();
 			this.tlpMain.SuspendLayout();
 			this.SuspendLayout();
 			// 
 			// baseConfigPanel
 			// 
-			this.baseConfigPanel.Location = new System.Drawing.Point(0, 98);
+			this.baseConfigPanel.Location = new System.Drawing.Point(0, 121);
 			this.baseConfigPanel.Size = new System.Drawing.Size(302, 29);
 			// 
 			// tlpMain
@@ -55,16 +56,17 @@ namespace Mesen.GUI.Forms.NetPlay
 			this.tlpMain.Controls.Add(this.txtServerName, 1, 0);
 			this.tlpMain.Controls.Add(this.lblPassword, 0, 2);
 			this.tlpMain.Controls.Add(this.txtPassword, 1, 2);
+			this.tlpMain.Controls.Add(this.chkRollback, 0, 3);
 			this.tlpMain.Dock = System.Windows.Forms.DockStyle.Fill;
 			this.tlpMain.Location = new System.Drawing.Point(0, 0);
 			this.tlpMain.Name = "tlpMain";
-			this.tlpMain.RowCount = 4;
+			this.tlpMain.RowCount = 5;
+			this.tlpMain.RowStyles.Add(new System.Windows.Forms.RowStyle());
 			this.tlpMain.RowStyles.Add(new System.Windows.Forms.RowStyle());
 			this.tlpMain.RowStyles.Add(new System.Windows.Forms.RowStyle());
 			this.tlpMain.RowStyles.Add(new System.Windows.Forms.RowStyle());
 			this.tlpMain.RowStyles.Add(new System.Windows.Forms.RowStyle(System.Windows.Forms.SizeType.Percent, 100F));
-			this.tlpMain.RowStyles.Add(new System.Windows.Forms.RowStyle(System.Windows.Forms.SizeType.Absolute, 20F));
-			this.tlpMain.Size = new System.Drawing.Size(302, 98);
+			this.tlpMain.Size = new System.Drawing.Size(302, 121);
 			this.tlpMain.TabIndex = 1;
 			// 
 			// txtPort
@@ -125,11 +127,22 @@ namespace Mesen.GUI.Forms.NetPlay
 			this.txtPassword.UseSystemPasswordChar = true;
 			this.txtPassword.TextChanged += new System.EventHandler(this.Field_ValueChanged);
 			// 
+			// chkRollback
+			// 
+			this.chkRollback.AutoSize = true;
+			this.tlpMain.SetColumnSpan(this.chkRollback, 2);
+			this.chkRollback.Location = new System.Drawing.Point(3, 81);
+			this.chkRollback.Name = "chkRollback";
+			this.chkRollback.Size = new System.Drawing.Size(268, 17);
+			this.chkRollback.TabIndex = 14;
+			this.chkRollback.Text = "Use rollback (all players run the game, lower latency)";
+			this.chkRollback.UseVisualStyleBackColor = true;
+			// 
 			// frmServerConfig
 			// 
 			this.AutoScaleDimensions = new System.Drawing.SizeF(6F, 13F);
 			this.AutoScaleMode = System.Windows.Forms.AutoScaleMode.Font;
-			this.ClientSize = new System.Drawing.Size(302, 127);
+			this.ClientSize = new System.Drawing.Size(302, 150);
 			this.Controls.Add(this.tlpMain);
 			this.FormBorderStyle = System.Windows.Forms.FormBorderStyle.FixedSingle;
 			this.MaximizeBox = false;
@@ -154,5 +167,6 @@ namespace Mesen.GUI.Forms.NetPlay
 		private System.Windows.Forms.TextBox txtPassword;
 		private System.Windows.Forms.Label lblPort;
 		private System.Windows.Forms.TextBox txtPort;
+		private System.Windows.Forms.CheckBox chkRollback;
 	}
 }
\ No newline at end of file
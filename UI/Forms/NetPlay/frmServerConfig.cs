@@ -22,6 +22,7 @@ namespace Mesen.GUI.Forms.NetPlay
 			AddBinding(nameof(NetplayConfig.ServerName), txtServerName);
 			AddBinding(nameof(NetplayConfig.ServerPassword), txtPassword);
 			AddBinding(nameof(NetplayConfig.ServerPort), txtPort, eNumberFormat.Decimal);
+			AddBinding(nameof(NetplayConfig.ServerRollback), chkRollback);
 		}
 
 		private void Field_ValueChanged(object sender, EventArgs e)
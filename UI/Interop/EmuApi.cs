@@ -104,10 +104,64 @@ namespace Mesen.GUI
 			return null;
 		}
 
+		[DllImport(DllPath)] public static extern RewindStatistics GetRewindStatistics();
+		[DllImport(DllPath)] public static extern VideoPipelineStatistics GetVideoPipelineStatistics();
+		[DllImport(DllPath)] public static extern void SetSubsystemProfilerEnabled([MarshalAs(UnmanagedType.I1)]bool enabled);
+		[DllImport(DllPath)] public static extern SubsystemProfilerStats GetSubsystemProfilerStats();
+
 		[DllImport(DllPath)] public static extern void SetCheats([In]UInt32[] cheats, UInt32 cheatCount);
 		[DllImport(DllPath)] public static extern void ClearCheats();
 	}
 
+	public struct RewindStatistics
+	{
+		public UInt32 VideoBufferSize;
+		public UInt32 VideoBufferUsage;
+		public UInt32 VideoFrameCount;
+		public UInt32 DroppedFrameCount;
+
+		public UInt32 HistoryBlockCount;
+		public UInt32 HistoryKeyframeCount;
+		public UInt32 HistoryMemoryUsage;
+	}
+
+	public struct VideoPipelineStatistics
+	{
+		public UInt32 RenderedFrames;
+		public UInt32 DecoderDroppedFrames;
+		public UInt32 RendererDroppedFrames;
+		public double LastLatency;
+		public double AverageLatency;
+		public double MaxLatency;
+	}
+
+	public enum HostSubsystem
+	{
+		Cpu = 0,
+		Dma,
+		Ppu,
+		Spc,
+		Sa1,
+		Gsu,
+		Cx4,
+		Coprocessor,
+		VideoFilter,
+		Idle
+	}
+
+	public struct SubsystemProfilerStats
+	{
+		public UInt32 FrameCount;
+
+		//Indexed by HostSubsystem, in microseconds
+		[MarshalAs(UnmanagedType.ByValArray, SizeConst = 10)]
+		public double[] TotalTime;
+		[MarshalAs(UnmanagedType.ByValArray, SizeConst = 10)]
+		public double[] LastFrameTime;
+		[MarshalAs(UnmanagedType.ByValArray, SizeConst = 10)]
+		public double[] MaxFrameTime;
+	}
+
 	public struct ScreenSize
 	{
 		public Int32 Width;
@@ -9,7 +9,7 @@ namespace Mesen.GUI
 	{
 		private const string DllPath = "MesenSCore.dll";
 
-		[DllImport(DllPath)] public static extern void StartServer(UInt16 port, [MarshalAs(UnmanagedType.CustomMarshaler, MarshalTypeRef = typeof(Utf8Marshaler))]string password, [MarshalAs(UnmanagedType.CustomMarshaler, MarshalTypeRef = typeof(Utf8Marshaler))]string hostPlayerName);
+		[DllImport(DllPath)] public static extern void StartServer(UInt16 port, [MarshalAs(UnmanagedType.CustomMarshaler, MarshalTypeRef = typeof(Utf8Marshaler))]string password, [MarshalAs(UnmanagedType.CustomMarshaler, MarshalTypeRef = typeof(Utf8Marshaler))]string hostPlayerName, [MarshalAs(UnmanagedType.I1)]bool rollback);
 		[DllImport(DllPath)] public static extern void StopServer();
 		[DllImport(DllPath)] [return: MarshalAs(UnmanagedType.I1)] public static extern bool IsServerRunning();
 		[DllImport(DllPath)] public static extern void Connect([MarshalAs(UnmanagedType.CustomMarshaler, MarshalTypeRef = typeof(Utf8Marshaler))]string host, UInt16 port, [MarshalAs(UnmanagedType.CustomMarshaler, MarshalTypeRef = typeof(Utf8Marshaler))]string password, [MarshalAs(UnmanagedType.CustomMarshaler, MarshalTypeRef = typeof(Utf8Marshaler))]string playerName, [MarshalAs(UnmanagedType.I1)]bool spectator);
@@ -19,5 +19,19 @@ namespace Mesen.GUI
 		[DllImport(DllPath)] public static extern Int32 NetPlayGetAvailableControllers();
 		[DllImport(DllPath)] public static extern void NetPlaySelectController(Int32 controllerPort);
 		[DllImport(DllPath)] public static extern Int32 NetPlayGetControllerPort();
+		[DllImport(DllPath)] public static extern NetplayStatistics NetPlayGetStatistics();
+	}
+
+	public struct NetplayStatistics
+	{
+		public UInt64 BytesSent;
+		public UInt64 BytesReceived;
+		public UInt32 MessagesSent;
+		public UInt32 MessagesReceived;
+		public UInt32 InputMessagesSent;
+		public UInt32 InputFramesSent;
+		public UInt32 InputFramesResent;
+		public UInt32 DroppedMessages;
+		public UInt32 StallCount;
 	}
 }
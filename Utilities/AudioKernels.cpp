@@ -0,0 +1,265 @@
+#include "stdafx.h"
+#include <cmath>
+#include <sstream>
+#include <iomanip>
+#include "AudioKernels.h"
+#include "HermiteResampler.h"
+#include "Equalizer.h"
+#include "Timer.h"
+
+#ifdef AUDIO_KERNELS_SSE2
+typedef __m128i SampleVector;
+static __forceinline SampleVector LoadSamples(const int16_t* samples) { return _mm_loadu_si128((const __m128i*)samples); }
+static __forceinline void StoreSamples(int16_t* samples, SampleVector v) { _mm_storeu_si128((__m128i*)samples, v); }
+static __forceinline SampleVector AddSamples(SampleVector a, SampleVector b) { return _mm_add_epi16(a, b); }
+
+static __forceinline SampleVector ScaleSamples(SampleVector samples, uint32_t volume, uint32_t divider)
+{
+	//32-bit products (the low and high halves of the 16x16-bit multiplications)
+	__m128i volumeVector = _mm_set1_epi16((int16_t)volume);
+	__m128i low = _mm_mullo_epi16(samples, volumeVector);
+	__m128i high = _mm_mulhi_epi16(samples, volumeVector);
+
+	//The products fit in a float's mantissa, and their quotient is never close enough to an integer for the
+	//division's rounding to change the truncated result - this gives the same result as an integer division
+	__m128 dividerVector = _mm_set1_ps((float)divider);
+	__m128i lowResult = _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(low, high)), dividerVector));
+	__m128i highResult = _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(low, high)), dividerVector));
+	return _mm_packs_epi32(lowResult, highResult);
+}
+#elif defined(AUDIO_KERNELS_NEON)
+typedef int16x8_t SampleVector;
+static __forceinline SampleVector LoadSamples(const int16_t* samples) { return vld1q_s16(samples); }
+static __forceinline void StoreSamples(int16_t* samples, SampleVector v) { vst1q_s16(samples, v); }
+static __forceinline SampleVector AddSamples(SampleVector a, SampleVector b) { return vaddq_s16(a, b); }
+
+static __forceinline SampleVector ScaleSamples(SampleVector samples, uint32_t volume, uint32_t divider)
+{
+	//See the SSE2 version
+	int32x4_t low = vmull_n_s16(vget_low_s16(samples), (int16_t)volume);
+	int32x4_t high = vmull_n_s16(vget_high_s16(samples), (int16_t)volume);
+	float32x4_t dividerVector = vdupq_n_f32((float)divider);
+	int32x4_t lowResult = vcvtq_s32_f32(vdivq_f32(vcvtq_f32_s32(low), dividerVector));
+	int32x4_t highResult = vcvtq_s32_f32(vdivq_f32(vcvtq_f32_s32(high), dividerVector));
+	return vcombine_s16(vqmovn_s32(lowResult), vqmovn_s32(highResult));
+}
+#endif
+
+void AudioKernels::ApplyVolumeScalar(int16_t* samples, uint32_t count, uint32_t volume, uint32_t divider)
+{
+	for(uint32_t i = 0; i < count; i++) {
+		samples[i] = (int32_t)samples[i] * (int32_t)volume / (int32_t)divider;
+	}
+}
+
+void AudioKernels::MixSamplesScalar(int16_t* dst, const int16_t* src, uint32_t count, uint32_t volume, uint32_t divider)
+{
+	if(volume == divider) {
+		for(uint32_t i = 0; i < count; i++) {
+			dst[i] += src[i];
+		}
+	} else {
+		for(uint32_t i = 0; i < count; i++) {
+			dst[i] += (int16_t)((int32_t)src[i] * (int32_t)volume / (int32_t)divider);
+		}
+	}
+}
+
+void AudioKernels::ApplyVolume(int16_t* samples, uint32_t count, uint32_t volume, uint32_t divider)
+{
+	uint32_t i = 0;
+#ifdef AUDIO_KERNELS_SIMD
+	for(; i + 8 <= count; i += 8) {
+		StoreSamples(samples + i, ScaleSamples(LoadSamples(samples + i), volume, divider));
+	}
+#endif
+
+	if(i < count) {
+		ApplyVolumeScalar(samples + i, count - i, volume, divider);
+	}
+}
+
+void AudioKernels::MixSamples(int16_t* dst, const int16_t* src, uint32_t count, uint32_t volume, uint32_t divider)
+{
+	uint32_t i = 0;
+#ifdef AUDIO_KERNELS_SIMD
+	if(volume == divider) {
+		for(; i + 8 <= count; i += 8) {
+			StoreSamples(dst + i, AddSamples(LoadSamples(dst + i), LoadSamples(src + i)));
+		}
+	} else {
+		for(; i + 8 <= count; i += 8) {
+			StoreSamples(dst + i, AddSamples(LoadSamples(dst + i), ScaleSamples(LoadSamples(src + i), volume, divider)));
+		}
+	}
+#endif
+
+	if(i < count) {
+		MixSamplesScalar(dst + i, src + i, count - i, volume, divider);
+	}
+}
+
+static uint32_t GetMaxError(const int16_t* a, const int16_t* b, uint32_t count)
+{
+	uint32_t maxError = 0;
+	for(uint32_t i = 0; i < count; i++) {
+		maxError = std::max<uint32_t>(maxError, (uint32_t)std::abs((int32_t)a[i] - (int32_t)b[i]));
+	}
+	return maxError;
+}
+
+vector<AudioKernels::KernelResult> AudioKernels::CompareKernels(uint32_t frameCount)
+{
+	//One frame of audio at the SPC's sample rate (~32040Hz, 60fps)
+	constexpr uint32_t frameSize = 534;
+	constexpr uint32_t maxOutputSize = 0x1000;
+
+	KernelResult results[5] = {
+		{ "Resampler", 0, 0, 0 }, { "Equalizer", 0, 0, 0 }, { "Volume", 0, 0, 0 }, { "Mix", 0, 0, 0 }, { "Mix (volume)", 0, 0, 0 }
+	};
+
+	HermiteResampler scalarResampler, simdResampler;
+	Equalizer scalarEqualizer, simdEqualizer;
+	vector<double> bandGains = { 6, 4, 2, 0, -2, -4, -6, -8, -10, 0, 3, 6, 9, 12, 15, 18, 20, -20, -10, 0 };
+	scalarEqualizer.UpdateEqualizers(bandGains, 32040);
+	simdEqualizer.UpdateEqualizers(bandGains, 32040);
+
+	int16_t input[frameSize * 2];
+	int16_t mixInput[frameSize * 2];
+	int16_t scalarOutput[maxOutputSize * 2];
+	int16_t simdOutput[maxOutputSize * 2];
+
+	uint32_t seed = 0x12345678;
+	auto random = [&seed]() {
+		seed = seed * 1103515245 + 12345;
+		return (int32_t)((seed >> 8) & 0xFFFF) - 0x8000;
+	};
+
+	Timer timer;
+	auto run = [&timer](double &elapsed, auto func) {
+		timer.Reset();
+		func();
+		elapsed += timer.GetElapsedMS();
+	};
+
+	for(uint32_t frame = 0; frame < frameCount; frame++) {
+		//Loud tones + noise (some of the equalizer's output is clipped), with silent frames to test the denormal handling
+		bool silent = (frame & 0x07) == 0x07;
+		for(uint32_t i = 0; i < frameSize; i++) {
+			double t = (double)(frame * frameSize + i) / 32040;
+			input[i * 2] = silent ? 0 : (int16_t)(sin(t * 440 * 6.2831853) * 16000 + random() / 4);
+			input[i * 2 + 1] = silent ? 0 : (int16_t)(sin(t * 3000 * 6.2831853) * 12000 + random() / 3);
+			mixInput[i * 2] = (int16_t)random();
+			mixInput[i * 2 + 1] = (int16_t)random();
+		}
+
+		//The output rate is constantly adjusted by SoundResampler
+		double dstRate = 48000 * (1 + sin(frame * 0.01) * 0.005);
+		scalarResampler.SetSampleRates(32040, dstRate);
+		simdResampler.SetSampleRates(32040, dstRate);
+		uint32_t scalarCount = 0, simdCount = 0;
+		run(results[0].ScalarMs, [&]() { scalarCount = scalarResampler.ResampleScalar(input, frameSize, scalarOutput); });
+		run(results[0].SimdMs, [&]() { simdCount = simdResampler.Resample(input, frameSize, simdOutput); });
+		results[0].MaxError = std::max(results[0].MaxError, scalarCount == simdCount ? GetMaxError(scalarOutput, simdOutput, scalarCount * 2) : 0xFFFF);
+
+		memcpy(scalarOutput, input, sizeof(input));
+		memcpy(simdOutput, input, sizeof(input));
+		run(results[1].ScalarMs, [&]() { scalarEqualizer.ApplyEqualizerScalar(frameSize, scalarOutput); });
+		run(results[1].SimdMs, [&]() { simdEqualizer.ApplyEqualizer(frameSize, simdOutput); });
+		results[1].MaxError = std::max(results[1].MaxError, GetMaxError(scalarOutput, simdOutput, frameSize * 2));
+
+		//Odd sample counts, to test the scalar code used for the last samples
+		uint32_t count = frameSize * 2 - (frame & 0x07);
+		memcpy(scalarOutput, input, sizeof(input));
+		memcpy(simdOutput, input, sizeof(input));
+		uint32_t volume = frame % 101;
+		run(results[2].ScalarMs, [&]() { ApplyVolumeScalar(scalarOutput, count, volume, 100); });
+		run(results[2].SimdMs, [&]() { ApplyVolume(simdOutput, count, volume, 100); });
+		results[2].MaxError = std::max(results[2].MaxError, GetMaxError(scalarOutput, simdOutput, frameSize * 2));
+
+		run(results[3].ScalarMs, [&]() { MixSamplesScalar(scalarOutput, mixInput, count, 1, 1); });
+		run(results[3].SimdMs, [&]() { MixSamples(simdOutput, mixInput, count); });
+		results[3].MaxError = std::max(results[3].MaxError, GetMaxError(scalarOutput, simdOutput, frameSize * 2));
+
+		volume = frame % 256;
+		run(results[4].ScalarMs, [&]() { MixSamplesScalar(scalarOutput, mixInput, count, volume, 255); });
+		run(results[4].SimdMs, [&]() { MixSamples(simdOutput, mixInput, count, volume, 255); });
+		results[4].MaxError = std::max(results[4].MaxError, GetMaxError(scalarOutput, simdOutput, frameSize * 2));
+	}
+
+	return vector<KernelResult>(std::begin(results), std::end(results));
+}
+
+string AudioKernels::GetInstructionSet()
+{
+#if defined(AUDIO_KERNELS_SSE2)
+	return "SSE2";
+#elif defined(AUDIO_KERNELS_NEON)
+	return "NEON";
+#else
+	return "none (scalar fallback)";
+#endif
+}
+
+bool AudioKernels::RunBenchmark(uint32_t frameCount, string &report)
+{
+	vector<KernelResult> results = CompareKernels(frameCount);
+
+	std::stringstream ss;
+	ss << "Instruction set: " << GetInstructionSet() << std::endl;
+
+	bool passed = true;
+	ss << "Kernel\tScalar\tSIMD (ms/frame)\tSpeedup\tMax error" << std::endl;
+	for(KernelResult &result : results) {
+		ss << result.Name << "\t" << std::fixed << std::setprecision(4) << (result.ScalarMs / frameCount) << "\t" << (result.SimdMs / frameCount);
+		ss << "\t" << std::setprecision(2) << (result.SimdMs > 0 ? result.ScalarMs / result.SimdMs : 0) << "x\t" << result.MaxError << std::endl;
+		passed &= result.MaxError <= MaxSampleError;
+	}
+	ss << (passed ? "Passed" : "Failed") << " (max error allowed: " << MaxSampleError << ")" << std::endl;
+
+	report = ss.str();
+	return passed;
+}
+
+bool AudioKernels::RunTests(string &report)
+{
+	std::stringstream ss;
+	ss << "{" << std::endl << "\t\"instructionSet\": \"" << GetInstructionSet() << "\"," << std::endl << "\t\"tests\": [";
+
+	//Compares the vectorized code against the scalar implementations
+	bool passed = true;
+	bool firstTest = true;
+	for(KernelResult &result : CompareKernels(60)) {
+		bool testPassed = result.MaxError <= MaxSampleError;
+		passed &= testPassed;
+		ss << (firstTest ? "" : ",") << std::endl << "\t\t{ \"kernel\": \"" << result.Name << "\", \"maxError\": " << result.MaxError;
+		ss << ", \"passed\": " << (testPassed ? "true" : "false") << " }";
+		firstTest = false;
+	}
+
+	//Every sample value, with every volume used by the callers
+	vector<int16_t> samples(0x10000);
+	vector<int16_t> expected(0x10000);
+	for(uint32_t divider : { 100, 255 }) {
+		uint32_t mismatchCount = 0;
+		for(uint32_t volume = 0; volume <= divider; volume++) {
+			for(uint32_t i = 0; i < 0x10000; i++) {
+				samples[i] = (int16_t)i;
+			}
+			expected = samples;
+			ApplyVolumeScalar(expected.data(), 0x10000, volume, divider);
+			ApplyVolume(samples.data(), 0x10000, volume, divider);
+			if(samples != expected) {
+				mismatchCount++;
+			}
+		}
+
+		passed &= mismatchCount == 0;
+		ss << "," << std::endl << "\t\t{ \"kernel\": \"Volume (all sample values)\", \"divider\": " << divider;
+		ss << ", \"mismatchedVolumes\": " << mismatchCount << ", \"passed\": " << (mismatchCount == 0 ? "true" : "false") << " }";
+	}
+
+	ss << std::endl << "\t]," << std::endl << "\t\"passed\": " << (passed ? "true" : "false") << std::endl << "}" << std::endl;
+	report = ss.str();
+	return passed;
+}
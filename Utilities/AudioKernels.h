@@ -0,0 +1,106 @@
+#pragma once
+#include "stdafx.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define AUDIO_KERNELS_SSE2
+	#include <emmintrin.h>
+#elif (defined(__aarch64__) || defined(_M_ARM64)) && (defined(__ARM_NEON) || defined(_M_ARM64))
+	#define AUDIO_KERNELS_NEON
+	#include <arm_neon.h>
+#endif
+
+#if defined(AUDIO_KERNELS_SSE2) || defined(AUDIO_KERNELS_NEON)
+	#define AUDIO_KERNELS_SIMD
+
+//A pair of doubles holding the left and right channels of a stereo sample, used to process both channels with the same instructions.
+//The operations are done in the same order as the scalar code (no fused multiply-add), so the results match it.
+#ifdef AUDIO_KERNELS_SSE2
+typedef __m128d StereoValue;
+static __forceinline StereoValue StereoLoad(const double* values) { return _mm_loadu_pd(values); }
+static __forceinline void StereoStore(double* values, StereoValue v) { _mm_storeu_pd(values, v); }
+static __forceinline StereoValue StereoSet(double left, double right) { return _mm_set_pd(right, left); }
+static __forceinline StereoValue StereoSplat(double value) { return _mm_set1_pd(value); }
+static __forceinline StereoValue StereoAdd(StereoValue a, StereoValue b) { return _mm_add_pd(a, b); }
+static __forceinline StereoValue StereoSub(StereoValue a, StereoValue b) { return _mm_sub_pd(a, b); }
+static __forceinline StereoValue StereoMul(StereoValue a, StereoValue b) { return _mm_mul_pd(a, b); }
+
+//Returns 0 for values in the (-limit, limit) range
+static __forceinline StereoValue StereoFlushToZero(StereoValue v, StereoValue limit, StereoValue negLimit)
+{
+	return _mm_andnot_pd(_mm_and_pd(_mm_cmplt_pd(v, limit), _mm_cmpgt_pd(v, negLimit)), v);
+}
+
+//Clamps both values to the int16 range and truncates them (like the scalar code's casts)
+static __forceinline void StereoStoreSamples(int16_t* out, StereoValue v)
+{
+	v = _mm_max_pd(_mm_min_pd(v, _mm_set1_pd(32767.0)), _mm_set1_pd(-32768.0));
+	__m128i samples = _mm_cvttpd_epi32(v);
+	samples = _mm_packs_epi32(samples, samples);
+	int32_t pair = _mm_cvtsi128_si32(samples);
+	memcpy(out, &pair, sizeof(pair));
+}
+#else
+typedef float64x2_t StereoValue;
+static __forceinline StereoValue StereoLoad(const double* values) { return vld1q_f64(values); }
+static __forceinline void StereoStore(double* values, StereoValue v) { vst1q_f64(values, v); }
+static __forceinline StereoValue StereoSet(double left, double right) { return vsetq_lane_f64(right, vdupq_n_f64(left), 1); }
+static __forceinline StereoValue StereoSplat(double value) { return vdupq_n_f64(value); }
+static __forceinline StereoValue StereoAdd(StereoValue a, StereoValue b) { return vaddq_f64(a, b); }
+static __forceinline StereoValue StereoSub(StereoValue a, StereoValue b) { return vsubq_f64(a, b); }
+static __forceinline StereoValue StereoMul(StereoValue a, StereoValue b) { return vmulq_f64(a, b); }
+
+static __forceinline StereoValue StereoFlushToZero(StereoValue v, StereoValue limit, StereoValue negLimit)
+{
+	uint64x2_t isTiny = vandq_u64(vcltq_f64(v, limit), vcgtq_f64(v, negLimit));
+	return vreinterpretq_f64_u64(vbicq_u64(vreinterpretq_u64_f64(v), isTiny));
+}
+
+static __forceinline void StereoStoreSamples(int16_t* out, StereoValue v)
+{
+	v = vmaxq_f64(vminq_f64(v, vdupq_n_f64(32767.0)), vdupq_n_f64(-32768.0));
+	int64x2_t samples = vcvtq_s64_f64(v);
+	out[0] = (int16_t)vgetq_lane_s64(samples, 0);
+	out[1] = (int16_t)vgetq_lane_s64(samples, 1);
+}
+#endif
+#endif
+
+//Sample processing kernels used by the audio pipeline (SSE2 or NEON when available, with a scalar fallback)
+//The resampler (HermiteResampler) and the equalizer (Equalizer) have their own vectorized implementations, built on the
+//StereoValue functions above - RunBenchmark/RunTests compare all of them against their scalar implementations.
+class AudioKernels
+{
+private:
+	struct KernelResult
+	{
+		const char* Name;
+		double ScalarMs;
+		double SimdMs;
+		uint32_t MaxError;
+	};
+
+	static void ApplyVolumeScalar(int16_t* samples, uint32_t count, uint32_t volume, uint32_t divider);
+	static void MixSamplesScalar(int16_t* dst, const int16_t* src, uint32_t count, uint32_t volume, uint32_t divider);
+
+	static vector<KernelResult> CompareKernels(uint32_t frameCount);
+	static string GetInstructionSet();
+
+public:
+	//Max difference allowed between the scalar and vectorized results. Both are expected to be identical (the operations are
+	//done in the same order), but the compiler may use fused multiply-adds in the scalar code on some platforms.
+	static constexpr uint32_t MaxSampleError = 1;
+
+	//samples[i] = samples[i] * volume / divider (volume <= divider <= 255)
+	static void ApplyVolume(int16_t* samples, uint32_t count, uint32_t volume, uint32_t divider);
+
+	//dst[i] += src[i] * volume / divider (volume <= divider <= 255) - the sum wraps around, like it does in the scalar code
+	static void MixSamples(int16_t* dst, const int16_t* src, uint32_t count, uint32_t volume = 1, uint32_t divider = 1);
+
+	//Processes frameCount frames of audio with each kernel, and reports the time taken by the scalar and vectorized code
+	//Returns true when the outputs of the scalar and vectorized code matched (within MaxSampleError)
+	static bool RunBenchmark(uint32_t frameCount, string &report);
+
+	//Compares the vectorized kernels against their scalar implementations, and ApplyVolume against the scalar code for every sample value
+	//Returns true when all tests passed, report contains the result of each test (JSON)
+	static bool RunTests(string &report);
+};
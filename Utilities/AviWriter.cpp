@@ -255,7 +255,7 @@ void AviWriter::AddFrame(uint8_t *frameData)
 
 	if(_audioPos) {
 		auto lock = _audioLock.AcquireSafe();
-		WriteAviChunk("01wb", _audioPos, _audiobuf, 0);
+		WriteAviChunk("01wb", _audioPos, _audiobuf.data(), 0);
 		_audiowritten += _audioPos;
 		_audioPos = 0;
 	}
@@ -268,6 +268,9 @@ void AviWriter::AddSound(int16_t *data, uint32_t sampleCount)
 	}
 
 	auto lock = _audioLock.AcquireSafe();
-	memcpy(_audiobuf+_audioPos/2, data, sampleCount * 4);
+	if(_audioPos / 2 + sampleCount * 2 > _audiobuf.size()) {
+		_audiobuf.resize(_audioPos / 2 + sampleCount * 2);
+	}
+	memcpy(_audiobuf.data() + _audioPos/2, data, sampleCount * 4);
 	_audioPos += sampleCount * 4;
 }
\ No newline at end of file
@@ -25,7 +25,8 @@ private:
 
 	VideoCodec _codecType;
 
-	int16_t _audiobuf[WaveBufferSize];
+	//Audio received since the last frame, grows if the samples arrive in a large batch (they are sent by SoundRecordingStream's thread)
+	vector<int16_t> _audiobuf = vector<int16_t>(WaveBufferSize);
 	uint32_t _audioPos = 0;
 	uint32_t _audiorate = 0;
 	uint32_t _audiowritten = 0;
@@ -1,8 +1,108 @@
 #include "stdafx.h"
 #include "Equalizer.h"
 #include "orfanidis_eq.h"
+#include "AudioKernels.h"
 
 void Equalizer::ApplyEqualizer(uint32_t sampleCount, int16_t *samples)
+{
+#ifdef AUDIO_KERNELS_SIMD
+	//Same calculations as orfanidis_eq::eq1::sbs_process, done for both channels at once.
+	//Each filter section processes the whole buffer, so its state stays in registers.
+	uint32_t count = sampleCount * 2;
+	if(_bandBuffer.size() < count) {
+		_bandBuffer.resize(count);
+		_outputBuffer.resize(count);
+	}
+
+	double* bandSamples = _bandBuffer.data();
+	double* output = _outputBuffer.data();
+	std::fill(output, output + count, 0.0);
+
+	for(EqualizerBand &band : _bands) {
+		for(uint32_t i = 0; i < count; i++) {
+			bandSamples[i] = samples[i];
+		}
+
+		for(uint32_t i = 0; i < band.SectionCount; i++) {
+			ProcessSection(_sections[band.FirstSection + i], bandSamples, sampleCount);
+		}
+
+		StereoValue gain = StereoSplat(band.Gain);
+		for(uint32_t i = 0; i < count; i += 2) {
+			StereoStore(output + i, StereoAdd(StereoLoad(output + i), StereoMul(gain, StereoLoad(bandSamples + i))));
+		}
+	}
+
+	for(uint32_t i = 0; i < count; i += 2) {
+		StereoStoreSamples(samples + i, StereoLoad(output + i));
+	}
+#else
+	ApplyEqualizerScalar(sampleCount, samples);
+#endif
+}
+
+#ifdef AUDIO_KERNELS_SIMD
+void Equalizer::ProcessSection(EqualizerSection &section, double* samples, uint32_t sampleCount)
+{
+	//Same as orfanidis_eq::fo_section::df1_fo_process
+	const StereoValue zero = StereoSplat(0);
+	const StereoValue limit = StereoSplat(0.000000000001);
+	const StereoValue negLimit = StereoSplat(-0.000000000001);
+
+	const StereoValue b0 = StereoSplat(section.B[0]);
+	const StereoValue b1 = StereoSplat(section.B[1]);
+	const StereoValue b2 = StereoSplat(section.B[2]);
+	const StereoValue b3 = StereoSplat(section.B[3]);
+	const StereoValue b4 = StereoSplat(section.B[4]);
+	const StereoValue a1 = StereoSplat(section.A[1]);
+	const StereoValue a2 = StereoSplat(section.A[2]);
+	const StereoValue a3 = StereoSplat(section.A[3]);
+	const StereoValue a4 = StereoSplat(section.A[4]);
+
+	StereoValue num0 = StereoLoad(section.NumBuffer[0]);
+	StereoValue num1 = StereoLoad(section.NumBuffer[1]);
+	StereoValue num2 = StereoLoad(section.NumBuffer[2]);
+	StereoValue num3 = StereoLoad(section.NumBuffer[3]);
+	StereoValue denum0 = StereoLoad(section.DenumBuffer[0]);
+	StereoValue denum1 = StereoLoad(section.DenumBuffer[1]);
+	StereoValue denum2 = StereoLoad(section.DenumBuffer[2]);
+	StereoValue denum3 = StereoLoad(section.DenumBuffer[3]);
+
+	for(uint32_t i = 0; i < sampleCount * 2; i += 2) {
+		StereoValue in = StereoLoad(samples + i);
+
+		StereoValue out = StereoAdd(zero, StereoMul(b0, in));
+		out = StereoAdd(out, StereoSub(StereoMul(b1, num0), StereoMul(denum0, a1)));
+		out = StereoAdd(out, StereoSub(StereoMul(b2, num1), StereoMul(denum1, a2)));
+		out = StereoAdd(out, StereoSub(StereoMul(b3, num2), StereoMul(denum2, a3)));
+		out = StereoAdd(out, StereoSub(StereoMul(b4, num3), StereoMul(denum3, a4)));
+
+		//Prevent denormalized values
+		num3 = num2;
+		num2 = num1;
+		num1 = num0;
+		num0 = StereoFlushToZero(in, limit, negLimit);
+
+		denum3 = denum2;
+		denum2 = denum1;
+		denum1 = denum0;
+		denum0 = StereoFlushToZero(out, limit, negLimit);
+
+		StereoStore(samples + i, denum0);
+	}
+
+	StereoStore(section.NumBuffer[0], num0);
+	StereoStore(section.NumBuffer[1], num1);
+	StereoStore(section.NumBuffer[2], num2);
+	StereoStore(section.NumBuffer[3], num3);
+	StereoStore(section.DenumBuffer[0], denum0);
+	StereoStore(section.DenumBuffer[1], denum1);
+	StereoStore(section.DenumBuffer[2], denum2);
+	StereoStore(section.DenumBuffer[3], denum3);
+}
+#endif
+
+void Equalizer::ApplyEqualizerScalar(uint32_t sampleCount, int16_t *samples)
 {
 	double outL, outR;
 	for(uint32_t i = 0; i < sampleCount; i++) {
@@ -39,6 +139,22 @@ void Equalizer::UpdateEqualizers(vector<double> bandGains, uint32_t sampleRate)
 			_equalizerRight->change_band_gain_db(i, bandGains[i]);
 		}
 
+		//Both channels use the same filters - the state of the copied sections is reset, like the filters'
+		_bands.clear();
+		_sections.clear();
+		for(unsigned int i = 0; i < _equalizerLeft->get_number_of_bands(); i++) {
+			EqualizerBand band = {};
+			band.Gain = _equalizerLeft->get_band_gain(i);
+			band.FirstSection = (uint32_t)_sections.size();
+			for(const orfanidis_eq::fo_section &filterSection : _equalizerLeft->get_band_filter(i)->get_sections()) {
+				EqualizerSection section = {};
+				filterSection.get_coefficients(section.B, section.A);
+				_sections.push_back(section);
+			}
+			band.SectionCount = (uint32_t)_sections.size() - band.FirstSection;
+			_bands.push_back(band);
+		}
+
 		_prevSampleRate = sampleRate;
 		_prevEqualizerGains = bandGains;
 	}
@@ -5,14 +5,43 @@
 class Equalizer
 {
 private:
+	//Copy of a filter section's coefficients, with the state of both channels (interleaved, like the samples)
+	struct EqualizerSection
+	{
+		double B[5];
+		double A[5];
+		double NumBuffer[4][2];
+		double DenumBuffer[4][2];
+	};
+
+	struct EqualizerBand
+	{
+		double Gain;
+		uint32_t FirstSection;
+		uint32_t SectionCount;
+	};
+
 	unique_ptr<orfanidis_eq::freq_grid> _eqFrequencyGrid;
 	unique_ptr<orfanidis_eq::eq1> _equalizerLeft;
 	unique_ptr<orfanidis_eq::eq1> _equalizerRight;
 
+	//Used by the vectorized implementation
+	vector<EqualizerBand> _bands;
+	vector<EqualizerSection> _sections;
+	vector<double> _bandBuffer;
+	vector<double> _outputBuffer;
+
 	uint32_t _prevSampleRate = 0;
 	vector<double> _prevEqualizerGains;
 
+	void ProcessSection(EqualizerSection& section, double* samples, uint32_t sampleCount);
+
 public:
+	//Processes both channels at once with SSE2/NEON when available (same results as ApplyEqualizerScalar)
 	void ApplyEqualizer(uint32_t sampleCount, int16_t *samples);
+
+	//Reference implementation (orfanidis_eq), also used when SIMD isn't available
+	void ApplyEqualizerScalar(uint32_t sampleCount, int16_t *samples);
+
 	void UpdateEqualizers(vector<double> bandGains, uint32_t sampleRate);
 };
\ No newline at end of file
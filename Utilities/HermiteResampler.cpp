@@ -1,5 +1,6 @@
 #include "stdafx.h"
 #include "HermiteResampler.h"
+#include "AudioKernels.h"
 
 //Adapted from http://paulbourke.net/miscellaneous/interpolation/
 //Original author: Paul Bourke ("Any source code found here may be freely used provided credits are given to the author.")
@@ -55,6 +56,70 @@ uint32_t HermiteResampler::Resample(int16_t* in, uint32_t inSampleCount, int16_t
 		return inSampleCount;
 	}
 
+#ifdef AUDIO_KERNELS_SIMD
+	//Same calculations as HermiteInterpolate (with tension & bias = 0), for both channels at once
+	StereoValue v0 = StereoSet(_prevLeft[0], _prevRight[0]);
+	StereoValue v1 = StereoSet(_prevLeft[1], _prevRight[1]);
+	StereoValue v2 = StereoSet(_prevLeft[2], _prevRight[2]);
+	StereoValue v3 = StereoSet(_prevLeft[3], _prevRight[3]);
+	const StereoValue half = StereoSplat(0.5);
+
+	double fraction = _fraction;
+	uint32_t outPos = 0;
+
+	for(uint32_t i = 0; i < inSampleCount * 2; i += 2) {
+		if(fraction <= 1.0) {
+			//The tangents only depend on the source samples
+			StereoValue m0 = StereoAdd(StereoMul(StereoSub(v1, v0), half), StereoMul(StereoSub(v2, v1), half));
+			StereoValue m1 = StereoAdd(StereoMul(StereoSub(v2, v1), half), StereoMul(StereoSub(v3, v2), half));
+
+			do {
+				double mu = fraction;
+				double mu2 = mu * mu;
+				double mu3 = mu2 * mu;
+				double a0 = 2 * mu3 - 3 * mu2 + 1;
+				double a1 = mu3 - 2 * mu2 + mu;
+				double a2 = mu3 - mu2;
+				double a3 = -2 * mu3 + 3 * mu2;
+
+				StereoValue output = StereoAdd(StereoMul(StereoSplat(a0), v1), StereoMul(StereoSplat(a1), m0));
+				output = StereoAdd(output, StereoMul(StereoSplat(a2), m1));
+				output = StereoAdd(output, StereoMul(StereoSplat(a3), v2));
+				StereoStoreSamples(out + outPos, output);
+
+				outPos += 2;
+				fraction += _rateRatio;
+			} while(fraction <= 1.0);
+		}
+
+		//Move to the next source sample
+		v0 = v1;
+		v1 = v2;
+		v2 = v3;
+		v3 = StereoSet((double)in[i], (double)in[i + 1]);
+		fraction -= 1.0;
+	}
+
+	double left[4], right[4];
+	double values[2];
+	StereoValue history[4] = { v0, v1, v2, v3 };
+	for(int i = 0; i < 4; i++) {
+		StereoStore(values, history[i]);
+		left[i] = values[0];
+		right[i] = values[1];
+	}
+	memcpy(_prevLeft, left, sizeof(left));
+	memcpy(_prevRight, right, sizeof(right));
+	_fraction = fraction;
+
+	return outPos / 2;
+#else
+	return ResampleScalar(in, inSampleCount, out);
+#endif
+}
+
+uint32_t HermiteResampler::ResampleScalar(int16_t* in, uint32_t inSampleCount, int16_t* out)
+{
 	uint32_t outPos = 0;
 
 	for(uint32_t i = 0; i < inSampleCount * 2; i += 2) {
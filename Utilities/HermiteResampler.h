@@ -16,5 +16,10 @@ public:
 	void Reset();
 
 	void SetSampleRates(double srcRate, double dstRate);
+
+	//Processes both channels at once with SSE2/NEON when available (same results as ResampleScalar)
 	uint32_t Resample(int16_t* in, uint32_t inSampleCount, int16_t* out);
+
+	//Reference implementation, also used when SIMD isn't available
+	uint32_t ResampleScalar(int16_t* in, uint32_t inSampleCount, int16_t* out);
 };
\ No newline at end of file
@@ -471,3 +471,70 @@ void scale(unsigned scale, void* void_dst, unsigned dst_slice, const void* void_
 	}
 }
 
+/**
+ * Apply the Scale effect to the rows [y_first, y_last) of a bitmap.
+ * The output rows are identical to the ones produced by scale() for the whole bitmap,
+ * which allows a bitmap to be split in horizontal bands that are processed separately.
+ * \param y_first First source row to process.
+ * \param y_last Source row after the last one to process.
+ * See scale() for the other parameters.
+ */
+void scale_slice(unsigned scale, void* void_dst, unsigned dst_slice, const void* void_src, unsigned src_slice, unsigned pixel, unsigned width, unsigned height, unsigned y_first, unsigned y_last)
+{
+	unsigned char* dst = (unsigned char*)void_dst;
+	const unsigned char* src = (const unsigned char*)void_src;
+	unsigned y;
+
+	if (y_last > height)
+		y_last = height;
+
+	if (scale == 4 || scale == 404) {
+		/* compute the 2x rows of the slice (and of its neighbor rows), then scale them again */
+		unsigned mid_first = y_first > 0 ? y_first - 1 : 0;
+		unsigned mid_last = y_last < height ? y_last + 1 : height;
+		unsigned mid_slice = (2 * pixel * width + 0x7) & ~0x7;
+		unsigned char* mid = (unsigned char*)malloc(2 * (mid_last - mid_first) * mid_slice);
+		if (!mid)
+			return;
+
+		for (y = mid_first; y < mid_last; y++) {
+			stage_scale2x(mid + (2 * (y - mid_first)) * mid_slice, mid + (2 * (y - mid_first) + 1) * mid_slice,
+				src + (y > 0 ? y - 1 : 0) * src_slice, src + y * src_slice, src + (y + 1 < height ? y + 1 : y) * src_slice, pixel, width);
+		}
+
+		for (y = y_first; y < y_last; y++) {
+			unsigned m0 = y > 0 ? 2 * y - 1 : 0;
+			unsigned m3 = y + 1 < height ? 2 * y + 2 : 2 * y + 1;
+			unsigned char* d = dst + 4 * y * dst_slice;
+			stage_scale4x(d, d + dst_slice, d + 2 * dst_slice, d + 3 * dst_slice,
+				mid + (m0 - 2 * mid_first) * mid_slice, mid + (2 * y - 2 * mid_first) * mid_slice,
+				mid + (2 * y + 1 - 2 * mid_first) * mid_slice, mid + (m3 - 2 * mid_first) * mid_slice, pixel, width);
+		}
+
+		free(mid);
+		return;
+	}
+
+	for (y = y_first; y < y_last; y++) {
+		const unsigned char* src0 = src + (y > 0 ? y - 1 : 0) * src_slice;
+		const unsigned char* src1 = src + y * src_slice;
+		const unsigned char* src2 = src + (y + 1 < height ? y + 1 : y) * src_slice;
+
+		switch (scale) {
+		case 202 :
+		case 2 :
+			stage_scale2x(dst + 2 * y * dst_slice, dst + (2 * y + 1) * dst_slice, src0, src1, src2, pixel, width);
+			break;
+		case 203 :
+			stage_scale2x3(dst + 3 * y * dst_slice, dst + (3 * y + 1) * dst_slice, dst + (3 * y + 2) * dst_slice, src0, src1, src2, pixel, width);
+			break;
+		case 204 :
+			stage_scale2x4(dst + 4 * y * dst_slice, dst + (4 * y + 1) * dst_slice, dst + (4 * y + 2) * dst_slice, dst + (4 * y + 3) * dst_slice, src0, src1, src2, pixel, width);
+			break;
+		case 303 :
+		case 3 :
+			stage_scale3x(dst + 3 * y * dst_slice, dst + (3 * y + 1) * dst_slice, dst + (3 * y + 2) * dst_slice, src0, src1, src2, pixel, width);
+			break;
+		}
+	}
+}
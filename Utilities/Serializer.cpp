@@ -7,19 +7,49 @@
 Serializer::Serializer(uint32_t version)
 {
 	_version = version;
+	_saving = true;
+
+	_ownedBuffer = vector<uint8_t>(0x50000);
+	_buffer = &_ownedBuffer;
+	_data = _buffer->data();
+	_dataSize = (uint32_t)_buffer->size();
+}
 
-	_block.reset(new BlockData());
-	_block->Data = vector<uint8_t>(0x50000);
-	_block->Position = 0;
+Serializer::Serializer(uint32_t version, vector<uint8_t> &buffer)
+{
+	//Saves into a caller-owned buffer - the buffer is only grown when needed, so it can be reused without reallocating
+	_version = version;
 	_saving = true;
+
+	if(buffer.empty()) {
+		buffer.resize(0x50000);
+	}
+	_buffer = &buffer;
+	_data = _buffer->data();
+	_dataSize = (uint32_t)_buffer->size();
 }
 
-Serializer::Serializer(istream &file, uint32_t version, bool compressed)
+Serializer::Serializer(uint32_t version, uint8_t* buffer, uint32_t bufferSize)
 {
+	//Saves directly into a fixed-size, caller-owned buffer (throws if the state does not fit)
 	_version = version;
+	_saving = true;
+
+	_data = buffer;
+	_dataSize = bufferSize;
+}
 
-	_block.reset(new BlockData());
-	_block->Position = 0;
+Serializer::Serializer(uint8_t* data, uint32_t size, uint32_t version)
+{
+	//Loads directly from an uncompressed state in memory, without copying it
+	_version = version;
+	_saving = false;
+	InitLoad(data, size);
+}
+
+Serializer::Serializer(istream &file, uint32_t version, bool compressed)
+{
+	_version = version;
 	_saving = false;
 
 	if(compressed) {
@@ -32,36 +62,50 @@ Serializer::Serializer(istream &file, uint32_t version, bool compressed)
 		vector<uint8_t> compressedData(compressedSize, 0);
 		file.read((char*)compressedData.data(), compressedSize);
 
-		_block->Data = vector<uint8_t>(decompressedSize, 0);
+		_ownedBuffer = vector<uint8_t>(decompressedSize, 0);
 
 		unsigned long decompSize = decompressedSize;
-		uncompress(_block->Data.data(), &decompSize, compressedData.data(), (unsigned long)compressedData.size());
+		uncompress(_ownedBuffer.data(), &decompSize, compressedData.data(), (unsigned long)compressedData.size());
 	} else {
 		file.seekg(0, std::ios::end);
 		uint32_t size = (uint32_t)file.tellg();
 		file.seekg(0, std::ios::beg);
 
-		_block->Data = vector<uint8_t>(size, 0);
-		file.read((char*)_block->Data.data(), size);
+		_ownedBuffer = vector<uint8_t>(size, 0);
+		file.read((char*)_ownedBuffer.data(), size);
 	}
+
+	InitLoad(_ownedBuffer.data(), (uint32_t)_ownedBuffer.size());
+}
+
+void Serializer::InitLoad(uint8_t* data, uint32_t size)
+{
+	_data = data;
+	_dataSize = size;
+	_position = 0;
+	_blockEnd = size;
 }
 
 void Serializer::EnsureCapacity(uint32_t typeSize)
 {
-	//Make sure the current block/stream is large enough to fit the next write
-	uint32_t oldSize = (uint32_t)_block->Data.size();
-	if(oldSize == 0) {
-		oldSize = typeSize * 2;
+	//Make sure the buffer is large enough to fit the next write
+	uint32_t sizeRequired = _position + typeSize;
+	if(sizeRequired <= _dataSize) {
+		return;
 	}
 
-	uint32_t sizeRequired = _block->Position + typeSize;
-	
-	uint32_t newSize = oldSize;
+	if(!_buffer) {
+		throw std::runtime_error("Save state buffer is too small");
+	}
+
+	uint32_t newSize = std::max<uint32_t>(_dataSize, 0x100);
 	while(newSize < sizeRequired) {
 		newSize *= 2;
 	}
 
-	_block->Data.resize(newSize);
+	_buffer->resize(newSize);
+	_data = _buffer->data();
+	_dataSize = newSize;
 }
 
 void Serializer::RecursiveStream()
@@ -70,48 +114,47 @@ void Serializer::RecursiveStream()
 
 void Serializer::StreamStartBlock()
 {
-	unique_ptr<BlockData> block(new BlockData());
-	block->Position = 0;
-
-	if(!_saving) {
-		VectorInfo<uint8_t> vectorInfo = { &block->Data };
-		InternalStream(vectorInfo);
+	//Each block is stored as its size (uint32), followed by its content
+	if(_saving) {
+		EnsureCapacity(sizeof(uint32_t));
+		_blockStack.push_back(_position);
+		_position += sizeof(uint32_t);
 	} else {
-		block->Data = vector<uint8_t>(0x100);
+		uint32_t blockSize = 0;
+		StreamElement<uint32_t>(blockSize);
+		_blockStack.push_back(_blockEnd);
+		_blockEnd = _position + std::min(blockSize, _blockEnd - _position);
 	}
-
-	_blocks.push_back(std::move(_block));
-	_block = std::move(block);
 }
 
 void Serializer::StreamEndBlock()
 {
-	if(_blocks.empty()) {
+	if(_blockStack.empty()) {
 		throw std::runtime_error("Invalid call to end block");
 	}
 
-	unique_ptr<BlockData> block = std::move(_block);
-
-	_block = std::move(_blocks.back());
-	_blocks.pop_back();
-
 	if(_saving) {
-		ArrayInfo<uint8_t> arrayInfo { block->Data.data(), block->Position };
-		InternalStream(arrayInfo);
+		uint32_t blockStart = _blockStack.back();
+		uint32_t blockSize = _position - blockStart - sizeof(uint32_t);
+		memcpy(_data + blockStart, &blockSize, sizeof(uint32_t));
+	} else {
+		_position = _blockEnd;
+		_blockEnd = _blockStack.back();
 	}
+	_blockStack.pop_back();
 }
 
 void Serializer::Save(ostream& file, int compressionLevel)
 {
 	if(compressionLevel == 0) {
-		file.write((char*)_block->Data.data(), _block->Position);
+		file.write((char*)_data, _position);
 	} else {
-		unsigned long compressedSize = compressBound((unsigned long)_block->Position);
+		unsigned long compressedSize = compressBound((unsigned long)_position);
 		uint8_t* compressedData = new uint8_t[compressedSize];
-		compress2(compressedData, &compressedSize, (unsigned char*)_block->Data.data(), (unsigned long)_block->Position, compressionLevel);
+		compress2(compressedData, &compressedSize, (unsigned char*)_data, (unsigned long)_position, compressionLevel);
 
 		uint32_t size = (uint32_t)compressedSize;
-		file.write((char*)&_block->Position, sizeof(uint32_t));
+		file.write((char*)&_position, sizeof(uint32_t));
 		file.write((char*)&size, sizeof(uint32_t));
 		file.write((char*)compressedData, compressedSize);
 		delete[] compressedData;
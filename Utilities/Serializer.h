@@ -25,23 +25,26 @@ struct ValueInfo
 	T DefaultValue;
 };
 
-struct BlockData
-{
-	vector<uint8_t> Data;
-	uint32_t Position;
-};
-
 class Serializer
 {
 private:
-	vector<unique_ptr<BlockData>> _blocks;	
-	unique_ptr<BlockData> _block;
+	//All blocks are written to (or read from) a single flat buffer
+	//When saving, each block's size is reserved when the block starts and patched when it ends
+	vector<uint8_t> _ownedBuffer;
+	vector<uint8_t>* _buffer = nullptr;
+	uint8_t* _data = nullptr;
+	uint32_t _dataSize = 0;
+
+	uint32_t _position = 0;
+	uint32_t _blockEnd = 0;
+	vector<uint32_t> _blockStack;
 
 	uint32_t _version = 0;
 	bool _saving = false;
 
 private:
 	void EnsureCapacity(uint32_t typeSize);
+	void InitLoad(uint8_t* data, uint32_t size);
 
 	template<typename T> void StreamElement(T &value, T defaultValue = T());
 	
@@ -59,10 +62,14 @@ private:
 
 public:
 	Serializer(uint32_t version);
+	Serializer(uint32_t version, vector<uint8_t> &buffer);
+	Serializer(uint32_t version, uint8_t* buffer, uint32_t bufferSize);
+	Serializer(uint8_t* data, uint32_t size, uint32_t version);
 	Serializer(istream &file, uint32_t version, bool compressed = true);
 
 	uint32_t GetVersion() { return _version; }
 	bool IsSaving() { return _saving; }
+	uint32_t GetSize() { return _position; }
 
 	template<typename... T> void Stream(T&... args);
 	template<typename T> void StreamArray(T *array, uint32_t size);
@@ -81,20 +88,16 @@ template<typename T>
 void Serializer::StreamElement(T &value, T defaultValue)
 {
 	if(_saving) {
-		uint8_t* bytes = (uint8_t*)&value;
-		int typeSize = sizeof(T);
-
-		EnsureCapacity(typeSize);
-		for(int i = 0; i < typeSize; i++) {
-			_block->Data[_block->Position++] = bytes[i];
-		}
+		EnsureCapacity(sizeof(T));
+		memcpy(_data + _position, &value, sizeof(T));
+		_position += sizeof(T);
 	} else {
-		if(_block->Position + sizeof(T) <= _block->Data.size()) {
-			memcpy(&value, _block->Data.data() + _block->Position, sizeof(T));
-			_block->Position += sizeof(T);
+		if(_position + sizeof(T) <= _blockEnd) {
+			memcpy(&value, _data + _position, sizeof(T));
+			_position += sizeof(T);
 		} else {
 			value = defaultValue;
-			_block->Position = (uint32_t)_block->Data.size();
+			_position = _blockEnd;
 		}
 	}
 }
@@ -105,20 +108,19 @@ void Serializer::InternalStream(ArrayInfo<T> &info)
 	uint32_t count = info.ElementCount;
 	StreamElement<uint32_t>(count);
 
-	if(!_saving) {
-		//Reset array to 0 before loading from file
-		memset(info.Array, 0, info.ElementCount * sizeof(T));
-	}
-
-	//Load the number of elements requested, or the maximum possible (based on what is present in the save state)
-	EnsureCapacity(info.ElementCount * sizeof(T));
-
+	uint32_t size = info.ElementCount * sizeof(T);
 	if(_saving) {
-		memcpy(_block->Data.data() + _block->Position, info.Array, info.ElementCount * sizeof(T));
+		EnsureCapacity(size);
+		memcpy(_data + _position, info.Array, size);
+		_position += size;
 	} else {
-		memcpy(info.Array, _block->Data.data() + _block->Position, info.ElementCount * sizeof(T));
+		//Load the number of elements requested, or the maximum possible (based on what is present in the save state)
+		//Anything missing from the save state is reset to 0
+		uint32_t available = std::min(size, _blockEnd - _position);
+		memcpy(info.Array, _data + _position, available);
+		memset((uint8_t*)info.Array + available, 0, size - available);
+		_position += available;
 	}
-	_block->Position += info.ElementCount * sizeof(T);
 }
 
 template<typename T>
@@ -129,19 +131,21 @@ void Serializer::InternalStream(VectorInfo<T> &info)
 	uint32_t count = (uint32_t)vector->size();
 	StreamElement<uint32_t>(count);
 
-	if(!_saving) {
+	uint32_t size = count * sizeof(T);
+	if(_saving) {
+		EnsureCapacity(size);
+		memcpy(_data + _position, vector->data(), size);
+		_position += size;
+	} else {
 		if(count > 0xFFFFFF) {
 			throw std::runtime_error("Invalid save state");
 		}
 		vector->resize(count);
-		memset(vector->data(), 0, sizeof(T)*count);
-	}
 
-	//Load the number of elements requested
-	T* pointer = vector->data();
-	for(uint32_t i = 0; i < count; i++) {
-		StreamElement<T>(*pointer);
-		pointer++;
+		uint32_t available = std::min(size, _blockEnd - _position);
+		memcpy(vector->data(), _data + _position, available);
+		memset((uint8_t*)vector->data() + available, 0, size - available);
+		_position += available;
 	}
 }
 
@@ -0,0 +1,133 @@
+#pragma once
+#include "stdafx.h"
+
+//Lock-free ring buffer, for a single producer thread and a single consumer thread (e.g the emulation thread and an audio callback)
+//The cursors are free-running counters that wrap around at 2^32 (the capacity is a power of 2), so the amount of data in
+//the buffer is always writeCursor - readCursor. Each thread only ever modifies its own cursor, and only publishes it (with
+//release semantics) once the data it covers has been copied, so the other thread never sees a cursor before its data.
+//Writes that don't fit in the buffer are truncated (overrun) and reads that ask for more data than is available are
+//partial (underrun) - both events are counted, along with the number of elements that were dropped by overruns.
+template<typename T>
+class SpscRingBuffer
+{
+private:
+	vector<T> _buffer;
+	uint32_t _mask = 0;
+
+	atomic<uint32_t> _writeCursor;
+	atomic<uint32_t> _readCursor;
+
+	atomic<uint32_t> _overrunCount;
+	atomic<uint32_t> _underrunCount;
+	atomic<uint64_t> _droppedCount;
+
+public:
+	SpscRingBuffer()
+	{
+		_writeCursor = 0;
+		_readCursor = 0;
+		ResetCounters();
+	}
+
+	//Must only be called while neither thread is using the buffer
+	void Reset(uint32_t minCapacity)
+	{
+		uint32_t capacity = 1;
+		while(capacity < minCapacity) {
+			capacity <<= 1;
+		}
+
+		if(_buffer.size() != capacity) {
+			_buffer = vector<T>(capacity);
+			_mask = capacity - 1;
+		}
+		Clear();
+		ResetCounters();
+	}
+
+	//Must only be called while neither thread is using the buffer
+	void Clear()
+	{
+		_writeCursor = 0;
+		_readCursor = 0;
+	}
+
+	//Producer: copies up to "count" elements into the buffer, returns the number of elements that were written
+	uint32_t Write(const T* data, uint32_t count)
+	{
+		uint32_t writeCursor = _writeCursor.load(std::memory_order_relaxed);
+		uint32_t readCursor = _readCursor.load(std::memory_order_acquire);
+		uint32_t freeCount = (uint32_t)_buffer.size() - (writeCursor - readCursor);
+
+		if(count > freeCount) {
+			_overrunCount++;
+			_droppedCount += count - freeCount;
+			count = freeCount;
+		}
+
+		uint32_t start = writeCursor & _mask;
+		uint32_t firstPart = std::min(count, (uint32_t)_buffer.size() - start);
+		memcpy(_buffer.data() + start, data, firstPart * sizeof(T));
+		memcpy(_buffer.data(), data + firstPart, (count - firstPart) * sizeof(T));
+
+		_writeCursor.store(writeCursor + count, std::memory_order_release);
+		return count;
+	}
+
+	//Consumer: copies up to "count" elements from the buffer, returns the number of elements that were read
+	uint32_t Read(T* output, uint32_t count)
+	{
+		uint32_t readCursor = _readCursor.load(std::memory_order_relaxed);
+		uint32_t writeCursor = _writeCursor.load(std::memory_order_acquire);
+		uint32_t availableCount = writeCursor - readCursor;
+
+		if(count > availableCount) {
+			_underrunCount++;
+			count = availableCount;
+		}
+
+		uint32_t start = readCursor & _mask;
+		uint32_t firstPart = std::min(count, (uint32_t)_buffer.size() - start);
+		memcpy(output, _buffer.data() + start, firstPart * sizeof(T));
+		memcpy(output + firstPart, _buffer.data(), (count - firstPart) * sizeof(T));
+
+		_readCursor.store(readCursor + count, std::memory_order_release);
+		return count;
+	}
+
+	//Either thread: number of elements that can be read (the value can be outdated by the time it is used by the caller)
+	uint32_t GetAvailableCount()
+	{
+		//Read cursor first: the write cursor can only be ahead of the value it had at that point
+		uint32_t readCursor = _readCursor.load(std::memory_order_acquire);
+		uint32_t writeCursor = _writeCursor.load(std::memory_order_acquire);
+		return std::min(writeCursor - readCursor, (uint32_t)_buffer.size());
+	}
+
+	uint32_t GetCapacity()
+	{
+		return (uint32_t)_buffer.size();
+	}
+
+	uint32_t GetOverrunCount()
+	{
+		return _overrunCount;
+	}
+
+	uint32_t GetUnderrunCount()
+	{
+		return _underrunCount;
+	}
+
+	uint64_t GetDroppedCount()
+	{
+		return _droppedCount;
+	}
+
+	void ResetCounters()
+	{
+		_overrunCount = 0;
+		_underrunCount = 0;
+		_droppedCount = 0;
+	}
+};
@@ -0,0 +1,77 @@
+#pragma once
+#include "stdafx.h"
+
+//Lock-free triple buffer, for a single producer thread and a single consumer thread
+//The producer always has a buffer it can write to (it never waits for the consumer), and the consumer
+//always receives the most recent buffer that was published. Buffers that are replaced by a newer
+//one before the consumer gets to them are counted as dropped.
+template<typename T>
+class TripleBuffer
+{
+private:
+	static constexpr uint8_t IndexMask = 0x03;
+	static constexpr uint8_t NewDataFlag = 0x04;
+
+	T _buffers[3];
+
+	//Only used by the producer
+	uint8_t _writeIndex = 0;
+
+	//Buffer that is shared between both threads - NewDataFlag is set when it was published but not consumed yet
+	atomic<uint8_t> _sharedIndex;
+
+	//Only used by the consumer
+	uint8_t _readIndex = 2;
+
+	atomic<uint32_t> _droppedCount;
+
+public:
+	TripleBuffer()
+	{
+		_sharedIndex = 1;
+		_droppedCount = 0;
+	}
+
+	//Producer: buffer to fill before calling Publish()
+	T& GetWriteBuffer()
+	{
+		return _buffers[_writeIndex];
+	}
+
+	//Producer: makes the write buffer available to the consumer, and gets a new buffer to write to
+	void Publish()
+	{
+		uint8_t previous = _sharedIndex.exchange(_writeIndex | NewDataFlag);
+		if(previous & NewDataFlag) {
+			_droppedCount++;
+		}
+		_writeIndex = previous & IndexMask;
+	}
+
+	//Consumer: returns true (and updates the read buffer) if a new buffer was published since the last call
+	bool Consume()
+	{
+		if(!(_sharedIndex.load() & NewDataFlag)) {
+			return false;
+		}
+
+		_readIndex = _sharedIndex.exchange(_readIndex) & IndexMask;
+		return true;
+	}
+
+	//Consumer: last buffer returned by Consume()
+	T& GetReadBuffer()
+	{
+		return _buffers[_readIndex];
+	}
+
+	uint32_t GetDroppedCount()
+	{
+		return _droppedCount;
+	}
+
+	void ResetDroppedCount()
+	{
+		_droppedCount = 0;
+	}
+};
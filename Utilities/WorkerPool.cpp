@@ -0,0 +1,88 @@
+#include "stdafx.h"
+#include "WorkerPool.h"
+
+WorkerPool::WorkerPool(uint32_t threadCount)
+{
+	_nextTask = 0;
+	for(uint32_t i = 1; i < threadCount; i++) {
+		_threads.push_back(std::thread(&WorkerPool::WorkerThread, this));
+	}
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		_stopFlag = true;
+	}
+	_startSignal.notify_all();
+
+	for(std::thread& thread : _threads) {
+		thread.join();
+	}
+}
+
+uint32_t WorkerPool::GetThreadCount()
+{
+	return (uint32_t)_threads.size() + 1;
+}
+
+void WorkerPool::ProcessTasks(const std::function<void(uint32_t)>& task, uint32_t taskCount)
+{
+	uint32_t taskIndex;
+	while((taskIndex = _nextTask++) < taskCount) {
+		task(taskIndex);
+	}
+}
+
+void WorkerPool::WorkerThread()
+{
+	uint64_t lastJobId = 0;
+	while(true) {
+		const std::function<void(uint32_t)>* task;
+		uint32_t taskCount;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_startSignal.wait(lock, [=] { return _stopFlag || _jobId != lastJobId; });
+			if(_stopFlag) {
+				return;
+			}
+			lastJobId = _jobId;
+			task = _task;
+			taskCount = _taskCount;
+		}
+
+		ProcessTasks(*task, taskCount);
+
+		std::unique_lock<std::mutex> lock(_mutex);
+		if(--_activeWorkers == 0) {
+			_doneSignal.notify_one();
+		}
+	}
+}
+
+void WorkerPool::Run(uint32_t taskCount, const std::function<void(uint32_t)>& task)
+{
+	if(_threads.empty() || taskCount <= 1) {
+		for(uint32_t i = 0; i < taskCount; i++) {
+			task(i);
+		}
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		_task = &task;
+		_taskCount = taskCount;
+		_nextTask = 0;
+		_activeWorkers = (uint32_t)_threads.size();
+		_jobId++;
+	}
+	_startSignal.notify_all();
+
+	ProcessTasks(task, taskCount);
+
+	//Wait for the workers to finish their current task (and to stop referencing the task)
+	std::unique_lock<std::mutex> lock(_mutex);
+	_doneSignal.wait(lock, [=] { return _activeWorkers == 0; });
+}
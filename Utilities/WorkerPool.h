@@ -0,0 +1,37 @@
+#pragma once
+#include "stdafx.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+//Small pool of persistent threads used to split a job into independent tasks (e.g bands of an image)
+//The calling thread also processes tasks, so a pool with a thread count of 1 doesn't start any thread.
+class WorkerPool
+{
+private:
+	vector<std::thread> _threads;
+	std::mutex _mutex;
+	std::condition_variable _startSignal;
+	std::condition_variable _doneSignal;
+
+	const std::function<void(uint32_t)>* _task = nullptr;
+	uint32_t _taskCount = 0;
+	atomic<uint32_t> _nextTask;
+	uint32_t _activeWorkers = 0;
+	uint64_t _jobId = 0;
+	bool _stopFlag = false;
+
+	void WorkerThread();
+	void ProcessTasks(const std::function<void(uint32_t)>& task, uint32_t taskCount);
+
+public:
+	WorkerPool(uint32_t threadCount);
+	~WorkerPool();
+
+	//Number of threads that process tasks, including the calling thread
+	uint32_t GetThreadCount();
+
+	//Calls task(i) for each i in [0, taskCount) and returns once all tasks are done
+	void Run(uint32_t taskCount, const std::function<void(uint32_t)>& task);
+};
@@ -381,6 +381,12 @@ namespace orfanidis_eq {
 			return df1_fo_process(in);
 		}
 
+		//Used by the vectorized equalizer (Equalizer.cpp)
+		void get_coefficients(eq_single_t* b, eq_single_t* a) const {
+			b[0] = b0; b[1] = b1; b[2] = b2; b[3] = b3; b[4] = b4;
+			a[0] = a0; a[1] = a1; a[2] = a2; a[3] = a3; a[4] = a4;
+		}
+
 		virtual fo_section get() {
 			return *this;
 		}
@@ -468,6 +474,7 @@ namespace orfanidis_eq {
 		virtual ~bp_filter() {}
 
 		virtual eq_single_t process(eq_single_t in) = 0;
+		virtual const std::vector<fo_section>& get_sections() = 0;
 	};
 
 	class butterworth_bp_filter : public bp_filter
@@ -537,6 +544,8 @@ namespace orfanidis_eq {
 			return bw_gain;
 		}
 
+		const std::vector<fo_section>& get_sections() { return sections_; }
+
 		virtual eq_single_t process(eq_single_t in) {
 			eq_single_t p0 = in;
 			eq_single_t p1 = 0;
@@ -619,6 +628,8 @@ namespace orfanidis_eq {
 			return bw_gain;
 		}
 
+		const std::vector<fo_section>& get_sections() { return sections_; }
+
 		eq_single_t process(eq_single_t in) {
 			eq_single_t p0 = in;
 			eq_single_t p1 = 0;
@@ -697,6 +708,8 @@ namespace orfanidis_eq {
 			return bw_gain;
 		}
 
+		const std::vector<fo_section>& get_sections() { return sections_; }
+
 		eq_single_t process(eq_single_t in) {
 			eq_single_t p0 = in;
 			eq_single_t p1 = 0;
@@ -894,6 +907,8 @@ namespace orfanidis_eq {
 		unsigned int get_number_of_bands() {
 			return freq_grid_.get_number_of_bands();
 		}
+		bp_filter* get_band_filter(unsigned int band_number) { return filters_[band_number]; }
+		eq_single_t get_band_gain(unsigned int band_number) { return band_gains_[band_number]; }
 		const char* get_version() { return eq_version; }
 	};
 